@@ -0,0 +1,205 @@
+/* Copyright (c) 2017, Waterloo Autonomous Vehicles Laboratory (WAVELab),
+ * Waterloo Intelligent Systems Engineering Lab (WISELab),
+ * University of Waterloo.
+ *
+ * Refer to the accompanying LICENSE file for license information.
+ *
+ * ############################################################################
+ ******************************************************************************
+ |                                                                            |
+ |                         /\/\__/\_/\      /\_/\__/\/\                       |
+ |                         \          \____/          /                       |
+ |                          '----________________----'                        |
+ |                              /                \                            |
+ |                            O/_____/_______/____\O                          |
+ |                            /____________________\                          |
+ |                           /    (#UNIVERSITY#)    \                         |
+ |                           |[**](#OFWATERLOO#)[**]|                         |
+ |                           \______________________/                         |
+ |                            |_""__|_,----,_|__""_|                          |
+ |                            ! !                ! !                          |
+ |                            '-'                '-'                          |
+ |       __    _   _  _____  ___  __  _  ___  _    _  ___  ___   ____  ____   |
+ |      /  \  | | | ||_   _|/ _ \|  \| |/ _ \| \  / |/ _ \/ _ \ /     |       |
+ |     / /\ \ | |_| |  | |  ||_||| |\  |||_|||  \/  |||_||||_|| \===\ |====   |
+ |    /_/  \_\|_____|  |_|  \___/|_| \_|\___/|_|\/|_|\___/\___/ ____/ |____   |
+ |                                                                            |
+ ******************************************************************************
+ * ############################################################################
+ *
+ * File: local_tangent_frame.hpp
+ * Desc: Local ENU frame with a precomputed datum transform
+ *
+ * ############################################################################
+*/
+
+#ifndef WAVE_GEOGRAPHY_LOCAL_TANGENT_FRAME_HPP
+#define WAVE_GEOGRAPHY_LOCAL_TANGENT_FRAME_HPP
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include "wave/utils/math.hpp"
+
+namespace wave {
+
+/** A local Cartesian ENU frame defined by a fixed datum point.
+ *
+ *  The ECEF <-> ENU transforms are computed once on construction, so
+ *  converting points, poses and covariances to or from the frame is a matrix
+ *  product rather than a call to enuPointFromLLH() or llhPointFromENU() per
+ *  point. The NED and NWU frames at the same datum are also provided.
+ */
+class LocalTangentFrame {
+ public:
+    /** Constructs the frame at a datum point.
+     *
+     *  @param[in] datum the LLH datum point defining the local ENU frame. If
+     *  /p datum_is_llh is set to false, then the datum values are taken as
+     *  ECEF instead.
+     *  @param[in] datum_is_llh \b true: The given datum values are LLH
+     *  (default). <BR>
+     *  \b false: The given datum values are ECEF
+     */
+    explicit LocalTangentFrame(const Vec3 &datum, bool datum_is_llh = true);
+
+    /** The datum as (Latitude, Longitude, Height) */
+    const Vec3 &datumLLH() const {
+        return this->datum_llh;
+    }
+
+    /** The datum in the geocentric ECEF frame */
+    Vec3 datumECEF() const {
+        return this->T_ecef_enu.translation();
+    }
+
+    /** @name Transforms
+     *  Affine transforms converting column-vector points between frames
+     *  @{ */
+    const Affine3 &ecefFromENUTransform() const {
+        return this->T_ecef_enu;
+    }
+
+    const Affine3 &enuFromECEFTransform() const {
+        return this->T_enu_ecef;
+    }
+
+    const Affine3 &nedFromECEFTransform() const {
+        return this->T_ned_ecef;
+    }
+
+    const Affine3 &nwuFromECEFTransform() const {
+        return this->T_nwu_ecef;
+    }
+    /** @} */
+
+    /** @name Points
+     *  @{ */
+    Vec3 enuPointFromECEF(const Vec3 &point_ecef) const {
+        return this->T_enu_ecef * point_ecef;
+    }
+
+    Vec3 ecefPointFromENU(const Vec3 &point_enu) const {
+        return this->T_ecef_enu * point_enu;
+    }
+
+    Vec3 nedPointFromECEF(const Vec3 &point_ecef) const {
+        return this->T_ned_ecef * point_ecef;
+    }
+
+    Vec3 ecefPointFromNED(const Vec3 &point_ned) const {
+        return this->T_ecef_enu * (this->R_ned_enu.transpose() * point_ned);
+    }
+
+    Vec3 nwuPointFromECEF(const Vec3 &point_ecef) const {
+        return this->T_nwu_ecef * point_ecef;
+    }
+
+    Vec3 ecefPointFromNWU(const Vec3 &point_nwu) const {
+        return this->T_ecef_enu * (this->R_nwu_enu.transpose() * point_nwu);
+    }
+
+    /** Converts an LLH point to ENU, as enuPointFromLLH() */
+    Vec3 enuPointFromLLH(const Vec3 &point_llh) const;
+
+    /** Converts an ENU point to LLH, as llhPointFromENU() */
+    Vec3 llhPointFromENU(const Vec3 &point_enu) const;
+    /** @} */
+
+    /** @name Poses
+     *  Converts the pose of a body, T_frame_body, between frames
+     *  @{ */
+    Affine3 enuPoseFromECEF(const Affine3 &T_ecef_body) const {
+        return this->T_enu_ecef * T_ecef_body;
+    }
+
+    Affine3 ecefPoseFromENU(const Affine3 &T_enu_body) const {
+        return this->T_ecef_enu * T_enu_body;
+    }
+    /** @} */
+
+    /** @name Covariances
+     *  Rotates the covariance of a position, or of a 6-vector of two
+     *  world-frame errors such as (rotation, translation). Covariances of
+     *  errors in the body frame do not depend on the world frame.
+     *  @{ */
+    Mat3 enuCovarianceFromECEF(const Mat3 &cov_ecef) const {
+        const Mat3 &R = this->T_enu_ecef.linear();
+        return R * cov_ecef * R.transpose();
+    }
+
+    Mat3 ecefCovarianceFromENU(const Mat3 &cov_enu) const {
+        const Mat3 &R = this->T_ecef_enu.linear();
+        return R * cov_enu * R.transpose();
+    }
+
+    Mat6 enuCovarianceFromECEF(const Mat6 &cov_ecef) const {
+        return rotateCovariance(this->T_enu_ecef.linear(), cov_ecef);
+    }
+
+    Mat6 ecefCovarianceFromENU(const Mat6 &cov_enu) const {
+        return rotateCovariance(this->T_ecef_enu.linear(), cov_enu);
+    }
+    /** @} */
+
+    /** @name Batches
+     *  Convert each column of a 3xN matrix of points
+     *  @{ */
+    void enuPointsFromECEF(const Eigen::Ref<const Eigen::Matrix3Xd> &ecef,
+                           Eigen::Matrix3Xd &enu) const;
+
+    void ecefPointsFromENU(const Eigen::Ref<const Eigen::Matrix3Xd> &enu,
+                           Eigen::Matrix3Xd &ecef) const;
+
+    void enuPointsFromLLH(const Eigen::Ref<const Eigen::Matrix3Xd> &llh,
+                          Eigen::Matrix3Xd &enu) const;
+
+    void llhPointsFromENU(const Eigen::Ref<const Eigen::Matrix3Xd> &enu,
+                          Eigen::Matrix3Xd &llh) const;
+    /** @} */
+
+ private:
+    Vec3 datum_llh;
+    Affine3 T_ecef_enu;
+    Affine3 T_enu_ecef;
+    Affine3 T_ned_ecef;
+    Affine3 T_nwu_ecef;
+
+    // Rotations from ENU to the other local frames
+    Mat3 R_ned_enu;
+    Mat3 R_nwu_enu;
+
+    static Mat6 rotateCovariance(const Mat3 &R, const Mat6 &cov) {
+        Mat6 R6 = Mat6::Zero();
+        R6.topLeftCorner<3, 3>() = R;
+        R6.bottomRightCorner<3, 3>() = R;
+        return R6 * cov * R6.transpose();
+    }
+
+ public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+}  // namespace wave
+
+#endif  // WAVE_GEOGRAPHY_LOCAL_TANGENT_FRAME_HPP
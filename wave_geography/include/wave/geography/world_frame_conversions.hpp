@@ -38,6 +38,8 @@
 #define WAVE_GEOGRAPHY_WORLD_FRAME_CONVERSIONS_HPP
 
 #include <cmath>
+#include <cstddef>
+#include <Eigen/Core>
 #include <GeographicLib/Geocentric.hpp>
 #include <GeographicLib/LocalCartesian.hpp>
 
@@ -129,5 +131,64 @@ void llhPointFromENU(const double point_enu[3],
                      double point_llh[3],
                      bool datum_is_llh = true);
 
+/** Converts each column of a 3xN matrix of LLH points to ECEF, as
+ *  ecefPointFromLLH() does for a single point.
+ *
+ *  The closed-form conversion is evaluated over all points at once, without
+ *  constructing GeographicLib objects per point.
+ *
+ *  @param[in] llh the input llh points as columns of (Latitude, Longitude,
+ *  Height).
+ *  @param[out] ecef the corresponding points in the geocentric ECEF frame,
+ *  resized to match \p llh.
+ */
+void ecefPointsFromLLH(const Eigen::Ref<const Eigen::Matrix3Xd> &llh,
+                       Eigen::Matrix3Xd &ecef);
+
+/** Converts each column of a 3xN matrix of ECEF points to LLH, as
+ *  llhPointFromECEF() does for a single point.
+ *
+ *  Uses the closed-form solution of Vermeille (2002), evaluated over all
+ *  points at once. It agrees with GeographicLib to well under a micrometre.
+ *  The closed form is undefined within about 43 km of the Earth's centre, so
+ *  points there are converted with llhPointFromECEF() instead.
+ *
+ *  @param[in] ecef the input points in the geocentric ECEF frame.
+ *  @param[out] llh the corresponding llh points as columns of (Latitude,
+ *  Longitude, Height), resized to match \p ecef.
+ */
+void llhPointsFromECEF(const Eigen::Ref<const Eigen::Matrix3Xd> &ecef,
+                       Eigen::Matrix3Xd &llh);
+
+/** Converts \p n LLH points stored as separate arrays (structure of arrays)
+ *  to ECEF, as ecefPointsFromLLH().
+ *
+ *  @param[in] n the number of points.
+ *  @param[in] latitude, longitude, height the input arrays of \p n values.
+ *  @param[out] x, y, z the output arrays of \p n ECEF coordinates.
+ */
+void ecefPointsFromLLH(std::size_t n,
+                       const double *latitude,
+                       const double *longitude,
+                       const double *height,
+                       double *x,
+                       double *y,
+                       double *z);
+
+/** Converts \p n ECEF points stored as separate arrays (structure of arrays)
+ *  to LLH, as llhPointsFromECEF().
+ *
+ *  @param[in] n the number of points.
+ *  @param[in] x, y, z the input arrays of \p n ECEF coordinates.
+ *  @param[out] latitude, longitude, height the output arrays of \p n values.
+ */
+void llhPointsFromECEF(std::size_t n,
+                       const double *x,
+                       const double *y,
+                       const double *z,
+                       double *latitude,
+                       double *longitude,
+                       double *height);
+
 }  // namespace wave
 #endif  // WAVE_GEOGRAPHY_WORLD_FRAME_CONVERSIONS_HPP
@@ -0,0 +1,112 @@
+/* Copyright (c) 2017, Waterloo Autonomous Vehicles Laboratory (WAVELab),
+ * Waterloo Intelligent Systems Engineering Lab (WISELab),
+ * University of Waterloo.
+ *
+ * Refer to the accompanying LICENSE file for license information.
+ *
+ * ############################################################################
+ ******************************************************************************
+ |                                                                            |
+ |                         /\/\__/\_/\      /\_/\__/\/\                       |
+ |                         \          \____/          /                       |
+ |                          '----________________----'                        |
+ |                              /                \                            |
+ |                            O/_____/_______/____\O                          |
+ |                            /____________________\                          |
+ |                           /    (#UNIVERSITY#)    \                         |
+ |                           |[**](#OFWATERLOO#)[**]|                         |
+ |                           \______________________/                         |
+ |                            |_""__|_,----,_|__""_|                          |
+ |                            ! !                ! !                          |
+ |                            '-'                '-'                          |
+ |       __    _   _  _____  ___  __  _  ___  _    _  ___  ___   ____  ____   |
+ |      /  \  | | | ||_   _|/ _ \|  \| |/ _ \| \  / |/ _ \/ _ \ /     |       |
+ |     / /\ \ | |_| |  | |  ||_||| |\  |||_|||  \/  |||_||||_|| \===\ |====   |
+ |    /_/  \_\|_____|  |_|  \___/|_| \_|\___/|_|\/|_|\___/\___/ ____/ |____   |
+ |                                                                            |
+ ******************************************************************************
+ * ############################################################################
+ *
+ * File: local_tangent_frame.cpp
+ * Desc: Implementation file for LocalTangentFrame
+ *
+ * ############################################################################
+*/
+
+#include "wave/geography/local_tangent_frame.hpp"
+#include "wave/geography/world_frame_conversions.hpp"
+
+namespace wave {
+
+LocalTangentFrame::LocalTangentFrame(const Vec3 &datum, bool datum_is_llh) {
+    double T[4][4];
+    ecefFromENUTransformMatrix(datum.data(), T, datum_is_llh);
+    this->T_ecef_enu.matrix() =
+      Eigen::Map<Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(&T[0][0]);
+    this->T_enu_ecef = this->T_ecef_enu.inverse(Eigen::Isometry);
+
+    if (datum_is_llh) {
+        this->datum_llh = datum;
+    } else {
+        llhPointFromECEF(datum.data(), this->datum_llh.data());
+    }
+
+    // Build the axis permutations column by column from the utils conversions
+    Mat3 R_enu_ned;
+    for (int i = 0; i < 3; ++i) {
+        Vec3 column;
+        ned2enu(Vec3::Unit(i), column);
+        R_enu_ned.col(i) = column;
+        enu2nwu(Vec3::Unit(i), column);
+        this->R_nwu_enu.col(i) = column;
+    }
+    this->R_ned_enu = R_enu_ned.transpose();
+
+    this->T_ned_ecef = this->R_ned_enu * this->T_enu_ecef;
+    this->T_nwu_ecef = this->R_nwu_enu * this->T_enu_ecef;
+}
+
+Vec3 LocalTangentFrame::enuPointFromLLH(const Vec3 &point_llh) const {
+    Vec3 point_ecef;
+    ecefPointFromLLH(point_llh.data(), point_ecef.data());
+    return this->enuPointFromECEF(point_ecef);
+}
+
+Vec3 LocalTangentFrame::llhPointFromENU(const Vec3 &point_enu) const {
+    const Vec3 point_ecef = this->ecefPointFromENU(point_enu);
+    Vec3 point_llh;
+    llhPointFromECEF(point_ecef.data(), point_llh.data());
+    return point_llh;
+}
+
+void LocalTangentFrame::enuPointsFromECEF(
+  const Eigen::Ref<const Eigen::Matrix3Xd> &ecef,
+  Eigen::Matrix3Xd &enu) const {
+    enu = this->T_enu_ecef.linear() * ecef;
+    enu.colwise() += this->T_enu_ecef.translation();
+}
+
+void LocalTangentFrame::ecefPointsFromENU(
+  const Eigen::Ref<const Eigen::Matrix3Xd> &enu,
+  Eigen::Matrix3Xd &ecef) const {
+    ecef = this->T_ecef_enu.linear() * enu;
+    ecef.colwise() += this->T_ecef_enu.translation();
+}
+
+void LocalTangentFrame::enuPointsFromLLH(
+  const Eigen::Ref<const Eigen::Matrix3Xd> &llh,
+  Eigen::Matrix3Xd &enu) const {
+    Eigen::Matrix3Xd ecef;
+    ecefPointsFromLLH(llh, ecef);
+    this->enuPointsFromECEF(ecef, enu);
+}
+
+void LocalTangentFrame::llhPointsFromENU(
+  const Eigen::Ref<const Eigen::Matrix3Xd> &enu,
+  Eigen::Matrix3Xd &llh) const {
+    Eigen::Matrix3Xd ecef;
+    this->ecefPointsFromENU(enu, ecef);
+    llhPointsFromECEF(ecef, llh);
+}
+
+}  // namespace wave
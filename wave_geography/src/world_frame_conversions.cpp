@@ -34,11 +34,127 @@
  * ############################################################################
 */
 
+#include <algorithm>
+#include <cmath>
 #include <Eigen/Core>
 #include "wave/geography/world_frame_conversions.hpp"
 
 namespace wave {
 
+namespace {
+
+// WGS84 ellipsoid, as used by GeographicLib::Geocentric::WGS84()
+const double WGS84_A = 6378137.0;
+const double WGS84_F = 1.0 / 298.257223563;
+const double WGS84_E2 = WGS84_F * (2.0 - WGS84_F);
+
+const double DEG_TO_RAD = M_PI / 180.0;
+
+// Points converted at a time. Intermediate arrays of this size stay on the
+// stack and in cache, while being long enough to vectorize over.
+const Eigen::Index CHUNK_SIZE = 256;
+
+using Chunk = Eigen::Array<double, Eigen::Dynamic, 1, 0, CHUNK_SIZE, 1>;
+
+// Accepts both contiguous arrays and the rows of a 3xN matrix
+using ArrayRef = Eigen::Ref<Eigen::ArrayXd, 0, Eigen::InnerStride<>>;
+using ConstArrayRef =
+  Eigen::Ref<const Eigen::ArrayXd, 0, Eigen::InnerStride<>>;
+
+Chunk atan2Chunk(const Chunk &y, const Chunk &x) {
+    return y.binaryExpr(x, [](double a, double b) { return std::atan2(a, b); });
+}
+
+// Closed-form geodetic to geocentric conversion
+void ecefFromLLHChunk(const ConstArrayRef &latitude,
+                      const ConstArrayRef &longitude,
+                      const ConstArrayRef &height,
+                      ArrayRef x,
+                      ArrayRef y,
+                      ArrayRef z) {
+    const Chunk phi = DEG_TO_RAD * latitude;
+    const Chunk lambda = DEG_TO_RAD * longitude;
+    const Chunk sin_phi = phi.sin();
+
+    // Prime vertical radius of curvature
+    const Chunk N = WGS84_A / (1.0 - WGS84_E2 * sin_phi.square()).sqrt();
+    const Chunk r = (N + height) * phi.cos();
+
+    x = r * lambda.cos();
+    y = r * lambda.sin();
+    z = (N * (1.0 - WGS84_E2) + height) * sin_phi;
+}
+
+// Closed-form geocentric to geodetic conversion of Vermeille (2002), "Direct
+// transformation from geocentric coordinates to geodetic coordinates"
+void llhFromECEFChunk(const ConstArrayRef &x,
+                      const ConstArrayRef &y,
+                      const ConstArrayRef &z,
+                      ArrayRef latitude,
+                      ArrayRef longitude,
+                      ArrayRef height) {
+    const double e4 = WGS84_E2 * WGS84_E2;
+    const double a2 = WGS84_A * WGS84_A;
+
+    const Chunk xy2 = x.square() + y.square();
+    const Chunk z2 = z.square();
+    const Chunk p = xy2 / a2;
+    const Chunk q = (1.0 - WGS84_E2) / a2 * z2;
+    const Chunk r = (p + q - e4) / 6.0;
+    const Chunk s = e4 * p * q / (4.0 * r.cube());
+    const Chunk t = (1.0 + s + (s * (2.0 + s)).sqrt()).unaryExpr([](double v) {
+        return std::cbrt(v);
+    });
+    const Chunk u = r * (1.0 + t + t.inverse());
+    const Chunk v = (u.square() + e4 * q).sqrt();
+    const Chunk w = WGS84_E2 * (u + v - q) / (2.0 * v);
+    const Chunk k = (u + v + w.square()).sqrt() - w;
+    const Chunk D = k * xy2.sqrt() / (k + WGS84_E2);
+    const Chunk Dz = (D.square() + z2).sqrt();
+
+    latitude = 2.0 / DEG_TO_RAD * atan2Chunk(z, D + Dz);
+    longitude = 1.0 / DEG_TO_RAD * atan2Chunk(y, x);
+    height = (k + WGS84_E2 - 1.0) / k * Dz;
+
+    // The closed form is undefined inside the evolute of the ellipsoid,
+    // within about 43 km of the Earth's centre, where it gives a NaN height.
+    // Convert those points one at a time instead.
+    for (Eigen::Index i = 0; i < height.size(); ++i) {
+        if (!std::isfinite(height[i])) {
+            const double ecef[3] = {x[i], y[i], z[i]};
+            double llh[3];
+            llhPointFromECEF(ecef, llh);
+            latitude[i] = llh[0];
+            longitude[i] = llh[1];
+            height[i] = llh[2];
+        }
+    }
+}
+
+// Applies a chunk conversion to each chunk of three input and three output
+// arrays of equal length
+template <typename ChunkFunction>
+void convertChunks(ChunkFunction f,
+                   const ConstArrayRef &in0,
+                   const ConstArrayRef &in1,
+                   const ConstArrayRef &in2,
+                   ArrayRef out0,
+                   ArrayRef out1,
+                   ArrayRef out2) {
+    const auto n = in0.size();
+    for (Eigen::Index i = 0; i < n; i += CHUNK_SIZE) {
+        const auto len = std::min(CHUNK_SIZE, n - i);
+        f(in0.segment(i, len),
+          in1.segment(i, len),
+          in2.segment(i, len),
+          out0.segment(i, len),
+          out1.segment(i, len),
+          out2.segment(i, len));
+    }
+}
+
+}  // namespace
+
 void ecefPointFromLLH(const double llh[3], double ecef[3]) {
     double latitude = llh[0], longitude = llh[1], height = llh[2];
 
@@ -111,44 +227,17 @@ void ecefFromENUTransformMatrix(const double datum[3],
 void enuFromECEFTransformMatrix(const double datum[3],
                                 double T_enu_ecef[4][4],
                                 bool datum_is_llh) {
-    // Get T_ecef_enu and then invert it
     double T_ecef_enu[4][4];
     ecefFromENUTransformMatrix(datum, T_ecef_enu, datum_is_llh);
 
     // Affine inverse: [R | t]^(-1) = [ R^T | - R^T * t]
-    // TODO(msmart/benskikos) - Move these functions to somewhere where we have
-    // matrix classes and ownership since it is ours. Manual transposition is
-    // undesirable. The below should be 2 lines:
-    // R_new = R.transpose(); t_new = - R.transpose()*t;
-    T_enu_ecef[0][0] = T_ecef_enu[0][0];
-    T_enu_ecef[0][1] = T_ecef_enu[1][0];
-    T_enu_ecef[0][2] = T_ecef_enu[2][0];
-    T_enu_ecef[1][0] = T_ecef_enu[0][1];
-    T_enu_ecef[1][1] = T_ecef_enu[1][1];
-    T_enu_ecef[1][2] = T_ecef_enu[2][1];
-    T_enu_ecef[2][0] = T_ecef_enu[0][2];
-    T_enu_ecef[2][1] = T_ecef_enu[1][2];
-    T_enu_ecef[2][2] = T_ecef_enu[2][2];
-
-    // Affine inverse translation component: -R_inverse * b
-    //    with b as the 4th column of T_ecef_enu
-    T_enu_ecef[0][3] = -T_enu_ecef[0][0] * T_ecef_enu[0][3]    //
-                       - T_enu_ecef[0][1] * T_ecef_enu[1][3]   //
-                       - T_enu_ecef[0][2] * T_ecef_enu[2][3];  //
-
-    T_enu_ecef[1][3] = -T_enu_ecef[1][0] * T_ecef_enu[0][3]    //
-                       - T_enu_ecef[1][1] * T_ecef_enu[1][3]   //
-                       - T_enu_ecef[1][2] * T_ecef_enu[2][3];  //
-
-    T_enu_ecef[2][3] = -T_enu_ecef[2][0] * T_ecef_enu[0][3]    //
-                       - T_enu_ecef[2][1] * T_ecef_enu[1][3]   //
-                       - T_enu_ecef[2][2] * T_ecef_enu[2][3];  //
-
-    // Last row is the same
-    T_enu_ecef[3][0] = 0.0;
-    T_enu_ecef[3][1] = 0.0;
-    T_enu_ecef[3][2] = 0.0;
-    T_enu_ecef[3][3] = 1.0;
+    using RowMajorMat4 = Eigen::Matrix<double, 4, 4, Eigen::RowMajor>;
+    Eigen::Map<RowMajorMat4> T_out{&T_enu_ecef[0][0]};
+    const Eigen::Map<const RowMajorMat4> T_in{&T_ecef_enu[0][0]};
+    T_out.topLeftCorner<3, 3>() = T_in.topLeftCorner<3, 3>().transpose();
+    T_out.topRightCorner<3, 1>() =
+      -T_out.topLeftCorner<3, 3>() * T_in.topRightCorner<3, 1>();
+    T_out.row(3) << 0.0, 0.0, 0.0, 1.0;
 }
 
 void enuPointFromLLH(const double point_llh[3],
@@ -203,4 +292,66 @@ void llhPointFromENU(const double point_enu[3],
                      point_llh[2]);
 }
 
+void ecefPointsFromLLH(const Eigen::Ref<const Eigen::Matrix3Xd> &llh,
+                       Eigen::Matrix3Xd &ecef) {
+    ecef.resize(3, llh.cols());
+    convertChunks(ecefFromLLHChunk,
+                  llh.row(0).transpose().array(),
+                  llh.row(1).transpose().array(),
+                  llh.row(2).transpose().array(),
+                  ecef.row(0).transpose().array(),
+                  ecef.row(1).transpose().array(),
+                  ecef.row(2).transpose().array());
+}
+
+void llhPointsFromECEF(const Eigen::Ref<const Eigen::Matrix3Xd> &ecef,
+                       Eigen::Matrix3Xd &llh) {
+    llh.resize(3, ecef.cols());
+    convertChunks(llhFromECEFChunk,
+                  ecef.row(0).transpose().array(),
+                  ecef.row(1).transpose().array(),
+                  ecef.row(2).transpose().array(),
+                  llh.row(0).transpose().array(),
+                  llh.row(1).transpose().array(),
+                  llh.row(2).transpose().array());
+}
+
+void ecefPointsFromLLH(std::size_t n,
+                       const double *latitude,
+                       const double *longitude,
+                       const double *height,
+                       double *x,
+                       double *y,
+                       double *z) {
+    using ConstMap = Eigen::Map<const Eigen::ArrayXd>;
+    using Map = Eigen::Map<Eigen::ArrayXd>;
+    const auto size = static_cast<Eigen::Index>(n);
+    convertChunks(ecefFromLLHChunk,
+                  ConstMap{latitude, size},
+                  ConstMap{longitude, size},
+                  ConstMap{height, size},
+                  Map{x, size},
+                  Map{y, size},
+                  Map{z, size});
+}
+
+void llhPointsFromECEF(std::size_t n,
+                       const double *x,
+                       const double *y,
+                       const double *z,
+                       double *latitude,
+                       double *longitude,
+                       double *height) {
+    using ConstMap = Eigen::Map<const Eigen::ArrayXd>;
+    using Map = Eigen::Map<Eigen::ArrayXd>;
+    const auto size = static_cast<Eigen::Index>(n);
+    convertChunks(llhFromECEFChunk,
+                  ConstMap{x, size},
+                  ConstMap{y, size},
+                  ConstMap{z, size},
+                  Map{latitude, size},
+                  Map{longitude, size},
+                  Map{height, size});
+}
+
 }  // namespace wave
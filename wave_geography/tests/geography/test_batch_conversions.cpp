@@ -0,0 +1,217 @@
+/* Copyright (c) 2017, Waterloo Autonomous Vehicles Laboratory (WAVELab),
+ * Waterloo Intelligent Systems Engineering Lab (WISELab),
+ * University of Waterloo.
+ *
+ * Refer to the accompanying LICENSE file for license information.
+ *
+ * ############################################################################
+ ******************************************************************************
+ |                                                                            |
+ |                         /\/\__/\_/\      /\_/\__/\/\                       |
+ |                         \          \____/          /                       |
+ |                          '----________________----'                        |
+ |                              /                \                            |
+ |                            O/_____/_______/____\O                          |
+ |                            /____________________\                          |
+ |                           /    (#UNIVERSITY#)    \                         |
+ |                           |[**](#OFWATERLOO#)[**]|                         |
+ |                           \______________________/                         |
+ |                            |_""__|_,----,_|__""_|                          |
+ |                            ! !                ! !                          |
+ |                            '-'                '-'                          |
+ |       __    _   _  _____  ___  __  _  ___  _    _  ___  ___   ____  ____   |
+ |      /  \  | | | ||_   _|/ _ \|  \| |/ _ \| \  / |/ _ \/ _ \ /     |       |
+ |     / /\ \ | |_| |  | |  ||_||| |\  |||_|||  \/  |||_||||_|| \===\ |====   |
+ |    /_/  \_\|_____|  |_|  \___/|_| \_|\___/|_|\/|_|\___/\___/ ____/ |____   |
+ |                                                                            |
+ ******************************************************************************
+ * ############################################################################
+ *
+ * File: test_batch_conversions.cpp
+ * Desc: Tests for batch world frame conversions and LocalTangentFrame
+ *
+ * ############################################################################
+*/
+
+#include <gtest/gtest.h>
+#include "wave/geography/local_tangent_frame.hpp"
+#include "wave/geography/world_frame_conversions.hpp"
+
+namespace wave {
+
+class BatchConversionTest : public ::testing::Test {
+ protected:
+    // Points spread over the globe, from below sea level to orbit
+    Eigen::Matrix3Xd points_llh;
+
+    // Datum near the University of Waterloo
+    const Eigen::Vector3d datum_llh{43.4723, -80.5449, 330.0};
+
+    BatchConversionTest() {
+        const int n_lat = 19, n_lon = 24;
+        const double heights[] = {-400.0, 0.0, 330.0, 8848.0, 4.0e5};
+        this->points_llh.resize(3, n_lat * n_lon * 5);
+        int col = 0;
+        for (int i = 0; i < n_lat; ++i) {
+            for (int j = 0; j < n_lon; ++j) {
+                for (const double height : heights) {
+                    // Include both poles and the antimeridian
+                    this->points_llh.col(col++) << -90.0 + 10.0 * i,
+                      -180.0 + 15.0 * j, height;
+                }
+            }
+        }
+    }
+};
+
+TEST_F(BatchConversionTest, ecefFromLLHMatchesPerPoint) {
+    Eigen::Matrix3Xd points_ecef;
+    ecefPointsFromLLH(this->points_llh, points_ecef);
+    ASSERT_EQ(this->points_llh.cols(), points_ecef.cols());
+
+    for (int i = 0; i < this->points_llh.cols(); ++i) {
+        Eigen::Vector3d expected;
+        ecefPointFromLLH(this->points_llh.col(i).data(), expected.data());
+        EXPECT_NEAR(0.0, (expected - points_ecef.col(i)).norm(), 1e-6);
+    }
+}
+
+TEST_F(BatchConversionTest, llhFromECEFMatchesPerPoint) {
+    Eigen::Matrix3Xd points_ecef(3, this->points_llh.cols());
+    for (int i = 0; i < this->points_llh.cols(); ++i) {
+        ecefPointFromLLH(this->points_llh.col(i).data(),
+                         points_ecef.col(i).data());
+    }
+
+    Eigen::Matrix3Xd points_llh_results;
+    llhPointsFromECEF(points_ecef, points_llh_results);
+    ASSERT_EQ(points_ecef.cols(), points_llh_results.cols());
+
+    for (int i = 0; i < points_ecef.cols(); ++i) {
+        Eigen::Vector3d expected;
+        llhPointFromECEF(points_ecef.col(i).data(), expected.data());
+        EXPECT_NEAR(expected(0), points_llh_results(0, i), 1e-9);
+        EXPECT_NEAR(expected(2), points_llh_results(2, i), 1e-6);
+
+        // Longitude is undefined at the poles
+        if (std::abs(expected(0)) < 90.0 - 1e-9) {
+            EXPECT_NEAR(expected(1), points_llh_results(1, i), 1e-9);
+        }
+    }
+}
+
+TEST_F(BatchConversionTest, llhFromECEFNearCentre) {
+    // Inside the evolute of the ellipsoid, including the centre itself
+    Eigen::Matrix3Xd points_ecef(3, 5);
+    points_ecef << 0.0, 1.0, 1.0e3, -2.0e4, 3.0e4,  //
+      0.0, 1.0, 0.0, 1.0e4, 0.0,                    //
+      0.0, 1.0, 1.0e3, 5.0e3, 1.0e3;
+
+    Eigen::Matrix3Xd points_llh_results;
+    llhPointsFromECEF(points_ecef, points_llh_results);
+
+    for (int i = 0; i < points_ecef.cols(); ++i) {
+        Eigen::Vector3d expected;
+        llhPointFromECEF(points_ecef.col(i).data(), expected.data());
+        EXPECT_TRUE(points_llh_results.col(i).allFinite());
+        EXPECT_EQ(expected, points_llh_results.col(i).eval());
+    }
+}
+
+TEST_F(BatchConversionTest, structureOfArrays) {
+    const auto n = static_cast<std::size_t>(this->points_llh.cols());
+    const Eigen::VectorXd latitude = this->points_llh.row(0);
+    const Eigen::VectorXd longitude = this->points_llh.row(1);
+    const Eigen::VectorXd height = this->points_llh.row(2);
+
+    Eigen::VectorXd x(n), y(n), z(n);
+    ecefPointsFromLLH(n,
+                      latitude.data(),
+                      longitude.data(),
+                      height.data(),
+                      x.data(),
+                      y.data(),
+                      z.data());
+
+    Eigen::Matrix3Xd points_ecef;
+    ecefPointsFromLLH(this->points_llh, points_ecef);
+    EXPECT_TRUE(x.transpose() == points_ecef.row(0));
+    EXPECT_TRUE(y.transpose() == points_ecef.row(1));
+    EXPECT_TRUE(z.transpose() == points_ecef.row(2));
+
+    Eigen::VectorXd latitude_results(n), longitude_results(n),
+      height_results(n);
+    llhPointsFromECEF(n,
+                      x.data(),
+                      y.data(),
+                      z.data(),
+                      latitude_results.data(),
+                      longitude_results.data(),
+                      height_results.data());
+
+    Eigen::Matrix3Xd points_llh_results;
+    llhPointsFromECEF(points_ecef, points_llh_results);
+    EXPECT_TRUE(latitude_results.transpose() == points_llh_results.row(0));
+    EXPECT_TRUE(longitude_results.transpose() == points_llh_results.row(1));
+    EXPECT_TRUE(height_results.transpose() == points_llh_results.row(2));
+}
+
+TEST_F(BatchConversionTest, localTangentFrameMatchesPerPoint) {
+    const LocalTangentFrame frame{this->datum_llh};
+
+    double T_ecef_enu[4][4];
+    ecefFromENUTransformMatrix(this->datum_llh.data(), T_ecef_enu);
+    const auto &T = frame.ecefFromENUTransform().matrix();
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            EXPECT_EQ(T_ecef_enu[i][j], T(i, j));
+        }
+    }
+
+    // Points within 10 km of the datum
+    Eigen::Matrix3Xd points_llh = this->points_llh.leftCols(100);
+    for (int i = 0; i < points_llh.cols(); ++i) {
+        points_llh.col(i) = this->datum_llh;
+        points_llh(0, i) += 0.001 * (i % 90) - 0.045;
+        points_llh(1, i) += 0.0013 * (i % 70) - 0.045;
+        points_llh(2, i) += 10.0 * (i % 13);
+    }
+
+    Eigen::Matrix3Xd points_enu;
+    frame.enuPointsFromLLH(points_llh, points_enu);
+
+    Eigen::Matrix3Xd points_llh_results;
+    frame.llhPointsFromENU(points_enu, points_llh_results);
+
+    for (int i = 0; i < points_llh.cols(); ++i) {
+        Eigen::Vector3d expected;
+        enuPointFromLLH(
+          points_llh.col(i).data(), this->datum_llh.data(), expected.data());
+        EXPECT_NEAR(0.0, (expected - points_enu.col(i)).norm(), 1e-6);
+
+        EXPECT_NEAR(points_llh(0, i), points_llh_results(0, i), 1e-9);
+        EXPECT_NEAR(points_llh(1, i), points_llh_results(1, i), 1e-9);
+        EXPECT_NEAR(points_llh(2, i), points_llh_results(2, i), 1e-6);
+    }
+}
+
+TEST_F(BatchConversionTest, localTangentFrameFromECEFDatum) {
+    Eigen::Vector3d datum_ecef;
+    ecefPointFromLLH(this->datum_llh.data(), datum_ecef.data());
+
+    const LocalTangentFrame frame_llh{this->datum_llh};
+    const LocalTangentFrame frame_ecef{datum_ecef, false};
+
+    EXPECT_NEAR(0.0, (datum_ecef - frame_llh.datumECEF()).norm(), 1e-6);
+    EXPECT_NEAR(
+      0.0, (this->datum_llh - frame_ecef.datumLLH()).norm(), 1e-6);
+    EXPECT_TRUE(frame_llh.enuFromECEFTransform().isApprox(
+      frame_ecef.enuFromECEFTransform()));
+
+    // The datum is the origin of the frame
+    Eigen::Matrix3Xd points_enu;
+    frame_ecef.enuPointsFromECEF(datum_ecef, points_enu);
+    EXPECT_NEAR(0.0, points_enu.norm(), 1e-6);
+}
+
+}  // namespace wave
@@ -0,0 +1,145 @@
+/* Copyright (c) 2017, Waterloo Autonomous Vehicles Laboratory (WAVELab),
+ * Waterloo Intelligent Systems Engineering Lab (WISELab),
+ * University of Waterloo.
+ *
+ * Refer to the accompanying LICENSE file for license information.
+ *
+ * ############################################################################
+ ******************************************************************************
+ |                                                                            |
+ |                         /\/\__/\_/\      /\_/\__/\/\                       |
+ |                         \          \____/          /                       |
+ |                          '----________________----'                        |
+ |                              /                \                            |
+ |                            O/_____/_______/____\O                          |
+ |                            /____________________\                          |
+ |                           /    (#UNIVERSITY#)    \                         |
+ |                           |[**](#OFWATERLOO#)[**]|                         |
+ |                           \______________________/                         |
+ |                            |_""__|_,----,_|__""_|                          |
+ |                            ! !                ! !                          |
+ |                            '-'                '-'                          |
+ |       __    _   _  _____  ___  __  _  ___  _    _  ___  ___   ____  ____   |
+ |      /  \  | | | ||_   _|/ _ \|  \| |/ _ \| \  / |/ _ \/ _ \ /     |       |
+ |     / /\ \ | |_| |  | |  ||_||| |\  |||_|||  \/  |||_||||_|| \===\ |====   |
+ |    /_/  \_\|_____|  |_|  \___/|_| \_|\___/|_|\/|_|\___/\___/ ____/ |____   |
+ |                                                                            |
+ ******************************************************************************
+ * ############################################################################
+ *
+ * File: test_local_tangent_frame.cpp
+ * Desc: Tests for LocalTangentFrame point, pose and covariance conversions
+ *
+ * ############################################################################
+*/
+
+#include <gtest/gtest.h>
+#include "wave/geography/local_tangent_frame.hpp"
+#include "wave/geography/world_frame_conversions.hpp"
+
+namespace wave {
+
+class LocalTangentFrameTest : public ::testing::Test {
+ protected:
+    // Datum near the University of Waterloo
+    const Vec3 datum_llh{43.4723, -80.5449, 330.0};
+    const LocalTangentFrame frame{datum_llh};
+
+    // A point about a kilometre from the datum
+    const Vec3 point_llh{43.4800, -80.5400, 350.0};
+};
+
+TEST_F(LocalTangentFrameTest, pointsMatchPerPoint) {
+    Vec3 expected_enu;
+    enuPointFromLLH(
+      this->point_llh.data(), this->datum_llh.data(), expected_enu.data());
+
+    const Vec3 point_enu = this->frame.enuPointFromLLH(this->point_llh);
+    EXPECT_NEAR(0.0, (expected_enu - point_enu).norm(), 1e-6);
+
+    const Vec3 point_llh_result = this->frame.llhPointFromENU(point_enu);
+    EXPECT_NEAR(this->point_llh(0), point_llh_result(0), 1e-9);
+    EXPECT_NEAR(this->point_llh(1), point_llh_result(1), 1e-9);
+    EXPECT_NEAR(this->point_llh(2), point_llh_result(2), 1e-6);
+
+    Vec3 point_ecef;
+    ecefPointFromLLH(this->point_llh.data(), point_ecef.data());
+    EXPECT_NEAR(
+      0.0, (point_enu - this->frame.enuPointFromECEF(point_ecef)).norm(), 1e-6);
+    EXPECT_NEAR(
+      0.0, (point_ecef - this->frame.ecefPointFromENU(point_enu)).norm(), 1e-6);
+}
+
+TEST_F(LocalTangentFrameTest, transformMatchesMatrixFunction) {
+    double T_enu_ecef[4][4];
+    enuFromECEFTransformMatrix(this->datum_llh.data(), T_enu_ecef);
+
+    const auto &T = this->frame.enuFromECEFTransform().matrix();
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            EXPECT_NEAR(T_enu_ecef[i][j], T(i, j), 1e-6);
+        }
+    }
+}
+
+TEST_F(LocalTangentFrameTest, nedAndNWU) {
+    Vec3 point_ecef;
+    ecefPointFromLLH(this->point_llh.data(), point_ecef.data());
+    const Vec3 point_enu = this->frame.enuPointFromECEF(point_ecef);
+
+    Vec3 expected_nwu, point_enu_from_ned;
+    enu2nwu(point_enu, expected_nwu);
+    const Vec3 point_ned = this->frame.nedPointFromECEF(point_ecef);
+    ned2enu(point_ned, point_enu_from_ned);
+
+    const Vec3 point_nwu = this->frame.nwuPointFromECEF(point_ecef);
+    EXPECT_NEAR(0.0, (expected_nwu - point_nwu).norm(), 1e-6);
+    EXPECT_NEAR(0.0, (point_enu - point_enu_from_ned).norm(), 1e-6);
+
+    EXPECT_NEAR(
+      0.0, (point_ecef - this->frame.ecefPointFromNED(point_ned)).norm(), 1e-6);
+    EXPECT_NEAR(
+      0.0,
+      (point_ecef - this->frame.ecefPointFromNWU(expected_nwu)).norm(),
+      1e-6);
+}
+
+TEST_F(LocalTangentFrameTest, poses) {
+    Affine3 T_enu_body = Affine3::Identity();
+    T_enu_body.rotate(Eigen::AngleAxisd(0.3, Vec3{0.1, 0.2, 1.0}.normalized()));
+    T_enu_body.pretranslate(Vec3{100.0, -50.0, 2.0});
+
+    const Affine3 T_ecef_body = this->frame.ecefPoseFromENU(T_enu_body);
+    EXPECT_NEAR(0.0,
+                (this->frame.ecefPointFromENU(T_enu_body.translation()) -
+                 T_ecef_body.translation())
+                  .norm(),
+                1e-6);
+    EXPECT_TRUE(this->frame.enuPoseFromECEF(T_ecef_body)
+                  .matrix()
+                  .isApprox(T_enu_body.matrix(), 1e-9));
+}
+
+TEST_F(LocalTangentFrameTest, covariances) {
+    // Uncertain only in the ENU up direction
+    Mat3 cov_enu = Mat3::Zero();
+    cov_enu(2, 2) = 4.0;
+
+    const Mat3 cov_ecef = this->frame.ecefCovarianceFromENU(cov_enu);
+    const Vec3 up_ecef = this->frame.ecefFromENUTransform().linear().col(2);
+    EXPECT_NEAR(4.0, up_ecef.transpose() * cov_ecef * up_ecef, 1e-9);
+    EXPECT_TRUE(
+      this->frame.enuCovarianceFromECEF(cov_ecef).isApprox(cov_enu, 1e-9));
+
+    Mat6 cov6_enu = Mat6::Identity();
+    cov6_enu.bottomRightCorner<3, 3>() = cov_enu;
+    const Mat6 cov6_ecef = this->frame.ecefCovarianceFromENU(cov6_enu);
+    const Mat3 cov6_ecef_rotation = cov6_ecef.topLeftCorner<3, 3>();
+    const Mat3 cov6_ecef_translation = cov6_ecef.bottomRightCorner<3, 3>();
+    EXPECT_TRUE(cov6_ecef_rotation.isApprox(Mat3::Identity()));
+    EXPECT_TRUE(cov6_ecef_translation.isApprox(cov_ecef));
+    EXPECT_TRUE(
+      this->frame.enuCovarianceFromECEF(cov6_ecef).isApprox(cov6_enu, 1e-9));
+}
+
+}  // namespace wave
@@ -0,0 +1,127 @@
+/** Throughput of the batch world frame conversions against the per-point
+ * functions.
+ *
+ * The points are GPS fixes spread over a few kilometres around a datum near
+ * Waterloo. The benchmark argument is the number of points converted per
+ * iteration, and items/s is points per second.
+ *
+ * BM_*PerPoint call ecefPointFromLLH(), llhPointFromECEF() or
+ * enuPointFromLLH() once per point. BM_*Batch convert all points with one call
+ * to the Eigen 3xN overloads or a LocalTangentFrame.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "wave/geography/local_tangent_frame.hpp"
+#include "wave/geography/world_frame_conversions.hpp"
+
+namespace wave {
+
+const Eigen::Vector3d DATUM_LLH{43.4723, -80.5449, 330.0};
+
+/** Generates `n` LLH points within a few kilometres of the datum */
+Eigen::Matrix3Xd makePointsLLH(int n) {
+    Eigen::Matrix3Xd points_llh(3, n);
+    for (int i = 0; i < n; ++i) {
+        points_llh.col(i) = DATUM_LLH;
+        points_llh(0, i) += 1e-5 * (i % 3001) - 0.015;
+        points_llh(1, i) += 1e-5 * (i % 2999) - 0.015;
+        points_llh(2, i) += 0.01 * (i % 1009);
+    }
+    return points_llh;
+}
+
+Eigen::Matrix3Xd makePointsECEF(int n) {
+    Eigen::Matrix3Xd points_ecef;
+    ecefPointsFromLLH(makePointsLLH(n), points_ecef);
+    return points_ecef;
+}
+
+void BM_ECEFFromLLHPerPoint(benchmark::State &state) {
+    const auto points_llh = makePointsLLH(state.range(0));
+    Eigen::Matrix3Xd points_ecef(3, points_llh.cols());
+
+    for (auto _ : state) {
+        for (int i = 0; i < points_llh.cols(); ++i) {
+            ecefPointFromLLH(points_llh.col(i).data(),
+                             points_ecef.col(i).data());
+        }
+        benchmark::DoNotOptimize(points_ecef.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ECEFFromLLHBatch(benchmark::State &state) {
+    const auto points_llh = makePointsLLH(state.range(0));
+    Eigen::Matrix3Xd points_ecef;
+
+    for (auto _ : state) {
+        ecefPointsFromLLH(points_llh, points_ecef);
+        benchmark::DoNotOptimize(points_ecef.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LLHFromECEFPerPoint(benchmark::State &state) {
+    const auto points_ecef = makePointsECEF(state.range(0));
+    Eigen::Matrix3Xd points_llh(3, points_ecef.cols());
+
+    for (auto _ : state) {
+        for (int i = 0; i < points_ecef.cols(); ++i) {
+            llhPointFromECEF(points_ecef.col(i).data(),
+                             points_llh.col(i).data());
+        }
+        benchmark::DoNotOptimize(points_llh.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LLHFromECEFBatch(benchmark::State &state) {
+    const auto points_ecef = makePointsECEF(state.range(0));
+    Eigen::Matrix3Xd points_llh;
+
+    for (auto _ : state) {
+        llhPointsFromECEF(points_ecef, points_llh);
+        benchmark::DoNotOptimize(points_llh.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ENUFromLLHPerPoint(benchmark::State &state) {
+    const auto points_llh = makePointsLLH(state.range(0));
+    Eigen::Matrix3Xd points_enu(3, points_llh.cols());
+
+    for (auto _ : state) {
+        for (int i = 0; i < points_llh.cols(); ++i) {
+            enuPointFromLLH(points_llh.col(i).data(),
+                            DATUM_LLH.data(),
+                            points_enu.col(i).data());
+        }
+        benchmark::DoNotOptimize(points_enu.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ENUFromLLHBatch(benchmark::State &state) {
+    const auto points_llh = makePointsLLH(state.range(0));
+    Eigen::Matrix3Xd points_enu;
+
+    // Constructing the frame is part of the cost of a batch
+    for (auto _ : state) {
+        const LocalTangentFrame frame{DATUM_LLH};
+        frame.enuPointsFromLLH(points_llh, points_enu);
+        benchmark::DoNotOptimize(points_enu.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ECEFFromLLHPerPoint)->Arg(1000)->Arg(1000000);
+BENCHMARK(BM_ECEFFromLLHBatch)->Arg(1000)->Arg(1000000);
+BENCHMARK(BM_LLHFromECEFPerPoint)->Arg(1000)->Arg(1000000);
+BENCHMARK(BM_LLHFromECEFBatch)->Arg(1000)->Arg(1000000);
+BENCHMARK(BM_ENUFromLLHPerPoint)->Arg(1000)->Arg(1000000);
+BENCHMARK(BM_ENUFromLLHBatch)->Arg(1000)->Arg(1000000);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
@@ -0,0 +1,178 @@
+#ifndef WAVE_COMPOSITE_STATE_HPP
+#define WAVE_COMPOSITE_STATE_HPP
+
+#include <string>
+#include <gtsam/base/Lie.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/OptionalJacobian.h>
+
+/**
+ * Generates the traits required to optimize with gtsam for a state made of
+ * several members, all of which have traits already defined, such as
+ * PoseVelBias.
+ *
+ * The tangent vector stacks the tangent vectors of the members in the order
+ * they are listed, and each operation is applied to each member separately, so
+ * the Jacobians are block diagonal. The Jacobian of each member is computed in
+ * fixed-size storage on the stack and copied into its diagonal block, so no
+ * operation allocates, with or without Jacobians.
+ *
+ * To use, specialize gtsam::traits for the state by deriving from
+ * CompositeStateTraits, listing its members:
+ *
+ *     template <>
+ *     struct traits<wave::PoseVel>
+ *       : wave::CompositeStateTraits<
+ *           wave::PoseVel,
+ *           wave::StateMember<wave::PoseVel, Pose3, &wave::PoseVel::pose>,
+ *           wave::StateMember<wave::PoseVel, VelType, &wave::PoseVel::vel>> {};
+ */
+
+namespace wave {
+
+/** A member of a composite state, for CompositeStateTraits */
+template <typename State, typename T, T State::*Member>
+struct StateMember {
+    using Type = T;
+    enum { dimension = gtsam::traits<T>::dimension };
+
+    static T &get(State &m) {
+        return m.*Member;
+    }
+
+    static const T &get(const State &m) {
+        return m.*Member;
+    }
+};
+
+namespace internal {
+
+/** Applies each operation to the members, starting at `Offset` in the tangent
+ * vector */
+template <int Offset, typename... Members>
+struct CompositeStateOps;
+
+}  // namespace internal
+
+template <typename State, typename... Members>
+struct CompositeStateTraits {
+ private:
+    using Ops = internal::CompositeStateOps<0, Members...>;
+
+ public:
+    typedef gtsam::lie_group_tag structure_category;
+
+    /**
+     * Basic (Testable)
+     */
+
+    static void Print(const State &m1, const std::string &str = "") {
+        Ops::print(m1, str);
+    }
+
+    static bool Equals(const State &m1, const State &m2, double tol = 1e-8) {
+        return Ops::equals(m1, m2, tol);
+    }
+
+    /**
+     * Manifold
+     */
+
+    enum { dimension = Ops::dimension };
+    static int GetDimension(const State &) {
+        return dimension;
+    }
+
+    typedef State ManifoldType;
+    typedef Eigen::Matrix<double, dimension, 1> TangentVector;
+
+    // The tangent vector is just stacking all the smaller tangent vectors
+    static TangentVector Local(const State &origin, const State &other) {
+        TangentVector retval;
+        Ops::local(origin, other, retval);
+        return retval;
+    }
+
+    static State Retract(const State &origin, const TangentVector &v) {
+        State retval;
+        Ops::retract(origin, v, retval);
+        return retval;
+    }
+
+    /**
+     * Lie group
+     */
+
+    typedef gtsam::multiplicative_group_tag group_flavor;
+
+    typedef gtsam::OptionalJacobian<dimension, dimension> ChartJacobian;
+
+    static State Identity() {
+        return State();
+    }
+
+    static TangentVector Logmap(const State &m,
+                                ChartJacobian Hm = boost::none) {
+        TangentVector retval;
+        if (Hm) {
+            Hm->setZero();
+        }
+        Ops::logmap(m, retval, Hm);
+        return retval;
+    }
+
+    static State Expmap(const TangentVector &v,
+                        ChartJacobian Hv = boost::none) {
+        State retval;
+        if (Hv) {
+            Hv->setZero();
+        }
+        Ops::expmap(v, retval, Hv);
+        return retval;
+    }
+
+    static State Compose(const State &m1,
+                         const State &m2,
+                         ChartJacobian H1 = boost::none,
+                         ChartJacobian H2 = boost::none) {
+        State retval;
+        if (H1) {
+            H1->setZero();
+        }
+        if (H2) {
+            H2->setZero();
+        }
+        Ops::compose(m1, m2, retval, H1, H2);
+        return retval;
+    }
+
+    static State Between(const State &m1,
+                         const State &m2,
+                         ChartJacobian H1 = boost::none,
+                         ChartJacobian H2 = boost::none) {
+        State retval;
+        if (H1) {
+            H1->setZero();
+        }
+        if (H2) {
+            H2->setZero();
+        }
+        Ops::between(m1, m2, retval, H1, H2);
+        return retval;
+    }
+
+    static State Inverse(const State &m, ChartJacobian H = boost::none) {
+        State retval;
+        if (H) {
+            H->setZero();
+        }
+        Ops::inverse(m, retval, H);
+        return retval;
+    }
+};
+
+}  // namespace wave
+
+#include "wave/gtsam/impl/composite_state_impl.hpp"
+
+#endif  // WAVE_COMPOSITE_STATE_HPP
@@ -0,0 +1,88 @@
+#ifndef WAVE_GRAPH_BUILDER_HPP
+#define WAVE_GRAPH_BUILDER_HPP
+
+#include <utility>
+#include <vector>
+
+#include <gtsam/geometry/Cal3_S2.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/slam/ProjectionFactor.h>
+
+#include "wave/utils/math.hpp"
+#include "wave/containers/landmark_measurement.hpp"
+#include "wave/containers/landmark_measurement_container.hpp"
+
+namespace wave {
+
+/** Builds graphs of camera poses and landmarks from measurements in bulk.
+ *
+ * Every projection factor shares the builder's calibration and noise model,
+ * and the graph is reserved for all factors before they are added. Camera
+ * poses use the keys x0, x1, ..., and landmarks l<landmark id>.
+ *
+ * For VoDataset, see vo_dataset_graph.hpp.
+ */
+class GraphBuilder {
+ public:
+    using ProjectionFactor = gtsam::
+      GenericProjectionFactor<gtsam::Pose3, gtsam::Point3, gtsam::Cal3_S2>;
+
+    /**
+     * @param K camera intrinsic matrix
+     * @param pixel_model noise model of landmark measurements, in pixels
+     */
+    GraphBuilder(const Mat3 &K, const gtsam::SharedNoiseModel &pixel_model);
+
+    static gtsam::Symbol poseKey(std::size_t i) {
+        return gtsam::Symbol{'x', i};
+    }
+
+    static gtsam::Symbol landmarkKey(LandmarkId id) {
+        return gtsam::Symbol{'l', id};
+    }
+
+    /** Adds a projection factor for each observation from pose `i`
+     *
+     * Called once per pose, this does not reserve the graph, since growing
+     * it by exactly each pose's observations would reallocate every time.
+     *
+     * @param observations pairs of landmark id and measurement
+     */
+    void addProjectionFactors(
+      gtsam::NonlinearFactorGraph &graph,
+      std::size_t i,
+      const std::vector<std::pair<LandmarkId, Vec2>> &observations) const;
+
+    /** Adds a projection factor for each measurement from sensor `s`, from
+     * the pose given by its image number.
+     *
+     * The measurements are read in place, without copying out tracks.
+     */
+    template <typename T>
+    void addProjectionFactors(
+      gtsam::NonlinearFactorGraph &graph,
+      const LandmarkMeasurementContainer<T> &landmarks,
+      const typename LandmarkMeasurementContainer<T>::SensorIdType &s) const;
+
+    /** Adds a BetweenFactor between each pair of consecutive poses, measuring
+     * the relative pose between them */
+    void addBetweenFactors(gtsam::NonlinearFactorGraph &graph,
+                           const std::vector<gtsam::Pose3> &poses,
+                           const gtsam::SharedNoiseModel &model) const;
+
+    const boost::shared_ptr<gtsam::Cal3_S2> &calibration() const {
+        return this->K;
+    }
+
+ private:
+    boost::shared_ptr<gtsam::Cal3_S2> K;
+    gtsam::SharedNoiseModel pixel_model;
+};
+
+}  // namespace wave
+
+#include "wave/gtsam/impl/graph_builder_impl.hpp"
+
+#endif  // WAVE_GRAPH_BUILDER_HPP
@@ -0,0 +1,171 @@
+#ifndef WAVE_COMPOSITE_STATE_IMPL_HPP
+#define WAVE_COMPOSITE_STATE_IMPL_HPP
+
+#include "wave/gtsam/composite_state.hpp"
+
+namespace wave {
+namespace internal {
+
+/** Wraps fixed-size storage for a member Jacobian, if the composite Jacobian
+ * `H` is wanted */
+template <int N, typename Jacobian>
+inline gtsam::OptionalJacobian<N, N> memberJacobian(
+  const Jacobian &H, Eigen::Matrix<double, N, N> &J) {
+    if (H) {
+        return gtsam::OptionalJacobian<N, N>{J};
+    }
+    return gtsam::OptionalJacobian<N, N>{};
+}
+
+template <int Offset>
+struct CompositeStateOps<Offset> {
+    enum { dimension = 0 };
+
+    template <typename State>
+    static void print(const State &, const std::string &) {}
+
+    template <typename State>
+    static bool equals(const State &, const State &, double) {
+        return true;
+    }
+
+    template <typename State, typename Vector>
+    static void local(const State &, const State &, Vector &) {}
+
+    template <typename State, typename Vector>
+    static void retract(const State &, const Vector &, State &) {}
+
+    template <typename State, typename Vector, typename Jacobian>
+    static void logmap(const State &, Vector &, Jacobian &) {}
+
+    template <typename State, typename Vector, typename Jacobian>
+    static void expmap(const Vector &, State &, Jacobian &) {}
+
+    template <typename State, typename Jacobian>
+    static void compose(
+      const State &, const State &, State &, Jacobian &, Jacobian &) {}
+
+    template <typename State, typename Jacobian>
+    static void between(
+      const State &, const State &, State &, Jacobian &, Jacobian &) {}
+
+    template <typename State, typename Jacobian>
+    static void inverse(const State &, State &, Jacobian &) {}
+};
+
+template <int Offset, typename Member, typename... Rest>
+struct CompositeStateOps<Offset, Member, Rest...> {
+    using Traits = gtsam::traits<typename Member::Type>;
+    using Next = CompositeStateOps<Offset + Member::dimension, Rest...>;
+    enum { dim = Member::dimension };
+    enum { dimension = dim + Next::dimension };
+
+    /** Fixed-size storage for the Jacobian of this member */
+    using MemberJacobian = Eigen::Matrix<double, dim, dim>;
+
+    template <typename State>
+    static void print(const State &m, const std::string &str) {
+        Traits::Print(Member::get(m), str);
+        Next::print(m, str);
+    }
+
+    template <typename State>
+    static bool equals(const State &m1, const State &m2, double tol) {
+        if (!Traits::Equals(Member::get(m1), Member::get(m2), tol)) {
+            return false;
+        }
+        return Next::equals(m1, m2, tol);
+    }
+
+    template <typename State, typename Vector>
+    static void local(const State &origin, const State &other, Vector &v) {
+        v.template segment<dim>(Offset) =
+          Traits::Local(Member::get(origin), Member::get(other));
+        Next::local(origin, other, v);
+    }
+
+    template <typename State, typename Vector>
+    static void retract(const State &origin, const Vector &v, State &result) {
+        Member::get(result) =
+          Traits::Retract(Member::get(origin), v.template segment<dim>(Offset));
+        Next::retract(origin, v, result);
+    }
+
+    template <typename State, typename Vector, typename Jacobian>
+    static void logmap(const State &m, Vector &v, Jacobian &H) {
+        MemberJacobian J;
+        v.template segment<dim>(Offset) =
+          Traits::Logmap(Member::get(m), memberJacobian<dim>(H, J));
+        if (H) {
+            H->template block<dim, dim>(Offset, Offset) = J;
+        }
+        Next::logmap(m, v, H);
+    }
+
+    template <typename State, typename Vector, typename Jacobian>
+    static void expmap(const Vector &v, State &result, Jacobian &H) {
+        MemberJacobian J;
+        Member::get(result) = Traits::Expmap(v.template segment<dim>(Offset),
+                                             memberJacobian<dim>(H, J));
+        if (H) {
+            H->template block<dim, dim>(Offset, Offset) = J;
+        }
+        Next::expmap(v, result, H);
+    }
+
+    template <typename State, typename Jacobian>
+    static void compose(const State &m1,
+                        const State &m2,
+                        State &result,
+                        Jacobian &H1,
+                        Jacobian &H2) {
+        MemberJacobian J1, J2;
+        Member::get(result) = Traits::Compose(Member::get(m1),
+                                              Member::get(m2),
+                                              memberJacobian<dim>(H1, J1),
+                                              memberJacobian<dim>(H2, J2));
+        if (H1) {
+            H1->template block<dim, dim>(Offset, Offset) = J1;
+        }
+        if (H2) {
+            H2->template block<dim, dim>(Offset, Offset) = J2;
+        }
+        Next::compose(m1, m2, result, H1, H2);
+    }
+
+    template <typename State, typename Jacobian>
+    static void between(const State &m1,
+                        const State &m2,
+                        State &result,
+                        Jacobian &H1,
+                        Jacobian &H2) {
+        MemberJacobian J1, J2;
+        Member::get(result) = Traits::Between(Member::get(m1),
+                                              Member::get(m2),
+                                              memberJacobian<dim>(H1, J1),
+                                              memberJacobian<dim>(H2, J2));
+        if (H1) {
+            H1->template block<dim, dim>(Offset, Offset) = J1;
+        }
+        if (H2) {
+            H2->template block<dim, dim>(Offset, Offset) = J2;
+        }
+        Next::between(m1, m2, result, H1, H2);
+    }
+
+    template <typename State, typename Jacobian>
+    static void inverse(const State &m, State &result, Jacobian &H) {
+        MemberJacobian J;
+        Member::get(result) =
+          Traits::Inverse(Member::get(m), memberJacobian<dim>(H, J));
+        if (H) {
+            H->template block<dim, dim>(Offset, Offset) = J;
+        }
+        Next::inverse(m, result, H);
+    }
+};
+
+}  // namespace internal
+}  // namespace wave
+
+#endif  // WAVE_COMPOSITE_STATE_IMPL_HPP
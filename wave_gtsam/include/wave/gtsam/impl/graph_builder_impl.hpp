@@ -0,0 +1,27 @@
+#ifndef WAVE_GRAPH_BUILDER_IMPL_HPP
+#define WAVE_GRAPH_BUILDER_IMPL_HPP
+
+#include <iterator>
+
+namespace wave {
+
+template <typename T>
+void GraphBuilder::addProjectionFactors(
+  gtsam::NonlinearFactorGraph &graph,
+  const LandmarkMeasurementContainer<T> &landmarks,
+  const typename LandmarkMeasurementContainer<T>::SensorIdType &s) const {
+    const auto range = landmarks.getAllFromSensor(s);
+    graph.reserve(graph.size() + std::distance(range.first, range.second));
+
+    for (auto it = range.first; it != range.second; ++it) {
+        graph.emplace_shared<ProjectionFactor>(gtsam::Point2{it->value},
+                                               this->pixel_model,
+                                               poseKey(it->image),
+                                               landmarkKey(it->landmark_id),
+                                               this->K);
+    }
+}
+
+}  // namespace wave
+
+#endif  // WAVE_GRAPH_BUILDER_IMPL_HPP
@@ -11,22 +11,19 @@ MotionFactor<wave::PoseVelBias, wave::PoseVelBias>::evaluateError(
   const wave::PoseVelBias &m2,
   boost::optional<gtsam::Matrix &> H1,
   boost::optional<gtsam::Matrix &> H2) const {
-    gtsam::Vector retval;
+    Eigen::Matrix<double, 15, 1> retval;
 
     if (H1) {
-        H1->resize(15, 15);
-        H1->setIdentity();
+        *H1 = Eigen::Matrix<double, 15, 15>::Identity();
 
         H1->block<6, 6>(0, 6).noalias() =
           this->delt * gtsam::Matrix6::Identity();
     }
 
     if (H2) {
-        H2->resize(15, 15);
-        *H2 = -1 * Eigen::Matrix<double, 15, 15>::Identity();
+        *H2 = -Eigen::Matrix<double, 15, 15>::Identity();
     }
 
-    retval.resize(15, 1);
     retval.block<6, 1>(0, 0).noalias() =
       m1.vel * this->delt - m1.pose.localCoordinates(m2.pose);
     retval.block<6, 1>(6, 0).noalias() = m1.vel - m2.vel;
@@ -41,22 +38,19 @@ inline gtsam::Vector MotionFactor<wave::PoseVel, wave::PoseVel>::evaluateError(
   const wave::PoseVel &m2,
   boost::optional<gtsam::Matrix &> H1,
   boost::optional<gtsam::Matrix &> H2) const {
-    gtsam::Vector retval;
+    Eigen::Matrix<double, 12, 1> retval;
 
     if (H1) {
-        H1->resize(12, 12);
-        H1->setIdentity();
+        *H1 = Eigen::Matrix<double, 12, 12>::Identity();
 
         H1->block<6, 6>(0, 6).noalias() =
           this->delt * gtsam::Matrix6::Identity();
     }
 
     if (H2) {
-        H2->resize(12, 12);
-        *H2 = -1 * Eigen::Matrix<double, 12, 12>::Identity();
+        *H2 = -Eigen::Matrix<double, 12, 12>::Identity();
     }
 
-    retval.resize(12, 1);
     retval.block<6, 1>(0, 0).noalias() =
       m1.vel * this->delt - m1.pose.localCoordinates(m2.pose);
     retval.block<6, 1>(6, 0).noalias() = m1.vel - m2.vel;
@@ -0,0 +1,48 @@
+#ifndef WAVE_STATE_PROJECTION_FACTOR_IMPL_HPP
+#define WAVE_STATE_PROJECTION_FACTOR_IMPL_HPP
+
+#include <gtsam/geometry/CalibratedCamera.h>
+#include <gtsam/geometry/PinholePose.h>
+
+namespace wave {
+
+template <class T>
+gtsam::Vector StateProjectionFactor<T>::evaluateError(
+  const T &m,
+  const gtsam::Point3 &landmark,
+  boost::optional<gtsam::Matrix &> H1,
+  boost::optional<gtsam::Matrix &> H2) const {
+    gtsam::Matrix6 J_compose;
+    gtsam::Matrix26 J_pose;
+    gtsam::Matrix23 J_landmark;
+
+    const auto T_LOCAL_C = m.pose.compose(this->T_B_C, H1 ? &J_compose : 0);
+    const gtsam::PinholePose<gtsam::Cal3_S2> camera{T_LOCAL_C, this->K};
+
+    gtsam::Vector2 retval;
+    try {
+        retval = camera.project2(
+                   landmark, H1 ? &J_pose : 0, H2 ? &J_landmark : 0) -
+                 this->measured;
+    } catch (gtsam::CheiralityException &) {
+        if (H1) {
+            *H1 = Eigen::Matrix<double, 2, gtsam::traits<T>::dimension>::Zero();
+        }
+        if (H2) {
+            *H2 = gtsam::Matrix23::Zero();
+        }
+        return gtsam::Vector2::Constant(2.0 * this->K->fx());
+    }
+
+    if (H1) {
+        *H1 = Eigen::Matrix<double, 2, gtsam::traits<T>::dimension>::Zero();
+        H1->block<2, 6>(0, T::pose_offset).noalias() = J_pose * J_compose;
+    }
+    if (H2) {
+        *H2 = J_landmark;
+    }
+    return retval;
+}
+}
+
+#endif  // WAVE_STATE_PROJECTION_FACTOR_IMPL_HPP
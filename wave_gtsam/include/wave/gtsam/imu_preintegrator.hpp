@@ -0,0 +1,62 @@
+#ifndef WAVE_IMU_PREINTEGRATOR_HPP
+#define WAVE_IMU_PREINTEGRATOR_HPP
+
+#include <gtsam/navigation/CombinedImuFactor.h>
+
+#include "wave/utils/math.hpp"
+#include "wave/containers/measurement.hpp"
+#include "wave/containers/measurement_container.hpp"
+
+namespace wave {
+
+/** An IMU sample: angular velocity followed by linear acceleration, in the
+ * body frame */
+using ImuMeasurement = Measurement<Vec6, int>;
+
+using ImuMeasurementContainer = MeasurementContainer<ImuMeasurement>;
+
+/** Preintegrates IMU samples from a MeasurementContainer between keyframes.
+ *
+ * The samples of one sensor in [t_i, t_j] are integrated over each interval
+ * between consecutive samples, using the mean of the values at its ends. The
+ * values at t_i and t_j themselves are interpolated with
+ * MeasurementContainer::get(), so keyframes need not coincide with samples.
+ *
+ * The samples are read in place through MeasurementContainer::getTimeWindow(),
+ * rather than copied out of the container first.
+ */
+class ImuPreintegrator {
+ public:
+    using Params = gtsam::PreintegratedCombinedMeasurements::Params;
+
+    /**
+     * @param params IMU noise and gravity parameters
+     * @param sensor sensor id of the samples to use
+     */
+    explicit ImuPreintegrator(const boost::shared_ptr<Params> &params,
+                              int sensor = 0);
+
+    /** Returns whether the samples of the sensor cover [t_i, t_j] */
+    bool covers(const ImuMeasurementContainer &imu,
+                const TimePoint &t_i,
+                const TimePoint &t_j) const;
+
+    /** Preintegrates the samples between t_i and t_j
+     *
+     * @param bias the IMU bias estimate at t_i
+     * @throw std::out_of_range if the samples do not cover [t_i, t_j]
+     */
+    gtsam::PreintegratedCombinedMeasurements integrate(
+      const ImuMeasurementContainer &imu,
+      const TimePoint &t_i,
+      const TimePoint &t_j,
+      const gtsam::imuBias::ConstantBias &bias) const;
+
+ private:
+    boost::shared_ptr<Params> params;
+    int sensor;
+};
+
+}  // namespace wave
+
+#endif  // WAVE_IMU_PREINTEGRATOR_HPP
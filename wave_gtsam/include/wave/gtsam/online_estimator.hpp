@@ -0,0 +1,261 @@
+#ifndef WAVE_ONLINE_ESTIMATOR_HPP
+#define WAVE_ONLINE_ESTIMATOR_HPP
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <gtsam/geometry/Cal3_S2.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/navigation/CombinedImuFactor.h>
+#include <gtsam/nonlinear/ISAM2.h>
+
+#include "wave/utils/math.hpp"
+#include "wave/containers/measurement.hpp"
+#include "wave/containers/measurement_container.hpp"
+#include "wave/containers/landmark_measurement.hpp"
+#include "wave/containers/landmark_measurement_container.hpp"
+#include "wave/gtsam/imu_preintegrator.hpp"
+#include "wave/gtsam/pose_vel_bias.hpp"
+
+namespace wave {
+
+/** A GPS measurement of the body pose in the local frame */
+using GpsMeasurement = Measurement<gtsam::Pose3, int>;
+
+using GpsMeasurementContainer = MeasurementContainer<GpsMeasurement>;
+using CameraMeasurementContainer =
+  LandmarkMeasurementContainer<LandmarkMeasurement<int>>;
+
+struct OnlineEstimatorParams {
+    /** iSAM2 relinearizes a variable when its update exceeds this */
+    double relinearize_threshold = 0.1;
+
+    /** iSAM2 checks for relinearization only every this many updates */
+    int relinearize_skip = 10;
+
+    /** Extra iSAM2 iterations run by each update(), beyond the first.
+     * Each improves the estimate after large changes, at the cost of
+     * latency. */
+    int extra_iterations = 0;
+
+    /** Length of the fixed-lag window, in seconds. When positive, states
+     * older than this before the latest state are marginalized into linear
+     * priors on the remaining variables, and the window is solved in batch
+     * by each update(). When zero, all states are kept and solved with
+     * iSAM2. */
+    double lag = 0.0;
+
+    /** Levenberg-Marquardt iterations run by each update() in fixed-lag
+     * mode */
+    int lag_iterations = 3;
+
+    /** Standard deviations of the PosePrior and BiasPrior anchoring the
+     * oldest state of the fixed-lag window at its estimate. Anchors are
+     * replaced, never marginalized, as the window moves. Zero disables
+     * the anchor. */
+    double anchor_pose_sigma = 0.0;
+    double anchor_bias_sigma = 0.0;
+
+    /** Sensor ids of the measurements to use from each container */
+    int imu_sensor = 0;
+    int gps_sensor = 0;
+    int camera_sensor = 0;
+
+    /** Standard deviations of the prior on the initial state */
+    double prior_rotation_sigma = 1e-3;
+    double prior_position_sigma = 1e-3;
+    double prior_velocity_sigma = 1e-1;
+    double prior_bias_sigma = 1e-1;
+
+    /** Standard deviations of the constant velocity motion model linking
+     * consecutive states, per state. When IMU measurements link the states,
+     * the position and linear velocity terms are left to the IMU factor. */
+    double motion_rotation_sigma = 1e-1;
+    double motion_position_sigma = 1.0;
+    double motion_velocity_sigma = 1.0;
+    double motion_bias_sigma = 1e-2;
+
+    /** Standard deviations of GPS measurements */
+    double gps_rotation_sigma = 1e-2;
+    double gps_position_sigma = 0.5;
+
+    /** Standard deviation of landmark measurements, in pixels */
+    double pixel_sigma = 1.0;
+
+    /** Number of states which must observe a landmark before it is added to
+     * the estimate. Its observations are held until then. */
+    int min_landmark_observations = 2;
+
+    /** Depth at which a new landmark is initialized along its first ray */
+    double landmark_init_depth = 10.0;
+
+    /** Magnitude of gravity, along -z of the local frame */
+    double gravity = 9.81;
+
+    /** IMU noise densities, and bias random walks */
+    double gyroscope_sigma = 1e-3;
+    double accelerometer_sigma = 1e-2;
+    double integration_sigma = 1e-4;
+    double gyroscope_bias_sigma = 1e-5;
+    double accelerometer_bias_sigma = 1e-4;
+
+    /** Standard deviation of the prior on the initial IMU bias */
+    double prior_imu_bias_sigma = 1e-1;
+
+    OnlineEstimatorParams() {}
+
+    OnlineEstimatorParams(double relinearize_threshold,
+                          int relinearize_skip,
+                          int extra_iterations)
+        : relinearize_threshold{relinearize_threshold},
+          relinearize_skip{relinearize_skip},
+          extra_iterations{extra_iterations} {}
+};
+
+/** Incremental estimator of PoseVelBias states using iSAM2.
+ *
+ * Each call to update() adds a state at the given time, with factors for the
+ * new measurements:
+ *  - IMU samples since the previous state are preintegrated into a
+ *    PreintegratedImuFactor, with an IMU bias variable per state
+ *  - a GPS measurement at the state time adds a GPSFactorWithBiasGeneral
+ *  - landmark measurements at the state time add StateProjectionFactors
+ *  - a MotionFactor links every state to the previous one
+ *
+ * The new factors are added to iSAM2 incrementally, so the cost of each
+ * update depends on the variables affected by the new measurements rather
+ * than on the length of the sequence. Only the latest state is recovered
+ * after each update; the full estimate is recovered on request.
+ *
+ * With a positive `lag` in the params, the estimator is a fixed-lag smoother
+ * instead: states older than the lag are marginalized, along with their IMU
+ * biases and the landmarks observed only from them, and the remaining window
+ * is optimized in batch. Memory and update time are then bounded by the
+ * length of the window rather than of the run.
+ *
+ * States use the keys x0, x1, ..., IMU biases b0, b1, ..., and landmarks
+ * l<landmark id>.
+ */
+class OnlineEstimator {
+ public:
+    explicit OnlineEstimator(
+      const OnlineEstimatorParams &params = OnlineEstimatorParams{});
+
+    /** Sets the camera used by landmark measurements
+     *
+     * @param K camera intrinsic matrix
+     * @param T_B_C pose of the camera in the body frame
+     */
+    void setCamera(const Mat3 &K, const gtsam::Pose3 &T_B_C);
+
+    /** Adds the first state at time `t`, with a prior at `initial` */
+    void initialize(const TimePoint &t,
+                    const PoseVelBias &initial,
+                    const gtsam::imuBias::ConstantBias &initial_imu_bias =
+                      gtsam::imuBias::ConstantBias{});
+
+    /** Adds a state at time `t`, with factors for the measurements in the
+     * containers, and updates the estimate.
+     *
+     * Measurements are taken from the sensors given in the params. IMU
+     * measurements are used if they cover the time from the previous state
+     * to `t`; GPS and landmark measurements only at exactly `t`.
+     *
+     * @throw std::logic_error if not initialized, or if `t` is not after the
+     * previous state
+     */
+    void update(const TimePoint &t,
+                const ImuMeasurementContainer &imu,
+                const GpsMeasurementContainer &gps,
+                const CameraMeasurementContainer &landmarks);
+
+    /** Returns the estimate of the latest state */
+    const PoseVelBias &latestState() const {
+        return this->latest_state;
+    }
+
+    /** Returns the estimate of the latest IMU bias */
+    const gtsam::imuBias::ConstantBias &latestImuBias() const {
+        return this->latest_imu_bias;
+    }
+
+    /** Returns the number of states added */
+    std::size_t numStates() const {
+        return this->first_state + this->state_times.size();
+    }
+
+    /** Returns the index of the oldest state not marginalized */
+    std::size_t firstState() const {
+        return this->first_state;
+    }
+
+    /** Returns the time of each state not marginalized, from firstState() */
+    const std::deque<TimePoint> &stateTimes() const {
+        return this->state_times;
+    }
+
+    /** Computes the estimate of all variables not marginalized */
+    gtsam::Values estimate() const;
+
+    /** Returns the time taken by the last update() */
+    std::chrono::steady_clock::duration lastUpdateDuration() const {
+        return this->last_update_duration;
+    }
+
+ private:
+    /** Adds the factors for landmark measurements at time `t` */
+    void addLandmarkFactors(const TimePoint &t,
+                            const CameraMeasurementContainer &landmarks);
+
+    /** Returns whether `key` has an estimate, or an initial value pending */
+    bool hasValue(gtsam::Key key) const;
+
+    /** Returns the current estimate of state `i` */
+    PoseVelBias stateEstimate(std::size_t i) const;
+
+    /** Runs iSAM2, or the fixed-lag smoother, on the new factors and values,
+     * and recovers the latest state */
+    void runUpdate();
+
+    /** Optimizes the fixed-lag window with the new factors and values */
+    void optimizeWindow();
+
+    /** Marginalizes the states older than the lag out of the window */
+    void marginalizeOldStates();
+
+    /** Replaces the anchor factors with priors on the oldest state */
+    void anchorOldestState();
+
+    OnlineEstimatorParams params;
+    gtsam::ISAM2 isam;
+    ImuPreintegrator preintegrator;
+    boost::shared_ptr<gtsam::Cal3_S2> K;
+    gtsam::Pose3 T_B_C;
+
+    std::size_t first_state = 0;
+    std::deque<TimePoint> state_times;
+    PoseVelBias latest_state;
+    gtsam::imuBias::ConstantBias latest_imu_bias;
+    std::chrono::steady_clock::duration last_update_duration{};
+
+    /** Factors and initial values not yet given to iSAM2 */
+    gtsam::NonlinearFactorGraph new_factors;
+    gtsam::Values new_values;
+
+    /** In fixed-lag mode, the factors and estimate of the window, including
+     * the linear priors left by marginalization, and the anchor factors */
+    gtsam::NonlinearFactorGraph window_factors;
+    gtsam::Values window_values;
+    gtsam::NonlinearFactorGraph anchor_factors;
+
+    /** Observations of landmarks not yet in the estimate, as pairs of state
+     * index and measurement */
+    std::map<LandmarkId, std::vector<std::pair<std::size_t, Vec2>>>
+      pending_landmarks;
+};
+
+}  // namespace wave
+
+#endif  // WAVE_ONLINE_ESTIMATOR_HPP
@@ -0,0 +1,47 @@
+#ifndef WAVE_PARALLEL_LINEARIZE_HPP
+#define WAVE_PARALLEL_LINEARIZE_HPP
+
+#include <vector>
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+/**
+ * Parallel versions of NonlinearFactorGraph::linearize() and error().
+ *
+ * The factors are split into blocks, which threads take in turn. Each factor
+ * is evaluated exactly as in the serial version, and the results are placed
+ * or summed in factor order, so they are bitwise identical to it. The factors
+ * must be safe to evaluate concurrently, as all wave_gtsam factors are.
+ */
+
+namespace wave {
+
+/** Linearizes each factor of `graph` at `values`
+ *
+ * @param n_threads maximum number of threads to use. If 0, uses the number of
+ * hardware threads.
+ * @return a graph with the linearized factor at the index of each factor
+ */
+boost::shared_ptr<gtsam::GaussianFactorGraph> linearizeParallel(
+  const gtsam::NonlinearFactorGraph &graph,
+  const gtsam::Values &values,
+  int n_threads = 0);
+
+/** Computes the error of each factor of `graph` at `values`, or zero for null
+ * factors */
+std::vector<double> factorErrorsParallel(
+  const gtsam::NonlinearFactorGraph &graph,
+  const gtsam::Values &values,
+  int n_threads = 0);
+
+/** Computes the total error of `graph` at `values`, as used by the
+ * optimizers' convergence checks */
+double errorParallel(const gtsam::NonlinearFactorGraph &graph,
+                     const gtsam::Values &values,
+                     int n_threads = 0);
+
+}  // namespace wave
+
+#endif  // WAVE_PARALLEL_LINEARIZE_HPP
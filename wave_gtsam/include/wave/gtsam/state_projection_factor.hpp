@@ -0,0 +1,60 @@
+#ifndef WAVE_STATE_PROJECTION_FACTOR_HPP
+#define WAVE_STATE_PROJECTION_FACTOR_HPP
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/geometry/Cal3_S2.h>
+#include <gtsam/geometry/Point2.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/geometry/Pose3.h>
+
+/**
+ * Projection of a landmark into a camera mounted on the body of a combined
+ * state, such as PoseVelBias. Provides the effect of
+ * gtsam::GenericProjectionFactor for custom states.
+ *
+ * The model is
+ * r = project(T_LOCAL_B * T_B_C, landmark) - measurement
+ *
+ * where T_LOCAL_B is the pose of the state and T_B_C the fixed pose of the
+ * camera in the body frame.
+ */
+
+namespace wave {
+
+template <class T>
+class StateProjectionFactor
+  : public gtsam::NoiseModelFactor2<T, gtsam::Point3> {
+ private:
+    gtsam::Point2 measured;
+    boost::shared_ptr<gtsam::Cal3_S2> K;
+    gtsam::Pose3 T_B_C;
+
+ public:
+    StateProjectionFactor(gtsam::Key state_key,
+                          gtsam::Key landmark_key,
+                          const gtsam::Point2 &measured,
+                          const boost::shared_ptr<gtsam::Cal3_S2> &K,
+                          const gtsam::Pose3 &T_B_C,
+                          const gtsam::SharedNoiseModel &model)
+        : gtsam::NoiseModelFactor2<T, gtsam::Point3>::NoiseModelFactor2(
+            model, state_key, landmark_key),
+          measured{measured},
+          K{K},
+          T_B_C{T_B_C} {}
+
+    /** Evaluate the reprojection error.
+     *
+     * If the landmark is behind the camera, the error is a constant 2 * fx in
+     * each direction with zero Jacobians, as in gtsam::GenericProjectionFactor.
+     */
+    gtsam::Vector evaluateError(
+      const T &m,
+      const gtsam::Point3 &landmark,
+      boost::optional<gtsam::Matrix &> H1 = boost::none,
+      boost::optional<gtsam::Matrix &> H2 = boost::none) const;
+};
+}
+
+#include "wave/gtsam/impl/state_projection_factor_impl.hpp"
+
+#endif  // WAVE_STATE_PROJECTION_FACTOR_HPP
@@ -0,0 +1,67 @@
+#ifndef WAVE_VO_DATASET_GRAPH_HPP
+#define WAVE_VO_DATASET_GRAPH_HPP
+
+#include "wave/gtsam/graph_builder.hpp"
+#include "wave/vision/dataset/VoDataset.hpp"
+
+/**
+ * Building gtsam graphs from a VoDataset with GraphBuilder. These functions
+ * are header-only, so only their users need to link wave_vision.
+ */
+
+namespace wave {
+
+/** Returns the ground truth pose of the camera at `state`.
+ *
+ * The camera's z axis looks along the robot's x axis, as in VoTestCamera.
+ */
+inline gtsam::Pose3 cameraPoseFromState(const VoInstant &state) {
+    // Rotate -90 deg about the x axis, then -90 deg about the z axis
+    const auto q_BC = Quaternion{Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
+                                 Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX())};
+    const Quaternion q_GC = state.robot_q_GB * q_BC;
+    return gtsam::Pose3{gtsam::Rot3{q_GC}, gtsam::Point3{state.robot_G_p_GB}};
+}
+
+/** Returns the ground truth camera pose of each state of `dataset` */
+inline std::vector<gtsam::Pose3> cameraPoses(const VoDataset &dataset) {
+    std::vector<gtsam::Pose3> poses;
+    poses.reserve(dataset.states.size());
+    for (const auto &state : dataset.states) {
+        poses.push_back(cameraPoseFromState(state));
+    }
+    return poses;
+}
+
+/** Adds a projection factor for every observation in `dataset`, from the
+ * pose with the index of its state.
+ *
+ * If `between_model` is given, also adds BetweenFactors measuring the ground
+ * truth relative pose between consecutive states.
+ */
+inline void addDatasetFactors(
+  const GraphBuilder &builder,
+  gtsam::NonlinearFactorGraph &graph,
+  const VoDataset &dataset,
+  const gtsam::SharedNoiseModel &between_model = nullptr) {
+    std::size_t num_factors = 0;
+    for (const auto &state : dataset.states) {
+        num_factors += state.features_observed.size();
+    }
+    if (between_model && !dataset.states.empty()) {
+        num_factors += dataset.states.size() - 1;
+    }
+    graph.reserve(graph.size() + num_factors);
+
+    for (std::size_t i = 0; i < dataset.states.size(); ++i) {
+        builder.addProjectionFactors(
+          graph, i, dataset.states[i].features_observed);
+    }
+    if (between_model) {
+        builder.addBetweenFactors(graph, cameraPoses(dataset), between_model);
+    }
+}
+
+}  // namespace wave
+
+#endif  // WAVE_VO_DATASET_GRAPH_HPP
@@ -0,0 +1,43 @@
+#include "wave/gtsam/graph_builder.hpp"
+
+#include <gtsam/slam/BetweenFactor.h>
+
+namespace wave {
+
+GraphBuilder::GraphBuilder(const Mat3 &K,
+                           const gtsam::SharedNoiseModel &pixel_model)
+    : K{boost::make_shared<gtsam::Cal3_S2>(
+        K(0, 0), K(1, 1), K(0, 1), K(0, 2), K(1, 2))},
+      pixel_model{pixel_model} {}
+
+void GraphBuilder::addProjectionFactors(
+  gtsam::NonlinearFactorGraph &graph,
+  std::size_t i,
+  const std::vector<std::pair<LandmarkId, Vec2>> &observations) const {
+    const auto pose_key = poseKey(i);
+    for (const auto &observation : observations) {
+        graph.emplace_shared<ProjectionFactor>(
+          gtsam::Point2{observation.second},
+          this->pixel_model,
+          pose_key,
+          landmarkKey(observation.first),
+          this->K);
+    }
+}
+
+void GraphBuilder::addBetweenFactors(
+  gtsam::NonlinearFactorGraph &graph,
+  const std::vector<gtsam::Pose3> &poses,
+  const gtsam::SharedNoiseModel &model) const {
+    if (poses.size() < 2) {
+        return;
+    }
+    graph.reserve(graph.size() + poses.size() - 1);
+
+    for (std::size_t i = 1; i < poses.size(); ++i) {
+        graph.emplace_shared<gtsam::BetweenFactor<gtsam::Pose3>>(
+          poseKey(i - 1), poseKey(i), poses[i - 1].between(poses[i]), model);
+    }
+}
+
+}  // namespace wave
@@ -17,44 +17,45 @@ gtsam::Vector HandEyeFactor::evaluateError(
   boost::optional<gtsam::Matrix &> J_T_LOCAL_S2,
   boost::optional<gtsam::Matrix &> J_T_S1_S2,
   boost::optional<gtsam::Matrix &> J_B_Z) const {
-    gtsam::Matrix J_compose_right;
-    gtsam::Matrix J_compose_left2, J_compose_right2;
-    gtsam::Matrix J_between_left, J_between_right;
-    gtsam::Matrix J_logmap, J_bias;
+    // Intermediate Jacobians are fixed-size, and only computed if needed
+    const bool want_left = J_T_S1_S2 || J_B_Z;
+    gtsam::Matrix6 J_compose_right;
+    gtsam::Matrix6 J_compose_left2, J_compose_right2;
+    gtsam::Matrix6 J_between_left, J_between_right;
+    gtsam::Matrix6 J_logmap;
 
     gtsam::Rot3 IdenRot;
     gtsam::Pose3 Lifted_Bias(IdenRot, B_Z);
 
     gtsam::Pose3 bias_T_S1_S2 =
-      Lifted_Bias.compose(T_S1_S2, J_compose_left2, J_compose_right2);
+      Lifted_Bias.compose(T_S1_S2,
+                          J_B_Z ? &J_compose_left2 : nullptr,
+                          J_T_S1_S2 ? &J_compose_right2 : nullptr);
 
-    auto meas_T_LOCAL_S2 =
-      this->T_LOCAL_S1.compose(bias_T_S1_S2, boost::none, J_compose_right);
+    auto meas_T_LOCAL_S2 = this->T_LOCAL_S1.compose(
+      bias_T_S1_S2, boost::none, want_left ? &J_compose_right : nullptr);
     auto est_T_eye =
-      meas_T_LOCAL_S2.between(T_LOCAL_S2, J_between_left, J_between_right);
-    auto retval = gtsam::Pose3::Logmap(est_T_eye, J_logmap);
+      meas_T_LOCAL_S2.between(T_LOCAL_S2,
+                              want_left ? &J_between_left : nullptr,
+                              J_T_LOCAL_S2 ? &J_between_right : nullptr);
+    gtsam::Vector6 retval = gtsam::Pose3::Logmap(
+      est_T_eye, (J_T_LOCAL_S2 || want_left) ? &J_logmap : nullptr);
 
     if (J_T_LOCAL_S2) {
-        J_T_LOCAL_S2->resize(T_LOCAL_S2.dimension, T_LOCAL_S2.dimension);
-
         *J_T_LOCAL_S2 = J_logmap * J_between_right;
     }
-    if (J_T_S1_S2) {
-        J_T_S1_S2->resize(T_S1_S2.dimension, T_S1_S2.dimension);
-
-        *J_T_S1_S2 =
-          J_logmap * J_between_left * J_compose_right * J_compose_right2;
-    }
-    if (J_B_Z) {
-        J_B_Z->resize(6, 3);
-        J_bias.resize(6, 3);
-        J_bias.setZero();
-        J_bias(3, 0) = 1;
-        J_bias(4, 1) = 1;
-        J_bias(5, 2) = 1;
-
-        *J_B_Z = J_logmap * J_between_left * J_compose_right * J_compose_left2 *
-                 J_bias;
+    if (want_left) {
+        // Jacobian of the error wrt bias_T_S1_S2
+        const gtsam::Matrix6 J_left =
+          J_logmap * J_between_left * J_compose_right;
+        if (J_T_S1_S2) {
+            *J_T_S1_S2 = J_left * J_compose_right2;
+        }
+        if (J_B_Z) {
+            // The bias lifts to a pure translation, so only the translation
+            // columns of J_compose_left2 are needed
+            *J_B_Z = J_left * J_compose_left2.rightCols<3>();
+        }
     }
 
     return retval;
@@ -0,0 +1,67 @@
+#include "wave/gtsam/imu_preintegrator.hpp"
+
+#include <iterator>
+
+namespace wave {
+
+namespace {
+
+/** Integrates the interval between samples `m1` and `m2`, using the mean of
+ * their values */
+void integrateInterval(gtsam::PreintegratedCombinedMeasurements &pim,
+                       const TimePoint &t1,
+                       const Vec6 &m1,
+                       const TimePoint &t2,
+                       const Vec6 &m2) {
+    const double dt = std::chrono::duration<double>(t2 - t1).count();
+    const Vec6 mean = 0.5 * (m1 + m2);
+    pim.integrateMeasurement(mean.tail<3>(), mean.head<3>(), dt);
+}
+
+}  // namespace
+
+ImuPreintegrator::ImuPreintegrator(const boost::shared_ptr<Params> &params,
+                                   int sensor)
+    : params{params}, sensor{sensor} {}
+
+bool ImuPreintegrator::covers(const ImuMeasurementContainer &imu,
+                              const TimePoint &t_i,
+                              const TimePoint &t_j) const {
+    // The sensor range is sorted by time
+    const auto range = imu.getAllFromSensor(this->sensor);
+    if (range.first == range.second) {
+        return false;
+    }
+    return range.first->time_point <= t_i &&
+           std::prev(range.second)->time_point >= t_j;
+}
+
+gtsam::PreintegratedCombinedMeasurements ImuPreintegrator::integrate(
+  const ImuMeasurementContainer &imu,
+  const TimePoint &t_i,
+  const TimePoint &t_j,
+  const gtsam::imuBias::ConstantBias &bias) const {
+    gtsam::PreintegratedCombinedMeasurements pim{this->params, bias};
+    auto last_time = t_i;
+    Vec6 last_value = imu.get(t_i, this->sensor);
+
+    const auto range = imu.getTimeWindow(t_i, t_j);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->sensor_id != this->sensor || it->time_point <= last_time) {
+            continue;
+        }
+        integrateInterval(
+          pim, last_time, last_value, it->time_point, it->value);
+        last_time = it->time_point;
+        last_value = it->value;
+    }
+
+    // Interpolate the end, unless it coincides with the last sample
+    if (last_time < t_j) {
+        integrateInterval(
+          pim, last_time, last_value, t_j, imu.get(t_j, this->sensor));
+    }
+    return pim;
+}
+
+}  // namespace wave
@@ -0,0 +1,421 @@
+#include "wave/gtsam/online_estimator.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#include <gtsam/geometry/PinholeCamera.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/LinearContainerFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include "wave/gtsam/bias_prior.hpp"
+#include "wave/gtsam/gps_factor_with_bias_general.hpp"
+#include "wave/gtsam/motion_factor.hpp"
+#include "wave/gtsam/pose_prior.hpp"
+#include "wave/gtsam/preint_imu_factor.hpp"
+#include "wave/gtsam/state_projection_factor.hpp"
+
+namespace wave {
+
+namespace {
+
+gtsam::Symbol stateKey(std::size_t i) {
+    return gtsam::Symbol{'x', i};
+}
+
+gtsam::Symbol imuBiasKey(std::size_t i) {
+    return gtsam::Symbol{'b', i};
+}
+
+gtsam::Symbol landmarkKey(LandmarkId id) {
+    return gtsam::Symbol{'l', id};
+}
+
+double toSeconds(const std::chrono::steady_clock::duration &d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+gtsam::ISAM2Params isamParams(const OnlineEstimatorParams &params) {
+    gtsam::ISAM2Params isam_params;
+    isam_params.relinearizeThreshold = params.relinearize_threshold;
+    isam_params.relinearizeSkip = params.relinearize_skip;
+    return isam_params;
+}
+
+boost::shared_ptr<ImuPreintegrator::Params> imuParams(
+  const OnlineEstimatorParams &params) {
+    auto imu_params = ImuPreintegrator::Params::MakeSharedU(params.gravity);
+    imu_params->gyroscopeCovariance =
+      std::pow(params.gyroscope_sigma, 2) * gtsam::I_3x3;
+    imu_params->accelerometerCovariance =
+      std::pow(params.accelerometer_sigma, 2) * gtsam::I_3x3;
+    imu_params->integrationCovariance =
+      std::pow(params.integration_sigma, 2) * gtsam::I_3x3;
+    imu_params->biasOmegaCovariance =
+      std::pow(params.gyroscope_bias_sigma, 2) * gtsam::I_3x3;
+    imu_params->biasAccCovariance =
+      std::pow(params.accelerometer_bias_sigma, 2) * gtsam::I_3x3;
+    return imu_params;
+}
+
+}  // namespace
+
+OnlineEstimator::OnlineEstimator(const OnlineEstimatorParams &params)
+    : params{params},
+      isam{isamParams(params)},
+      preintegrator{imuParams(params), params.imu_sensor} {}
+
+void OnlineEstimator::setCamera(const Mat3 &K, const gtsam::Pose3 &T_B_C) {
+    this->K = boost::make_shared<gtsam::Cal3_S2>(
+      K(0, 0), K(1, 1), K(0, 1), K(0, 2), K(1, 2));
+    this->T_B_C = T_B_C;
+}
+
+void OnlineEstimator::initialize(
+  const TimePoint &t,
+  const PoseVelBias &initial,
+  const gtsam::imuBias::ConstantBias &initial_imu_bias) {
+    if (this->numStates() > 0) {
+        throw std::logic_error("OnlineEstimator: already initialized");
+    }
+
+    Eigen::Matrix<double, 15, 1> sigmas;
+    sigmas << gtsam::Vector3::Constant(this->params.prior_rotation_sigma),
+      gtsam::Vector3::Constant(this->params.prior_position_sigma),
+      gtsam::Vector6::Constant(this->params.prior_velocity_sigma),
+      gtsam::Vector3::Constant(this->params.prior_bias_sigma);
+    this->new_factors.add(gtsam::PriorFactor<PoseVelBias>(
+      stateKey(0), initial, gtsam::noiseModel::Diagonal::Sigmas(sigmas)));
+    this->new_factors.add(gtsam::PriorFactor<gtsam::imuBias::ConstantBias>(
+      imuBiasKey(0),
+      initial_imu_bias,
+      gtsam::noiseModel::Isotropic::Sigma(6,
+                                          this->params.prior_imu_bias_sigma)));
+    this->new_values.insert(stateKey(0), initial);
+    this->new_values.insert(imuBiasKey(0), initial_imu_bias);
+
+    this->state_times.push_back(t);
+    this->runUpdate();
+}
+
+void OnlineEstimator::update(const TimePoint &t,
+                             const ImuMeasurementContainer &imu,
+                             const GpsMeasurementContainer &gps,
+                             const CameraMeasurementContainer &landmarks) {
+    if (this->state_times.empty()) {
+        throw std::logic_error("OnlineEstimator: not initialized");
+    }
+    if (t <= this->state_times.back()) {
+        throw std::logic_error("OnlineEstimator: states must be in order");
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t i = this->numStates();
+    const auto t_prev = this->state_times.back();
+    const double dt = toSeconds(t - t_prev);
+    const auto &prev = this->latest_state;
+
+    // Predict the new state, and link it to the previous one
+    const bool have_imu = this->preintegrator.covers(imu, t_prev, t);
+
+    PoseVelBias predicted = prev;
+    if (have_imu) {
+        const auto pim = this->preintegrator.integrate(
+          imu, t_prev, t, this->latest_imu_bias);
+        const gtsam::NavState nav{prev.pose, prev.vel.tail<3>()};
+        const auto predicted_nav = pim.predict(nav, this->latest_imu_bias);
+        predicted.pose = predicted_nav.pose();
+        predicted.vel.tail<3>() = predicted_nav.velocity();
+
+        this->new_factors.add(PreintegratedImuFactor<PoseVelBias>(
+          stateKey(i - 1), stateKey(i), imuBiasKey(i - 1), imuBiasKey(i), pim));
+    } else {
+        predicted.pose = prev.pose.retract(dt * prev.vel);
+
+        // Without IMU, the bias has nothing to link it but its prior
+        this->new_factors.add(gtsam::PriorFactor<gtsam::imuBias::ConstantBias>(
+          imuBiasKey(i),
+          this->latest_imu_bias,
+          gtsam::noiseModel::Isotropic::Sigma(
+            6, this->params.prior_imu_bias_sigma)));
+    }
+    this->new_values.insert(stateKey(i), predicted);
+    this->new_values.insert(imuBiasKey(i), this->latest_imu_bias);
+
+    // The motion model relates the body-frame velocity to the change in pose.
+    // The IMU factor uses the linear velocity in the local frame instead, so
+    // if present it replaces the position and linear velocity terms.
+    const double unused_sigma = 1e6;
+    const double position_sigma =
+      have_imu ? unused_sigma : this->params.motion_position_sigma;
+    const double linear_velocity_sigma =
+      have_imu ? unused_sigma : this->params.motion_velocity_sigma;
+    Eigen::Matrix<double, 15, 1> motion_sigmas;
+    motion_sigmas << gtsam::Vector3::Constant(
+                       this->params.motion_rotation_sigma),
+      gtsam::Vector3::Constant(position_sigma),
+      gtsam::Vector3::Constant(this->params.motion_velocity_sigma),
+      gtsam::Vector3::Constant(linear_velocity_sigma),
+      gtsam::Vector3::Constant(this->params.motion_bias_sigma);
+    this->new_factors.add(MotionFactor<PoseVelBias, PoseVelBias>(
+      stateKey(i - 1),
+      stateKey(i),
+      dt,
+      gtsam::noiseModel::Diagonal::Sigmas(motion_sigmas)));
+
+    // GPS at exactly this time
+    const auto gps_range = gps.getTimeWindow(t, t);
+    for (auto it = gps_range.first; it != gps_range.second; ++it) {
+        if (it->sensor_id != this->params.gps_sensor) {
+            continue;
+        }
+        gtsam::Vector6 gps_sigmas;
+        gps_sigmas << gtsam::Vector3::Constant(this->params.gps_rotation_sigma),
+          gtsam::Vector3::Constant(this->params.gps_position_sigma);
+        this->new_factors.add(GPSFactorWithBiasGeneral<PoseVelBias>(
+          stateKey(i),
+          it->value,
+          gtsam::noiseModel::Diagonal::Sigmas(gps_sigmas)));
+    }
+
+    this->state_times.push_back(t);
+    this->addLandmarkFactors(t, landmarks);
+    this->runUpdate();
+
+    this->last_update_duration = std::chrono::steady_clock::now() - start;
+}
+
+void OnlineEstimator::addLandmarkFactors(
+  const TimePoint &t, const CameraMeasurementContainer &landmarks) {
+    const auto range = landmarks.getTimeWindow(t, t);
+    if (range.first == range.second) {
+        return;
+    }
+    if (!this->K) {
+        throw std::logic_error("OnlineEstimator: camera not set");
+    }
+
+    const std::size_t i = this->numStates() - 1;
+    const auto model =
+      gtsam::noiseModel::Isotropic::Sigma(2, this->params.pixel_sigma);
+    const auto addFactor = [&](std::size_t state, LandmarkId id, Vec2 m) {
+        this->new_factors.add(
+          StateProjectionFactor<PoseVelBias>(stateKey(state),
+                                             landmarkKey(id),
+                                             gtsam::Point2{m},
+                                             this->K,
+                                             this->T_B_C,
+                                             model));
+    };
+
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->sensor_id != this->params.camera_sensor) {
+            continue;
+        }
+        const auto id = it->landmark_id;
+        if (this->hasValue(landmarkKey(id))) {
+            addFactor(i, id, it->value);
+            continue;
+        }
+
+        auto &pending = this->pending_landmarks[id];
+        pending.emplace_back(i, it->value);
+        if (static_cast<int>(pending.size()) <
+            this->params.min_landmark_observations) {
+            continue;
+        }
+
+        // Initialize the landmark along the ray of its first observation
+        const auto first_state = pending.front().first;
+        const gtsam::PinholeCamera<gtsam::Cal3_S2> camera{
+          this->stateEstimate(first_state).pose.compose(this->T_B_C),
+          *this->K};
+        this->new_values.insert(
+          landmarkKey(id),
+          camera.backproject(gtsam::Point2{pending.front().second},
+                             this->params.landmark_init_depth));
+
+        for (const auto &observation : pending) {
+            addFactor(observation.first, id, observation.second);
+        }
+        this->pending_landmarks.erase(id);
+    }
+}
+
+bool OnlineEstimator::hasValue(gtsam::Key key) const {
+    if (this->new_values.exists(key)) {
+        return true;
+    }
+    return this->params.lag > 0 ? this->window_values.exists(key)
+                                : this->isam.valueExists(key);
+}
+
+PoseVelBias OnlineEstimator::stateEstimate(std::size_t i) const {
+    const auto key = stateKey(i);
+    if (this->new_values.exists(key)) {
+        return this->new_values.at<PoseVelBias>(key);
+    }
+    return this->params.lag > 0
+             ? this->window_values.at<PoseVelBias>(key)
+             : this->isam.calculateEstimate<PoseVelBias>(key);
+}
+
+void OnlineEstimator::runUpdate() {
+    const std::size_t i = this->numStates() - 1;
+    if (this->params.lag > 0) {
+        this->optimizeWindow();
+        this->latest_state = this->window_values.at<PoseVelBias>(stateKey(i));
+        this->latest_imu_bias =
+          this->window_values.at<gtsam::imuBias::ConstantBias>(
+            imuBiasKey(i));
+        this->marginalizeOldStates();
+        return;
+    }
+
+    this->isam.update(this->new_factors, this->new_values);
+    for (int k = 0; k < this->params.extra_iterations; ++k) {
+        this->isam.update();
+    }
+    this->new_factors.resize(0);
+    this->new_values.clear();
+
+    this->latest_state = this->isam.calculateEstimate<PoseVelBias>(stateKey(i));
+    this->latest_imu_bias =
+      this->isam.calculateEstimate<gtsam::imuBias::ConstantBias>(
+        imuBiasKey(i));
+}
+
+void OnlineEstimator::optimizeWindow() {
+    this->window_factors.push_back(this->new_factors);
+    this->window_values.insert(this->new_values);
+    this->new_factors.resize(0);
+    this->new_values.clear();
+
+    gtsam::NonlinearFactorGraph graph = this->window_factors;
+    graph.push_back(this->anchor_factors);
+
+    gtsam::LevenbergMarquardtParams lm_params;
+    lm_params.maxIterations = this->params.lag_iterations;
+    gtsam::LevenbergMarquardtOptimizer optimizer{
+      graph, this->window_values, lm_params};
+    this->window_values = optimizer.optimize();
+}
+
+void OnlineEstimator::marginalizeOldStates() {
+    const auto cutoff =
+      this->state_times.back() -
+      std::chrono::duration_cast<TimePoint::duration>(
+        std::chrono::duration<double>(this->params.lag));
+
+    gtsam::KeySet marginalized;
+    while (this->state_times.size() > 1 &&
+           this->state_times.front() < cutoff) {
+        marginalized.insert(stateKey(this->first_state));
+        marginalized.insert(imuBiasKey(this->first_state));
+        this->state_times.pop_front();
+        ++this->first_state;
+    }
+    if (marginalized.empty()) {
+        return;
+    }
+
+    const auto touchesMarginalized = [&](const gtsam::NonlinearFactor &f) {
+        for (const auto key : f.keys()) {
+            if (marginalized.count(key)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Landmarks with no factor to a remaining state would be left in the
+    // window forever, so they go with the states observing them
+    std::map<gtsam::Key, bool> landmark_kept;
+    for (const auto &factor : this->window_factors) {
+        const bool kept = !touchesMarginalized(*factor);
+        for (const auto key : factor->keys()) {
+            if (gtsam::Symbol{key}.chr() == 'l') {
+                landmark_kept[key] = landmark_kept[key] || kept;
+            }
+        }
+    }
+    for (const auto &landmark : landmark_kept) {
+        if (!landmark.second) {
+            marginalized.insert(landmark.first);
+        }
+    }
+
+    // Eliminate the marginalized variables from the factors involving them,
+    // leaving a linear prior on their neighbours
+    gtsam::NonlinearFactorGraph kept, removed;
+    for (const auto &factor : this->window_factors) {
+        if (touchesMarginalized(*factor)) {
+            removed.push_back(factor);
+        } else {
+            kept.push_back(factor);
+        }
+    }
+
+    const auto linear = removed.linearize(this->window_values);
+    const auto linear_keys = linear->keys();
+    gtsam::Ordering ordering;
+    for (const auto key : marginalized) {
+        if (linear_keys.count(key)) {
+            ordering.push_back(key);
+        }
+    }
+    const auto eliminated = linear->eliminatePartialMultifrontal(ordering);
+    for (const auto &factor : *eliminated.second) {
+        if (factor && !factor->empty()) {
+            kept.add(gtsam::LinearContainerFactor{factor, this->window_values});
+        }
+    }
+
+    for (const auto key : marginalized) {
+        this->window_values.erase(key);
+    }
+    this->window_factors = kept;
+
+    // Observations from marginalized states can no longer be added
+    for (auto it = this->pending_landmarks.begin();
+         it != this->pending_landmarks.end();) {
+        auto &pending = it->second;
+        while (!pending.empty() && pending.front().first < this->first_state) {
+            pending.erase(pending.begin());
+        }
+        it = pending.empty() ? this->pending_landmarks.erase(it) : ++it;
+    }
+
+    this->anchorOldestState();
+}
+
+void OnlineEstimator::anchorOldestState() {
+    this->anchor_factors.resize(0);
+    const auto key = stateKey(this->first_state);
+    const auto &oldest = this->window_values.at<PoseVelBias>(key);
+    if (this->params.anchor_pose_sigma > 0) {
+        this->anchor_factors.add(PosePrior<PoseVelBias>(
+          key,
+          oldest.pose,
+          gtsam::noiseModel::Isotropic::Sigma(
+            6, this->params.anchor_pose_sigma)));
+    }
+    if (this->params.anchor_bias_sigma > 0) {
+        this->anchor_factors.add(BiasPrior<PoseVelBias>(
+          key,
+          oldest.bias,
+          gtsam::noiseModel::Isotropic::Sigma(
+            3, this->params.anchor_bias_sigma)));
+    }
+}
+
+gtsam::Values OnlineEstimator::estimate() const {
+    if (this->params.lag > 0) {
+        return this->window_values;
+    }
+    return this->isam.calculateEstimate();
+}
+
+}  // namespace wave
@@ -0,0 +1,105 @@
+/** Long synthetic runs of OnlineEstimator, in fixed-lag and full iSAM2 mode.
+ *
+ * The body moves along a circle at constant speed, with IMU samples at 100Hz
+ * and a GPS measurement at each state, 10 per second. The benchmark arguments
+ * are the number of states and the lag in milliseconds; a lag of zero keeps
+ * every state in iSAM2.
+ *
+ * items/s is updates per second over the whole run. The counters give the
+ * mean time of an update over the first and the last 10% of the run, in
+ * milliseconds, and the number of variables in the estimate at the end. In
+ * fixed-lag mode both should stay constant as the run gets longer.
+ */
+
+#include <cmath>
+
+#include <benchmark/benchmark.h>
+
+#include "wave/gtsam/online_estimator.hpp"
+
+namespace wave {
+
+const double SPEED = 5.0;
+const double YAW_RATE = 0.1;
+const double GRAVITY = 9.81;
+const int IMU_PER_STATE = 10;
+const std::chrono::milliseconds IMU_PERIOD{10};
+
+TimePoint stateTime(int k) {
+    return TimePoint{} + k * IMU_PER_STATE * IMU_PERIOD;
+}
+
+PoseVelBias trueState(double t) {
+    const double yaw = YAW_RATE * t;
+    const double radius = SPEED / YAW_RATE;
+    PoseVelBias state;
+    state.pose = gtsam::Pose3{
+      gtsam::Rot3::Yaw(yaw),
+      gtsam::Point3{radius * std::sin(yaw), radius * (1 - std::cos(yaw)), 0}};
+    state.vel << 0, 0, YAW_RATE, SPEED * std::cos(yaw), SPEED * std::sin(yaw),
+      0;
+    return state;
+}
+
+void BM_LongRun(benchmark::State &state) {
+    const int num_states = state.range(0);
+
+    // In the body frame, the centripetal acceleration is constant along y,
+    // and the accelerometers measure the reaction to gravity
+    ImuMeasurementContainer imu;
+    GpsMeasurementContainer gps;
+    const CameraMeasurementContainer landmarks;
+    Vec6 sample;
+    sample << 0, 0, YAW_RATE, 0, SPEED * YAW_RATE, GRAVITY;
+    for (int j = 0; j <= num_states * IMU_PER_STATE; ++j) {
+        imu.emplace(TimePoint{} + j * IMU_PERIOD, 0, sample);
+    }
+    for (int k = 0; k <= num_states; ++k) {
+        const double t =
+          std::chrono::duration<double>(stateTime(k) - TimePoint{}).count();
+        gps.emplace(stateTime(k), 0, trueState(t).pose);
+    }
+
+    OnlineEstimatorParams params;
+    params.gravity = GRAVITY;
+    params.lag = state.range(1) / 1000.0;
+
+    const int window = num_states / 10;
+    double first_ms = 0, last_ms = 0;
+    std::size_t num_variables = 0;
+    for (auto _ : state) {
+        OnlineEstimator estimator{params};
+        estimator.initialize(stateTime(0), trueState(0));
+
+        for (int k = 1; k <= num_states; ++k) {
+            estimator.update(stateTime(k), imu, gps, landmarks);
+            const double ms = std::chrono::duration<double, std::milli>(
+                                estimator.lastUpdateDuration())
+                                .count();
+            if (k <= window) {
+                first_ms += ms;
+            } else if (k > num_states - window) {
+                last_ms += ms;
+            }
+        }
+        num_variables = estimator.estimate().size();
+        benchmark::DoNotOptimize(estimator.latestState());
+    }
+
+    const auto num_windows = state.iterations() * window;
+    state.SetItemsProcessed(state.iterations() * num_states);
+    state.counters["first_update_ms"] = first_ms / num_windows;
+    state.counters["last_update_ms"] = last_ms / num_windows;
+    state.counters["variables"] = num_variables;
+}
+
+BENCHMARK(BM_LongRun)
+  ->Args({1000, 0})
+  ->Args({1000, 2000})
+  ->Args({10000, 2000})
+  ->Args({100000, 2000})
+  ->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
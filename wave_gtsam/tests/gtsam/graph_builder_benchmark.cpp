@@ -0,0 +1,113 @@
+/** Building graphs of projection factors from VoDataset and
+ * LandmarkMeasurementContainer.
+ *
+ * The dataset has 100 observations per state, and the benchmark argument is
+ * the total number of observations. BM_BuildManual builds the graph as the
+ * offline examples do, converting each observation and copying each factor
+ * into the graph. BM_BuildFromDataset and BM_BuildFromContainer use
+ * GraphBuilder, from the dataset and from a container holding the same
+ * observations.
+ *
+ * items/s is factors added per second.
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include "wave/gtsam/graph_builder.hpp"
+#include "wave/gtsam/vo_dataset_graph.hpp"
+
+namespace wave {
+
+const int OBSERVATIONS_PER_STATE = 100;
+
+VoDataset makeDataset(int num_observations) {
+    VoDataset dataset;
+    dataset.camera_K << 200, 0, 320, 0, 200, 240, 0, 0, 1;
+    const int num_states = num_observations / OBSERVATIONS_PER_STATE;
+    dataset.states.resize(num_states);
+    for (int i = 0; i < num_states; ++i) {
+        auto &state = dataset.states[i];
+        state.time = 0.1 * i;
+        state.robot_G_p_GB = Vec3{0.5 * i, 0, 0};
+        state.robot_q_GB = Quaternion::Identity();
+
+        // Each landmark is seen from ten consecutive states
+        for (int j = 0; j < OBSERVATIONS_PER_STATE; ++j) {
+            const LandmarkId id = (i / 10) * OBSERVATIONS_PER_STATE + j;
+            state.features_observed.emplace_back(id, Vec2{j, 240});
+        }
+    }
+    return dataset;
+}
+
+void BM_BuildManual(benchmark::State &state) {
+    const auto dataset = makeDataset(state.range(0));
+    const auto K = boost::make_shared<gtsam::Cal3_S2>(200, 200, 0, 320, 240);
+    const auto model = gtsam::noiseModel::Isotropic::Sigma(2, 1.0);
+
+    std::size_t num_factors = 0;
+    for (auto _ : state) {
+        gtsam::NonlinearFactorGraph graph;
+        for (auto i = 0u; i < dataset.states.size(); ++i) {
+            const auto &observations = dataset.states[i].features_observed;
+            for (size_t j = 0; j < observations.size(); ++j) {
+                const auto measurement = gtsam::Point2{observations[j].second};
+                const auto landmark_id = observations[j].first;
+                auto projection_factor = GraphBuilder::ProjectionFactor{
+                  measurement,
+                  model,
+                  gtsam::Symbol{'x', i},
+                  gtsam::Symbol{'l', landmark_id},
+                  K};
+                graph.push_back(projection_factor);
+            }
+        }
+        num_factors += graph.size();
+    }
+    state.SetItemsProcessed(num_factors);
+}
+
+void BM_BuildFromDataset(benchmark::State &state) {
+    const auto dataset = makeDataset(state.range(0));
+    const GraphBuilder builder{dataset.camera_K,
+                               gtsam::noiseModel::Isotropic::Sigma(2, 1.0)};
+
+    std::size_t num_factors = 0;
+    for (auto _ : state) {
+        gtsam::NonlinearFactorGraph graph;
+        addDatasetFactors(builder, graph, dataset);
+        num_factors += graph.size();
+    }
+    state.SetItemsProcessed(num_factors);
+}
+
+void BM_BuildFromContainer(benchmark::State &state) {
+    const auto dataset = makeDataset(state.range(0));
+    const GraphBuilder builder{dataset.camera_K,
+                               gtsam::noiseModel::Isotropic::Sigma(2, 1.0)};
+
+    LandmarkMeasurementContainer<LandmarkMeasurement<int>> landmarks;
+    for (std::size_t i = 0; i < dataset.states.size(); ++i) {
+        const auto t = TimePoint{} + i * std::chrono::milliseconds{100};
+        for (const auto &obs : dataset.states[i].features_observed) {
+            landmarks.emplace(t, 0, obs.first, i, obs.second);
+        }
+    }
+
+    std::size_t num_factors = 0;
+    for (auto _ : state) {
+        gtsam::NonlinearFactorGraph graph;
+        builder.addProjectionFactors(graph, landmarks, 0);
+        num_factors += graph.size();
+    }
+    state.SetItemsProcessed(num_factors);
+}
+
+BENCHMARK(BM_BuildManual)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFromDataset)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFromContainer)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
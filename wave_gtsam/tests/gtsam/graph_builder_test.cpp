@@ -0,0 +1,91 @@
+#include <gtsam/nonlinear/Values.h>
+
+#include "wave/gtsam/graph_builder.hpp"
+#include "wave/gtsam/vo_dataset_graph.hpp"
+#include "wave/wave_test.hpp"
+
+namespace wave {
+
+class GraphBuilderTest : public ::testing::Test {
+ protected:
+    VoDataset dataset;
+    gtsam::Values truth;
+    std::size_t num_observations = 0;
+    const gtsam::SharedNoiseModel pixel_model =
+      gtsam::noiseModel::Isotropic::Sigma(2, 1.0);
+
+    GraphBuilderTest() {
+        VoDatasetGenerator generator;
+        generator.camera.image_width = 640;
+        generator.camera.image_height = 480;
+        generator.camera.K << 200, 0, 320, 0, 200, 240, 0, 0, 1;
+        generator.camera.hz = 10.0;
+        generator.nb_landmarks = 100;
+        generator.landmark_x_bounds << -10, 10;
+        generator.landmark_y_bounds << -10, 10;
+        generator.landmark_z_bounds << -1, 1;
+        this->dataset = generator.generate();
+
+        const auto poses = cameraPoses(this->dataset);
+        for (std::size_t i = 0; i < poses.size(); ++i) {
+            this->truth.insert(GraphBuilder::poseKey(i), poses[i]);
+            this->num_observations +=
+              this->dataset.states[i].features_observed.size();
+        }
+        for (const auto &landmark : this->dataset.landmarks) {
+            this->truth.insert(GraphBuilder::landmarkKey(landmark.first),
+                               gtsam::Point3{landmark.second});
+        }
+    }
+
+    // Checks every projection factor shares the builder's calibration and
+    // noise model
+    void expectShared(const GraphBuilder &builder,
+                      const gtsam::NonlinearFactorGraph &graph) const {
+        for (const auto &factor : graph) {
+            const auto projection =
+              boost::dynamic_pointer_cast<GraphBuilder::ProjectionFactor>(
+                factor);
+            if (projection) {
+                EXPECT_EQ(builder.calibration(), projection->calibration());
+                EXPECT_EQ(this->pixel_model, projection->noiseModel());
+            }
+        }
+    }
+};
+
+TEST_F(GraphBuilderTest, from_dataset) {
+    const GraphBuilder builder{this->dataset.camera_K, this->pixel_model};
+    const auto between_model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+
+    gtsam::NonlinearFactorGraph graph;
+    addDatasetFactors(builder, graph, this->dataset, between_model);
+
+    EXPECT_EQ(this->num_observations + this->dataset.states.size() - 1,
+              graph.size());
+    EXPECT_NEAR(0.0, graph.error(this->truth), 1e-6);
+    this->expectShared(builder, graph);
+}
+
+TEST_F(GraphBuilderTest, from_container) {
+    const GraphBuilder builder{this->dataset.camera_K, this->pixel_model};
+
+    // Each state is one image, with measurements from two sensors
+    LandmarkMeasurementContainer<LandmarkMeasurement<int>> landmarks;
+    for (std::size_t i = 0; i < this->dataset.states.size(); ++i) {
+        const auto t = TimePoint{} + i * std::chrono::milliseconds{100};
+        for (const auto &obs : this->dataset.states[i].features_observed) {
+            landmarks.emplace(t, 0, obs.first, i, obs.second);
+            landmarks.emplace(t, 1, obs.first, i, Vec2::Zero());
+        }
+    }
+
+    gtsam::NonlinearFactorGraph graph;
+    builder.addProjectionFactors(graph, landmarks, 0);
+
+    EXPECT_EQ(this->num_observations, graph.size());
+    EXPECT_NEAR(0.0, graph.error(this->truth), 1e-6);
+    this->expectShared(builder, graph);
+}
+
+}  // namespace wave
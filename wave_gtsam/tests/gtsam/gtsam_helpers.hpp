@@ -4,6 +4,7 @@
 #include <gtsam/geometry/Pose3.h>
 
 #include "wave/utils/math.hpp"
+#include "wave/gtsam/vo_dataset_graph.hpp"
 #include "wave/vision/dataset/VoDataset.hpp"
 
 namespace wave {
@@ -19,16 +20,7 @@ inline gtsam::Pose3 gtsamPoseFromEigen(const Quaternion &q, const Vec3 &p) {
  * looks along the robot's x axis).
  */
 inline gtsam::Pose3 gtsamPoseFromState(const VoInstant &state) {
-    // Transform from robot to camera frame
-    // This involves the rotation sequence: -90 deg about initial x axis,
-    // 0, then -90 deg about initial z axis.
-    const auto q_BC = Quaternion{Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
-                                 Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX())};
-
-    const Quaternion q_GC = state.robot_q_GB * q_BC;
-    const auto &G_p_GC = state.robot_G_p_GB;
-
-    return gtsamPoseFromEigen(q_GC, G_p_GC);
+    return cameraPoseFromState(state);
 }
 
 /** Get the tranformation between two gtsam poses */
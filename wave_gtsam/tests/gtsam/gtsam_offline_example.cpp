@@ -1,10 +1,8 @@
 #include <gtsam/slam/PriorFactor.h>
 #include <gtsam/slam/ProjectionFactor.h>
-#include <gtsam/slam/BetweenFactor.h>
 
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
-#include <gtsam/inference/Symbol.h>
 #include <gtsam/linear/Sampler.h>
 
 #include "wave/wave_test.hpp"
@@ -40,93 +38,65 @@ TEST_F(GtsamExample, run) {
     gtsam::NonlinearFactorGraph graph;
     gtsam::Values initial_estimate;
 
-    std::vector<gtsam::Pose3> true_poses;
+    const auto true_poses = cameraPoses(this->dataset);
 
     // Since the synthetic dataset has zero noise, we will generate some
     // Set up a gaussian noise source of 1.1 pixel in u and v
     auto measurement_noise_model = gtsam::noiseModel::Isotropic::Sigma(2, 1.1);
     auto measurement_noise_sampler = gtsam::Sampler{measurement_noise_model};
 
-    // Loop over the different poses, adding the observations to iSAM
-    // incrementally
-    for (auto i = 0u; i < this->dataset.states.size(); ++i) {
-        const auto &state = this->dataset.states[i];
-        const auto &observations = state.features_observed;
+    // Add a purposely offset initial estimate of each pose, and of each
+    // landmark the first time we see it
+    const auto pose_offset =
+      gtsam::Pose3{gtsam::Rot3::Rodrigues(-0.02, 0.02, 0.22),
+                   gtsam::Point3{0.05, -0.10, 0.20}};
+    const auto landmark_offset = gtsam::Point3{-0.25, 0.20, 0.15};
 
-        // We have to convert things to gtsam types
-        // @todo better integration
+    auto noisy_dataset = this->dataset;
+    for (auto i = 0u; i < noisy_dataset.states.size(); ++i) {
+        const auto &pose = true_poses[i];
+        initial_estimate.insert(GraphBuilder::poseKey(i),
+                                pose.compose(pose_offset));
 
-        const auto pose = gtsamPoseFromState(state);
-        true_poses.push_back(pose);
-
-        if (use_odometry_factors && i > 0) {
-            // Add odometry factor
-            auto between = poseBetweenStates(dataset.states[i - 1], state);
-
-            Vec6 noise_vec;
-            noise_vec << Vec3::Constant(0.001), Vec3::Constant(0.0001);
-
-            auto noise = gtsam::noiseModel::Diagonal::Sigmas(noise_vec);
-            auto odometry_factor = gtsam::BetweenFactor<gtsam::Pose3>{
-              gtsam::Symbol{'x', i - 1}, gtsam::Symbol{'x', i}, between, noise};
-            graph.push_back(odometry_factor);
-        }
-
-        // Add a purposely offset initial estimate
-        const auto offset =
-          gtsam::Pose3{gtsam::Rot3::Rodrigues(-0.02, 0.02, 0.22),
-                       gtsam::Point3{0.05, -0.10, 0.20}};
-
-        auto pose_estimate = pose;
-        pose_estimate = pose_estimate.compose(offset);
-        initial_estimate.insert(gtsam::Symbol{'x', i}, pose_estimate);
-
-
-        // Add factors for each landmark observation
-        for (size_t j = 0; j < observations.size(); ++j) {
-            // Convert observation
-            const auto measurement = gtsam::Point2{observations[j].second};
-            const auto landmark_id = observations[j].first;
+        gtsam::SimpleCamera camera(pose, *this->kParams);
+        for (auto &observation : noisy_dataset.states[i].features_observed) {
+            const auto landmark_id = observation.first;
 
             // Double check that our measurement matches gtsam's projection fn
             const auto &G_p_GF = this->dataset.landmarks[landmark_id];
-            gtsam::SimpleCamera camera(pose, *this->kParams);
             const gtsam::Point2 gt_measurement =
               camera.project(gtsam::Point3{G_p_GF});
-            ASSERT_PRED2(VectorsNear, gt_measurement, measurement);
+            ASSERT_PRED2(
+              VectorsNear, gt_measurement, gtsam::Point2{observation.second});
 
             // Add some artificial noise to the synthetic measurement
-            auto noisy_measurement =
-              measurement + measurement_noise_sampler.sample();
-
-            auto projection_factor =
-              gtsam::GenericProjectionFactor<gtsam::Pose3,
-                                             gtsam::Point3,
-                                             gtsam::Cal3_S2>{
-                noisy_measurement,
-                measurement_noise_model,
-                gtsam::Symbol{'x', i},
-                gtsam::Symbol{'l', landmark_id},
-                this->kParams};
-
-            graph.push_back(projection_factor);
-
-            // Add a purposely offset initial estimate the first time we see it
-            const auto key = gtsam::Symbol{'l', landmark_id};
+            observation.second += measurement_noise_sampler.sample();
+
+            const auto key = GraphBuilder::landmarkKey(landmark_id);
             if (!initial_estimate.exists(key)) {
-                auto offset = gtsam::Point3{-0.25, 0.20, 0.15};
-                initial_estimate.insert<gtsam::Point3>(key, G_p_GF + offset);
+                initial_estimate.insert<gtsam::Point3>(
+                  key, G_p_GF + landmark_offset);
             }
         }
+    }
 
-        // Add priors on the first two poses to fix the origin and scale
-        if (i < 2) {
-            VecX noise_vec{6};
-            noise_vec << Vec3::Constant(1e-5), Vec3::Constant(1e-6);
-            auto poseNoise = gtsam::noiseModel::Diagonal::Sigmas(noise_vec);
-            graph.push_back(gtsam::PriorFactor<gtsam::Pose3>{
-              gtsam::Symbol{'x', i}, pose, poseNoise});
-        }
+    // Add factors for each landmark observation, and odometry factors if used
+    gtsam::SharedNoiseModel odometry_noise_model;
+    if (use_odometry_factors) {
+        Vec6 noise_vec;
+        noise_vec << Vec3::Constant(0.001), Vec3::Constant(0.0001);
+        odometry_noise_model = gtsam::noiseModel::Diagonal::Sigmas(noise_vec);
+    }
+    GraphBuilder builder{this->kParams->matrix(), measurement_noise_model};
+    addDatasetFactors(builder, graph, noisy_dataset, odometry_noise_model);
+
+    // Add priors on the first two poses to fix the origin and scale
+    VecX noise_vec{6};
+    noise_vec << Vec3::Constant(1e-5), Vec3::Constant(1e-6);
+    auto poseNoise = gtsam::noiseModel::Diagonal::Sigmas(noise_vec);
+    for (auto i = 0u; i < 2; ++i) {
+        graph.push_back(gtsam::PriorFactor<gtsam::Pose3>{
+          GraphBuilder::poseKey(i), true_poses[i], poseNoise});
     }
 
     gtsam::LevenbergMarquardtOptimizer optimizer{graph, initial_estimate};
@@ -140,7 +110,7 @@ TEST_F(GtsamExample, run) {
 
     // Check camera poses
     for (auto i = 0u; i < true_poses.size(); ++i) {
-        const auto key = gtsam::Symbol{'x', i};
+        const auto key = GraphBuilder::poseKey(i);
         // We have to cast the generic Value back to the known type
         const auto estimated_pose = result.at(key).cast<gtsam::Pose3>();
         const auto &true_pose = true_poses[i];
@@ -163,7 +133,7 @@ TEST_F(GtsamExample, run) {
         const auto &landmark_id = l.first;
         const auto &true_pos = l.second;
 
-        const auto key = gtsam::Symbol{'l', landmark_id};
+        const auto key = GraphBuilder::landmarkKey(landmark_id);
         const auto estimated_pos = result.at(key).cast<gtsam::Point3>();
         const auto landmark_error = (true_pos - estimated_pos).norm();
 
@@ -1,10 +1,8 @@
 #include <gtsam/slam/PriorFactor.h>
 #include <gtsam/slam/ProjectionFactor.h>
-#include <gtsam/slam/BetweenFactor.h>
 
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
-#include <gtsam/inference/Symbol.h>
 #include <gtsam/linear/Sampler.h>
 
 #include "wave/wave_test.hpp"
@@ -35,7 +33,7 @@ TEST_F(GtsamExample, run) {
     gtsam::NonlinearFactorGraph graph;
     gtsam::Values initial_estimate;
 
-    std::vector<gtsam::Pose3> true_poses;
+    const auto true_poses = cameraPoses(this->dataset);
 
     // This dataset has some pixel noise, but we don't know what it is exactly.
     // Estimate at one pixel in u and v
@@ -50,80 +48,57 @@ TEST_F(GtsamExample, run) {
       gtsam::noiseModel::Diagonal::Sigmas(noise_vec);
     auto odometry_noise_sampler = gtsam::Sampler{odometry_noise_model};
 
-    // Loop over the different poses, adding the observations to iSAM
-    // incrementally
-    for (auto i = 0u; i < this->dataset.states.size(); ++i) {
-        const auto &state = this->dataset.states[i];
-        const auto &observations = state.features_observed;
-
-        // We have to convert things to gtsam types
-        // @todo better integration
-
-        const auto pose = gtsamPoseFromState(state);
-        true_poses.push_back(pose);
-
-        // Add a purposely offset initial estimate
-        const auto offset = gtsam::Pose3{gtsam::Rot3::Rodrigues(-0.1, 0.1, 0.1),
-                                         gtsam::Point3{0.05, -0.10, 0.20}};
-
-        auto pose_estimate = pose;
-        pose_estimate = pose_estimate.compose(offset);
-        initial_estimate.insert(gtsam::Symbol{'x', i}, pose_estimate);
-
-        if (use_odometry_factors && i > 0) {
-            // Add odometry factor
-            auto between = poseBetweenStates(dataset.states[i - 1], state);
-
-            // Add artificial noise
-            const auto offset = odometry_noise_sampler.sample();
-            between = between.expmap(offset);
-
-            auto odometry_factor =
-              gtsam::BetweenFactor<gtsam::Pose3>{gtsam::Symbol{'x', i - 1},
-                                                 gtsam::Symbol{'x', i},
-                                                 between,
-                                                 odometry_noise_model};
-            graph.push_back(odometry_factor);
-        }
+    GraphBuilder builder{this->kParams->matrix(), measurement_noise_model};
 
+    if (use_projection_factors) {
         // Add factors for each landmark observation
-        for (size_t j = 0; j < observations.size(); ++j) {
-            if (!use_projection_factors) {
-                break;
-            }
-
-            // Convert observation
-            const auto measurement = gtsam::Point2{observations[j].second};
-            const auto landmark_id = observations[j].first;
-
-            auto projection_factor =
-              gtsam::GenericProjectionFactor<gtsam::Pose3,
-                                             gtsam::Point3,
-                                             gtsam::Cal3_S2>{
-                measurement,
-                measurement_noise_model,
-                gtsam::Symbol{'x', i},
-                gtsam::Symbol{'l', landmark_id},
-                this->kParams};
-            graph.push_back(projection_factor);
-
-            // Initialize the landmark just in front of the camera
-            const auto key = gtsam::Symbol{'l', landmark_id};
-            if (!initial_estimate.exists(key)) {
-                auto camera = gtsam::SimpleCamera{pose, *this->kParams};
-                auto est = camera.backproject(measurement, 3.0);
-                initial_estimate.insert<gtsam::Point3>(key, est);
+        addDatasetFactors(builder, graph, this->dataset);
+
+        // Initialize each landmark just in front of the first camera to see it
+        for (auto i = 0u; i < true_poses.size(); ++i) {
+            const auto camera =
+              gtsam::SimpleCamera{true_poses[i], *this->kParams};
+            for (const auto &observation :
+                 this->dataset.states[i].features_observed) {
+                const auto key = GraphBuilder::landmarkKey(observation.first);
+                if (!initial_estimate.exists(key)) {
+                    const auto measurement = gtsam::Point2{observation.second};
+                    auto est = camera.backproject(measurement, 3.0);
+                    initial_estimate.insert<gtsam::Point3>(key, est);
+                }
             }
         }
+    }
 
-        // Add priors on the first two poses to fix the origin and scale
-        if (i < 2) {
-            VecX noise_vec{6};
-            noise_vec << Vec3::Constant(1e-5), Vec3::Constant(1e-6);
-            auto poseNoise = gtsam::noiseModel::Diagonal::Sigmas(noise_vec);
-            graph.push_back(gtsam::PriorFactor<gtsam::Pose3>{
-              gtsam::Symbol{'x', i}, pose, poseNoise});
+    if (use_odometry_factors) {
+        // Chain the relative poses between consecutive states, with
+        // artificial noise, so each odometry factor measures a noisy relative
+        // pose
+        std::vector<gtsam::Pose3> odometry_poses{true_poses.front()};
+        for (auto i = 1u; i < true_poses.size(); ++i) {
+            const auto between = true_poses[i - 1].between(true_poses[i]);
+            const auto offset = odometry_noise_sampler.sample();
+            odometry_poses.push_back(odometry_poses.back() *
+                                     between.expmap(offset));
         }
+        builder.addBetweenFactors(graph, odometry_poses, odometry_noise_model);
+    }
+
+    // Add a purposely offset initial estimate of each pose
+    const auto offset = gtsam::Pose3{gtsam::Rot3::Rodrigues(-0.1, 0.1, 0.1),
+                                     gtsam::Point3{0.05, -0.10, 0.20}};
+    for (auto i = 0u; i < true_poses.size(); ++i) {
+        initial_estimate.insert(GraphBuilder::poseKey(i),
+                                true_poses[i].compose(offset));
+    }
+
+    // Add priors on the first two poses to fix the origin and scale
+    VecX prior_noise_vec{6};
+    prior_noise_vec << Vec3::Constant(1e-5), Vec3::Constant(1e-6);
+    auto poseNoise = gtsam::noiseModel::Diagonal::Sigmas(prior_noise_vec);
+    for (auto i = 0u; i < 2; ++i) {
+        graph.push_back(gtsam::PriorFactor<gtsam::Pose3>{
+          GraphBuilder::poseKey(i), true_poses[i], poseNoise});
     }
 
     gtsam::LevenbergMarquardtOptimizer optimizer{graph, initial_estimate};
@@ -137,7 +112,7 @@ TEST_F(GtsamExample, run) {
 
     // Check camera poses
     for (auto i = 0u; i < true_poses.size(); ++i) {
-        const auto key = gtsam::Symbol{'x', i};
+        const auto key = GraphBuilder::poseKey(i);
         // We have to cast the generic Value back to the known type
         const auto estimated_pose = result.at(key).cast<gtsam::Pose3>();
         const auto &true_pose = true_poses[i];
@@ -134,4 +134,37 @@ TEST(hand_eye, jacobians) {
     EXPECT_NEAR((J_B_Z - J_BZnum).norm(), 0, 1e-8);
 }
 
+// Test that requesting only some jacobians gives the same values
+TEST(hand_eye, partial_jacobians) {
+    gtsam::Pose3 T_loc_1(gtsam::Rot3::Ypr(0.3, -0.2, 0.1),
+                         gtsam::Point3(32, 2, 3));
+    gtsam::Pose3 T_loc_2(gtsam::Rot3::Ypr(0.35, -0.1, 0.2),
+                         gtsam::Point3(32.1, 2.3, 2.9));
+    gtsam::Pose3 T_s1s2(gtsam::Rot3::Ypr(0.0, 0.0, 0.1),
+                        gtsam::Point3(0.2, 0.3, -0.1));
+    gtsam::Point3 B_Z(0.01, -0.02, 0.03);
+
+    Mat6 info;
+    info.setIdentity();
+    auto model = gtsam::noiseModel::Gaussian::Information(info);
+    HandEyeFactor factor(3, 2, 4, T_loc_1, model);
+
+    gtsam::Matrix J_loc2, J_s1s2, J_B_Z;
+    auto err =
+      factor.evaluateError(T_loc_2, T_s1s2, B_Z, J_loc2, J_s1s2, J_B_Z);
+
+    gtsam::Matrix J_loc2_only, J_s1s2_only, J_B_Z_only;
+    auto err_loc2 = factor.evaluateError(
+      T_loc_2, T_s1s2, B_Z, J_loc2_only, boost::none, boost::none);
+    factor.evaluateError(
+      T_loc_2, T_s1s2, B_Z, boost::none, J_s1s2_only, boost::none);
+    factor.evaluateError(
+      T_loc_2, T_s1s2, B_Z, boost::none, boost::none, J_B_Z_only);
+
+    EXPECT_NEAR((err - err_loc2).norm(), 0, 1e-12);
+    EXPECT_NEAR((J_loc2 - J_loc2_only).norm(), 0, 1e-12);
+    EXPECT_NEAR((J_s1s2 - J_s1s2_only).norm(), 0, 1e-12);
+    EXPECT_NEAR((J_B_Z - J_B_Z_only).norm(), 0, 1e-12);
+}
+
 }  // namespace wave
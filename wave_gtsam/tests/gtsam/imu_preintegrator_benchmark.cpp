@@ -0,0 +1,132 @@
+/** Building PreintegratedImuFactors from IMU samples in a MeasurementContainer.
+ *
+ * Samples arrive at 100Hz, and a factor is built at each keyframe. The first
+ * benchmark argument is the number of samples per keyframe. When the second
+ * argument is 1, the preintegration from the last keyframe is also requested
+ * at every sample, as an estimator predicting the current state would.
+ *
+ * BM_ManualFactors copies the samples out of a time window and integrates
+ * them one at a time into a new PreintegratedCombinedMeasurements, as
+ * OnlineEstimator used to. BM_PreintegratorFactors uses ImuPreintegrator,
+ * which reads the samples in place. Both integrate every request from its
+ * keyframe.
+ *
+ * items/s is factors built per second.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wave/gtsam/imu_preintegrator.hpp"
+#include "wave/gtsam/preint_imu_factor.hpp"
+
+namespace wave {
+
+const std::chrono::milliseconds IMU_PERIOD{10};
+const int NUM_KEYFRAMES = 100;
+
+boost::shared_ptr<ImuPreintegrator::Params> imuParams() {
+    auto params = ImuPreintegrator::Params::MakeSharedU(9.81);
+    params->gyroscopeCovariance = 1e-6 * gtsam::I_3x3;
+    params->accelerometerCovariance = 1e-4 * gtsam::I_3x3;
+    params->integrationCovariance = 1e-8 * gtsam::I_3x3;
+    return params;
+}
+
+ImuMeasurementContainer makeSamples(int num_samples) {
+    ImuMeasurementContainer imu;
+    for (int k = 0; k <= num_samples; ++k) {
+        Vec6 sample;
+        sample << 0.01, 0, 0.1, 0.2, 0.5, 9.81;
+        imu.emplace(TimePoint{} + k * IMU_PERIOD, 0, sample);
+    }
+    return imu;
+}
+
+gtsam::PreintegratedCombinedMeasurements manualPreintegrate(
+  const ImuMeasurementContainer &imu,
+  const boost::shared_ptr<ImuPreintegrator::Params> &params,
+  const TimePoint &t_i,
+  const TimePoint &t_j) {
+    gtsam::PreintegratedCombinedMeasurements pim{params};
+    const auto range = imu.getTimeWindow(t_i, t_j);
+    const std::vector<ImuMeasurement> samples(range.first, range.second);
+    for (std::size_t n = 1; n < samples.size(); ++n) {
+        const double dt = std::chrono::duration<double>(
+                            samples[n].time_point - samples[n - 1].time_point)
+                            .count();
+        pim.integrateMeasurement(samples[n - 1].value.tail<3>(),
+                                 samples[n - 1].value.head<3>(),
+                                 dt);
+    }
+    return pim;
+}
+
+void BM_ManualFactors(benchmark::State &state) {
+    const int per_keyframe = state.range(0);
+    const bool predict = state.range(1);
+    const auto params = imuParams();
+    const auto imu = makeSamples(NUM_KEYFRAMES * per_keyframe);
+
+    for (auto _ : state) {
+        for (int i = 0; i < NUM_KEYFRAMES; ++i) {
+            const auto t_i = TimePoint{} + i * per_keyframe * IMU_PERIOD;
+            if (predict) {
+                for (int k = 1; k < per_keyframe; ++k) {
+                    const auto t = t_i + k * IMU_PERIOD;
+                    auto pim = manualPreintegrate(imu, params, t_i, t);
+                    benchmark::DoNotOptimize(pim.deltaTij());
+                }
+            }
+            const auto t_j = t_i + per_keyframe * IMU_PERIOD;
+            const auto pim = manualPreintegrate(imu, params, t_i, t_j);
+            PreintegratedImuFactor<PoseVelBias> factor(
+              2 * i, 2 * i + 2, 2 * i + 1, 2 * i + 3, pim);
+            benchmark::DoNotOptimize(factor);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_KEYFRAMES);
+}
+
+void BM_PreintegratorFactors(benchmark::State &state) {
+    const int per_keyframe = state.range(0);
+    const bool predict = state.range(1);
+    const auto imu = makeSamples(NUM_KEYFRAMES * per_keyframe);
+    const gtsam::imuBias::ConstantBias bias;
+
+    for (auto _ : state) {
+        ImuPreintegrator preintegrator{imuParams()};
+        for (int i = 0; i < NUM_KEYFRAMES; ++i) {
+            const auto t_i = TimePoint{} + i * per_keyframe * IMU_PERIOD;
+            if (predict) {
+                for (int k = 1; k < per_keyframe; ++k) {
+                    auto pim = preintegrator.integrate(
+                      imu, t_i, t_i + k * IMU_PERIOD, bias);
+                    benchmark::DoNotOptimize(pim.deltaTij());
+                }
+            }
+            const auto t_j = t_i + per_keyframe * IMU_PERIOD;
+            const auto pim = preintegrator.integrate(imu, t_i, t_j, bias);
+            PreintegratedImuFactor<PoseVelBias> factor(
+              2 * i, 2 * i + 2, 2 * i + 1, 2 * i + 3, pim);
+            benchmark::DoNotOptimize(factor);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_KEYFRAMES);
+}
+
+BENCHMARK(BM_ManualFactors)
+  ->Args({10, 0})
+  ->Args({100, 0})
+  ->Args({10, 1})
+  ->Args({100, 1});
+BENCHMARK(BM_PreintegratorFactors)
+  ->Args({10, 0})
+  ->Args({100, 0})
+  ->Args({10, 1})
+  ->Args({100, 1});
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
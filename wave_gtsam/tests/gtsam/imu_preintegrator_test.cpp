@@ -0,0 +1,123 @@
+#include <cmath>
+#include <vector>
+
+#include "wave/gtsam/imu_preintegrator.hpp"
+#include "wave/wave_test.hpp"
+
+namespace wave {
+
+class ImuPreintegratorTest : public ::testing::Test {
+ protected:
+    const std::chrono::milliseconds period{10};
+    const int num_samples = 100;
+    const gtsam::imuBias::ConstantBias bias{gtsam::Vector3{0.1, 0, 0},
+                                            gtsam::Vector3{0, 0.01, 0}};
+
+    boost::shared_ptr<ImuPreintegrator::Params> params =
+      ImuPreintegrator::Params::MakeSharedU(9.81);
+    ImuMeasurementContainer imu;
+
+    ImuPreintegratorTest() {
+        this->params->gyroscopeCovariance = 1e-6 * gtsam::I_3x3;
+        this->params->accelerometerCovariance = 1e-4 * gtsam::I_3x3;
+        this->params->integrationCovariance = 1e-8 * gtsam::I_3x3;
+
+        // Samples varying linearly in time, and samples from another sensor
+        for (int k = 0; k <= this->num_samples; ++k) {
+            Vec6 sample;
+            sample << 0.1, 0, 0.01 * k, 0.2, -0.01 * k, 9.81;
+            this->imu.emplace(this->sampleTime(k), 0, sample);
+            this->imu.emplace(this->sampleTime(k), 1, Vec6::Zero());
+        }
+    }
+
+    TimePoint sampleTime(double k) const {
+        return TimePoint{} +
+               std::chrono::duration_cast<TimePoint::duration>(k *
+                                                               this->period);
+    }
+
+    // Integrates each interval with the mean of its ends, by hand
+    gtsam::PreintegratedCombinedMeasurements expected(double k_i,
+                                                      double k_j) const {
+        gtsam::PreintegratedCombinedMeasurements pim{this->params,
+                                                     this->bias};
+        std::vector<double> times{k_i};
+        for (int k = std::ceil(k_i); k <= k_j; ++k) {
+            if (k > k_i) {
+                times.push_back(k);
+            }
+        }
+        if (times.back() < k_j) {
+            times.push_back(k_j);
+        }
+        for (std::size_t n = 1; n < times.size(); ++n) {
+            const Vec6 mean =
+              0.5 * (this->imu.get(this->sampleTime(times[n - 1]), 0) +
+                     this->imu.get(this->sampleTime(times[n]), 0));
+            const double dt =
+              std::chrono::duration<double>(this->sampleTime(times[n]) -
+                                            this->sampleTime(times[n - 1]))
+                .count();
+            pim.integrateMeasurement(mean.tail<3>(), mean.head<3>(), dt);
+        }
+        return pim;
+    }
+};
+
+TEST_F(ImuPreintegratorTest, matches_manual) {
+    ImuPreintegrator preintegrator{this->params};
+    const auto pim = preintegrator.integrate(
+      this->imu, this->sampleTime(10), this->sampleTime(50), this->bias);
+    EXPECT_TRUE(pim.equals(this->expected(10, 50)));
+    EXPECT_DOUBLE_EQ(0.4, pim.deltaTij());
+}
+
+TEST_F(ImuPreintegratorTest, interpolates_boundaries) {
+    ImuPreintegrator preintegrator{this->params};
+    const auto pim = preintegrator.integrate(
+      this->imu, this->sampleTime(10.5), this->sampleTime(49.25), this->bias);
+    EXPECT_TRUE(pim.equals(this->expected(10.5, 49.25)));
+    EXPECT_NEAR(0.3875, pim.deltaTij(), 1e-9);
+}
+
+TEST_F(ImuPreintegratorTest, repeated_calls) {
+    const ImuPreintegrator preintegrator{this->params};
+    const auto t_i = this->sampleTime(10.5);
+    for (double k_j = 11; k_j <= 90; k_j += 2.5) {
+        const auto pim = preintegrator.integrate(
+          this->imu, t_i, this->sampleTime(k_j), this->bias);
+        EXPECT_TRUE(pim.equals(this->expected(10.5, k_j))) << k_j;
+    }
+
+    // Each call uses its own start and bias
+    const auto pim = preintegrator.integrate(
+      this->imu, this->sampleTime(20), this->sampleTime(30), this->bias);
+    EXPECT_TRUE(pim.equals(this->expected(20, 30)));
+    const auto other = preintegrator.integrate(
+      this->imu,
+      this->sampleTime(20),
+      this->sampleTime(40),
+      gtsam::imuBias::ConstantBias{});
+    EXPECT_DOUBLE_EQ(0, other.biasHat().vector().norm());
+}
+
+TEST_F(ImuPreintegratorTest, covers) {
+    ImuPreintegrator preintegrator{this->params};
+    EXPECT_TRUE(preintegrator.covers(
+      this->imu, this->sampleTime(0), this->sampleTime(this->num_samples)));
+    EXPECT_FALSE(preintegrator.covers(
+      this->imu, this->sampleTime(-1), this->sampleTime(10)));
+    const auto after_end = this->sampleTime(this->num_samples + 1);
+    EXPECT_FALSE(
+      preintegrator.covers(this->imu, this->sampleTime(10), after_end));
+    EXPECT_THROW(preintegrator.integrate(
+                   this->imu, this->sampleTime(10), after_end, this->bias),
+                 std::out_of_range);
+
+    ImuPreintegrator other_sensor{this->params, 2};
+    EXPECT_FALSE(other_sensor.covers(
+      this->imu, this->sampleTime(0), this->sampleTime(10)));
+}
+
+}  // namespace wave
@@ -0,0 +1,120 @@
+/** Linearizing graphs of the factors in wave_gtsam.
+ *
+ * Each graph is built like the corresponding unit test graph, repeated to the
+ * number of factors given by the benchmark argument. items/s is factors
+ * linearized per second.
+ *
+ * BM_LinearizeMotionGraph linearizes a chain of MotionFactors on PoseVelBias
+ * states, as in pose_vel_state_test. BM_LinearizeImuGraph linearizes a chain
+ * of PreintegratedImuFactors with the measurements of imu_preint_test.
+ * BM_LinearizeHandEyeGraph linearizes HandEyeFactors sharing one calibration
+ * and bias, as in hand_eye_test.
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include "wave/gtsam/hand_eye.hpp"
+#include "wave/gtsam/motion_factor.hpp"
+#include "wave/gtsam/preint_imu_factor.hpp"
+
+namespace wave {
+
+void BM_LinearizeMotionGraph(benchmark::State &state) {
+    const double delta_t = 0.1;
+    const auto num_factors = state.range(0);
+    auto model = gtsam::noiseModel::Isotropic::Sigma(15, 0.1);
+
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values values;
+    PoseVelBias s;
+    s.vel << 0, 0, 0.1, 5, 0, 0;
+    values.insert(0, s);
+    for (int i = 1; i <= num_factors; ++i) {
+        s.pose = s.pose.retract(delta_t * s.vel);
+        values.insert(i, s);
+        graph.add(MotionFactor<PoseVelBias, PoseVelBias>(
+          i - 1, i, delta_t, model));
+    }
+
+    for (auto _ : state) {
+        auto linear = graph.linearize(values);
+        benchmark::DoNotOptimize(linear.get());
+    }
+    state.SetItemsProcessed(state.iterations() * num_factors);
+}
+
+void BM_LinearizeImuGraph(benchmark::State &state) {
+    const auto num_factors = state.range(0);
+    const double gravity = 10;
+
+    auto params =
+      gtsam::PreintegratedCombinedMeasurements::Params::MakeSharedD(gravity);
+    params->gyroscopeCovariance = 1e-8 * gtsam::I_3x3;
+    params->accelerometerCovariance = 1e-6 * gtsam::I_3x3;
+    params->integrationCovariance = 1e-4 * gtsam::I_3x3;
+    gtsam::imuBias::ConstantBias bias{gtsam::Vector3{0.2, 0, 0},
+                                      gtsam::Vector3{0, 0, 0.3}};
+    gtsam::PreintegratedCombinedMeasurements pim{params, bias};
+    const gtsam::Vector3 omega{0, 0, M_PI / 10.0 + 0.3};
+    const gtsam::Vector3 acc{0.2, 0, -gravity};
+    for (int k = 0; k < 10; ++k) {
+        pim.integrateMeasurement(acc, omega, 0.1);
+    }
+
+    // States use even keys and biases odd keys
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values values;
+    PoseVelBias s;
+    s.vel << 0, 0, 0, 0.5, 0, 0;
+    values.insert(0, s);
+    values.insert(1, bias);
+    for (int i = 1; i <= num_factors; ++i) {
+        s.pose = s.pose.retract(0.1 * s.vel);
+        values.insert(2 * i, s);
+        values.insert(2 * i + 1, bias);
+        graph.add(PreintegratedImuFactor<PoseVelBias>(
+          2 * (i - 1), 2 * i, 2 * i - 1, 2 * i + 1, pim));
+    }
+
+    for (auto _ : state) {
+        auto linear = graph.linearize(values);
+        benchmark::DoNotOptimize(linear.get());
+    }
+    state.SetItemsProcessed(state.iterations() * num_factors);
+}
+
+void BM_LinearizeHandEyeGraph(benchmark::State &state) {
+    const auto num_factors = state.range(0);
+    auto model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+    const gtsam::Pose3 T_s1_s2{gtsam::Rot3::Ypr(0, 0, 0.1),
+                               gtsam::Point3{0.2, 0.3, -0.1}};
+
+    // The calibration and bias use the last two keys
+    const gtsam::Key calib_key = num_factors, bias_key = num_factors + 1;
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values values;
+    values.insert(calib_key, T_s1_s2);
+    values.insert(bias_key, gtsam::Point3{0, 0, 0});
+    for (int i = 0; i < num_factors; ++i) {
+        const gtsam::Pose3 T_local_s1{gtsam::Rot3::Ypr(0.01 * i, 0, 0),
+                                      gtsam::Point3{0.5 * i, 0, 0}};
+        values.insert(i, T_local_s1 * T_s1_s2);
+        graph.add(HandEyeFactor(i, calib_key, bias_key, T_local_s1, model));
+    }
+
+    for (auto _ : state) {
+        auto linear = graph.linearize(values);
+        benchmark::DoNotOptimize(linear.get());
+    }
+    state.SetItemsProcessed(state.iterations() * num_factors);
+}
+
+BENCHMARK(BM_LinearizeMotionGraph)->Arg(100)->Arg(10000);
+BENCHMARK(BM_LinearizeImuGraph)->Arg(100)->Arg(10000);
+BENCHMARK(BM_LinearizeHandEyeGraph)->Arg(100)->Arg(10000);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
@@ -0,0 +1,84 @@
+/** Replaying the KITTI-derived VO test data through OnlineEstimator.
+ *
+ * Each state of the dataset is one update, with the ground truth body pose as
+ * a GPS measurement and the feature observations as landmark measurements.
+ * The data has no IMU measurements. The benchmark argument is the iSAM2
+ * relinearize_skip.
+ *
+ * items/s is updates per second over the whole replay, and the counters give
+ * the mean and maximum time of a single update, in milliseconds.
+ */
+
+#include <algorithm>
+
+#include <benchmark/benchmark.h>
+
+#include "wave/gtsam/online_estimator.hpp"
+#include "wave/vision/dataset/VoDataset.hpp"
+#include "gtsam_helpers.hpp"
+
+namespace wave {
+
+const auto DATASET_DIR = "tests/data/vo_data_drive_0036";
+
+TimePoint timeFromSeconds(double t) {
+    return TimePoint{} + std::chrono::duration_cast<TimePoint::duration>(
+                           std::chrono::duration<double>(t));
+}
+
+gtsam::Pose3 bodyPose(const VoInstant &state) {
+    return gtsamPoseFromEigen(state.robot_q_GB, state.robot_G_p_GB);
+}
+
+void BM_ReplayKitti(benchmark::State &state) {
+    const auto dataset = VoDataset::loadFromDirectory(DATASET_DIR);
+    const auto &states = dataset.states;
+
+    GpsMeasurementContainer gps;
+    CameraMeasurementContainer landmarks;
+    const ImuMeasurementContainer imu;
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        const auto t = timeFromSeconds(states[i].time);
+        gps.emplace(t, 0, bodyPose(states[i]));
+        for (const auto &obs : states[i].features_observed) {
+            landmarks.emplace(t, 0, obs.first, i, obs.second);
+        }
+    }
+    const auto T_B_C =
+      bodyPose(states.front()).between(gtsamPoseFromState(states.front()));
+
+    OnlineEstimatorParams params;
+    params.relinearize_skip = state.range(0);
+
+    double total_ms = 0, max_ms = 0;
+    for (auto _ : state) {
+        OnlineEstimator estimator{params};
+        estimator.setCamera(dataset.camera_K, T_B_C);
+
+        PoseVelBias initial;
+        initial.pose = bodyPose(states.front());
+        estimator.initialize(timeFromSeconds(states.front().time), initial);
+
+        for (std::size_t i = 1; i < states.size(); ++i) {
+            estimator.update(
+              timeFromSeconds(states[i].time), imu, gps, landmarks);
+            const double ms = std::chrono::duration<double, std::milli>(
+                                estimator.lastUpdateDuration())
+                                .count();
+            total_ms += ms;
+            max_ms = std::max(max_ms, ms);
+        }
+        benchmark::DoNotOptimize(estimator.latestState());
+    }
+
+    const auto num_updates = state.iterations() * (states.size() - 1);
+    state.SetItemsProcessed(num_updates);
+    state.counters["mean_update_ms"] = total_ms / num_updates;
+    state.counters["max_update_ms"] = max_ms;
+}
+
+BENCHMARK(BM_ReplayKitti)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
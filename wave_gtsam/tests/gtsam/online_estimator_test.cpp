@@ -0,0 +1,178 @@
+#include <gtsam/geometry/PinholeCamera.h>
+#include <gtsam/inference/Symbol.h>
+
+#include "wave/gtsam/online_estimator.hpp"
+#include "wave/wave_test.hpp"
+
+namespace wave {
+
+// Body moving along x at constant velocity, without rotation, so the local
+// and body frame velocities are equal
+class OnlineEstimatorTest : public ::testing::Test {
+ protected:
+    const double speed = 1.0;
+    const double gravity = 9.81;
+    const int imu_per_state = 10;
+    const std::chrono::milliseconds imu_period{10};
+
+    ImuMeasurementContainer imu;
+    GpsMeasurementContainer gps;
+    CameraMeasurementContainer landmarks;
+
+    TimePoint stateTime(int k) const {
+        return TimePoint{} + k * this->imu_per_state * this->imu_period;
+    }
+
+    PoseVelBias trueState(int k) const {
+        const double t =
+          std::chrono::duration<double>(this->stateTime(k) - TimePoint{})
+            .count();
+        PoseVelBias state;
+        state.pose =
+          gtsam::Pose3{gtsam::Rot3{}, gtsam::Point3{this->speed * t, 0, 0}};
+        state.vel << 0, 0, 0, speed, 0, 0;
+        return state;
+    }
+
+    void addImu(int num_states) {
+        // Accelerometers measure the reaction to gravity
+        Vec6 sample;
+        sample << 0, 0, 0, 0, 0, this->gravity;
+        for (int j = 0; j <= num_states * this->imu_per_state; ++j) {
+            this->imu.emplace(TimePoint{} + j * this->imu_period, 0, sample);
+        }
+    }
+
+    void addGps(int num_states) {
+        for (int k = 0; k <= num_states; ++k) {
+            this->gps.emplace(this->stateTime(k), 0, this->trueState(k).pose);
+        }
+    }
+};
+
+TEST_F(OnlineEstimatorTest, imu_and_gps) {
+    const int num_states = 20;
+    this->addImu(num_states);
+    this->addGps(num_states);
+
+    OnlineEstimatorParams params;
+    params.gravity = this->gravity;
+    OnlineEstimator estimator{params};
+    estimator.initialize(this->stateTime(0), this->trueState(0));
+
+    for (int k = 1; k <= num_states; ++k) {
+        estimator.update(
+          this->stateTime(k), this->imu, this->gps, this->landmarks);
+
+        const auto expected = this->trueState(k);
+        const auto &actual = estimator.latestState();
+        EXPECT_PRED3(VectorsNearPrec,
+                     Vec3{actual.pose.translation()},
+                     Vec3{expected.pose.translation()},
+                     0.05);
+        EXPECT_PRED3(VectorsNearPrec,
+                     Vec3{actual.vel.tail<3>()},
+                     Vec3{expected.vel.tail<3>()},
+                     0.05);
+    }
+    EXPECT_EQ(num_states + 1u, estimator.numStates());
+}
+
+TEST_F(OnlineEstimatorTest, fixed_lag) {
+    const int num_states = 50;
+    this->addImu(num_states);
+    this->addGps(num_states);
+
+    // States are 0.1s apart, so the window holds six
+    OnlineEstimatorParams params;
+    params.gravity = this->gravity;
+    params.lag = 0.5;
+    const std::size_t window = 6;
+
+    for (const double anchor_sigma : {0.0, 1.0}) {
+        params.anchor_pose_sigma = anchor_sigma;
+        params.anchor_bias_sigma = anchor_sigma;
+        OnlineEstimator estimator{params};
+        estimator.initialize(this->stateTime(0), this->trueState(0));
+
+        for (int k = 1; k <= num_states; ++k) {
+            estimator.update(
+              this->stateTime(k), this->imu, this->gps, this->landmarks);
+
+            const auto expected = this->trueState(k);
+            const auto &actual = estimator.latestState();
+            EXPECT_PRED3(VectorsNearPrec,
+                         Vec3{actual.pose.translation()},
+                         Vec3{expected.pose.translation()},
+                         0.05);
+            EXPECT_PRED3(VectorsNearPrec,
+                         Vec3{actual.vel.tail<3>()},
+                         Vec3{expected.vel.tail<3>()},
+                         0.05);
+
+            // Each state has a PoseVelBias and an IMU bias
+            EXPECT_LE(estimator.stateTimes().size(), window);
+            EXPECT_EQ(2 * estimator.stateTimes().size(),
+                      estimator.estimate().size());
+        }
+        EXPECT_EQ(num_states + 1u, estimator.numStates());
+        EXPECT_EQ(num_states + 1u - window, estimator.firstState());
+    }
+}
+
+TEST_F(OnlineEstimatorTest, landmarks) {
+    const int num_states = 10;
+    this->addGps(num_states);
+
+    // Camera looking along the body x axis
+    const auto q_BC =
+      gtsam::Rot3::Ypr(-M_PI_2, 0, 0) * gtsam::Rot3::Ypr(0, 0, -M_PI_2);
+    const gtsam::Pose3 T_B_C{q_BC, gtsam::Point3{}};
+    Mat3 K;
+    K << 400, 0, 320, 0, 400, 240, 0, 0, 1;
+    const gtsam::Cal3_S2 cal{400, 400, 0, 320, 240};
+
+    std::vector<gtsam::Point3> points;
+    for (int j = 0; j < 20; ++j) {
+        points.emplace_back(20.0 + j, (j % 5) - 2.0, (j % 3) - 1.0);
+    }
+    for (int k = 0; k <= num_states; ++k) {
+        const gtsam::PinholeCamera<gtsam::Cal3_S2> camera{
+          this->trueState(k).pose.compose(T_B_C), cal};
+        for (std::size_t j = 0; j < points.size(); ++j) {
+            const auto m = camera.project(points[j]);
+            this->landmarks.emplace(
+              this->stateTime(k), 0, j, k, Vec2{m.x(), m.y()});
+        }
+    }
+
+    OnlineEstimatorParams params;
+    params.landmark_init_depth = 20.0;
+    OnlineEstimator estimator{params};
+    estimator.setCamera(K, T_B_C);
+    estimator.initialize(this->stateTime(0), this->trueState(0));
+    for (int k = 1; k <= num_states; ++k) {
+        estimator.update(
+          this->stateTime(k), this->imu, this->gps, this->landmarks);
+    }
+
+    const auto estimate = estimator.estimate();
+    for (std::size_t j = 0; j < points.size(); ++j) {
+        const Vec3 actual{estimate.at<gtsam::Point3>(gtsam::Symbol{'l', j})};
+        EXPECT_PRED3(VectorsNearPrec, actual, Vec3{points[j]}, 0.5) << j;
+    }
+}
+
+TEST_F(OnlineEstimatorTest, update_order) {
+    OnlineEstimator estimator;
+    EXPECT_THROW(estimator.update(
+                   this->stateTime(1), this->imu, this->gps, this->landmarks),
+                 std::logic_error);
+
+    estimator.initialize(this->stateTime(1), this->trueState(1));
+    EXPECT_THROW(estimator.update(
+                   this->stateTime(1), this->imu, this->gps, this->landmarks),
+                 std::logic_error);
+}
+
+}  // namespace wave
@@ -0,0 +1,136 @@
+/** Scaling of linearizeParallel() and errorParallel() with the thread count.
+ *
+ * The graph resembles a reprocessed drive: a chain of PoseVelBias states
+ * linked by MotionFactors, a GPSFactorWithBiasGeneral on each state, and each
+ * state observing 20 landmarks through StateProjectionFactors. The first
+ * benchmark argument is the number of states, and the second the number of
+ * threads, from 1 to the number of hardware threads.
+ *
+ * BM_LinearizeSerial and BM_ErrorSerial are NonlinearFactorGraph's own
+ * linearize() and error(), for reference. items/s is factors per second of
+ * wall time.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+#include <gtsam/inference/Symbol.h>
+
+#include "wave/gtsam/gps_factor_with_bias_general.hpp"
+#include "wave/gtsam/motion_factor.hpp"
+#include "wave/gtsam/parallel_linearize.hpp"
+#include "wave/gtsam/state_projection_factor.hpp"
+
+namespace wave {
+
+const int LANDMARKS_PER_STATE = 20;
+
+/** Builds the graph and values for a drive of `num_states` states */
+void makeDriveGraph(int num_states,
+                    gtsam::NonlinearFactorGraph &graph,
+                    gtsam::Values &values) {
+    const double delta_t = 0.1;
+    const auto motion_model = gtsam::noiseModel::Isotropic::Sigma(15, 0.1);
+    const auto gps_model = gtsam::noiseModel::Isotropic::Sigma(6, 0.5);
+    const auto pixel_model = gtsam::noiseModel::Isotropic::Sigma(2, 1.0);
+    const auto K = boost::make_shared<gtsam::Cal3_S2>(400, 400, 0, 320, 240);
+
+    // Camera looking along the body x axis
+    const gtsam::Pose3 T_B_C{
+      gtsam::Rot3::Ypr(-M_PI_2, 0, 0) * gtsam::Rot3::Ypr(0, 0, -M_PI_2),
+      gtsam::Point3{}};
+
+    PoseVelBias s;
+    s.vel << 0, 0, 0.01, 5, 0, 0;
+    for (int i = 0; i < num_states; ++i) {
+        const gtsam::Symbol x{'x', static_cast<std::size_t>(i)};
+        values.insert(x, s);
+        graph.add(GPSFactorWithBiasGeneral<PoseVelBias>(x, s.pose, gps_model));
+        if (i > 0) {
+            graph.add(MotionFactor<PoseVelBias, PoseVelBias>(
+              gtsam::Symbol{'x', static_cast<std::size_t>(i - 1)},
+              x,
+              delta_t,
+              motion_model));
+        }
+
+        // Each landmark is observed from the state it is added at
+        for (int j = 0; j < LANDMARKS_PER_STATE; ++j) {
+            const gtsam::Symbol l{
+              'l', static_cast<std::size_t>(i * LANDMARKS_PER_STATE + j)};
+            values.insert(l,
+                          s.pose.transformFrom(gtsam::Point3{
+                            20.0 + j, (j % 5) - 2.0, (j % 3) - 1.0}));
+            graph.add(StateProjectionFactor<PoseVelBias>(
+              x, l, gtsam::Point2{320, 240}, K, T_B_C, pixel_model));
+        }
+        s.pose = s.pose.retract(delta_t * s.vel);
+    }
+}
+
+/** Thread counts from 1 to the number of hardware threads */
+void threadArgs(benchmark::internal::Benchmark *b) {
+    const int max_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    for (int n = 1; n < max_threads; n *= 2) {
+        b->Args({10000, n});
+    }
+    b->Args({10000, max_threads});
+}
+
+void BM_LinearizeSerial(benchmark::State &state) {
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values values;
+    makeDriveGraph(state.range(0), graph, values);
+
+    for (auto _ : state) {
+        auto linear = graph.linearize(values);
+        benchmark::DoNotOptimize(linear.get());
+    }
+    state.SetItemsProcessed(state.iterations() * graph.size());
+}
+
+void BM_LinearizeParallel(benchmark::State &state) {
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values values;
+    makeDriveGraph(state.range(0), graph, values);
+
+    for (auto _ : state) {
+        auto linear = linearizeParallel(graph, values, state.range(1));
+        benchmark::DoNotOptimize(linear.get());
+    }
+    state.SetItemsProcessed(state.iterations() * graph.size());
+}
+
+void BM_ErrorSerial(benchmark::State &state) {
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values values;
+    makeDriveGraph(state.range(0), graph, values);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(graph.error(values));
+    }
+    state.SetItemsProcessed(state.iterations() * graph.size());
+}
+
+void BM_ErrorParallel(benchmark::State &state) {
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values values;
+    makeDriveGraph(state.range(0), graph, values);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+          errorParallel(graph, values, state.range(1)));
+    }
+    state.SetItemsProcessed(state.iterations() * graph.size());
+}
+
+BENCHMARK(BM_LinearizeSerial)->Arg(10000)->UseRealTime();
+BENCHMARK(BM_LinearizeParallel)->Apply(threadArgs)->UseRealTime();
+BENCHMARK(BM_ErrorSerial)->Arg(10000)->UseRealTime();
+BENCHMARK(BM_ErrorParallel)->Apply(threadArgs)->UseRealTime();
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+#include <gtsam/slam/PriorFactor.h>
+
+#include "wave/gtsam/gps_factor_with_bias_general.hpp"
+#include "wave/gtsam/motion_factor.hpp"
+#include "wave/gtsam/parallel_linearize.hpp"
+#include "wave/wave_test.hpp"
+
+namespace wave {
+
+// Chain of PoseVelBias states with motion and GPS factors, away from the
+// solution so every factor has error
+class ParallelLinearizeTest : public ::testing::Test {
+ protected:
+    const int num_states = 1000;
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values values;
+
+    ParallelLinearizeTest() {
+        const double delta_t = 0.1;
+        const auto motion_model = gtsam::noiseModel::Isotropic::Sigma(15, 0.1);
+        const auto gps_model = gtsam::noiseModel::Isotropic::Sigma(6, 0.5);
+
+        PoseVelBias s;
+        s.vel << 0, 0, 0.1, 5, 0, 0;
+        this->graph.add(gtsam::PriorFactor<PoseVelBias>(
+          0, s, gtsam::noiseModel::Isotropic::Sigma(15, 0.1)));
+        for (int i = 0; i < this->num_states; ++i) {
+            const auto measured = s.pose.retract(0.01 * gtsam::Vector6::Ones());
+            this->graph.add(
+              GPSFactorWithBiasGeneral<PoseVelBias>(i, measured, gps_model));
+            if (i > 0) {
+                this->graph.add(MotionFactor<PoseVelBias, PoseVelBias>(
+                  i - 1, i, delta_t, motion_model));
+            }
+
+            PoseVelBias perturbed = s;
+            perturbed.vel(3) += 0.01 * (i % 7);
+            this->values.insert(i, perturbed);
+            s.pose = s.pose.retract(delta_t * s.vel);
+        }
+
+        // Null factors are kept in place
+        this->graph.push_back(gtsam::NonlinearFactor::shared_ptr{});
+    }
+};
+
+TEST_F(ParallelLinearizeTest, linearize_identical) {
+    const auto expected = this->graph.linearize(this->values);
+    for (const int n_threads : {1, 2, 3, 8, 0}) {
+        const auto actual =
+          linearizeParallel(this->graph, this->values, n_threads);
+        ASSERT_EQ(expected->size(), actual->size());
+        for (std::size_t i = 0; i < expected->size(); ++i) {
+            const auto &e = expected->at(i);
+            const auto &a = actual->at(i);
+            ASSERT_EQ(static_cast<bool>(e), static_cast<bool>(a)) << i;
+            if (e) {
+                EXPECT_TRUE(e->keys() == a->keys()) << i;
+                EXPECT_TRUE(e->augmentedJacobian() == a->augmentedJacobian())
+                  << i;
+            }
+        }
+    }
+}
+
+TEST_F(ParallelLinearizeTest, error_identical) {
+    const double expected = this->graph.error(this->values);
+    EXPECT_GT(expected, 0);
+    for (const int n_threads : {1, 2, 3, 8, 0}) {
+        EXPECT_EQ(expected,
+                  errorParallel(this->graph, this->values, n_threads));
+
+        const auto errors =
+          factorErrorsParallel(this->graph, this->values, n_threads);
+        ASSERT_EQ(this->graph.size(), errors.size());
+        EXPECT_EQ(this->graph.at(1)->error(this->values), errors[1]);
+        EXPECT_EQ(0.0, errors.back());
+    }
+}
+
+TEST_F(ParallelLinearizeTest, missing_key_throws) {
+    // A factor in the middle of the graph, on a worker thread, cannot be
+    // evaluated
+    this->values.erase(this->num_states / 2);
+    EXPECT_THROW(this->graph.linearize(this->values),
+                 gtsam::ValuesKeyDoesNotExist);
+    for (const int n_threads : {1, 2, 8}) {
+        EXPECT_THROW(linearizeParallel(this->graph, this->values, n_threads),
+                     gtsam::ValuesKeyDoesNotExist);
+        EXPECT_THROW(errorParallel(this->graph, this->values, n_threads),
+                     gtsam::ValuesKeyDoesNotExist);
+    }
+}
+
+}  // namespace wave
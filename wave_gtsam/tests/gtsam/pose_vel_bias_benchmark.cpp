@@ -0,0 +1,155 @@
+/** Group operations and factor linearization on PoseVelBias states.
+ *
+ * items/s is operations (or linearizations) per second, and the allocs counter
+ * is the number of heap allocations per operation, counted by replacing the
+ * global operator new.
+ *
+ * BM_ComposeDynamic composes two states the way the hand-written traits used
+ * to, computing each member Jacobian into an Eigen::MatrixXd and copying it
+ * into the state Jacobian, for comparison with BM_Compose, which uses
+ * gtsam::traits<PoseVelBias>. BM_LinearizeBetweenFactor linearizes a
+ * BetweenFactor on two states; its allocations include those of gtsam itself.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <benchmark/benchmark.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include "wave/gtsam/pose_vel_bias.hpp"
+
+namespace {
+std::atomic<std::size_t> num_allocations{0};
+}
+
+void *operator new(std::size_t size) {
+    ++num_allocations;
+    if (void *p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+namespace wave {
+
+using Traits = gtsam::traits<PoseVelBias>;
+
+PoseVelBias randomState() {
+    PoseVelBias state;
+    state.pose = gtsam::Pose3::Expmap(gtsam::Vector6::Random());
+    state.vel.setRandom();
+    state.bias.setRandom();
+    return state;
+}
+
+/** Compose as the traits were written before, with dynamic-size Jacobians */
+PoseVelBias composeDynamic(const PoseVelBias &m1,
+                           const PoseVelBias &m2,
+                           Traits::ChartJacobian H1,
+                           Traits::ChartJacobian H2) {
+    PoseVelBias retval;
+    Eigen::MatrixXd J1, J2, J3, J4, J5, J6;
+    if (H1) {
+        H1->setZero();
+        J1.resize(6, 6);
+        J3.resize(6, 6);
+        J5.resize(3, 3);
+    }
+    if (H2) {
+        H2->setZero();
+        J2.resize(6, 6);
+        J4.resize(6, 6);
+        J6.resize(3, 3);
+    }
+    retval.pose =
+      gtsam::traits<gtsam::Pose3>::Compose(m1.pose, m2.pose, J1, J2);
+    retval.vel = gtsam::traits<VelType>::Compose(m1.vel, m2.vel, J3, J4);
+    retval.bias = gtsam::traits<BiasType>::Compose(m1.bias, m2.bias, J5, J6);
+    if (H1) {
+        H1->block<6, 6>(0, 0).noalias() = J1;
+        H1->block<6, 6>(6, 6).noalias() = J3;
+        H1->block<3, 3>(12, 12).noalias() = J5;
+    }
+    if (H2) {
+        H2->block<6, 6>(0, 0).noalias() = J2;
+        H2->block<6, 6>(6, 6).noalias() = J4;
+        H2->block<3, 3>(12, 12).noalias() = J6;
+    }
+    return retval;
+}
+
+void countAllocations(benchmark::State &state, std::size_t start) {
+    state.counters["allocs"] =
+      static_cast<double>(num_allocations - start) / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ComposeDynamic(benchmark::State &state) {
+    const auto m1 = randomState(), m2 = randomState();
+    Eigen::Matrix<double, 15, 15> H1, H2;
+
+    const std::size_t start = num_allocations;
+    for (auto _ : state) {
+        auto result = composeDynamic(m1, m2, H1, H2);
+        benchmark::DoNotOptimize(result);
+        benchmark::DoNotOptimize(H1.data());
+    }
+    countAllocations(state, start);
+}
+
+void BM_Compose(benchmark::State &state) {
+    const auto m1 = randomState(), m2 = randomState();
+    Eigen::Matrix<double, 15, 15> H1, H2;
+
+    const std::size_t start = num_allocations;
+    for (auto _ : state) {
+        auto result = Traits::Compose(m1, m2, H1, H2);
+        benchmark::DoNotOptimize(result);
+        benchmark::DoNotOptimize(H1.data());
+    }
+    countAllocations(state, start);
+}
+
+void BM_Between(benchmark::State &state) {
+    const auto m1 = randomState(), m2 = randomState();
+    Eigen::Matrix<double, 15, 15> H1, H2;
+
+    const std::size_t start = num_allocations;
+    for (auto _ : state) {
+        auto result = Traits::Between(m1, m2, H1, H2);
+        benchmark::DoNotOptimize(result);
+        benchmark::DoNotOptimize(H1.data());
+    }
+    countAllocations(state, start);
+}
+
+void BM_LinearizeBetweenFactor(benchmark::State &state) {
+    auto model = gtsam::noiseModel::Isotropic::Sigma(15, 0.1);
+    gtsam::BetweenFactor<PoseVelBias> factor(0, 1, randomState(), model);
+    gtsam::Values values;
+    values.insert(0, randomState());
+    values.insert(1, randomState());
+
+    const std::size_t start = num_allocations;
+    for (auto _ : state) {
+        auto linear = factor.linearize(values);
+        benchmark::DoNotOptimize(linear.get());
+    }
+    countAllocations(state, start);
+}
+
+BENCHMARK(BM_ComposeDynamic);
+BENCHMARK(BM_Compose);
+BENCHMARK(BM_Between);
+BENCHMARK(BM_LinearizeBetweenFactor);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
@@ -6,6 +6,7 @@
 #include <gtsam/slam/PriorFactor.h>
 #include <gtsam/slam/BetweenFactor.h>
 #include "wave/gtsam/motion_factor.hpp"
+#include "wave/gtsam/pose_vel_acc_bias.hpp"
 #include "wave/gtsam/pose_vel_bias.hpp"
 #include "wave/gtsam/pose_vel.hpp"
 #include "wave/wave_test.hpp"
@@ -249,4 +250,45 @@ TEST(pose_vel_bias_state, trivial_problem) {
     }
 }
 
+TEST(pose_vel_acc_bias_state, compose) {
+    PoseVelAccBias m1, m2;
+    m1.pose = gtsam::Pose3::Expmap(
+      (gtsam::Vector6() << 0.1, -0.2, 0.3, 1, 2, 3).finished());
+    m1.vel << -0.4, 0.3, 0.1, 5, 2, 1;
+    m1.acc << 0.01, 0.02, -0.03, 0.5, -0.2, 0.1;
+    m1.bias << 0.2, -0.1, 0.4;
+    m2.pose = gtsam::Pose3::Expmap(
+      (gtsam::Vector6() << -0.3, 0.1, 0.2, -2, 1, 0.5).finished());
+    m2.vel << 0.1, 0.2, 0.3, 1, 1, 1;
+    m2.acc << 0.1, 0.0, 0.2, -0.1, 0.3, 0.4;
+    m2.bias << -0.1, 0.1, 0.3;
+
+    gtsam::Matrix H1, H2, H1_pose, H2_pose;
+
+    // Expected values from separate objects
+    auto pose = gtsam::traits<gtsam::Pose3>::Compose(
+      m1.pose, m2.pose, H1_pose, H2_pose);
+
+    // Actual value
+    auto combined = gtsam::traits<PoseVelAccBias>::Compose(m1, m2, H1, H2);
+
+    EXPECT_TRUE(gtsam::traits<gtsam::Pose3>::Equals(combined.pose, pose));
+    EXPECT_PRED2(VectorsNear, combined.vel, m1.vel + m2.vel);
+    EXPECT_PRED2(VectorsNear, combined.acc, m1.acc + m2.acc);
+    EXPECT_PRED2(VectorsNear, combined.bias, m1.bias + m2.bias);
+    EXPECT_TRUE(gtsam::traits<PoseVelAccBias>::Equals(combined, m1 * m2));
+
+    EXPECT_PRED2(MatricesNear, (H1.block<6, 6>(0, 0)), H1_pose);
+    EXPECT_PRED2(MatricesNear, (H2.block<6, 6>(0, 0)), H2_pose);
+    EXPECT_TRUE((H1.block<15, 15>(6, 6)).isIdentity());
+    EXPECT_TRUE((H2.block<15, 15>(6, 6)).isIdentity());
+    EXPECT_TRUE((H1.block<6, 15>(0, 6)).isZero());
+    EXPECT_TRUE((H2.block<15, 6>(6, 0)).isZero());
+
+    // Retracting the local coordinates recovers the state
+    auto v = gtsam::traits<PoseVelAccBias>::Local(m1, m2);
+    EXPECT_TRUE(gtsam::traits<PoseVelAccBias>::Equals(
+      m2, gtsam::traits<PoseVelAccBias>::Retract(m1, v)));
+}
+
 }  // namespace wave
@@ -22,6 +22,7 @@
 
 #include "wave/matching/pcl_common.hpp"
 #include "wave/matching/matcher.hpp"
+#include "wave/matching/voxel_filter.hpp"
 
 namespace wave {
 /** @addtogroup matching
@@ -59,7 +60,7 @@ class GICPMatcher : public Matcher<PCLPointCloudPtr> {
 
  private:
     pcl::GeneralizedIterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> gicp;
-    pcl::VoxelGrid<pcl::PointXYZ> filter;
+    VoxelFilter filter;
     PCLPointCloudPtr ref, target, final;
     GICPMatcherParams params;
 };
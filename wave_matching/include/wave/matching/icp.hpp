@@ -22,6 +22,7 @@
 
 #include "wave/matching/pcl_common.hpp"
 #include "wave/matching/matcher.hpp"
+#include "wave/matching/voxel_filter.hpp"
 
 namespace wave {
 /** @addtogroup matching
@@ -57,6 +58,11 @@ struct ICPMatcherParams {
     /// not performed. If multiscale matching is set, this is the resolution
     /// of the final, fine-scale match
     float res = 0.1;
+
+    /// Maximum number of threads used for voxel downsampling. If 0, uses the
+    /// hardware concurrency.
+    int filter_threads = 0;
+
     enum covar_method : int {
         LUM,
         CENSI,
@@ -98,8 +104,12 @@ class ICPMatcher : public Matcher<PCLPointCloudPtr> {
  private:
     /** An instance of the ICP class from PCL */
     pcl::IterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> icp;
-    /** An instance of a PCL voxel filter. It is used to downsample input. */
-    pcl::VoxelGrid<pcl::PointXYZ> filter;
+    /** Voxel filter used to downsample input. In multiscale matching it
+     * produces every scale of each cloud in a single pass. */
+    VoxelFilter filter;
+
+    /** Downsampled input at each scale, finest first */
+    std::vector<PCLPointCloudPtr> ref_pyramid, target_pyramid;
 
     /** Pointers to the reference and target pointclouds. The "final" pointcloud
      * is not exposed. PCL's ICP class creates an aligned verison of the target
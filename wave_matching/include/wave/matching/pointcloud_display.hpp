@@ -8,13 +8,19 @@
  * separate thread so that it is always interactive.
  * Note: Ids are shared between all drawn objects, so they should be
  * globally unique.
+ *
+ * Adding an object never waits for rendering. Each id has a single pending
+ * slot: if an id is updated several times between frames, only the latest
+ * version is drawn. Clouds may be decimated before they are handed to the
+ * viewer, and the least recently updated clouds are removed from the display
+ * once the retained clouds exceed a memory budget.
  */
 
 #ifndef WAVE_POINTCLOUDDISPLAY_HPP
 #define WAVE_POINTCLOUDDISPLAY_HPP
 
 #include <atomic>
-#include <queue>
+#include <map>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -33,8 +39,15 @@ class PointCloudDisplay {
     /**
      * Default constructor
      * @param name: Display window title. Must be unique.
+     * @param max_points: clouds with more points are uniformly decimated to
+     * at most this many before display. If 0, clouds are not decimated.
+     * @param memory_budget: maximum bytes of point data kept in the display.
+     * When exceeded, the least recently updated clouds are removed. If 0,
+     * there is no limit.
      */
-    PointCloudDisplay(const std::string &name);
+    PointCloudDisplay(const std::string &name,
+                      std::size_t max_points = 0,
+                      std::size_t memory_budget = 0);
 
     /**
      * Calling this launches the worker thread and opens
@@ -53,8 +66,9 @@ class PointCloudDisplay {
      * Queues a pointcloud to be added to the display.
      * If worker thread isn't running nothing will happen.
      *
-     * A copy of the cloud is taken. To show changes, call addPointcloud again
-     * with the same id.
+     * A (possibly decimated) copy of the cloud is taken. To show changes, call
+     * addPointcloud again with the same id. Updates to an id which have not
+     * been drawn yet are replaced.
      *
      * @param cld: cloud to be added
      * @param id: identifier of cloud to be added. The id can be used to update
@@ -94,9 +108,14 @@ class PointCloudDisplay {
      */
     std::shared_ptr<pcl::visualization::PCLVisualizer> viewer;
     /**
-     * Transfers objects from queues to the internal visualizer class
+     * Transfers objects from pending slots to the internal visualizer class
      */
     void updateInternal();
+    /**
+     * Records that cloud `id` holding `bytes` of points is displayed, and
+     * removes the least recently updated clouds if over the memory budget
+     */
+    void retainCloud(int id, std::size_t bytes);
     /**
      * Function run by worker class.
      */
@@ -108,7 +127,12 @@ class PointCloudDisplay {
      * Used to stop worker thread
      */
     std::atomic_flag continueFlag = ATOMIC_FLAG_INIT;
-    std::mutex update_mutex;  ///< Protects buffers
+    std::size_t max_points;
+    std::size_t memory_budget;
+
+    /** Protects the pending slots. Only held to swap pointers, never while
+     * copying clouds or rendering. */
+    std::mutex update_mutex;
     /** Struct for cloud buffer */
     struct Cloud {
         PCLPointCloudPtr cloud;
@@ -129,9 +153,19 @@ class PointCloudDisplay {
         bool reset_camera;
     };
 
-    std::queue<Cloud> clouds;
-    std::queue<CloudI> cloudsi;
-    std::queue<Line> lines;
+    /** Latest undrawn update of each object, keyed by id */
+    std::map<int, Cloud> clouds;
+    std::map<int, CloudI> cloudsi;
+    std::map<std::pair<int, int>, Line> lines;
+
+    /** Bookkeeping for clouds in the viewer. Only used by the worker thread */
+    struct RetainedCloud {
+        std::size_t bytes;
+        uint64_t last_update;
+    };
+    std::map<int, RetainedCloud> retained;
+    std::size_t retained_bytes = 0;
+    uint64_t update_count = 0;
 };
 
 }  // namespace wave
@@ -0,0 +1,152 @@
+/** @file
+ * @ingroup matching
+ *
+ * Scan Context place recognition, used to find loop closure candidates
+ * without matching every pair of scans.
+ *
+ * Based on Kim and Kim, "Scan Context: Egocentric Spatial Descriptor for
+ * Place Recognition within 3D Point Cloud Map" (IROS 2018).
+ *
+ * Each scan is binned in polar coordinates around the sensor, like
+ * GroundSegmentation's polar bin grid, and the maximum height in each bin
+ * forms a rings x sectors descriptor. A rotation of the sensor about z only
+ * shifts the sectors, so:
+ *
+ * - the ring key, the mean of each ring, is rotation invariant and is used for
+ *   fast nearest neighbour search over all scans;
+ * - the few nearest candidates are re-ranked by the full descriptor distance,
+ *   minimized over sector shifts, which also estimates the relative yaw.
+ *
+ * Typical use is to insert each scan, then send the candidates from
+ * queryLoops() to a MultiMatcher for verification:
+ *
+ * ```
+ * ScanContextIndex index{params};
+ * for (int i = 0; i < num_scans; ++i) {
+ *     index.insert(*scans[i]);
+ *     for (const auto &c : index.queryLoops(i, 3)) {
+ *         matcher.insert(i, scans[c.id], scans[i]);
+ *     }
+ * }
+ * ```
+ *
+ * There are a few parameters that may be changed specific to this algorithm.
+ * They can be set in the yaml config file.
+ *
+ * - num_rings: number of range bins
+ * - num_sectors: number of azimuth bins
+ * - max_range: points farther than this from the sensor are ignored
+ * - sensor_height: added to z, so that bin heights are positive
+ * - num_candidates: nearest ring key matches re-ranked by full distance
+ * - search_radius: sector shifts tried either side of the sector key alignment
+ * - exclude_recent: queryLoops() ignores this many preceding scans
+ */
+
+#ifndef WAVE_MATCHING_SCAN_CONTEXT_HPP
+#define WAVE_MATCHING_SCAN_CONTEXT_HPP
+
+#include <vector>
+#include <Eigen/Core>
+
+#include "wave/matching/pcl_common.hpp"
+
+namespace wave {
+/** @addtogroup matching
+ *  @{ */
+
+struct ScanContextParams {
+    ScanContextParams(const std::string &config_path);
+    ScanContextParams() {}
+
+    int num_rings = 20;
+    int num_sectors = 60;
+    double max_range = 80.0;
+    double sensor_height = 2.0;
+    int num_candidates = 10;
+    int search_radius = 3;
+    int exclude_recent = 50;
+};
+
+/** Descriptor of one scan. Single precision keeps large maps compact. */
+struct ScanContext {
+    /** Maximum height in each bin, rings x sectors. Empty bins are 0. */
+    Eigen::MatrixXf desc;
+    /** Mean of each ring of `desc` */
+    Eigen::VectorXf ring_key;
+    /** Mean of each sector of `desc` */
+    Eigen::VectorXf sector_key;
+};
+
+/** A previously inserted scan similar to a query */
+struct PlaceCandidate {
+    int id;
+    /** Descriptor distance in [0, 1]; smaller is more similar */
+    double distance;
+    /** Estimated rotation about z in radians such that the query scan is
+     * approximately the candidate scan rotated by `yaw`. Useful as an initial
+     * guess when matching the pair. */
+    double yaw;
+};
+
+class ScanContextIndex {
+ public:
+    explicit ScanContextIndex(ScanContextParams params = ScanContextParams());
+
+    /** Computes the descriptor of a scan in the sensor frame */
+    ScanContext describe(const pcl::PointCloud<pcl::PointXYZ> &scan) const;
+
+    /** Adds a scan to the index.
+     * @return the id of the scan, which is the number of scans inserted before
+     */
+    int insert(const pcl::PointCloud<pcl::PointXYZ> &scan);
+    int insert(const ScanContext &descriptor);
+
+    /** Finds the `k` inserted scans most similar to `descriptor`.
+     *
+     * @param max_id only scans with id less than this are considered. If
+     * negative, all scans are.
+     * @return up to `k` candidates, most similar first
+     */
+    std::vector<PlaceCandidate> query(const ScanContext &descriptor,
+                                      int k,
+                                      int max_id = -1) const;
+
+    /** Finds loop closure candidates for an inserted scan, among the scans
+     * inserted at least `exclude_recent` scans before it */
+    std::vector<PlaceCandidate> queryLoops(int id, int k) const;
+
+    /** Full descriptor distance, minimized over sector shifts.
+     *
+     * Only the shifts near the best alignment of sector keys are tried, unless
+     * `search_radius` covers every sector.
+     *
+     * @param[out] yaw rotation from `b` to `a`, see PlaceCandidate::yaw
+     */
+    double distance(const ScanContext &a,
+                    const ScanContext &b,
+                    double *yaw = nullptr) const;
+
+    std::size_t size() const {
+        return this->descriptors.size();
+    }
+
+    const ScanContext &getDescriptor(int id) const {
+        return this->descriptors.at(id);
+    }
+
+ private:
+    ScanContextParams params;
+    std::vector<ScanContext> descriptors;
+    /** Ring keys of all scans as columns, for vectorized search */
+    Eigen::MatrixXf ring_keys;
+
+    /** Distance between `a` and `b` with `b` shifted by `shift` sectors */
+    double shiftedDistance(const ScanContext &a,
+                           const ScanContext &b,
+                           int shift) const;
+};
+
+/** @} group matching */
+}  // namespace wave
+
+#endif  // WAVE_MATCHING_SCAN_CONTEXT_HPP
@@ -0,0 +1,262 @@
+/** @file
+ * @ingroup matching
+ *
+ * Sources of lidar scans for offline processing.
+ *
+ * `MappedScanReader` memory-maps KITTI-style `.bin` velodyne scans and binary
+ * `.pcd` files, and exposes each scan as a `ScanView` pointing directly into
+ * the mapped file. No parsing is done beyond reading the PCD header, so
+ * opening a scan costs one `mmap` call.
+ *
+ * `ScanPrefetcher` walks a `ScanSource` in order on a background thread,
+ * faulting the next few scans into memory (and optionally converting them to
+ * PCL clouds) so the consumer, e.g. a `MultiMatcher`, never waits on disk.
+ */
+
+#ifndef WAVE_MATCHING_SCAN_SOURCE_HPP
+#define WAVE_MATCHING_SCAN_SOURCE_HPP
+
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "wave/utils/mapped_file.hpp"
+#include "wave/matching/pcl_common.hpp"
+
+namespace wave {
+/** @addtogroup matching
+ *  @{ */
+
+/** Read-only, zero-copy view of the points of one scan.
+ *
+ * Points are stored with a fixed stride of `pointStep()` bytes, with the x, y
+ * and z coordinates as 32-bit floats at fixed offsets into each point. The
+ * view shares ownership of the underlying mapping, so it remains valid after
+ * the source that created it is destroyed.
+ */
+class ScanView {
+ public:
+    ScanView() = default;
+
+    /**
+     * @param file mapping the points live in (kept alive by the view)
+     * @param data pointer to the first byte of the first point
+     * @param num_points number of points in the scan
+     * @param point_step size of one point in bytes
+     * @param x_offset, y_offset, z_offset byte offsets of the coordinates
+     * within one point
+     */
+    ScanView(std::shared_ptr<const MappedFile> file,
+             const char *data,
+             std::size_t num_points,
+             std::size_t point_step,
+             std::size_t x_offset,
+             std::size_t y_offset,
+             std::size_t z_offset)
+        : file{std::move(file)},
+          points{data},
+          num_points{num_points},
+          point_step{point_step},
+          offsets{x_offset, y_offset, z_offset} {}
+
+    /** @return the number of points in the scan */
+    std::size_t size() const noexcept {
+        return this->num_points;
+    }
+
+    bool empty() const noexcept {
+        return this->num_points == 0;
+    }
+
+    /** @return pointer to the first byte of the first point */
+    const char *data() const noexcept {
+        return this->points;
+    }
+
+    /** @return the distance in bytes between consecutive points */
+    std::size_t pointStep() const noexcept {
+        return this->point_step;
+    }
+
+    /** @return the coordinates of the i-th point. No bounds checking. */
+    pcl::PointXYZ operator[](std::size_t i) const noexcept {
+        // The mapped data is not necessarily 4-byte aligned, so copy bytes
+        // rather than dereferencing float pointers
+        const char *p = this->points + i * this->point_step;
+        pcl::PointXYZ point;
+        std::memcpy(&point.x, p + this->offsets[0], sizeof(float));
+        std::memcpy(&point.y, p + this->offsets[1], sizeof(float));
+        std::memcpy(&point.z, p + this->offsets[2], sizeof(float));
+        return point;
+    }
+
+    /** Reads one byte of every page spanned by the points, so the pages are
+     * faulted in by the calling thread rather than later by the consumer.
+     *
+     * @return a checksum of the touched bytes
+     */
+    std::size_t touchPages() const noexcept;
+
+    /** Copies the points into `cloud`, replacing its contents */
+    void copyTo(pcl::PointCloud<pcl::PointXYZ> &cloud) const;
+
+    /** @return a new PCL cloud holding a copy of the points, as consumed by
+     * the matchers */
+    PCLPointCloudPtr toPointCloud() const;
+
+ private:
+    std::shared_ptr<const MappedFile> file;
+    const char *points = nullptr;
+    std::size_t num_points = 0;
+    std::size_t point_step = 0;
+    std::size_t offsets[3] = {0, 0, 0};
+};
+
+/** Interface for an indexed sequence of scans */
+class ScanSource {
+ public:
+    virtual ~ScanSource() = default;
+
+    /** @return the number of scans in the sequence */
+    virtual std::size_t size() const = 0;
+
+    /** Opens the scan at position `i`.
+     * @throws std::out_of_range if `i >= size()`
+     * @throws std::runtime_error if the scan cannot be read
+     */
+    virtual ScanView getScan(std::size_t i) const = 0;
+};
+
+/** Scan source memory-mapping a list of scan files.
+ *
+ * The format of each file is chosen by its extension:
+ *  - `.bin`: KITTI velodyne format, packed float32 (x, y, z, reflectance)
+ *  - `.pcd`: PCL format, which must be saved with `DATA binary` and have
+ *  float32 `x`, `y` and `z` fields
+ *
+ * Files are mapped when their scan is requested, not on construction, so a
+ * reader over hours of data does not hold every file open at once.
+ */
+class MappedScanReader : public ScanSource {
+ public:
+    /** Reads the given files, in order */
+    explicit MappedScanReader(std::vector<std::string> file_paths);
+
+    /** Reads every `.bin` and `.pcd` file in `directory`, sorted by name.
+     * @throws std::runtime_error if the directory cannot be opened
+     */
+    static MappedScanReader fromDirectory(const std::string &directory);
+
+    std::size_t size() const override {
+        return this->file_paths.size();
+    }
+
+    ScanView getScan(std::size_t i) const override;
+
+    /** Maps and parses a single scan file */
+    static ScanView readScan(const std::string &file_path);
+
+ private:
+    std::vector<std::string> file_paths;
+};
+
+/** Reads scans from a `ScanSource` in order, ahead of the consumer.
+ *
+ * A background thread opens up to `depth` scans past the last one returned by
+ * `next()`, and reads every page of each so it is resident in memory. If
+ * `convert` is set, it also converts each scan to a PCL cloud, so the clouds
+ * can be handed straight to a `MultiMatcher`.
+ *
+ * Errors while reading a scan are rethrown from `next()`.
+ */
+class ScanPrefetcher {
+ public:
+    /** A scan that has been read ahead */
+    struct Scan {
+        std::size_t index;
+        ScanView view;
+        /** Converted cloud, or nullptr if conversion is disabled */
+        PCLPointCloudPtr cloud;
+    };
+
+    /**
+     * @param source scans to read. Must outlive the prefetcher.
+     * @param depth maximum number of scans read ahead of the consumer
+     * @param convert if true, also convert each scan to a PCL cloud
+     */
+    explicit ScanPrefetcher(const ScanSource &source,
+                            std::size_t depth = 4,
+                            bool convert = true);
+
+    ~ScanPrefetcher();
+
+    ScanPrefetcher(const ScanPrefetcher &) = delete;
+    ScanPrefetcher &operator=(const ScanPrefetcher &) = delete;
+
+    /** Gets the next scan, blocking until it has been read.
+     *
+     * @return false if every scan has already been returned
+     */
+    bool next(Scan *scan);
+
+ private:
+    const ScanSource &source;
+    const std::size_t depth;
+    const bool convert;
+
+    std::queue<Scan> ready;
+    std::size_t num_returned = 0;
+    std::exception_ptr error;
+    bool stop = false;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable ready_condition;
+    std::condition_variable space_condition;
+
+    /** Function run by the worker thread */
+    void spin();
+};
+
+/** Inserts each consecutive pair of scans from `prefetcher` into a
+ * `MultiMatcher`, in order.
+ *
+ * The match of scans i and i + 1 is inserted with id i. This blocks whenever
+ * the matcher's input queue is full, so at most `depth` scans are held in
+ * memory beyond those queued for matching.
+ *
+ * @tparam M a MultiMatcher type
+ * @return the number of pairs inserted
+ */
+template <typename M>
+int insertConsecutiveScans(ScanPrefetcher &prefetcher, M &matcher) {
+    ScanPrefetcher::Scan prev, cur;
+    if (!prefetcher.next(&prev)) {
+        return 0;
+    }
+    if (!prev.cloud) {
+        prev.cloud = prev.view.toPointCloud();
+    }
+
+    int count = 0;
+    while (prefetcher.next(&cur)) {
+        if (!cur.cloud) {
+            cur.cloud = cur.view.toPointCloud();
+        }
+        matcher.insert(static_cast<int>(prev.index), prev.cloud, cur.cloud);
+        ++count;
+        prev = std::move(cur);
+    }
+    return count;
+}
+
+/** @} group matching */
+}  // namespace wave
+
+#endif  // WAVE_MATCHING_SCAN_SOURCE_HPP
@@ -0,0 +1,91 @@
+/** @file
+ * @ingroup matching
+ *
+ * Multi-threaded voxel grid downsampling filter.
+ *
+ * Points are binned into cubic voxels through a hash map keyed by 64-bit voxel
+ * indices, so unlike `pcl::VoxelGrid` there is no limit on the extent of the
+ * cloud relative to the leaf size, and no sort over all points. Each thread
+ * owns the voxels whose hash falls in its shard, so no merging is needed.
+ *
+ * Because a voxel of edge `2^i * leaf` is exactly the union of `2^3i` voxels
+ * of edge `leaf`, `filterPyramid` computes the integer voxel index of each
+ * point once and derives every coarser level from it by a shift, producing all
+ * levels of a multiscale pyramid in one pass over the input.
+ */
+
+#ifndef WAVE_MATCHING_VOXEL_FILTER_HPP
+#define WAVE_MATCHING_VOXEL_FILTER_HPP
+
+#include <vector>
+
+#include "wave/matching/pcl_common.hpp"
+
+namespace wave {
+/** @addtogroup matching
+ *  @{ */
+
+class VoxelFilter {
+ public:
+    /** How to choose the point which represents each voxel */
+    enum class Mode {
+        /** The mean of all points in the voxel, like `pcl::VoxelGrid` */
+        CENTROID,
+        /** The first point of the input cloud falling in the voxel */
+        FIRST_POINT
+    };
+
+    /**
+     * @param leaf_size edge length of each voxel. If non-positive, filtering
+     * copies the input unchanged.
+     * @param mode how each voxel's output point is chosen
+     * @param n_threads maximum number of threads to use. If 0, uses the
+     * hardware concurrency. Small clouds use fewer threads.
+     */
+    explicit VoxelFilter(float leaf_size = -1,
+                         Mode mode = Mode::CENTROID,
+                         int n_threads = 0);
+
+    void setLeafSize(float leaf_size) {
+        this->leaf_size = leaf_size;
+    }
+
+    float getLeafSize() const {
+        return this->leaf_size;
+    }
+
+    void setMode(Mode mode) {
+        this->mode = mode;
+    }
+
+    /** Downsamples `input` into `output`.
+     *
+     * Non-finite points are dropped. Output points are ordered by the first
+     * input point in each voxel, so the result does not depend on the number
+     * of threads. `input` and `output` must not be the same cloud.
+     */
+    void filter(const pcl::PointCloud<pcl::PointXYZ> &input,
+                pcl::PointCloud<pcl::PointXYZ> &output) const;
+
+    /** Downsamples `input` at `num_levels` resolutions in a single pass.
+     *
+     * Level `i` of the output has leaf size `2^i * getLeafSize()`; level 0 is
+     * identical to the output of `filter()`.
+     *
+     * @param[out] output resized to `num_levels` clouds. Existing clouds are
+     * reused.
+     */
+    void filterPyramid(const pcl::PointCloud<pcl::PointXYZ> &input,
+                       int num_levels,
+                       std::vector<PCLPointCloudPtr> &output) const;
+
+ private:
+    float leaf_size;
+    Mode mode;
+    int n_threads;
+};
+
+/** @} group matching */
+}  // namespace wave
+
+#endif  // WAVE_MATCHING_VOXEL_FILTER_HPP
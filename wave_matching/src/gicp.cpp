@@ -17,14 +17,14 @@ GICPMatcherParams::GICPMatcherParams(const std::string &config_path) {
     }
 }
 
-GICPMatcher::GICPMatcher(GICPMatcherParams params1) : params(params1) {
+GICPMatcher::GICPMatcher(GICPMatcherParams params1)
+    : filter{params1.res}, params(params1) {
     this->ref = boost::make_shared<pcl::PointCloud<pcl::PointXYZ> >();
     this->target = boost::make_shared<pcl::PointCloud<pcl::PointXYZ> >();
     this->final = boost::make_shared<pcl::PointCloud<pcl::PointXYZ> >();
 
     if (params.res > 0) {
         this->resolution = params.res;
-        this->filter.setLeafSize(params.res, params.res, params.res);
     } else {
         this->resolution = -1;
     }
@@ -36,8 +36,7 @@ GICPMatcher::GICPMatcher(GICPMatcherParams params1) : params(params1) {
 
 void GICPMatcher::setRef(const PCLPointCloudPtr &ref) {
     if (this->resolution > 0) {
-        this->filter.setInputCloud(ref);
-        this->filter.filter(*(this->ref));
+        this->filter.filter(*ref, *(this->ref));
     } else {
         this->ref = ref;
     }
@@ -46,8 +45,7 @@ void GICPMatcher::setRef(const PCLPointCloudPtr &ref) {
 
 void GICPMatcher::setTarget(const PCLPointCloudPtr &target) {
     if (resolution > 0) {
-        this->filter.setInputCloud(target);
-        this->filter.filter(*(this->target));
+        this->filter.filter(*target, *(this->target));
     } else {
         this->target = target;
     }
@@ -14,6 +14,7 @@ ICPMatcherParams::ICPMatcherParams(const std::string &config_path) {
     parser.addParam("covar_estimator", &covar_est_temp);
     parser.addParam("res", &(this->res));
     parser.addParam("multiscale_steps", &(this->multiscale_steps));
+    parser.addParam("filter_threads", &(this->filter_threads), true);
 
     if (parser.load(config_path) != ConfigStatus::OK) {
         throw std::runtime_error{"Failed to Load Matcher Config"};
@@ -29,7 +30,9 @@ ICPMatcherParams::ICPMatcherParams(const std::string &config_path) {
     }
 }
 
-ICPMatcher::ICPMatcher(ICPMatcherParams params1) : params(params1) {
+ICPMatcher::ICPMatcher(ICPMatcherParams params1)
+    : params(params1),
+      filter{params1.res, VoxelFilter::Mode::CENTROID, params1.filter_threads} {
     this->ref = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
     this->target = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
     this->final = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
@@ -38,10 +41,6 @@ ICPMatcher::ICPMatcher(ICPMatcherParams params1) : params(params1) {
     this->downsampled_target =
       boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
 
-    if (this->params.res > 0) {
-        this->filter.setLeafSize(
-          this->params.res, this->params.res, this->params.res);
-    }
     this->resolution = this->params.res;
 
     this->icp.setMaxCorrespondenceDistance(this->params.max_corr);
@@ -75,19 +74,22 @@ void ICPMatcher::setTarget(const PCLPointCloudPtr &target) {
 bool ICPMatcher::match() {
     if (this->params.res > 0) {
         if (this->params.multiscale_steps > 0) {
+            // Downsample each cloud to every scale at once
+            const int num_levels = this->params.multiscale_steps + 1;
+            this->filter.setLeafSize(this->params.res);
+            this->filter.filterPyramid(
+              *(this->ref), num_levels, this->ref_pyramid);
+            this->filter.filterPyramid(
+              *(this->target), num_levels, this->target_pyramid);
+
             Affine3 running_transform = Affine3::Identity();
             for (int i = this->params.multiscale_steps; i >= 0; i--) {
-                float leaf_size = pow(2, i) * this->params.res;
-                this->filter.setLeafSize(leaf_size, leaf_size, leaf_size);
-                this->filter.setInputCloud(this->ref);
-                this->filter.filter(*(this->downsampled_ref));
-                pcl::transformPointCloud(*(this->downsampled_ref),
+                pcl::transformPointCloud(*(this->ref_pyramid[i]),
                                          *(this->downsampled_ref),
                                          running_transform);
                 this->icp.setInputSource(this->downsampled_ref);
 
-                this->filter.setInputCloud(this->target);
-                this->filter.filter(*(this->downsampled_target));
+                *(this->downsampled_target) = *(this->target_pyramid[i]);
                 this->icp.setInputTarget(this->downsampled_target);
 
                 this->icp.setMaxCorrespondenceDistance(pow(2, i) *
@@ -103,14 +105,11 @@ bool ICPMatcher::match() {
             this->result = running_transform;
             return true;
         } else {
-            this->filter.setLeafSize(
-              this->params.res, this->params.res, this->params.res);
-            this->filter.setInputCloud(this->ref);
-            this->filter.filter(*(this->downsampled_ref));
+            this->filter.setLeafSize(this->params.res);
+            this->filter.filter(*(this->ref), *(this->downsampled_ref));
             this->icp.setInputSource(this->downsampled_ref);
 
-            this->filter.setInputCloud(this->target);
-            this->filter.filter(*(this->downsampled_target));
+            this->filter.filter(*(this->target), *(this->downsampled_target));
             this->icp.setInputTarget(this->downsampled_target);
 
             this->icp.align(*(this->final));
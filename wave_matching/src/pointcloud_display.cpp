@@ -3,7 +3,42 @@
 
 namespace wave {
 
-PointCloudDisplay::PointCloudDisplay(const std::string &name) {
+namespace {
+
+/** Copies every k-th point of `cld`, so that at most `max_points` remain.
+ * If `max_points` is 0, copies the whole cloud. */
+template <typename PointT>
+typename pcl::PointCloud<PointT>::Ptr decimate(
+  const pcl::PointCloud<PointT> &cld, std::size_t max_points) {
+    if (max_points == 0 || cld.size() <= max_points) {
+        return cld.makeShared();
+    }
+    const auto stride = (cld.size() + max_points - 1) / max_points;
+    auto out = boost::make_shared<pcl::PointCloud<PointT>>();
+    out->reserve(cld.size() / stride + 1);
+    for (std::size_t i = 0; i < cld.size(); i += stride) {
+        out->push_back(cld.points[i]);
+    }
+    out->header = cld.header;
+    return out;
+}
+
+/** Puts `item` in the slot for `key`, keeping any camera reset requested by
+ * the update it replaces. The replaced update is left in `item`, so that it
+ * is freed by the caller outside the lock. */
+template <typename Key, typename T>
+void replacePending(std::map<Key, T> &slots, const Key &key, T &item) {
+    auto &slot = slots[key];
+    item.reset_camera |= slot.reset_camera;
+    std::swap(slot, item);
+}
+
+}  // namespace
+
+PointCloudDisplay::PointCloudDisplay(const std::string &name,
+                                     std::size_t max_points,
+                                     std::size_t memory_budget)
+    : max_points{max_points}, memory_budget{memory_budget} {
     this->display_name = name;
 }
 
@@ -29,9 +64,7 @@ void PointCloudDisplay::spin() {
         this->viewer->spinOnce(3);
         std::this_thread::sleep_for(std::chrono::milliseconds(3));
 
-        this->update_mutex.lock();
         this->updateInternal();
-        this->update_mutex.unlock();
     }
     // Cleanup viewer
     this->viewer->close();
@@ -41,16 +74,16 @@ void PointCloudDisplay::spin() {
 void PointCloudDisplay::addPointcloud(const PCLPointCloudPtr &cld,
                                       int id,
                                       bool reset_camera) {
-    this->update_mutex.lock();
-    this->clouds.emplace(Cloud{cld->makeShared(), id, reset_camera});
-    this->update_mutex.unlock();
+    Cloud item{decimate(*cld, this->max_points), id, reset_camera};
+    std::lock_guard<std::mutex> lock{this->update_mutex};
+    replacePending(this->clouds, id, item);
 }
 
 void PointCloudDisplay::addPointcloud(
   const pcl::PointCloud<pcl::PointXYZI>::Ptr &cld, int id, bool reset_camera) {
-    this->update_mutex.lock();
-    this->cloudsi.emplace(CloudI{cld->makeShared(), id, reset_camera});
-    this->update_mutex.unlock();
+    CloudI item{decimate(*cld, this->max_points), id, reset_camera};
+    std::lock_guard<std::mutex> lock{this->update_mutex};
+    replacePending(this->cloudsi, id, item);
 }
 
 void PointCloudDisplay::addLine(const pcl::PointXYZ &pt1,
@@ -58,15 +91,51 @@ void PointCloudDisplay::addLine(const pcl::PointXYZ &pt1,
                                 int id1,
                                 int id2,
                                 bool reset_camera) {
-    this->update_mutex.lock();
-    this->lines.emplace(Line{pt1, pt2, id1, id2, reset_camera});
-    this->update_mutex.unlock();
+    Line item{pt1, pt2, id1, id2, reset_camera};
+    std::lock_guard<std::mutex> lock{this->update_mutex};
+    replacePending(this->lines, std::make_pair(id1, id2), item);
+}
+
+void PointCloudDisplay::retainCloud(int id, std::size_t bytes) {
+    auto &entry = this->retained[id];
+    this->retained_bytes += bytes - entry.bytes;
+    entry.bytes = bytes;
+    entry.last_update = ++this->update_count;
+
+    if (this->memory_budget == 0) {
+        return;
+    }
+    // Always keep the cloud just drawn, even if it alone exceeds the budget
+    while (this->retained_bytes > this->memory_budget &&
+           this->retained.size() > 1) {
+        auto oldest = this->retained.begin();
+        for (auto it = this->retained.begin(); it != this->retained.end();
+             ++it) {
+            if (it->second.last_update < oldest->second.last_update) {
+                oldest = it;
+            }
+        }
+        this->viewer->removePointCloud(std::to_string(oldest->first));
+        this->retained_bytes -= oldest->second.bytes;
+        this->retained.erase(oldest);
+    }
 }
 
 void PointCloudDisplay::updateInternal() {
-    // add or update clouds in the viewer until the queue is empty
-    while (this->clouds.size() != 0) {
-        const auto &cld = this->clouds.front();
+    // Take all pending updates, so producers are never blocked while drawing
+    std::map<int, Cloud> clouds;
+    std::map<int, CloudI> cloudsi;
+    std::map<std::pair<int, int>, Line> lines;
+    {
+        std::lock_guard<std::mutex> lock{this->update_mutex};
+        std::swap(clouds, this->clouds);
+        std::swap(cloudsi, this->cloudsi);
+        std::swap(lines, this->lines);
+    }
+
+    // add or update the latest version of each cloud in the viewer
+    for (const auto &kv : clouds) {
+        const auto &cld = kv.second;
         // Give each id a unique color, using the Glasbey table of maximally
         // different colors. Use white for 0
         // Note the color handler uses the odd format of doubles 0-255
@@ -88,11 +157,12 @@ void PointCloudDisplay::updateInternal() {
         if (cld.reset_camera) {
             this->viewer->resetCamera();
         }
-        this->clouds.pop();
+        this->retainCloud(cld.id,
+                          cld.cloud->size() * sizeof(pcl::PointXYZ));
     }
 
-    while (this->cloudsi.size() != 0) {
-        const auto &cld = this->cloudsi.front();
+    for (const auto &kv : cloudsi) {
+        const auto &cld = kv.second;
         pcl::visualization::PointCloudColorHandlerGenericField<pcl::PointXYZI>
           col_handler(cld.cloud, "intensity");
         if (this->viewer->contains(std::to_string(cld.id))) {
@@ -105,15 +175,16 @@ void PointCloudDisplay::updateInternal() {
         if (cld.reset_camera) {
             this->viewer->resetCamera();
         }
-        this->cloudsi.pop();
+        this->retainCloud(cld.id,
+                          cld.cloud->size() * sizeof(pcl::PointXYZI));
     }
 
     double rad = 0.2;
     double hi = 200;
     double low = 0;
 
-    while (this->lines.size() != 0) {
-        const auto &line = this->lines.front();
+    for (const auto &kv : lines) {
+        const auto &line = kv.second;
         if (this->viewer->contains(std::to_string(line.id1) + "pt")) {
             this->viewer->updateSphere(
               line.pt1, rad, hi, low, low, std::to_string(line.id1) + "pt");
@@ -138,7 +209,6 @@ void PointCloudDisplay::updateInternal() {
         if (line.reset_camera) {
             this->viewer->resetCamera();
         }
-        this->lines.pop();
     }
 }
 }
@@ -0,0 +1,201 @@
+#include "wave/utils/config.hpp"
+#include "wave/utils/math.hpp"
+#include "wave/matching/scan_context.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace wave {
+
+ScanContextParams::ScanContextParams(const std::string &config_path) {
+    ConfigParser parser;
+    parser.addParam("num_rings", &(this->num_rings));
+    parser.addParam("num_sectors", &(this->num_sectors));
+    parser.addParam("max_range", &(this->max_range));
+    parser.addParam("sensor_height", &(this->sensor_height));
+    parser.addParam("num_candidates", &(this->num_candidates));
+    parser.addParam("search_radius", &(this->search_radius));
+    parser.addParam("exclude_recent", &(this->exclude_recent));
+
+    if (parser.load(config_path) != ConfigStatus::OK) {
+        throw std::runtime_error{"Failed to Load Scan Context Config"};
+    }
+}
+
+ScanContextIndex::ScanContextIndex(ScanContextParams params1)
+    : params(params1) {
+    if (this->params.num_rings < 1 || this->params.num_sectors < 1 ||
+        this->params.max_range <= 0) {
+        throw std::invalid_argument{"Invalid Scan Context parameters"};
+    }
+    this->ring_keys.resize(this->params.num_rings, 0);
+}
+
+ScanContext ScanContextIndex::describe(
+  const pcl::PointCloud<pcl::PointXYZ> &scan) const {
+    const auto num_rings = this->params.num_rings;
+    const auto num_sectors = this->params.num_sectors;
+    const double bsize_rad = 360.0 / num_sectors;
+    const double bsize_lin = this->params.max_range / num_rings;
+
+    ScanContext sc;
+    sc.desc = Eigen::MatrixXf::Zero(num_rings, num_sectors);
+    for (const auto &point : scan.points) {
+        const double xy_dist =
+          std::sqrt(point.x * point.x + point.y * point.y);
+        const double height = point.z + this->params.sensor_height;
+        // The negated comparison also rejects NaN
+        if (!(xy_dist < this->params.max_range) || height <= 0) {
+            continue;
+        }
+        const double ph = wrapTo360(rad2deg(std::atan2(point.y, point.x)));
+        const auto bind_rad =
+          std::min(static_cast<int>(ph / bsize_rad), num_sectors - 1);
+        // Rounding can put a point just inside max_range past the last ring
+        const auto bind_lin =
+          std::min(static_cast<int>(xy_dist / bsize_lin), num_rings - 1);
+
+        auto &bin = sc.desc(bind_lin, bind_rad);
+        bin = std::max(bin, static_cast<float>(height));
+    }
+    sc.ring_key = sc.desc.rowwise().mean();
+    sc.sector_key = sc.desc.colwise().mean().transpose();
+    return sc;
+}
+
+int ScanContextIndex::insert(const pcl::PointCloud<pcl::PointXYZ> &scan) {
+    return this->insert(this->describe(scan));
+}
+
+int ScanContextIndex::insert(const ScanContext &descriptor) {
+    const auto id = static_cast<int>(this->descriptors.size());
+    // Grow the key matrix geometrically, as conservativeResize copies
+    if (id >= this->ring_keys.cols()) {
+        this->ring_keys.conservativeResize(
+          Eigen::NoChange, std::max<Eigen::Index>(16, 2 * id));
+    }
+    this->ring_keys.col(id) = descriptor.ring_key;
+    this->descriptors.push_back(descriptor);
+    return id;
+}
+
+std::vector<PlaceCandidate> ScanContextIndex::query(
+  const ScanContext &descriptor, int k, int max_id) const {
+    const auto num_scans = static_cast<int>(this->descriptors.size());
+    const auto n = (max_id < 0) ? num_scans : std::min(max_id, num_scans);
+    if (n <= 0 || k <= 0) {
+        return {};
+    }
+
+    // Nearest ring keys over all scans, as one vectorized pass
+    const Eigen::VectorXf key_dists =
+      (this->ring_keys.leftCols(n).colwise() - descriptor.ring_key)
+        .colwise()
+        .squaredNorm()
+        .transpose();
+    std::vector<int> ids(n);
+    for (int i = 0; i < n; ++i) {
+        ids[i] = i;
+    }
+    const auto num_candidates =
+      std::min(n, std::max(k, this->params.num_candidates));
+    std::partial_sort(ids.begin(),
+                      ids.begin() + num_candidates,
+                      ids.end(),
+                      [&key_dists](int a, int b) {
+                          return key_dists[a] < key_dists[b];
+                      });
+
+    // Re-rank the candidates by full descriptor distance
+    std::vector<PlaceCandidate> candidates;
+    candidates.reserve(num_candidates);
+    for (int i = 0; i < num_candidates; ++i) {
+        PlaceCandidate c{ids[i], 0.0, 0.0};
+        c.distance =
+          this->distance(descriptor, this->descriptors[c.id], &c.yaw);
+        candidates.push_back(c);
+    }
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const PlaceCandidate &a, const PlaceCandidate &b) {
+                  return a.distance < b.distance;
+              });
+    if (static_cast<int>(candidates.size()) > k) {
+        candidates.resize(k);
+    }
+    return candidates;
+}
+
+std::vector<PlaceCandidate> ScanContextIndex::queryLoops(int id, int k) const {
+    return this->query(this->descriptors.at(id),
+                       k,
+                       std::max(0, id - this->params.exclude_recent));
+}
+
+double ScanContextIndex::distance(const ScanContext &a,
+                                  const ScanContext &b,
+                                  double *yaw) const {
+    const auto num_sectors = this->params.num_sectors;
+
+    // Coarse alignment: the shift best matching the sector keys
+    int best_key_shift = 0;
+    auto best_key_dist = std::numeric_limits<float>::max();
+    for (int shift = 0; shift < num_sectors; ++shift) {
+        float dist = 0;
+        for (int j = 0; j < num_sectors; ++j) {
+            const auto d =
+              a.sector_key[j] - b.sector_key[(j + shift) % num_sectors];
+            dist += d * d;
+        }
+        if (dist < best_key_dist) {
+            best_key_dist = dist;
+            best_key_shift = shift;
+        }
+    }
+
+    // Fine alignment: full distance around the coarse shift
+    const auto radius = std::min(this->params.search_radius, num_sectors / 2);
+    int best_shift = best_key_shift;
+    auto best_dist = std::numeric_limits<double>::max();
+    for (int offset = -radius; offset <= radius; ++offset) {
+        const auto shift =
+          (best_key_shift + offset + num_sectors) % num_sectors;
+        const auto dist = this->shiftedDistance(a, b, shift);
+        if (dist < best_dist) {
+            best_dist = dist;
+            best_shift = shift;
+        }
+    }
+
+    if (yaw) {
+        // Column j of a matches column j + shift of b, so a is b rotated back
+        // by shift sectors
+        const double sector_angle = 360.0 / num_sectors;
+        const auto sectors = (num_sectors - best_shift) % num_sectors;
+        *yaw = deg2rad(wrapTo180(sectors * sector_angle));
+    }
+    return best_dist;
+}
+
+double ScanContextIndex::shiftedDistance(const ScanContext &a,
+                                         const ScanContext &b,
+                                         int shift) const {
+    const auto num_sectors = this->params.num_sectors;
+    double sum = 0;
+    int count = 0;
+    for (int j = 0; j < num_sectors; ++j) {
+        const auto col_a = a.desc.col(j);
+        const auto col_b = b.desc.col((j + shift) % num_sectors);
+        const auto norm = col_a.norm() * col_b.norm();
+        // Sectors empty in either scan carry no information
+        if (norm > 0) {
+            sum += 1.0 - col_a.dot(col_b) / norm;
+            ++count;
+        }
+    }
+    return count > 0 ? sum / count : 1.0;
+}
+
+}  // namespace wave
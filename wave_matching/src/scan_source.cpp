@@ -0,0 +1,287 @@
+#include "wave/matching/scan_source.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+#include <stdexcept>
+
+#include <dirent.h>
+
+namespace wave {
+
+namespace {
+
+/** Returns true if `str` ends with `suffix` */
+bool endsWith(const std::string &str, const std::string &suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/** Size of a KITTI velodyne point: float32 x, y, z, reflectance */
+const std::size_t KITTI_POINT_STEP = 4 * sizeof(float);
+
+ScanView readKittiScan(std::shared_ptr<const MappedFile> file) {
+    if (file->size() % KITTI_POINT_STEP != 0) {
+        throw std::runtime_error{"MappedScanReader: size of [" + file->path() +
+                                 "] is not a multiple of the point size"};
+    }
+    const auto data = file->data();
+    const auto num_points = file->size() / KITTI_POINT_STEP;
+    return ScanView{std::move(file),
+                    data,
+                    num_points,
+                    KITTI_POINT_STEP,
+                    0,
+                    sizeof(float),
+                    2 * sizeof(float)};
+}
+
+/** Parses the ASCII header of a PCD file, and returns a view of the binary
+ * point data following it.
+ *
+ * See http://pointclouds.org/documentation/tutorials/pcd_file_format.php
+ */
+ScanView readPcdScan(std::shared_ptr<const MappedFile> file) {
+    const auto fail = [&file](const std::string &msg) {
+        return std::runtime_error{"MappedScanReader: [" + file->path() +
+                                  "]: " + msg};
+    };
+
+    std::vector<std::string> fields;
+    std::vector<std::size_t> sizes, counts;
+    std::vector<char> types;
+    std::size_t num_points = 0;
+    bool have_points = false;
+
+    // Read the header line by line until the DATA line, which is the last
+    const char *const begin = file->data();
+    const char *const end = begin + file->size();
+    const char *line_start = begin;
+    while (true) {
+        const char *line_end = std::find(line_start, end, '\n');
+        if (line_end == end) {
+            throw fail("no DATA line in header");
+        }
+        std::istringstream line{std::string(line_start, line_end)};
+        line_start = line_end + 1;
+
+        std::string key;
+        line >> key;
+        if (key.empty() || key[0] == '#') {
+            continue;
+        } else if (key == "FIELDS") {
+            for (std::string f; line >> f;) {
+                fields.push_back(f);
+            }
+        } else if (key == "SIZE") {
+            for (std::size_t s; line >> s;) {
+                sizes.push_back(s);
+            }
+        } else if (key == "TYPE") {
+            for (char t; line >> t;) {
+                types.push_back(t);
+            }
+        } else if (key == "COUNT") {
+            for (std::size_t c; line >> c;) {
+                counts.push_back(c);
+            }
+        } else if (key == "POINTS") {
+            have_points = static_cast<bool>(line >> num_points);
+        } else if (key == "DATA") {
+            std::string format;
+            line >> format;
+            if (format != "binary") {
+                throw fail("DATA " + format + " is not supported; use binary");
+            }
+            break;
+        }
+    }
+
+    // COUNT is optional and defaults to 1 for each field
+    if (counts.empty()) {
+        counts.assign(fields.size(), 1);
+    }
+    if (!have_points || fields.empty() || sizes.size() != fields.size() ||
+        types.size() != fields.size() || counts.size() != fields.size()) {
+        throw fail("malformed header");
+    }
+
+    // Find the offsets of x, y, z within each point
+    std::size_t point_step = 0;
+    std::size_t offsets[3];
+    int found = 0;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        const auto axis = std::string{"xyz"}.find(fields[i]);
+        if (fields[i].size() == 1 && axis != std::string::npos) {
+            if (types[i] != 'F' || sizes[i] != sizeof(float)) {
+                throw fail("field " + fields[i] + " is not float32");
+            }
+            offsets[axis] = point_step;
+            ++found;
+        }
+        point_step += sizes[i] * counts[i];
+    }
+    if (found != 3) {
+        throw fail("missing x, y or z field");
+    }
+
+    const char *data = line_start;
+    if (static_cast<std::size_t>(end - data) < num_points * point_step) {
+        throw fail("file is shorter than its header claims");
+    }
+
+    return ScanView{std::move(file),
+                    data,
+                    num_points,
+                    point_step,
+                    offsets[0],
+                    offsets[1],
+                    offsets[2]};
+}
+
+}  // namespace
+
+std::size_t ScanView::touchPages() const noexcept {
+    if (!this->file) {
+        return 0;
+    }
+    const auto offset =
+      static_cast<std::size_t>(this->points - this->file->data());
+    return this->file->touchPages(offset,
+                                  this->num_points * this->point_step);
+}
+
+void ScanView::copyTo(pcl::PointCloud<pcl::PointXYZ> &cloud) const {
+    cloud.resize(this->num_points);
+    for (std::size_t i = 0; i < this->num_points; ++i) {
+        cloud.points[i] = (*this)[i];
+    }
+    cloud.width = static_cast<uint32_t>(this->num_points);
+    cloud.height = 1;
+    cloud.is_dense = false;
+}
+
+PCLPointCloudPtr ScanView::toPointCloud() const {
+    auto cloud = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
+    this->copyTo(*cloud);
+    return cloud;
+}
+
+MappedScanReader::MappedScanReader(std::vector<std::string> file_paths)
+    : file_paths{std::move(file_paths)} {}
+
+MappedScanReader MappedScanReader::fromDirectory(const std::string &directory) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir == NULL) {
+        throw std::runtime_error{"MappedScanReader: failed to open [" +
+                                 directory + "]: " + std::strerror(errno)};
+    }
+
+    std::vector<std::string> paths;
+    struct dirent *next_file;
+    while ((next_file = readdir(dir)) != NULL) {
+        const std::string name = next_file->d_name;
+        if (endsWith(name, ".bin") || endsWith(name, ".pcd")) {
+            paths.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+
+    // KITTI and most recorders use zero-padded names, so this is time order
+    std::sort(paths.begin(), paths.end());
+    return MappedScanReader{std::move(paths)};
+}
+
+ScanView MappedScanReader::getScan(std::size_t i) const {
+    return readScan(this->file_paths.at(i));
+}
+
+ScanView MappedScanReader::readScan(const std::string &file_path) {
+    auto file = std::make_shared<const MappedFile>(file_path);
+    if (endsWith(file_path, ".bin")) {
+        return readKittiScan(std::move(file));
+    } else if (endsWith(file_path, ".pcd")) {
+        return readPcdScan(std::move(file));
+    }
+    throw std::runtime_error{"MappedScanReader: unknown scan format [" +
+                             file_path + "]"};
+}
+
+ScanPrefetcher::ScanPrefetcher(const ScanSource &source,
+                               std::size_t depth,
+                               bool convert)
+    : source(source),
+      depth{std::max<std::size_t>(depth, 1)},
+      convert{convert} {
+    this->worker = std::thread(&ScanPrefetcher::spin, this);
+}
+
+ScanPrefetcher::~ScanPrefetcher() {
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->stop = true;
+    }
+    this->space_condition.notify_all();
+    this->worker.join();
+}
+
+void ScanPrefetcher::spin() {
+    const auto num_scans = this->source.size();
+    for (std::size_t i = 0; i < num_scans; ++i) {
+        {
+            // Wait until the consumer has made room
+            std::unique_lock<std::mutex> lock(this->mutex);
+            while (!this->stop && this->ready.size() >= this->depth) {
+                this->space_condition.wait(lock);
+            }
+            if (this->stop) {
+                return;
+            }
+        }
+
+        // Do the slow work without holding the lock
+        Scan scan;
+        scan.index = i;
+        try {
+            scan.view = this->source.getScan(i);
+            scan.view.touchPages();
+            if (this->convert) {
+                scan.cloud = scan.view.toPointCloud();
+            }
+        } catch (...) {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->error = std::current_exception();
+            lock.unlock();
+            this->ready_condition.notify_one();
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->ready.push(std::move(scan));
+        }
+        this->ready_condition.notify_one();
+    }
+}
+
+bool ScanPrefetcher::next(Scan *scan) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (this->num_returned >= this->source.size()) {
+        return false;
+    }
+    while (this->ready.empty() && !this->error) {
+        this->ready_condition.wait(lock);
+    }
+    if (this->ready.empty()) {
+        std::rethrow_exception(this->error);
+    }
+
+    *scan = std::move(this->ready.front());
+    this->ready.pop();
+    ++(this->num_returned);
+    lock.unlock();
+    this->space_condition.notify_one();
+    return true;
+}
+
+}  // namespace wave
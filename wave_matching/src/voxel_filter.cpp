@@ -0,0 +1,240 @@
+#include "wave/matching/voxel_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
+namespace wave {
+
+namespace {
+
+/** Integer coordinates of a voxel */
+struct VoxelKey {
+    int64_t x, y, z;
+
+    bool operator==(const VoxelKey &other) const noexcept {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+struct VoxelKeyHash {
+    std::size_t operator()(const VoxelKey &k) const noexcept {
+        // Multiply each coordinate by a large odd constant and mix, so nearby
+        // voxels spread over the table
+        uint64_t h = static_cast<uint64_t>(k.x) * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<uint64_t>(k.y) * 0xC2B2AE3D27D4EB4Full;
+        h ^= static_cast<uint64_t>(k.z) * 0x165667B19E3779F9ull;
+        return static_cast<std::size_t>(h ^ (h >> 29));
+    }
+};
+
+/** Accumulated contents of one voxel */
+struct Voxel {
+    double sum[3];
+    uint32_t count;
+    std::size_t first;  ///< index of the first input point in the voxel
+};
+
+using VoxelMap = std::unordered_map<VoxelKey, Voxel, VoxelKeyHash>;
+
+/** Scaled coordinates beyond this cannot be converted to int64_t */
+const float MAX_SCALED_COORD = 4.0e18f;
+
+/** Minimum number of points worth giving to a thread */
+const std::size_t MIN_POINTS_PER_THREAD = 16384;
+
+/** Marks points whose voxel index cannot be represented */
+const int64_t INVALID_INDEX = std::numeric_limits<int64_t>::min();
+
+/** Computes the finest-level voxel key of points [begin, end) of `input` */
+void computeKeys(const pcl::PointCloud<pcl::PointXYZ> &input,
+                 std::size_t begin,
+                 std::size_t end,
+                 float inv_leaf,
+                 std::vector<VoxelKey> &keys) {
+    for (auto i = begin; i < end; ++i) {
+        const auto &p = input.points[i];
+        const float sx = p.x * inv_leaf;
+        const float sy = p.y * inv_leaf;
+        const float sz = p.z * inv_leaf;
+        // These comparisons are also false for NaN
+        if (!(std::abs(sx) < MAX_SCALED_COORD &&
+              std::abs(sy) < MAX_SCALED_COORD &&
+              std::abs(sz) < MAX_SCALED_COORD)) {
+            keys[i].x = INVALID_INDEX;
+            continue;
+        }
+        keys[i] = VoxelKey{static_cast<int64_t>(std::floor(sx)),
+                           static_cast<int64_t>(std::floor(sy)),
+                           static_cast<int64_t>(std::floor(sz))};
+    }
+}
+
+/** Bins every point whose voxel hashes to `shard` into one map per level.
+ *
+ * Each thread owns a disjoint set of voxels, so the maps need no merging.
+ */
+void binPoints(const pcl::PointCloud<pcl::PointXYZ> &input,
+               const std::vector<VoxelKey> &keys,
+               std::size_t shard,
+               std::size_t num_shards,
+               bool accumulate,
+               std::vector<VoxelMap> &maps) {
+    const VoxelKeyHash hash;
+    const auto num_levels = static_cast<int>(maps.size());
+    for (int l = 0; l < num_levels; ++l) {
+        maps[l].reserve(keys.size() / num_shards >> (1 + 2 * l));
+    }
+
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        const auto &key = keys[i];
+        if (key.x == INVALID_INDEX) {
+            continue;
+        }
+        for (int l = 0; l < num_levels; ++l) {
+            // Arithmetic right shift is floor division by 2^l, also for
+            // negative indices, so this is the index at leaf size 2^l * leaf
+            const VoxelKey level_key{key.x >> l, key.y >> l, key.z >> l};
+            if (num_shards > 1 && hash(level_key) % num_shards != shard) {
+                continue;
+            }
+            auto &voxel = maps[l][level_key];
+            if (voxel.count == 0) {
+                voxel.first = i;
+            }
+            ++voxel.count;
+            if (accumulate) {
+                const auto &p = input.points[i];
+                voxel.sum[0] += p.x;
+                voxel.sum[1] += p.y;
+                voxel.sum[2] += p.z;
+            }
+        }
+    }
+}
+
+/** Writes one output point per voxel, ordered by first input point */
+void writeVoxels(const pcl::PointCloud<pcl::PointXYZ> &input,
+                 const std::vector<const VoxelMap *> &shards,
+                 bool centroid,
+                 pcl::PointCloud<pcl::PointXYZ> &output) {
+    std::size_t num_voxels = 0;
+    for (const auto shard : shards) {
+        num_voxels += shard->size();
+    }
+    std::vector<const Voxel *> sorted;
+    sorted.reserve(num_voxels);
+    for (const auto shard : shards) {
+        for (const auto &kv : *shard) {
+            sorted.push_back(&kv.second);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Voxel *a, const Voxel *b) {
+        return a->first < b->first;
+    });
+
+    output.resize(sorted.size());
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        const auto &voxel = *sorted[i];
+        if (centroid) {
+            output.points[i].x = static_cast<float>(voxel.sum[0] / voxel.count);
+            output.points[i].y = static_cast<float>(voxel.sum[1] / voxel.count);
+            output.points[i].z = static_cast<float>(voxel.sum[2] / voxel.count);
+        } else {
+            output.points[i] = input.points[voxel.first];
+        }
+    }
+    output.width = static_cast<uint32_t>(sorted.size());
+    output.height = 1;
+    output.is_dense = true;
+}
+
+}  // namespace
+
+VoxelFilter::VoxelFilter(float leaf_size, Mode mode, int n_threads)
+    : leaf_size{leaf_size}, mode{mode}, n_threads{n_threads} {
+    if (this->n_threads <= 0) {
+        this->n_threads =
+          std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+}
+
+void VoxelFilter::filter(const pcl::PointCloud<pcl::PointXYZ> &input,
+                         pcl::PointCloud<pcl::PointXYZ> &output) const {
+    std::vector<PCLPointCloudPtr> levels{
+      PCLPointCloudPtr{&output, [](pcl::PointCloud<pcl::PointXYZ> *) {}}};
+    this->filterPyramid(input, 1, levels);
+}
+
+void VoxelFilter::filterPyramid(const pcl::PointCloud<pcl::PointXYZ> &input,
+                                int num_levels,
+                                std::vector<PCLPointCloudPtr> &output) const {
+    num_levels = std::max(num_levels, 1);
+    output.resize(num_levels);
+    for (auto &cloud : output) {
+        if (!cloud) {
+            cloud = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
+        }
+    }
+
+    if (this->leaf_size <= 0) {
+        for (auto &cloud : output) {
+            *cloud = input;
+        }
+        return;
+    }
+
+    // Small clouds are not worth the cost of starting threads
+    const auto num_points = input.points.size();
+    const auto num_threads = std::min<std::size_t>(
+      this->n_threads,
+      std::max<std::size_t>(1, num_points / MIN_POINTS_PER_THREAD));
+    const auto chunk = (num_points + num_threads - 1) / num_threads;
+    const float inv_leaf = 1.0f / this->leaf_size;
+    const bool centroid = (this->mode == Mode::CENTROID);
+
+    // Runs f(t) for t in [0, n), on the calling thread and n - 1 others
+    const auto parallelFor = [](std::size_t n,
+                                const std::function<void(std::size_t)> &f) {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 1; t < n; ++t) {
+            workers.emplace_back(f, t);
+        }
+        f(0);
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    };
+
+    // Compute voxel indices over contiguous chunks of the input
+    std::vector<VoxelKey> keys(num_points);
+    parallelFor(num_threads, [&](std::size_t t) {
+        computeKeys(input,
+                    std::min(t * chunk, num_points),
+                    std::min((t + 1) * chunk, num_points),
+                    inv_leaf,
+                    keys);
+    });
+
+    // Accumulate voxels, each thread owning the voxels in one hash shard
+    std::vector<std::vector<VoxelMap>> maps(
+      num_threads, std::vector<VoxelMap>(num_levels));
+    parallelFor(num_threads, [&](std::size_t t) {
+        binPoints(input, keys, t, num_threads, centroid, maps[t]);
+    });
+
+    // Write out each level on its own thread
+    parallelFor(num_levels, [&](std::size_t l) {
+        std::vector<const VoxelMap *> shards;
+        for (const auto &thread_maps : maps) {
+            shards.push_back(&thread_maps[l]);
+        }
+        writeVoxels(input, shards, centroid, *output[l]);
+    });
+}
+
+}  // namespace wave
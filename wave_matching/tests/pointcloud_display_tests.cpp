@@ -45,6 +45,26 @@ TEST(viewer, multiple_clouds_test) {
     display.stopSpin();
 }
 
+TEST(viewer, decimated_stream_test) {
+    // Keep at most 10000 points per cloud, and about three clouds in total
+    const std::size_t max_points = 10000;
+    PointCloudDisplay display(
+      "decimated_stream_test", max_points, 3 * max_points * 16);
+    display.startSpin();
+    PCLPointCloudPtr cloud =
+      boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
+    pcl::io::loadPCDFile(TEST_SCAN, *cloud);
+    Eigen::Affine3f transform(Eigen::Translation3f(Eigen::Vector3f(1, 0, 0)));
+    // Producing faster than the viewer renders must not block; only the
+    // latest cloud of each id is drawn, and old ids are dropped
+    for (int i = 0; i < 200; i++) {
+        pcl::transformPointCloud(*cloud, *cloud, transform);
+        display.addPointcloud(cloud, i / 20, i == 0);
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+    display.stopSpin();
+}
+
 TEST(viewer, line_test) {
     PointCloudDisplay display("line_test");
     display.startSpin();
@@ -0,0 +1,140 @@
+/** Recall and latency of ScanContextIndex retrieval.
+ *
+ * The database holds descriptors of the test scan seen from a grid of places.
+ * Each query revisits a random place with a small offset and a random
+ * heading. The `recall` counter is the fraction of queries whose true place
+ * is among the `k` results (the benchmark argument), and items/s is queries
+ * per second. BM_BruteForceQuery compares the full descriptor against every
+ * place, giving the recall attainable without the ring key search.
+ */
+
+#include <algorithm>
+#include <random>
+#include <benchmark/benchmark.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/common/transforms.h>
+
+#include "wave/matching/scan_context.hpp"
+
+namespace wave {
+
+const auto TEST_SCAN = "tests/data/testscan.pcd";
+const int GRID_SIZE = 21;        // places per side
+const float GRID_SPACING = 4.0;  // metres between places
+const int NUM_QUERIES = 50;
+
+struct Database {
+    ScanContextIndex index;
+    std::vector<ScanContext> queries;
+    std::vector<int> truth;
+
+    Database() {
+        pcl::PointCloud<pcl::PointXYZ> scan, moved;
+        pcl::io::loadPCDFile(TEST_SCAN, scan);
+
+        const auto view = [&](float x, float y, float yaw) {
+            Eigen::Affine3f transform =
+              Eigen::AngleAxisf(yaw, Eigen::Vector3f::UnitZ()) *
+              Eigen::Translation3f(-x, -y, 0);
+            pcl::transformPointCloud(scan, moved, transform);
+            return this->index.describe(moved);
+        };
+        const auto offset = GRID_SPACING * (GRID_SIZE - 1) / 2;
+        const auto coord = [offset](int i) {
+            return i * GRID_SPACING - offset;
+        };
+        for (int i = 0; i < GRID_SIZE; ++i) {
+            for (int j = 0; j < GRID_SIZE; ++j) {
+                this->index.insert(view(coord(i), coord(j), 0));
+            }
+        }
+
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> place(0, GRID_SIZE - 1);
+        std::uniform_real_distribution<float> noise(-0.5, 0.5);
+        std::uniform_real_distribution<float> heading(-M_PI, M_PI);
+        for (int q = 0; q < NUM_QUERIES; ++q) {
+            const auto i = place(gen), j = place(gen);
+            this->queries.push_back(view(
+              coord(i) + noise(gen), coord(j) + noise(gen), heading(gen)));
+            this->truth.push_back(i * GRID_SIZE + j);
+        }
+    }
+};
+
+const Database &database() {
+    static const Database db;
+    return db;
+}
+
+/** Describing a scan, for comparison with the query cost */
+void BM_ScanContextDescribe(benchmark::State &state) {
+    pcl::PointCloud<pcl::PointXYZ> scan;
+    pcl::io::loadPCDFile(TEST_SCAN, scan);
+    const ScanContextIndex index;
+
+    for (auto _ : state) {
+        const auto sc = index.describe(scan);
+        benchmark::DoNotOptimize(sc.desc.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ScanContextQuery(benchmark::State &state) {
+    const auto &db = database();
+    const auto k = static_cast<int>(state.range(0));
+    int hits = 0, total = 0;
+
+    for (auto _ : state) {
+        for (int q = 0; q < NUM_QUERIES; ++q) {
+            const auto candidates = db.index.query(db.queries[q], k);
+            for (const auto &c : candidates) {
+                hits += (c.id == db.truth[q]);
+            }
+            ++total;
+        }
+    }
+    state.SetItemsProcessed(total);
+    state.counters["recall"] = static_cast<double>(hits) / total;
+}
+
+void BM_BruteForceQuery(benchmark::State &state) {
+    const auto &db = database();
+    const auto k = static_cast<std::size_t>(state.range(0));
+    const auto num_places = static_cast<int>(db.index.size());
+    int hits = 0, total = 0;
+
+    for (auto _ : state) {
+        for (int q = 0; q < NUM_QUERIES; ++q) {
+            std::vector<std::pair<double, int>> dists;
+            for (int id = 0; id < num_places; ++id) {
+                dists.emplace_back(
+                  db.index.distance(db.queries[q], db.index.getDescriptor(id)),
+                  id);
+            }
+            std::partial_sort(dists.begin(), dists.begin() + k, dists.end());
+            for (std::size_t i = 0; i < k; ++i) {
+                hits += (dists[i].second == db.truth[q]);
+            }
+            ++total;
+        }
+    }
+    state.SetItemsProcessed(total);
+    state.counters["recall"] = static_cast<double>(hits) / total;
+}
+
+BENCHMARK(BM_ScanContextDescribe)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ScanContextQuery)
+  ->Arg(1)
+  ->Arg(5)
+  ->Arg(10)
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BruteForceQuery)
+  ->Arg(1)
+  ->Arg(5)
+  ->Arg(10)
+  ->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
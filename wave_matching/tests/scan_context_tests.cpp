@@ -0,0 +1,97 @@
+#include <pcl/io/pcd_io.h>
+#include <pcl/common/transforms.h>
+
+#include "wave/wave_test.hpp"
+#include "wave/matching/scan_context.hpp"
+
+namespace wave {
+
+const auto TEST_SCAN = "tests/data/testscan.pcd";
+const auto TEST_CONFIG = "tests/config/scan_context.yaml";
+
+class ScanContextTest : public testing::Test {
+ protected:
+    virtual void SetUp() {
+        this->scan = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
+        pcl::io::loadPCDFile(TEST_SCAN, *(this->scan));
+    }
+
+    /** The test scan as seen from a pose offset by `x` metres and `yaw` */
+    PCLPointCloudPtr moved(double x, double yaw) {
+        Eigen::Affine3f transform =
+          Eigen::AngleAxisf(yaw, Eigen::Vector3f::UnitZ()) *
+          Eigen::Translation3f(-x, 0, 0);
+        auto out = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
+        pcl::transformPointCloud(*(this->scan), *out, transform);
+        return out;
+    }
+
+    PCLPointCloudPtr scan;
+};
+
+TEST(ScanContextParamsTest, loadConfig) {
+    ScanContextParams params{TEST_CONFIG};
+    EXPECT_EQ(20, params.num_rings);
+    EXPECT_EQ(60, params.num_sectors);
+    EXPECT_EQ(50, params.exclude_recent);
+    EXPECT_THROW(ScanContextParams{"tests/config/nonexistent.yaml"},
+                 std::runtime_error);
+}
+
+TEST_F(ScanContextTest, descriptorSize) {
+    ScanContextIndex index;
+    const auto sc = index.describe(*(this->scan));
+    EXPECT_EQ(20, sc.desc.rows());
+    EXPECT_EQ(60, sc.desc.cols());
+    EXPECT_EQ(20, sc.ring_key.size());
+    EXPECT_EQ(60, sc.sector_key.size());
+    EXPECT_GT(sc.desc.maxCoeff(), 0.0f);
+    EXPECT_GE(sc.desc.minCoeff(), 0.0f);
+}
+
+TEST_F(ScanContextTest, rotationInvariant) {
+    ScanContextIndex index;
+    const auto yaw = 0.5;
+    const auto a = index.describe(*(this->moved(0, yaw)));
+    const auto b = index.describe(*(this->scan));
+
+    double est_yaw;
+    EXPECT_LT(index.distance(a, b, &est_yaw), 0.1);
+    // Within one sector
+    EXPECT_NEAR(yaw, est_yaw, 2 * M_PI / 60);
+    // Up to points moving between bins
+    EXPECT_LT((a.ring_key - b.ring_key).norm(), 0.05 * b.ring_key.norm());
+}
+
+TEST_F(ScanContextTest, retrieveRotatedPlace) {
+    ScanContextIndex index;
+    // Distinct places, then the first place revisited facing another way
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(i, index.insert(*(this->moved(25.0 * i, 0))));
+    }
+    const auto revisit = index.describe(*(this->moved(0, -2)));
+    const auto candidates = index.query(revisit, 3);
+
+    ASSERT_EQ(3u, candidates.size());
+    EXPECT_EQ(0, candidates[0].id);
+    EXPECT_NEAR(-2.0, candidates[0].yaw, 2 * M_PI / 60);
+    EXPECT_LE(candidates[0].distance, candidates[1].distance);
+    EXPECT_LE(candidates[1].distance, candidates[2].distance);
+}
+
+TEST_F(ScanContextTest, queryLoopsExcludesRecent) {
+    ScanContextParams params;
+    params.exclude_recent = 2;
+    ScanContextIndex index{params};
+    for (int i = 0; i < 4; ++i) {
+        index.insert(*(this->scan));
+    }
+
+    EXPECT_TRUE(index.queryLoops(1, 5).empty());
+    const auto candidates = index.queryLoops(3, 5);
+    ASSERT_EQ(1u, candidates.size());
+    EXPECT_EQ(0, candidates[0].id);
+    EXPECT_NEAR(0.0, candidates[0].distance, 1e-6);
+}
+
+}  // namespace wave
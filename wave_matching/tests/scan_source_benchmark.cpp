@@ -0,0 +1,77 @@
+/** Compares loading scans through pcl::io with MappedScanReader.
+ *
+ * The items/s counter reported for each benchmark is scans per second.
+ */
+
+#include <benchmark/benchmark.h>
+#include <pcl/io/pcd_io.h>
+
+#include "wave/matching/scan_source.hpp"
+
+namespace wave {
+
+const auto TEST_SCAN = "tests/data/testscan.pcd";
+
+/** Baseline: parse the PCD file into a fresh cloud, as the tests do */
+void BM_PclLoadPCD(benchmark::State &state) {
+    for (auto _ : state) {
+        pcl::PointCloud<pcl::PointXYZ> cloud;
+        pcl::io::loadPCDFile(TEST_SCAN, cloud);
+        benchmark::DoNotOptimize(cloud.points.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** Map the file and read every point through the zero-copy view */
+void BM_MappedView(benchmark::State &state) {
+    for (auto _ : state) {
+        const auto view = MappedScanReader::readScan(TEST_SCAN);
+        float sum = 0;
+        for (std::size_t i = 0; i < view.size(); ++i) {
+            sum += view[i].x;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** Map the file and convert it to a cloud usable by the matchers */
+void BM_MappedToPointCloud(benchmark::State &state) {
+    for (auto _ : state) {
+        const auto view = MappedScanReader::readScan(TEST_SCAN);
+        const auto cloud = view.toPointCloud();
+        benchmark::DoNotOptimize(cloud->points.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** Replay a sequence through the prefetcher, with the read-ahead depth given
+ * by the benchmark argument */
+void BM_PrefetchedSequence(benchmark::State &state) {
+    const auto num_scans = 32;
+    const auto reader =
+      MappedScanReader{std::vector<std::string>(num_scans, TEST_SCAN)};
+
+    for (auto _ : state) {
+        const auto depth = static_cast<std::size_t>(state.range(0));
+        ScanPrefetcher prefetcher{reader, depth};
+        ScanPrefetcher::Scan scan;
+        while (prefetcher.next(&scan)) {
+            benchmark::DoNotOptimize(scan.cloud->points.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * num_scans);
+}
+
+BENCHMARK(BM_PclLoadPCD)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MappedView)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MappedToPointCloud)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PrefetchedSequence)
+  ->RangeMultiplier(2)
+  ->Range(1, 8)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
@@ -0,0 +1,133 @@
+#include <pcl/io/pcd_io.h>
+#include <cstdio>
+#include <fstream>
+
+#include "wave/wave_test.hpp"
+#include "wave/matching/scan_source.hpp"
+
+namespace wave {
+
+const auto TEST_SCAN = "tests/data/testscan.pcd";
+const auto TEST_KITTI_SCAN = "/tmp/wave_scan_source_test.bin";
+
+class ScanSourceTest : public testing::Test {
+ protected:
+    virtual void SetUp() {
+        // Write a small scan in KITTI velodyne format
+        std::ofstream out{TEST_KITTI_SCAN, std::ios::binary};
+        for (int i = 0; i < 100; ++i) {
+            const float point[4] = {1.0f * i, -2.0f * i, 0.5f * i, 0.1f};
+            out.write(reinterpret_cast<const char *>(point), sizeof(point));
+        }
+    }
+
+    virtual void TearDown() {
+        std::remove(TEST_KITTI_SCAN);
+    }
+};
+
+/** Stands in for a MultiMatcher, recording the pairs inserted */
+struct RecordingMatcher {
+    void insert(const int &id,
+                const PCLPointCloudPtr &src,
+                const PCLPointCloudPtr &target) {
+        this->ids.push_back(id);
+        this->sizes.emplace_back(src->size(), target->size());
+    }
+
+    std::vector<int> ids;
+    std::vector<std::pair<std::size_t, std::size_t>> sizes;
+};
+
+TEST_F(ScanSourceTest, readKittiScan) {
+    const auto view = MappedScanReader::readScan(TEST_KITTI_SCAN);
+
+    ASSERT_EQ(100u, view.size());
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FLOAT_EQ(1.0f * i, view[i].x);
+        EXPECT_FLOAT_EQ(-2.0f * i, view[i].y);
+        EXPECT_FLOAT_EQ(0.5f * i, view[i].z);
+    }
+}
+
+TEST_F(ScanSourceTest, readPcdScanMatchesPcl) {
+    pcl::PointCloud<pcl::PointXYZ> expected;
+    pcl::io::loadPCDFile(TEST_SCAN, expected);
+
+    const auto view = MappedScanReader::readScan(TEST_SCAN);
+    const auto cloud = view.toPointCloud();
+
+    ASSERT_EQ(expected.size(), view.size());
+    ASSERT_EQ(expected.size(), cloud->size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].x, cloud->points[i].x);
+        EXPECT_EQ(expected[i].y, cloud->points[i].y);
+        EXPECT_EQ(expected[i].z, cloud->points[i].z);
+    }
+}
+
+TEST_F(ScanSourceTest, viewOutlivesReader) {
+    ScanView view;
+    {
+        MappedScanReader reader{{TEST_KITTI_SCAN}};
+        view = reader.getScan(0);
+    }
+    ASSERT_EQ(100u, view.size());
+    EXPECT_FLOAT_EQ(99.0f, view[99].x);
+}
+
+TEST_F(ScanSourceTest, invalidScans) {
+    MappedScanReader reader{{TEST_KITTI_SCAN}};
+    EXPECT_THROW(reader.getScan(1), std::out_of_range);
+    EXPECT_THROW(MappedScanReader::readScan("tests/config/icp.yaml"),
+                 std::runtime_error);
+    EXPECT_THROW(MappedScanReader::readScan("/tmp/wave_no_such_scan.bin"),
+                 std::runtime_error);
+}
+
+TEST_F(ScanSourceTest, prefetchInOrder) {
+    MappedScanReader reader{
+      {TEST_SCAN, TEST_KITTI_SCAN, TEST_SCAN, TEST_KITTI_SCAN}};
+    ScanPrefetcher prefetcher{reader, 2};
+
+    ScanPrefetcher::Scan scan;
+    for (std::size_t i = 0; i < reader.size(); ++i) {
+        ASSERT_TRUE(prefetcher.next(&scan));
+        EXPECT_EQ(i, scan.index);
+        ASSERT_TRUE(scan.cloud);
+        EXPECT_EQ(scan.view.size(), scan.cloud->size());
+    }
+    EXPECT_FALSE(prefetcher.next(&scan));
+}
+
+TEST_F(ScanSourceTest, prefetchRethrowsErrors) {
+    MappedScanReader reader{{TEST_KITTI_SCAN, "/tmp/wave_no_such_scan.bin"}};
+    ScanPrefetcher prefetcher{reader, 1, false};
+
+    ScanPrefetcher::Scan scan;
+    ASSERT_TRUE(prefetcher.next(&scan));
+    EXPECT_FALSE(scan.cloud);
+    EXPECT_THROW(prefetcher.next(&scan), std::runtime_error);
+}
+
+TEST_F(ScanSourceTest, stopBeforeFinished) {
+    MappedScanReader reader{{TEST_SCAN, TEST_SCAN, TEST_SCAN, TEST_SCAN}};
+    ScanPrefetcher prefetcher{reader, 1};
+    // The destructor must not wait for scans that are never consumed
+}
+
+TEST_F(ScanSourceTest, insertConsecutiveScans) {
+    MappedScanReader reader{{TEST_KITTI_SCAN, TEST_SCAN, TEST_KITTI_SCAN}};
+    ScanPrefetcher prefetcher{reader, 2, false};
+    RecordingMatcher matcher;
+
+    EXPECT_EQ(2, insertConsecutiveScans(prefetcher, matcher));
+    ASSERT_EQ(2u, matcher.ids.size());
+    EXPECT_EQ(0, matcher.ids[0]);
+    EXPECT_EQ(1, matcher.ids[1]);
+    EXPECT_EQ(100u, matcher.sizes[0].first);
+    EXPECT_EQ(matcher.sizes[0].second, matcher.sizes[1].first);
+    EXPECT_EQ(100u, matcher.sizes[1].second);
+}
+
+}  // namespace wave
@@ -0,0 +1,103 @@
+/** Compares pcl::VoxelGrid with VoxelFilter, for single resolutions and for
+ * the multiscale pyramid built by ICPMatcher.
+ *
+ * The items/s counter reported for each benchmark is input points per second.
+ */
+
+#include <benchmark/benchmark.h>
+#include <pcl/io/pcd_io.h>
+
+#include "wave/matching/voxel_filter.hpp"
+
+namespace wave {
+
+const auto TEST_SCAN = "tests/data/testscan.pcd";
+const float LEAF_SIZE = 0.1f;
+const int PYRAMID_LEVELS = 4;
+
+PCLPointCloudPtr loadScan() {
+    auto scan = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
+    pcl::io::loadPCDFile(TEST_SCAN, *scan);
+    return scan;
+}
+
+/** Baseline: one pcl::VoxelGrid pass */
+void BM_PclVoxelGrid(benchmark::State &state) {
+    const auto scan = loadScan();
+    pcl::VoxelGrid<pcl::PointXYZ> filter;
+    filter.setLeafSize(LEAF_SIZE, LEAF_SIZE, LEAF_SIZE);
+    pcl::PointCloud<pcl::PointXYZ> output;
+
+    for (auto _ : state) {
+        filter.setInputCloud(scan);
+        filter.filter(output);
+        benchmark::DoNotOptimize(output.points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scan->size());
+}
+
+/** One VoxelFilter pass, with the number of threads given by the argument */
+void BM_VoxelFilter(benchmark::State &state) {
+    const auto scan = loadScan();
+    const VoxelFilter filter{LEAF_SIZE,
+                             VoxelFilter::Mode::CENTROID,
+                             static_cast<int>(state.range(0))};
+    pcl::PointCloud<pcl::PointXYZ> output;
+
+    for (auto _ : state) {
+        filter.filter(*scan, output);
+        benchmark::DoNotOptimize(output.points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scan->size());
+}
+
+/** Baseline: a multiscale pyramid as one pcl::VoxelGrid pass per level */
+void BM_PclVoxelGridPyramid(benchmark::State &state) {
+    const auto scan = loadScan();
+    pcl::VoxelGrid<pcl::PointXYZ> filter;
+    pcl::PointCloud<pcl::PointXYZ> output;
+
+    for (auto _ : state) {
+        for (int i = 0; i < PYRAMID_LEVELS; ++i) {
+            const float leaf_size = (1 << i) * LEAF_SIZE;
+            filter.setLeafSize(leaf_size, leaf_size, leaf_size);
+            filter.setInputCloud(scan);
+            filter.filter(output);
+            benchmark::DoNotOptimize(output.points.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * scan->size());
+}
+
+/** A multiscale pyramid in a single VoxelFilter pass, with the number of
+ * threads given by the argument */
+void BM_VoxelFilterPyramid(benchmark::State &state) {
+    const auto scan = loadScan();
+    const VoxelFilter filter{LEAF_SIZE,
+                             VoxelFilter::Mode::CENTROID,
+                             static_cast<int>(state.range(0))};
+    std::vector<PCLPointCloudPtr> pyramid;
+
+    for (auto _ : state) {
+        filter.filterPyramid(*scan, PYRAMID_LEVELS, pyramid);
+        benchmark::DoNotOptimize(pyramid[0]->points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scan->size());
+}
+
+BENCHMARK(BM_PclVoxelGrid)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VoxelFilter)
+  ->RangeMultiplier(2)
+  ->Range(1, 8)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(BM_PclVoxelGridPyramid)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VoxelFilterPyramid)
+  ->RangeMultiplier(2)
+  ->Range(1, 8)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
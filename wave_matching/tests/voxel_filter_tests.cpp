@@ -0,0 +1,124 @@
+#include <pcl/io/pcd_io.h>
+#include <cmath>
+
+#include "wave/wave_test.hpp"
+#include "wave/matching/voxel_filter.hpp"
+
+namespace wave {
+
+const auto TEST_SCAN = "tests/data/testscan.pcd";
+
+class VoxelFilterTest : public testing::Test {
+ protected:
+    virtual void SetUp() {
+        this->scan = boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
+        pcl::io::loadPCDFile(TEST_SCAN, *(this->scan));
+
+        // Two points in each of two voxels of size 1, plus an invalid point
+        this->small.push_back(pcl::PointXYZ{0.1f, 0.1f, 0.1f});
+        this->small.push_back(pcl::PointXYZ{-0.5f, 2.5f, 0.5f});
+        this->small.push_back(pcl::PointXYZ{0.3f, 0.5f, 0.9f});
+        this->small.push_back(pcl::PointXYZ{NAN, 0.f, 0.f});
+        this->small.push_back(pcl::PointXYZ{-0.1f, 2.9f, 0.1f});
+    }
+
+    PCLPointCloudPtr scan;
+    pcl::PointCloud<pcl::PointXYZ> small;
+};
+
+TEST_F(VoxelFilterTest, centroid) {
+    VoxelFilter filter{1.0f, VoxelFilter::Mode::CENTROID};
+    pcl::PointCloud<pcl::PointXYZ> output;
+    filter.filter(this->small, output);
+
+    // Output is in order of the first point in each voxel
+    ASSERT_EQ(2u, output.size());
+    EXPECT_FLOAT_EQ(0.2f, output.points[0].x);
+    EXPECT_FLOAT_EQ(0.3f, output.points[0].y);
+    EXPECT_FLOAT_EQ(0.5f, output.points[0].z);
+    EXPECT_FLOAT_EQ(-0.3f, output.points[1].x);
+    EXPECT_FLOAT_EQ(2.7f, output.points[1].y);
+    EXPECT_FLOAT_EQ(0.3f, output.points[1].z);
+}
+
+TEST_F(VoxelFilterTest, firstPoint) {
+    VoxelFilter filter{1.0f, VoxelFilter::Mode::FIRST_POINT};
+    pcl::PointCloud<pcl::PointXYZ> output;
+    filter.filter(this->small, output);
+
+    ASSERT_EQ(2u, output.size());
+    EXPECT_EQ(this->small.points[0].x, output.points[0].x);
+    EXPECT_EQ(this->small.points[1].y, output.points[1].y);
+}
+
+TEST_F(VoxelFilterTest, nonPositiveLeafCopies) {
+    VoxelFilter filter{-1.0f};
+    pcl::PointCloud<pcl::PointXYZ> output;
+    filter.filter(*(this->scan), output);
+    EXPECT_EQ(this->scan->size(), output.size());
+}
+
+TEST_F(VoxelFilterTest, hugeExtent) {
+    // pcl::VoxelGrid refuses this cloud, as the voxel indices overflow int32
+    pcl::PointCloud<pcl::PointXYZ> input;
+    input.push_back(pcl::PointXYZ{-1e6f, 0.f, 0.f});
+    input.push_back(pcl::PointXYZ{1e6f, 0.f, 0.f});
+    input.push_back(pcl::PointXYZ{1e6f + 0.0001f, 0.f, 0.f});
+
+    VoxelFilter filter{0.001f};
+    pcl::PointCloud<pcl::PointXYZ> output;
+    filter.filter(input, output);
+    EXPECT_EQ(2u, output.size());
+}
+
+TEST_F(VoxelFilterTest, resultIndependentOfThreads) {
+    pcl::PointCloud<pcl::PointXYZ> single, multi;
+    VoxelFilter{0.1f, VoxelFilter::Mode::CENTROID, 1}.filter(*(this->scan),
+                                                             single);
+    VoxelFilter{0.1f, VoxelFilter::Mode::CENTROID, 4}.filter(*(this->scan),
+                                                             multi);
+
+    ASSERT_EQ(single.size(), multi.size());
+    for (std::size_t i = 0; i < single.size(); ++i) {
+        EXPECT_NEAR(single.points[i].x, multi.points[i].x, 1e-5);
+        EXPECT_NEAR(single.points[i].y, multi.points[i].y, 1e-5);
+        EXPECT_NEAR(single.points[i].z, multi.points[i].z, 1e-5);
+    }
+}
+
+TEST_F(VoxelFilterTest, pyramidMatchesSeparateFilters) {
+    const int levels = 4;
+    VoxelFilter filter{0.1f};
+    std::vector<PCLPointCloudPtr> pyramid;
+    filter.filterPyramid(*(this->scan), levels, pyramid);
+    ASSERT_EQ(static_cast<std::size_t>(levels), pyramid.size());
+
+    pcl::PointCloud<pcl::PointXYZ> output;
+    filter.filter(*(this->scan), output);
+    ASSERT_EQ(output.size(), pyramid[0]->size());
+
+    for (int i = 1; i < levels; ++i) {
+        // Coarser levels shrink, and differ from filtering at the coarse leaf
+        // size directly only by points rounding across voxel boundaries
+        EXPECT_LT(pyramid[i]->size(), pyramid[i - 1]->size());
+        VoxelFilter coarse{(1 << i) * 0.1f};
+        coarse.filter(*(this->scan), output);
+        EXPECT_NEAR(output.size(), pyramid[i]->size(), 0.01 * output.size());
+    }
+}
+
+TEST_F(VoxelFilterTest, sameVoxelsAsPcl) {
+    pcl::VoxelGrid<pcl::PointXYZ> pcl_filter;
+    pcl_filter.setLeafSize(0.1f, 0.1f, 0.1f);
+    pcl_filter.setInputCloud(this->scan);
+    pcl::PointCloud<pcl::PointXYZ> expected;
+    pcl_filter.filter(expected);
+
+    VoxelFilter filter{0.1f};
+    pcl::PointCloud<pcl::PointXYZ> output;
+    filter.filter(*(this->scan), output);
+
+    EXPECT_EQ(expected.size(), output.size());
+}
+
+}  // namespace wave
@@ -1,6 +1,8 @@
 #ifndef WAVE_OPTIMIZATION_CERES_BA_HPP
 #define WAVE_OPTIMIZATION_CERES_BA_HPP
 
+#include <memory>
+#include <set>
 #include <typeinfo>
 
 #include <ceres/ceres.h>
@@ -92,21 +94,149 @@ struct BAResidual {
     }
 };
 
+/** Quaternion parameterization for use with BAAnalyticResidual.
+ *
+ * The quaternion (x, y, z, w) is perturbed on the right, as
+ * `q * Exp(delta)`, so `delta` is a rotation vector in the rotated (camera)
+ * frame, matching the Jacobians of pinholeProject().
+ *
+ * ComputeJacobian() gives the derivative of Plus() with respect to `delta`,
+ * so any cost function with Jacobians with respect to the quaternion
+ * coefficients may use it.
+ */
+class BAQuaternionParameterization : public ceres::LocalParameterization {
+ public:
+    bool Plus(const double *x,
+              const double *delta,
+              double *x_plus_delta) const override;
+    bool ComputeJacobian(const double *x, double *jacobian) const override;
+    int GlobalSize() const override {
+        return 4;
+    }
+    int LocalSize() const override {
+        return 3;
+    }
+
+    /** Returns the derivative of Plus() at `x` with respect to `delta`, at
+     * `delta = 0` */
+    static Eigen::Matrix<double, 4, 3> plusJacobian(const double *x);
+
+    /** Returns the derivative with respect to `y`, at `y = x`, of the
+     * rotation vector of `x^-1 * y` to first order.
+     *
+     * For a unit quaternion, its product with plusJacobian() is the identity,
+     * so a cost function's Jacobian with respect to `delta` times this matrix
+     * is a Jacobian with respect to the quaternion which gives back the
+     * original through the parameterization.
+     */
+    static Eigen::Matrix<double, 3, 4> minusJacobian(const double *x);
+};
+
+/** Bundle Adjustment residual with analytic Jacobians.
+ *
+ * Computes the same residual as BAResidual, but evaluates the Jacobians
+ * directly with pinholeProject() instead of through automatic
+ * differentiation. The camera intrinsics are shared between all residuals of
+ * a camera rather than copied into each one.
+ *
+ * The parameter blocks are the same as BAResidual's: the camera quaternion
+ * (x, y, z, w), the camera position, and the landmark position. The
+ * quaternion block must use BAQuaternionParameterization.
+ */
+class BAAnalyticResidual : public ceres::SizedCostFunction<2, 4, 3, 3> {
+ public:
+    BAAnalyticResidual(std::shared_ptr<const Mat3> K, const Vec2 &measurement)
+        : K{std::move(K)}, measurement{measurement} {}
+
+    bool Evaluate(double const *const *parameters,
+                  double *residuals,
+                  double **jacobians) const override;
+
+    /** Camera intrinsics, shared with the other residuals of the camera */
+    std::shared_ptr<const Mat3> K;
+
+    /** Measured feature position in the image, in pixels */
+    Vec2 measurement;
+};
+
+/** Robust loss functions for BundleAdjustment */
+enum class BALoss { None, Huber, Cauchy };
+
+struct BundleAdjustmentParams {
+    /** Use BAAnalyticResidual. If false, use the autodiff BAResidual. */
+    bool analytic_jacobians = true;
+
+    /** Robust loss applied to every residual */
+    BALoss loss = BALoss::None;
+
+    /** Scale of the robust loss, in pixels. Residuals below this are treated
+     * as inliers. */
+    double loss_scale = 1.0;
+
+    /** Number of threads used to evaluate residuals and solve. */
+    int num_threads = 8;
+
+    /** Maximum number of solver iterations */
+    int max_num_iterations = 200;
+
+    /** Print solver progress and the full report to stdout */
+    bool verbose = true;
+
+    BundleAdjustmentParams() {}
+
+    BundleAdjustmentParams(bool analytic_jacobians,
+                           BALoss loss,
+                           double loss_scale,
+                           int num_threads)
+        : analytic_jacobians{analytic_jacobians},
+          loss{loss},
+          loss_scale{loss_scale},
+          num_threads{num_threads} {}
+};
+
 class BundleAdjustment {
  public:
     ceres::Problem problem;
     ceres::Solver::Options options;
     ceres::Solver::Summary summary;
+    BundleAdjustmentParams params;
 
     BundleAdjustment() {}
 
+    explicit BundleAdjustment(const BundleAdjustmentParams &params)
+        : params{params} {}
+
+    /** Adds a residual for each feature observed by a camera.
+     *
+     * The parameters `cam_t` and `cam_q`, and the landmarks, are optimized
+     * in place, so must not move until solve() returns.
+     *
+     * @param K camera intrinsics, shared by all the camera's residuals
+     * @param features observed features, one (x, y) per row
+     * @param landmark_ids id of the landmark of each feature
+     * @param cam_t camera position in the world frame
+     * @param cam_q camera orientation, as a quaternion (x, y, z, w)
+     * @param landmarks landmark position estimates
+     */
     int addCamera(const Mat3 &K,
                   const MatX &features,
                   const std::vector<LandmarkId> &landmark_ids,
                   double *cam_t,
                   double *cam_q,
                   LandmarkMap &landmarks);
+
+    /** Solves the problem, eliminating landmarks first with the Schur
+     * complement. */
     int solve();
+
+ private:
+    /** Returns the loss function to use, or nullptr for none. The problem
+     * takes ownership of the first one returned. */
+    ceres::LossFunction *lossFunction();
+
+    ceres::LossFunction *loss_function = nullptr;
+    std::set<double *> landmark_blocks;
+    std::set<double *> camera_blocks;
 };
 
 }  // namespace wave
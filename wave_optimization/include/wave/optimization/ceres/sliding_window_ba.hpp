@@ -0,0 +1,205 @@
+#ifndef WAVE_OPTIMIZATION_CERES_SLIDING_WINDOW_BA_HPP
+#define WAVE_OPTIMIZATION_CERES_SLIDING_WINDOW_BA_HPP
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <ceres/ceres.h>
+
+#include "wave/utils/utils.hpp"
+#include "wave/containers/landmark_measurement_container.hpp"
+#include "wave/vision/dataset/VoDataset.hpp"
+#include "wave/optimization/ceres/ba.hpp"
+
+namespace wave {
+
+/** Dense linear prior left by marginalizing states out of a sliding window.
+ *
+ * The prior is a linearization of the marginalized residuals about the
+ * estimates `x0` the kept variables had at the time. Its residual is
+ * `J * dx + r0`, where `dx` stacks the local difference of each variable from
+ * its linearization point. Each variable is a 3-vector, or a quaternion
+ * (x, y, z, w) whose local difference is a rotation vector on the right, as
+ * for BAQuaternionParameterization.
+ */
+class BAMarginalizationPrior : public ceres::CostFunction {
+ public:
+    struct Variable {
+        /** Parameter block, of 4 values if a quaternion, otherwise 3 */
+        double *block;
+        bool is_quaternion;
+        /** Linearization point */
+        Vec4 x0;
+    };
+
+    BAMarginalizationPrior(std::vector<Variable> variables,
+                           const MatX &J,
+                           const VecX &r0);
+
+    bool Evaluate(double const *const *parameters,
+                  double *residuals,
+                  double **jacobians) const override;
+
+    /** Local difference of a variable from its linearization point */
+    static Vec3 localDifference(const Variable &variable, const double *x);
+
+    std::vector<Variable> variables;
+    MatX J;
+    VecX r0;
+};
+
+struct SlidingWindowBAParams {
+    /** Number of keyframes optimized together. Older keyframes are
+     * marginalized. */
+    int window_size = 10;
+
+    /** Maximum number of solver iterations per solve() */
+    int max_num_iterations = 10;
+
+    /** Number of threads used to evaluate residuals and solve */
+    int num_threads = 1;
+
+    /** Robust loss applied to every reprojection residual */
+    BALoss loss = BALoss::None;
+
+    /** Scale of the robust loss, in pixels */
+    double loss_scale = 1.0;
+
+    /** Square root information of the prior holding the first keyframe's
+     * pose and the second keyframe's position at their initial estimates.
+     * This fixes the gauge freedom, including the scale, which monocular
+     * observations alone cannot. */
+    double gauge_prior = 1e4;
+
+    SlidingWindowBAParams() {}
+
+    SlidingWindowBAParams(int window_size,
+                          int max_num_iterations,
+                          int num_threads)
+        : window_size{window_size},
+          max_num_iterations{max_num_iterations},
+          num_threads{num_threads} {}
+};
+
+/** Local bundle adjustment over a sliding window of camera keyframes.
+ *
+ * Only the latest `window_size` keyframes, and the landmarks they observe,
+ * are optimized. When a keyframe leaves the window it is marginalized: its
+ * reprojection residuals, and those of landmarks no longer observed in the
+ * window, are folded into a BAMarginalizationPrior on the remaining states
+ * rather than dropped. The size of each solve is therefore bounded by the
+ * window, however long the sequence.
+ *
+ * Landmarks are only optimized once an initial estimate is given with
+ * addLandmark(), and once observed by at least two keyframes in the window
+ * (or constrained by the prior). Other observations are kept until then.
+ *
+ * Robust losses apply to the reprojection residuals during solve(); the prior
+ * is formed from the residuals without the loss.
+ */
+class SlidingWindowBA {
+ public:
+    /** A keyframe pose estimate and the landmarks observed in it */
+    struct Keyframe {
+        Quaternion q_GC;
+        Vec3 G_p_GC;
+        std::vector<LandmarkObservation> observations;
+    };
+
+    explicit SlidingWindowBA(
+      const Mat3 &K,
+      const SlidingWindowBAParams &params = SlidingWindowBAParams{});
+
+    /** Sets the estimate of a landmark, if it has none already */
+    void addLandmark(LandmarkId id, const Vec3 &G_p_GF);
+
+    /** Adds a keyframe observing the given landmarks, marginalizing the oldest
+     * keyframe if the window is full.
+     *
+     * The initial estimates of the first two keyframes set the gauge, so
+     * should be accurate.
+     *
+     * @param q_GC initial estimate of the camera orientation
+     * @param G_p_GC initial estimate of the camera position
+     */
+    void addKeyframe(const Quaternion &q_GC,
+                     const Vec3 &G_p_GC,
+                     std::vector<LandmarkObservation> observations);
+
+    /** Adds a keyframe at time `t`, with the measurements from `sensor` in
+     * the container at that time.
+     *
+     * @tparam ContainerType a LandmarkMeasurementContainer
+     */
+    template <typename ContainerType>
+    void addKeyframe(
+      const Quaternion &q_GC,
+      const Vec3 &G_p_GC,
+      const ContainerType &measurements,
+      const typename ContainerType::TimeType &t,
+      const typename ContainerType::SensorIdType &sensor);
+
+    /** Optimizes the keyframes and landmarks in the window */
+    void solve();
+
+    /** Returns the keyframes in the window, oldest first */
+    const std::deque<Keyframe> &keyframes() const {
+        return this->window;
+    }
+
+    /** Returns the landmark estimates */
+    const LandmarkMap &landmarks() const {
+        return this->landmark_estimates;
+    }
+
+    /** Summary of the last solve() */
+    ceres::Solver::Summary summary;
+
+ private:
+    /** Adds the gauge prior on the first two keyframes */
+    void addGaugePrior(Keyframe &keyframe);
+
+    /** Marginalizes the oldest keyframe into the prior */
+    void marginalizeOldest();
+
+    /** Counts the keyframes, from the `first`th, observing each landmark */
+    std::map<LandmarkId, int> countObservations(std::size_t first) const;
+
+    /** True if observations of the landmark should be used, given the counts
+     * of its observations in the window */
+    bool isActive(LandmarkId id,
+                  const std::map<LandmarkId, int> &counts) const;
+
+    Mat3 K;
+    SlidingWindowBAParams params;
+    std::deque<Keyframe> window;
+    std::size_t num_keyframes = 0;
+    LandmarkMap landmark_estimates;
+    std::unique_ptr<BAMarginalizationPrior> prior;
+
+    /** Landmarks with a variable in the prior */
+    std::set<LandmarkId> prior_landmarks;
+};
+
+template <typename ContainerType>
+void SlidingWindowBA::addKeyframe(
+  const Quaternion &q_GC,
+  const Vec3 &G_p_GC,
+  const ContainerType &measurements,
+  const typename ContainerType::TimeType &t,
+  const typename ContainerType::SensorIdType &sensor) {
+    std::vector<LandmarkObservation> observations;
+    const auto range = measurements.getTimeWindow(t, t);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->sensor_id == sensor) {
+            observations.emplace_back(it->landmark_id, it->value);
+        }
+    }
+    this->addKeyframe(q_GC, G_p_GC, std::move(observations));
+}
+
+}  // namespace wave
+#endif
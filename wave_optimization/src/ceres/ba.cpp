@@ -2,59 +2,196 @@
 
 namespace wave {
 
+bool BAQuaternionParameterization::Plus(const double *x,
+                                        const double *delta,
+                                        double *x_plus_delta) const {
+    Eigen::Map<const Quaternion> q{x};
+    Eigen::Map<const Vec3> d{delta};
+    Eigen::Map<Quaternion> result{x_plus_delta};
+
+    const double angle = d.norm();
+    if (angle > 0.0) {
+        result = q * Quaternion{Eigen::AngleAxisd{angle, d / angle}};
+    } else {
+        result = q;
+    }
+    return true;
+}
+
+bool BAQuaternionParameterization::ComputeJacobian(const double *x,
+                                                   double *jacobian) const {
+    // Ceres expects a row-major 4x3 Jacobian
+    Eigen::Map<Eigen::Matrix<double, 4, 3, Eigen::RowMajor>>{jacobian} =
+      plusJacobian(x);
+    return true;
+}
+
+Eigen::Matrix<double, 4, 3> BAQuaternionParameterization::plusJacobian(
+  const double *x) {
+    // q * (delta / 2, 1) to first order, for q = (v, w)
+    const Eigen::Map<const Quaternion> q{x};
+    const Vec3 v = q.vec();
+    Mat3 v_skew;
+    v_skew << 0, -v(2), v(1),  //
+      v(2), 0, -v(0),          //
+      -v(1), v(0), 0;          //
+
+    Eigen::Matrix<double, 4, 3> J;
+    J.topRows<3>() = 0.5 * (q.w() * Mat3::Identity() + v_skew);
+    J.bottomRows<1>() = -0.5 * v.transpose();
+    return J;
+}
+
+Eigen::Matrix<double, 3, 4> BAQuaternionParameterization::minusJacobian(
+  const double *x) {
+    // 2 * vec(x^-1 * y) is linear in y. For a unit quaternion this is
+    // 4 * plusJacobian(x)^T.
+    return 4.0 * plusJacobian(x).transpose();
+}
+
+bool BAAnalyticResidual::Evaluate(double const *const *parameters,
+                                  double *residuals,
+                                  double **jacobians) const {
+    Eigen::Map<const Quaternion> q_GC{parameters[0]};
+    Eigen::Map<const Vec3> G_p_GC{parameters[1]};
+    Eigen::Map<const Vec3> G_p_GF{parameters[2]};
+    Eigen::Map<Vec2> residual{residuals};
+
+    const bool want_jacobians = jacobians != nullptr &&
+                                (jacobians[0] != nullptr ||
+                                 jacobians[1] != nullptr ||
+                                 jacobians[2] != nullptr);
+    Vec2 est_pixel;
+    Eigen::Matrix<double, 2, 6> J_pose;
+    Eigen::Matrix<double, 2, 3> J_point;
+    pinholeProject(*this->K,
+                   q_GC.matrix(),
+                   G_p_GC,
+                   G_p_GF,
+                   est_pixel,
+                   want_jacobians ? &J_pose : nullptr,
+                   want_jacobians ? &J_point : nullptr);
+    residual = this->measurement - est_pixel;
+
+    if (!want_jacobians) {
+        return true;
+    }
+
+    // The residual is the negated measurement, so negate the Jacobians.
+    // Ceres expects row-major Jacobians.
+    using RowMajor23 = Eigen::Matrix<double, 2, 3, Eigen::RowMajor>;
+    if (jacobians[0] != nullptr) {
+        // pinholeProject() differentiates with respect to a right rotation
+        // perturbation, so map that to the quaternion coefficients
+        Eigen::Map<Eigen::Matrix<double, 2, 4, Eigen::RowMajor>>{
+          jacobians[0]} = -J_pose.leftCols<3>() *
+                          BAQuaternionParameterization::minusJacobian(
+                            parameters[0]);
+    }
+    if (jacobians[1] != nullptr) {
+        Eigen::Map<RowMajor23>{jacobians[1]} = -J_pose.rightCols<3>();
+    }
+    if (jacobians[2] != nullptr) {
+        Eigen::Map<RowMajor23>{jacobians[2]} = -J_point;
+    }
+    return true;
+}
+
+ceres::LossFunction *BundleAdjustment::lossFunction() {
+    if (this->loss_function == nullptr) {
+        switch (this->params.loss) {
+            case BALoss::Huber:
+                this->loss_function =
+                  new ceres::HuberLoss(this->params.loss_scale);
+                break;
+            case BALoss::Cauchy:
+                this->loss_function =
+                  new ceres::CauchyLoss(this->params.loss_scale);
+                break;
+            case BALoss::None: break;
+        }
+    }
+    return this->loss_function;
+}
+
 int BundleAdjustment::addCamera(const Mat3 &K,
                                 const MatX &features,
                                 const std::vector<LandmarkId> &landmark_ids,
                                 double *cam_t,
                                 double *cam_q,
                                 LandmarkMap &landmarks) {
+    const auto shared_K = std::make_shared<const Mat3>(K);
+
     // create a residual block for each image feature
     for (int i = 0; i < features.rows(); i++) {
-        // build residual
         Vec2 feature{features(i, 0), features(i, 1)};
-        auto residual = new BAResidual(K, feature);
 
         // build cost function
-        auto cost_func = new ceres::AutoDiffCostFunction<
-          BAResidual,  // Residual type
-          2,           // size of residual
-          4,           // size of 1st parameter - quaternion
-          3,           // size of 2nd parameter - camera center (x, y, z)
-          3            // size of 3rd parameter - 3d point in world (x, y, z)
-          >(residual);
+        ceres::CostFunction *cost_func;
+        if (this->params.analytic_jacobians) {
+            cost_func = new BAAnalyticResidual(shared_K, feature);
+        } else {
+            cost_func = new ceres::AutoDiffCostFunction<
+              BAResidual,  // Residual type
+              2,           // size of residual
+              4,           // size of 1st parameter - quaternion
+              3,           // size of 2nd parameter - camera center (x, y, z)
+              3            // size of 3rd parameter - 3d point in world
+              >(new BAResidual(K, feature));
+        }
 
         // add residual block to problem
-        this->problem.AddResidualBlock(
-          cost_func,                              // cost function
-          NULL,                                   // loss function
-          cam_q,                                  // camera quaternion
-          cam_t,                                  // camera translation
-          landmarks.at(landmark_ids[i]).data());  // landmark
+        double *landmark = landmarks.at(landmark_ids[i]).data();
+        this->problem.AddResidualBlock(cost_func,             // cost function
+                                       this->lossFunction(),  // loss function
+                                       cam_q,      // camera quaternion
+                                       cam_t,      // camera translation
+                                       landmark);  // landmark
+        this->landmark_blocks.insert(landmark);
     }
 
     // add quaternion local parameterization
-    ceres::LocalParameterization *quat_param;
-    quat_param = new ceres::EigenQuaternionParameterization();
-    this->problem.SetParameterization(cam_q, quat_param);
+    if (this->camera_blocks.insert(cam_q).second) {
+        ceres::LocalParameterization *quat_param;
+        if (this->params.analytic_jacobians) {
+            quat_param = new BAQuaternionParameterization();
+        } else {
+            quat_param = new ceres::EigenQuaternionParameterization();
+        }
+        this->problem.SetParameterization(cam_q, quat_param);
+    }
+    this->camera_blocks.insert(cam_t);
 
     return 0;
 }
 
 int BundleAdjustment::solve() {
     // set options
-    this->options.max_num_iterations = 200;
+    this->options.max_num_iterations = this->params.max_num_iterations;
     this->options.use_nonmonotonic_steps = false;
     this->options.use_inner_iterations = true;
     this->options.preconditioner_type = ceres::SCHUR_JACOBI;
     this->options.linear_solver_type = ceres::SPARSE_SCHUR;
     this->options.parameter_tolerance = 1e-10;
-    this->options.num_threads = 8;
-    this->options.num_linear_solver_threads = 8;
-    this->options.minimizer_progress_to_stdout = true;
+    this->options.num_threads = this->params.num_threads;
+    this->options.num_linear_solver_threads = this->params.num_threads;
+    this->options.minimizer_progress_to_stdout = this->params.verbose;
+
+    // eliminate the landmarks first, leaving a reduced camera system
+    auto ordering = new ceres::ParameterBlockOrdering;
+    for (const auto block : this->landmark_blocks) {
+        ordering->AddElementToGroup(block, 0);
+    }
+    for (const auto block : this->camera_blocks) {
+        ordering->AddElementToGroup(block, 1);
+    }
+    this->options.linear_solver_ordering.reset(ordering);
 
     // solve
     ceres::Solve(this->options, &this->problem, &this->summary);
-    std::cout << summary.FullReport() << "\n";
+    if (this->params.verbose) {
+        std::cout << summary.FullReport() << "\n";
+    }
 
     return 0;
 }
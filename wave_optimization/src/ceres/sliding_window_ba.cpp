@@ -0,0 +1,425 @@
+#include "wave/optimization/ceres/sliding_window_ba.hpp"
+
+#include <stdexcept>
+
+namespace wave {
+
+namespace {
+
+// Eigenvalues of the marginalized information below this are treated as
+// unobservable directions, and dropped from the prior
+const double MARGINALIZATION_EPS = 1e-8;
+
+/** Linearized residual and Jacobians with respect to a set of variables */
+struct LinearizedResidual {
+    VecX r;
+    /** Jacobian with respect to each variable, with the variable's index */
+    std::vector<std::pair<int, MatX>> J;
+};
+
+}  // namespace
+
+BAMarginalizationPrior::BAMarginalizationPrior(std::vector<Variable> variables,
+                                               const MatX &J,
+                                               const VecX &r0)
+    : variables{std::move(variables)}, J{J}, r0{r0} {
+    this->set_num_residuals(this->J.rows());
+    for (const auto &variable : this->variables) {
+        this->mutable_parameter_block_sizes()->push_back(
+          variable.is_quaternion ? 4 : 3);
+    }
+}
+
+Vec3 BAMarginalizationPrior::localDifference(const Variable &variable,
+                                             const double *x) {
+    if (!variable.is_quaternion) {
+        return Eigen::Map<const Vec3>{x} - variable.x0.head<3>();
+    }
+
+    // Rotation vector of q0^-1 * q, to first order
+    Eigen::Map<const Quaternion> q{x};
+    Eigen::Map<const Quaternion> q0{variable.x0.data()};
+    const Quaternion dq = q0.conjugate() * q;
+    return (dq.w() >= 0 ? 2.0 : -2.0) * dq.vec();
+}
+
+bool BAMarginalizationPrior::Evaluate(double const *const *parameters,
+                                      double *residuals,
+                                      double **jacobians) const {
+    const int n = this->variables.size();
+    VecX dx(3 * n);
+    for (int i = 0; i < n; ++i) {
+        dx.segment<3>(3 * i) =
+          localDifference(this->variables[i], parameters[i]);
+    }
+
+    Eigen::Map<VecX> residual{residuals, this->num_residuals()};
+    residual = this->J * dx + this->r0;
+
+    if (jacobians == nullptr) {
+        return true;
+    }
+
+    using RowMajorMat =
+      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    for (int i = 0; i < n; ++i) {
+        if (jacobians[i] == nullptr) {
+            continue;
+        }
+        const auto &variable = this->variables[i];
+        if (!variable.is_quaternion) {
+            Eigen::Map<RowMajorMat>{jacobians[i], this->num_residuals(), 3} =
+              this->J.middleCols<3>(3 * i);
+            continue;
+        }
+
+        // The local difference is linear in q, with the sign of the scalar
+        // part of q0^-1 * q
+        Eigen::Map<const Quaternion> q{parameters[i]};
+        Eigen::Map<const Quaternion> q0{variable.x0.data()};
+        const double sign = (q0.conjugate() * q).w() >= 0 ? 1.0 : -1.0;
+        Eigen::Map<RowMajorMat>{jacobians[i], this->num_residuals(), 4} =
+          sign * this->J.middleCols<3>(3 * i) *
+          BAQuaternionParameterization::minusJacobian(variable.x0.data());
+    }
+    return true;
+}
+
+SlidingWindowBA::SlidingWindowBA(const Mat3 &K,
+                                 const SlidingWindowBAParams &params)
+    : K{K}, params{params} {
+    if (params.window_size < 2) {
+        throw std::invalid_argument(
+          "SlidingWindowBA: window_size must be at least 2");
+    }
+}
+
+void SlidingWindowBA::addLandmark(LandmarkId id, const Vec3 &G_p_GF) {
+    this->landmark_estimates.emplace(id, G_p_GF);
+}
+
+void SlidingWindowBA::addKeyframe(
+  const Quaternion &q_GC,
+  const Vec3 &G_p_GC,
+  std::vector<LandmarkObservation> observations) {
+    this->window.push_back(Keyframe{q_GC, G_p_GC, std::move(observations)});
+    if (this->num_keyframes < 2) {
+        this->addGaugePrior(this->window.back());
+    }
+    ++this->num_keyframes;
+
+    if (this->window.size() > static_cast<size_t>(this->params.window_size)) {
+        this->marginalizeOldest();
+    }
+}
+
+void SlidingWindowBA::addGaugePrior(Keyframe &keyframe) {
+    // Hold the first keyframe's pose, and the second's position, which sets
+    // the scale. Nothing has been marginalized yet, so the prior holds only
+    // these terms.
+    using Variable = BAMarginalizationPrior::Variable;
+    std::vector<Variable> variables;
+    if (this->prior) {
+        variables = this->prior->variables;
+    } else {
+        variables.push_back(Variable{
+          keyframe.q_GC.coeffs().data(), true, keyframe.q_GC.coeffs()});
+    }
+    variables.push_back(
+      Variable{keyframe.G_p_GC.data(), false, Vec4::Zero()});
+    variables.back().x0.head<3>() = keyframe.G_p_GC;
+
+    const int size = 3 * variables.size();
+    this->prior.reset(new BAMarginalizationPrior(
+      std::move(variables),
+      this->params.gauge_prior * MatX::Identity(size, size),
+      VecX::Zero(size)));
+}
+
+std::map<LandmarkId, int> SlidingWindowBA::countObservations(
+  std::size_t first) const {
+    std::map<LandmarkId, int> counts;
+    for (auto i = first; i < this->window.size(); ++i) {
+        for (const auto &observation : this->window[i].observations) {
+            ++counts[observation.first];
+        }
+    }
+    return counts;
+}
+
+bool SlidingWindowBA::isActive(LandmarkId id,
+                               const std::map<LandmarkId, int> &counts) const {
+    if (this->landmark_estimates.count(id) == 0) {
+        return false;
+    }
+    const auto count = counts.find(id);
+    if (count != counts.end() && count->second >= 2) {
+        return true;
+    }
+
+    // A landmark in the prior is constrained by it
+    return this->prior_landmarks.count(id) > 0;
+}
+
+void SlidingWindowBA::marginalizeOldest() {
+    using Variable = BAMarginalizationPrior::Variable;
+    auto &oldest = this->window.front();
+    const auto counts = this->countObservations(0);
+    const auto remaining_counts = this->countObservations(1);
+
+    // Collect the variables touched by the marginalized residuals: the oldest
+    // pose, the landmarks it observes, and everything in the current prior.
+    // Those not observed by the remaining keyframes are marginalized.
+    std::vector<Variable> variables;
+    std::vector<bool> marginalize;
+    std::map<const double *, int> index;
+    const auto addVariable = [&](double *block,
+                                 bool is_quaternion,
+                                 bool marginalized) {
+        auto inserted = index.emplace(block, variables.size());
+        if (inserted.second) {
+            Variable variable{block, is_quaternion, Vec4::Zero()};
+            variable.x0.head(is_quaternion ? 4 : 3) =
+              Eigen::Map<const VecX>{block, is_quaternion ? 4 : 3};
+            variables.push_back(variable);
+            marginalize.push_back(marginalized);
+        }
+        return inserted.first->second;
+    };
+    const auto isRemaining = [&remaining_counts](LandmarkId id) {
+        return remaining_counts.count(id) > 0;
+    };
+
+    // Landmark of each landmark block, to find which landmarks are kept
+    std::map<const double *, LandmarkId> landmark_blocks;
+    for (const auto id : this->prior_landmarks) {
+        landmark_blocks.emplace(this->landmark_estimates.at(id).data(),
+                                      id);
+    }
+
+    const int q_index = addVariable(oldest.q_GC.coeffs().data(), true, true);
+    const int p_index = addVariable(oldest.G_p_GC.data(), false, true);
+
+    std::vector<LinearizedResidual> residuals;
+    const auto shared_K = std::make_shared<const Mat3>(this->K);
+    for (const auto &observation : oldest.observations) {
+        if (!this->isActive(observation.first, counts)) {
+            continue;
+        }
+        auto &G_p_GF = this->landmark_estimates.at(observation.first);
+        landmark_blocks.emplace(G_p_GF.data(), observation.first);
+        const int f_index = addVariable(
+          G_p_GF.data(), false, !isRemaining(observation.first));
+
+        BAAnalyticResidual cost{shared_K, observation.second};
+        const double *parameters[3] = {
+          oldest.q_GC.coeffs().data(), oldest.G_p_GC.data(), G_p_GF.data()};
+        Eigen::Matrix<double, 2, 4, Eigen::RowMajor> J_q;
+        Eigen::Matrix<double, 2, 3, Eigen::RowMajor> J_p, J_f;
+        double *jacobians[3] = {J_q.data(), J_p.data(), J_f.data()};
+        LinearizedResidual linearized;
+        linearized.r.resize(2);
+        cost.Evaluate(parameters, linearized.r.data(), jacobians);
+        linearized.J.emplace_back(
+          q_index,
+          J_q * BAQuaternionParameterization::plusJacobian(parameters[0]));
+        linearized.J.emplace_back(p_index, J_p);
+        linearized.J.emplace_back(f_index, J_f);
+        residuals.push_back(std::move(linearized));
+    }
+
+    if (this->prior) {
+        std::vector<int> prior_index;
+        for (const auto &variable : this->prior->variables) {
+            // Poses in the prior other than the oldest remain in the window
+            const auto landmark = landmark_blocks.find(variable.block);
+            const bool marginalized =
+              landmark != landmark_blocks.end() &&
+              !isRemaining(landmark->second);
+            prior_index.push_back(addVariable(
+              variable.block, variable.is_quaternion, marginalized));
+        }
+
+        // Evaluate the prior at the current estimates
+        const int m = this->prior->num_residuals();
+        const int n = this->prior->variables.size();
+        std::vector<const double *> parameters;
+        std::vector<MatX> jacobian_storage;
+        std::vector<double *> jacobians;
+        for (const auto &variable : this->prior->variables) {
+            parameters.push_back(variable.block);
+            jacobian_storage.emplace_back(
+              variable.is_quaternion ? 4 : 3, m);  // transposed, row-major
+        }
+        for (auto &storage : jacobian_storage) {
+            jacobians.push_back(storage.data());
+        }
+        LinearizedResidual linearized;
+        linearized.r.resize(m);
+        this->prior->Evaluate(
+          parameters.data(), linearized.r.data(), jacobians.data());
+        for (int i = 0; i < n; ++i) {
+            MatX J_i = jacobian_storage[i].transpose();
+            if (this->prior->variables[i].is_quaternion) {
+                J_i *= BAQuaternionParameterization::plusJacobian(
+                  parameters[i]);
+            }
+            linearized.J.emplace_back(prior_index[i], J_i);
+        }
+        residuals.push_back(std::move(linearized));
+    }
+
+    // Order the marginalized variables first, and accumulate the normal
+    // equations H dx = -b
+    std::vector<int> order(variables.size());
+    int num_marginalized = 0;
+    for (size_t i = 0; i < variables.size(); ++i) {
+        if (marginalize[i]) {
+            order[i] = num_marginalized++;
+        }
+    }
+    int next = num_marginalized;
+    for (size_t i = 0; i < variables.size(); ++i) {
+        if (!marginalize[i]) {
+            order[i] = next++;
+        }
+    }
+
+    const int size = 3 * variables.size();
+    MatX H = MatX::Zero(size, size);
+    VecX b = VecX::Zero(size);
+    for (const auto &linearized : residuals) {
+        for (const auto &J_i : linearized.J) {
+            const int row = 3 * order[J_i.first];
+            b.segment<3>(row) += J_i.second.transpose() * linearized.r;
+            for (const auto &J_j : linearized.J) {
+                const int col = 3 * order[J_j.first];
+                H.block<3, 3>(row, col) += J_i.second.transpose() * J_j.second;
+            }
+        }
+    }
+
+    // Schur complement onto the kept variables
+    const int m = 3 * num_marginalized;
+    const int k = size - m;
+    std::vector<Variable> kept(k / 3);
+    for (size_t i = 0; i < variables.size(); ++i) {
+        if (!marginalize[i]) {
+            kept[order[i] - num_marginalized] = variables[i];
+        }
+    }
+    this->window.pop_front();
+    this->prior_landmarks.clear();
+    for (const auto &variable : kept) {
+        const auto landmark = landmark_blocks.find(variable.block);
+        if (landmark != landmark_blocks.end()) {
+            this->prior_landmarks.insert(landmark->second);
+        }
+    }
+    if (k == 0) {
+        this->prior.reset();
+        return;
+    }
+
+    Eigen::SelfAdjointEigenSolver<MatX> Hmm_eig(H.topLeftCorner(m, m));
+    const VecX Hmm_eigs = Hmm_eig.eigenvalues();
+    const VecX Hmm_inv_eigs =
+      (Hmm_eigs.array() > MARGINALIZATION_EPS)
+        .select(Hmm_eigs.array().inverse(), 0.0);
+    const MatX Hmm_inv = Hmm_eig.eigenvectors() * Hmm_inv_eigs.asDiagonal() *
+                         Hmm_eig.eigenvectors().transpose();
+    const MatX Hkm_Hmm_inv = H.bottomLeftCorner(k, m) * Hmm_inv;
+    const MatX H_prior =
+      H.bottomRightCorner(k, k) - Hkm_Hmm_inv * H.topRightCorner(m, k);
+    const VecX b_prior = b.tail(k) - Hkm_Hmm_inv * b.head(m);
+
+    // Factor H_prior = J^T J, and b_prior = J^T r0
+    Eigen::SelfAdjointEigenSolver<MatX> eig(H_prior);
+    const VecX eigs = eig.eigenvalues();
+    const VecX sqrt_eigs =
+      (eigs.array() > MARGINALIZATION_EPS).select(eigs.array().sqrt(), 0.0);
+    const VecX inv_sqrt_eigs =
+      (eigs.array() > MARGINALIZATION_EPS)
+        .select(eigs.array().sqrt().inverse(), 0.0);
+    const MatX J =
+      sqrt_eigs.asDiagonal() * eig.eigenvectors().transpose();
+    const VecX r0 =
+      inv_sqrt_eigs.asDiagonal() * eig.eigenvectors().transpose() * b_prior;
+
+    this->prior.reset(new BAMarginalizationPrior(std::move(kept), J, r0));
+}
+
+void SlidingWindowBA::solve() {
+    ceres::Problem problem;
+    ceres::LossFunction *loss_function = nullptr;
+    switch (this->params.loss) {
+        case BALoss::Huber:
+            loss_function = new ceres::HuberLoss(this->params.loss_scale);
+            break;
+        case BALoss::Cauchy:
+            loss_function = new ceres::CauchyLoss(this->params.loss_scale);
+            break;
+        case BALoss::None: break;
+    }
+
+    const auto counts = this->countObservations(0);
+    const auto shared_K = std::make_shared<const Mat3>(this->K);
+    auto ordering = new ceres::ParameterBlockOrdering;
+    for (auto &keyframe : this->window) {
+        double *q_GC = keyframe.q_GC.coeffs().data();
+        double *G_p_GC = keyframe.G_p_GC.data();
+        problem.AddParameterBlock(
+          q_GC, 4, new BAQuaternionParameterization());
+        problem.AddParameterBlock(G_p_GC, 3);
+        ordering->AddElementToGroup(q_GC, 1);
+        ordering->AddElementToGroup(G_p_GC, 1);
+
+        for (const auto &observation : keyframe.observations) {
+            if (!this->isActive(observation.first, counts)) {
+                continue;
+            }
+            double *G_p_GF =
+              this->landmark_estimates.at(observation.first).data();
+            problem.AddResidualBlock(
+              new BAAnalyticResidual(shared_K, observation.second),
+              loss_function,
+              q_GC,
+              G_p_GC,
+              G_p_GF);
+            if (!ordering->IsMember(G_p_GF)) {
+                ordering->AddElementToGroup(G_p_GF, 0);
+            }
+        }
+    }
+
+    if (this->prior) {
+        // The problem owns its cost functions, so give it a copy
+        std::vector<double *> blocks;
+        for (const auto &variable : this->prior->variables) {
+            blocks.push_back(variable.block);
+            if (!ordering->IsMember(variable.block)) {
+                problem.AddParameterBlock(variable.block, 3);
+            }
+            // The dense prior links all its variables, so its landmarks
+            // cannot be eliminated first. This moves them in with the poses.
+            ordering->AddElementToGroup(variable.block, 1);
+        }
+        problem.AddResidualBlock(
+          new BAMarginalizationPrior(*this->prior), nullptr, blocks);
+    }
+
+    ceres::Solver::Options options;
+    options.max_num_iterations = this->params.max_num_iterations;
+    options.linear_solver_type = ceres::SPARSE_SCHUR;
+    options.num_threads = this->params.num_threads;
+    options.num_linear_solver_threads = this->params.num_threads;
+    if (ordering->GroupSize(0) > 0) {
+        options.linear_solver_ordering.reset(ordering);
+    } else {
+        // Every landmark is in the prior; let Ceres find an ordering
+        delete ordering;
+    }
+    ceres::Solve(options, &problem, &this->summary);
+}
+
+}  // namespace wave
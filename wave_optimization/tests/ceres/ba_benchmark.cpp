@@ -0,0 +1,110 @@
+/** Solving bundle adjustment on the VoDataset test data, with analytic and
+ * with automatic differentiation Jacobians.
+ *
+ * Each benchmark iteration builds the problem from noisy initial estimates
+ * (not timed) and runs a fixed number of solver iterations. items/s is solver
+ * iterations per second, so its inverse is the time per iteration. The
+ * benchmark argument is the number of threads.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "wave/optimization/ceres/ba.hpp"
+
+namespace wave {
+
+const auto TEST_CONFIG = "tests/data/vo_test.yaml";
+const int NUM_SOLVER_ITERATIONS = 10;
+
+/** Bundle adjustment parameters, initialized from a dataset with offsets */
+struct BAEstimates {
+    std::vector<Vec3> G_p_GC;
+    std::vector<Quaternion> q_GC;
+    LandmarkMap landmarks;
+
+    void addTo(const VoDataset &dataset, BundleAdjustment &ba) {
+        const Quaternion q_BC{Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
+                              Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX())};
+        const auto offset = Quaternion{Eigen::AngleAxisd{0.1, Vec3::UnitX()}};
+
+        this->G_p_GC.resize(dataset.states.size());
+        this->q_GC.resize(dataset.states.size());
+        this->landmarks = dataset.landmarks;
+        for (auto &l : this->landmarks) {
+            l.second += Vec3{0.3, -0.3, 0.3};
+        }
+
+        for (size_t i = 0; i < dataset.states.size(); i++) {
+            const auto &state = dataset.states[i];
+            this->G_p_GC[i] = state.robot_G_p_GB + Vec3{0.5, 0.1, -0.5};
+            this->q_GC[i] = state.robot_q_GB * offset * q_BC;
+
+            std::vector<LandmarkId> landmark_ids;
+            MatX features(state.features_observed.size(), 2);
+            for (size_t k = 0; k < state.features_observed.size(); k++) {
+                landmark_ids.push_back(state.features_observed[k].first);
+                features.row(k) = state.features_observed[k].second;
+            }
+            ba.addCamera(dataset.camera_K,
+                         features,
+                         landmark_ids,
+                         this->G_p_GC[i].data(),
+                         this->q_GC[i].coeffs().data(),
+                         this->landmarks);
+
+            // fix the first pose
+            if (i == 0) {
+                this->G_p_GC[i] = state.robot_G_p_GB;
+                this->q_GC[i] = state.robot_q_GB * q_BC;
+                ba.problem.SetParameterBlockConstant(this->G_p_GC[i].data());
+                ba.problem.SetParameterBlockConstant(
+                  this->q_GC[i].coeffs().data());
+            }
+        }
+    }
+};
+
+void solveBundleAdjustment(benchmark::State &state, bool analytic) {
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    const auto dataset = generator.generate();
+
+    BundleAdjustmentParams params{
+      analytic, BALoss::None, 1.0, static_cast<int>(state.range(0))};
+    params.max_num_iterations = NUM_SOLVER_ITERATIONS;
+    params.verbose = false;
+
+    int64_t num_iterations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        BundleAdjustment ba{params};
+        BAEstimates estimates;
+        estimates.addTo(dataset, ba);
+        state.ResumeTiming();
+
+        ba.solve();
+        num_iterations += ba.summary.iterations.size();
+    }
+    state.SetItemsProcessed(num_iterations);
+}
+
+void BM_BundleAdjustmentAnalytic(benchmark::State &state) {
+    solveBundleAdjustment(state, true);
+}
+
+void BM_BundleAdjustmentAutoDiff(benchmark::State &state) {
+    solveBundleAdjustment(state, false);
+}
+
+BENCHMARK(BM_BundleAdjustmentAnalytic)
+  ->Arg(1)
+  ->Arg(4)
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BundleAdjustmentAutoDiff)
+  ->Arg(1)
+  ->Arg(4)
+  ->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
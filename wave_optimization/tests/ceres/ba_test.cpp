@@ -93,14 +93,110 @@ TEST(BAResidual, testResidual) {
     EXPECT_NEAR(0.0, e[1], 0.0001);
 }
 
-TEST(BundleAdjustment, solve) {
+TEST(BAAnalyticResidual, matchesAutoDiff) {
+    Mat3 K;
+    K << 554.38, 0.0, 320.0,  //
+      0.0, 554.38, 320.0,     //
+      0.0, 0.0, 1.0;          //
+    const Vec2 feature{300.0, 250.0};
+
+    Quaternion q_GC{Eigen::AngleAxisd(0.3, Vec3{1, 2, 3}.normalized()) *
+                    Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
+                    Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX())};
+    Vec3 G_p_GC{0.5, -0.2, 0.1};
+    Vec3 G_p_GF{10.0, -1.0, 2.0};
+
+    BAAnalyticResidual analytic{std::make_shared<const Mat3>(K), feature};
+    ceres::AutoDiffCostFunction<BAResidual, 2, 4, 3, 3> autodiff{
+      new BAResidual{K, feature}};
+
+    const double *parameters[3] = {
+      q_GC.coeffs().data(), G_p_GC.data(), G_p_GF.data()};
+    Eigen::Matrix<double, 2, 4, Eigen::RowMajor> J_q, autodiff_J_q;
+    Eigen::Matrix<double, 2, 3, Eigen::RowMajor> J_t, autodiff_J_t;
+    Eigen::Matrix<double, 2, 3, Eigen::RowMajor> J_f, autodiff_J_f;
+    double *jacobians[3] = {J_q.data(), J_t.data(), J_f.data()};
+    double *autodiff_jacobians[3] = {
+      autodiff_J_q.data(), autodiff_J_t.data(), autodiff_J_f.data()};
+    Vec2 residual, autodiff_residual;
+
+    ASSERT_TRUE(analytic.Evaluate(parameters, residual.data(), jacobians));
+    ASSERT_TRUE(autodiff.Evaluate(
+      parameters, autodiff_residual.data(), autodiff_jacobians));
+
+    EXPECT_PRED2(VectorsNear, autodiff_residual, residual);
+    EXPECT_PRED2(MatricesNear, autodiff_J_t, J_t);
+    EXPECT_PRED2(MatricesNear, autodiff_J_f, J_f);
+
+    // The quaternion Jacobians may differ off the unit sphere, but must agree
+    // through the parameterization
+    const auto P =
+      BAQuaternionParameterization::plusJacobian(q_GC.coeffs().data());
+    const Eigen::Matrix<double, 2, 3> J_delta = J_q * P;
+    EXPECT_PRED2(MatricesNear, Eigen::MatrixXd{autodiff_J_q * P}, J_delta);
+
+    // Compare the rotation Jacobian to central differences through the
+    // parameterization
+    BAQuaternionParameterization parameterization;
+    const double h = 1e-6;
+    for (int j = 0; j < 3; ++j) {
+        const Vec3 d = h * Vec3::Unit(j);
+        Quaternion q_plus, q_minus;
+        parameterization.Plus(
+          q_GC.coeffs().data(), d.data(), q_plus.coeffs().data());
+        parameterization.Plus(
+          q_GC.coeffs().data(), Vec3{-d}.data(), q_minus.coeffs().data());
+
+        Vec2 plus, minus;
+        const double *parameters_plus[3] = {
+          q_plus.coeffs().data(), G_p_GC.data(), G_p_GF.data()};
+        const double *parameters_minus[3] = {
+          q_minus.coeffs().data(), G_p_GC.data(), G_p_GF.data()};
+        analytic.Evaluate(parameters_plus, plus.data(), nullptr);
+        analytic.Evaluate(parameters_minus, minus.data(), nullptr);
+
+        EXPECT_PRED3(VectorsNearPrec,
+                     Vec2{(plus - minus) / (2 * h)},
+                     J_delta.col(j),
+                     1e-6);
+    }
+}
+
+TEST(BAQuaternionParameterization, jacobian) {
+    const Quaternion q{Eigen::AngleAxisd(0.7, Vec3{1, -2, 3}.normalized())};
+    BAQuaternionParameterization parameterization;
+    Eigen::Matrix<double, 4, 3, Eigen::RowMajor> J;
+    ASSERT_TRUE(
+      parameterization.ComputeJacobian(q.coeffs().data(), J.data()));
+
+    // Compare to central differences of Plus
+    const double h = 1e-6;
+    for (int j = 0; j < 3; ++j) {
+        const Vec3 d = h * Vec3::Unit(j);
+        Quaternion q_plus, q_minus;
+        parameterization.Plus(
+          q.coeffs().data(), d.data(), q_plus.coeffs().data());
+        parameterization.Plus(
+          q.coeffs().data(), Vec3{-d}.data(), q_minus.coeffs().data());
+        EXPECT_PRED3(VectorsNearPrec,
+                     Vec4{(q_plus.coeffs() - q_minus.coeffs()) / (2 * h)},
+                     Vec4{J.col(j)},
+                     1e-8);
+    }
+
+    const auto M =
+      BAQuaternionParameterization::minusJacobian(q.coeffs().data());
+    EXPECT_PRED2(MatricesNear, Eigen::MatrixXd{M * J}, Mat3::Identity());
+}
+
+static void checkBundleAdjustment(const BundleAdjustmentParams &params) {
     // create vo dataset
     VoDatasetGenerator generator;
     generator.configure(TEST_CONFIG);
     auto dataset = generator.generate();
 
     // build bundle adjustment problem
-    BundleAdjustment ba;
+    BundleAdjustment ba{params};
 
     // We'll keep the parameters in a vector for now.
     // Note we have to pre-allocate the vector, so that pointers to the elements
@@ -190,4 +286,17 @@ TEST(BundleAdjustment, solve) {
     }
 }
 
+TEST(BundleAdjustment, solve) {
+    checkBundleAdjustment(BundleAdjustmentParams{});
+}
+
+TEST(BundleAdjustment, solveAutoDiff) {
+    checkBundleAdjustment(
+      BundleAdjustmentParams{false, BALoss::None, 1.0, 1});
+}
+
+TEST(BundleAdjustment, solveRobustLoss) {
+    checkBundleAdjustment(BundleAdjustmentParams{true, BALoss::Huber, 1.0, 2});
+}
+
 }  // namespace wave
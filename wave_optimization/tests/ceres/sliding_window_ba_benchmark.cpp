@@ -0,0 +1,70 @@
+/** Per-frame latency of sliding window bundle adjustment over a long
+ * synthetic VoDataset.
+ *
+ * The test dataset's trajectory is extended to NUM_STEPS steps, and each
+ * benchmark iteration adds the next keyframe to the window and solves it. The
+ * benchmark argument is the window size. items/s is keyframes solved per
+ * second, so its inverse is the latency per frame, which should depend on the
+ * window size but not on how far along the sequence the window is.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "wave/optimization/ceres/sliding_window_ba.hpp"
+
+namespace wave {
+
+const auto TEST_CONFIG = "tests/data/vo_test.yaml";
+const int NUM_STEPS = 5000;
+
+void BM_SlidingWindowBAFrame(benchmark::State &state) {
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    generator.nb_steps = NUM_STEPS;
+    const auto dataset = generator.generate();
+    const Quaternion q_BC{Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
+                          Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX())};
+
+    std::vector<size_t> keyframes;
+    for (size_t i = 0; i < dataset.states.size(); ++i) {
+        if (!dataset.states[i].features_observed.empty()) {
+            keyframes.push_back(i);
+        }
+    }
+
+    const SlidingWindowBAParams params{static_cast<int>(state.range(0)), 10, 1};
+    std::unique_ptr<SlidingWindowBA> ba;
+    size_t k = keyframes.size();
+
+    for (auto _ : state) {
+        // Start again from the beginning of the sequence
+        if (k == keyframes.size()) {
+            state.PauseTiming();
+            ba.reset(new SlidingWindowBA{dataset.camera_K, params});
+            for (const auto &l : dataset.landmarks) {
+                ba->addLandmark(l.first, l.second + Vec3{0.1, -0.1, 0.1});
+            }
+            k = 0;
+            state.ResumeTiming();
+        }
+
+        const auto &frame = dataset.states[keyframes[k]];
+        const Vec3 offset = k < 2 ? Vec3::Zero() : Vec3{0.05, -0.05, 0.05};
+        ba->addKeyframe(frame.robot_q_GB * q_BC,
+                        frame.robot_G_p_GB + offset,
+                        frame.features_observed);
+        ba->solve();
+        ++k;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SlidingWindowBAFrame)
+  ->Arg(5)
+  ->Arg(10)
+  ->Arg(20)
+  ->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
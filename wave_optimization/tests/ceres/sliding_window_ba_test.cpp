@@ -0,0 +1,184 @@
+#include "wave/wave_test.hpp"
+#include "wave/utils/utils.hpp"
+#include "wave/vision/dataset/VoDataset.hpp"
+#include "wave/optimization/ceres/sliding_window_ba.hpp"
+
+namespace wave {
+
+const std::string TEST_CONFIG = "tests/data/vo_test.yaml";
+
+using CameraMeasurement = LandmarkMeasurement<int>;
+using CameraContainer = LandmarkMeasurementContainer<CameraMeasurement>;
+
+static TimePoint toTimePoint(double time) {
+    return TimePoint{} +
+           std::chrono::duration_cast<TimePoint::duration>(
+             std::chrono::duration<double>{time});
+}
+
+class SlidingWindowBATest : public ::testing::Test {
+ protected:
+    VoDataset dataset;
+    CameraContainer measurements;
+    std::vector<size_t> keyframes;
+
+    // rotate the body frame by this to get the camera frame
+    Quaternion q_BC{Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
+                    Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX())};
+
+    SlidingWindowBATest() {
+        VoDatasetGenerator generator;
+        generator.configure(TEST_CONFIG);
+        this->dataset = generator.generate();
+
+        srand(3);
+        for (size_t i = 0; i < this->dataset.states.size(); ++i) {
+            const auto &state = this->dataset.states[i];
+            if (state.features_observed.empty()) {
+                continue;
+            }
+            this->keyframes.push_back(i);
+            for (const auto &feature : state.features_observed) {
+                this->measurements.emplace(toTimePoint(state.time),
+                                           0,
+                                           feature.first,
+                                           i,
+                                           feature.second +
+                                             0.05 * Vec2::Random());
+            }
+        }
+    }
+
+    Quaternion trueOrientation(size_t i) const {
+        return this->dataset.states[i].robot_q_GB * this->q_BC;
+    }
+
+    Vec3 truePosition(size_t i) const {
+        return this->dataset.states[i].robot_G_p_GB;
+    }
+
+    /** Runs the window over the whole dataset, checking each solve */
+    void run(SlidingWindowBA &ba, int window_size) {
+        for (const auto &l : this->dataset.landmarks) {
+            ba.addLandmark(l.first, l.second + 0.1 * Vec3::Random());
+        }
+
+        for (size_t k = 0; k < this->keyframes.size(); ++k) {
+            // Offset all but the first two keyframes, which fix the gauge
+            const auto i = this->keyframes[k];
+            const double scale = k < 2 ? 0.0 : 1.0;
+            const auto offset =
+              Quaternion{Eigen::AngleAxisd{scale * 0.03, Vec3::UnitX()}};
+            ba.addKeyframe(this->trueOrientation(i) * offset,
+                           this->truePosition(i) +
+                             scale * Vec3{0.1, -0.1, 0.1},
+                           this->measurements,
+                           toTimePoint(this->dataset.states[i].time),
+                           0);
+            ba.solve();
+            ASSERT_NE(ceres::FAILURE, ba.summary.termination_type)
+              << ba.summary.FullReport();
+            ASSERT_TRUE(ba.summary.IsSolutionUsable());
+
+            ASSERT_LE(ba.keyframes().size(), static_cast<size_t>(window_size));
+
+            // The newest keyframe has been corrected
+            const auto &newest = ba.keyframes().back();
+            EXPECT_LT(this->trueOrientation(i).angularDistance(newest.q_GC),
+                      0.01);
+            EXPECT_LT((this->truePosition(i) - newest.G_p_GC).norm(), 0.1);
+        }
+    }
+};
+
+TEST(BAMarginalizationPrior, quaternionJacobian) {
+    const Quaternion q0{Eigen::AngleAxisd(0.5, Vec3{0, 1, 1}.normalized())};
+    Quaternion q{Eigen::AngleAxisd(0.2, Vec3::UnitX()) * q0};
+    BAMarginalizationPrior prior{
+      {BAMarginalizationPrior::Variable{q.coeffs().data(), true, q0.coeffs()}},
+      Mat3::Identity(),
+      Vec3::Zero()};
+
+    const double *parameters[1] = {q.coeffs().data()};
+    Eigen::Matrix<double, 3, 4, Eigen::RowMajor> J;
+    double *jacobians[1] = {J.data()};
+    Vec3 residual;
+    ASSERT_TRUE(prior.Evaluate(parameters, residual.data(), jacobians));
+
+    // Compare to central differences through the parameterization
+    BAQuaternionParameterization parameterization;
+    const Eigen::Matrix<double, 3, 3> J_delta =
+      J * BAQuaternionParameterization::plusJacobian(q.coeffs().data());
+    const double h = 1e-6;
+    for (int j = 0; j < 3; ++j) {
+        const Vec3 d = h * Vec3::Unit(j);
+        Quaternion q_plus, q_minus;
+        parameterization.Plus(
+          q.coeffs().data(), d.data(), q_plus.coeffs().data());
+        parameterization.Plus(
+          q.coeffs().data(), Vec3{-d}.data(), q_minus.coeffs().data());
+        EXPECT_PRED3(VectorsNearPrec,
+                     Vec3{(BAMarginalizationPrior::localDifference(
+                             prior.variables[0], q_plus.coeffs().data()) -
+                           BAMarginalizationPrior::localDifference(
+                             prior.variables[0], q_minus.coeffs().data())) /
+                          (2 * h)},
+                     Vec3{J_delta.col(j)},
+                     1e-6);
+    }
+}
+
+TEST_F(SlidingWindowBATest, badWindowSize) {
+    EXPECT_THROW(SlidingWindowBA(this->dataset.camera_K,
+                                 SlidingWindowBAParams{1, 10, 1}),
+                 std::invalid_argument);
+}
+
+TEST_F(SlidingWindowBATest, addKeyframeFromContainer) {
+    SlidingWindowBA ba{this->dataset.camera_K};
+    const auto i = this->keyframes.front();
+    ba.addKeyframe(this->trueOrientation(i),
+                   this->truePosition(i),
+                   this->measurements,
+                   toTimePoint(this->dataset.states[i].time),
+                   0);
+
+    ASSERT_EQ(1u, ba.keyframes().size());
+    EXPECT_EQ(this->dataset.states[i].features_observed.size(),
+              ba.keyframes().front().observations.size());
+
+    // Measurements from other sensors are ignored
+    ba.addKeyframe(this->trueOrientation(i),
+                   this->truePosition(i),
+                   this->measurements,
+                   toTimePoint(this->dataset.states[i].time),
+                   1);
+    EXPECT_TRUE(ba.keyframes().back().observations.empty());
+}
+
+TEST_F(SlidingWindowBATest, solve) {
+    const int window_size = 5;
+    SlidingWindowBA ba{this->dataset.camera_K,
+                       SlidingWindowBAParams{window_size, 20, 1}};
+    ASSERT_GT(this->keyframes.size(), 2u * window_size);
+    this->run(ba, window_size);
+
+    // Landmarks observed in the window have converged
+    for (const auto &keyframe : ba.keyframes()) {
+        for (const auto &observation : keyframe.observations) {
+            const auto &estimate = ba.landmarks().at(observation.first);
+            const auto &truth = this->dataset.landmarks.at(observation.first);
+            EXPECT_LT((estimate - truth).norm(), 1.0);
+        }
+    }
+}
+
+TEST_F(SlidingWindowBATest, solveRobustLoss) {
+    const int window_size = 4;
+    SlidingWindowBAParams params{window_size, 20, 2};
+    params.loss = BALoss::Huber;
+    SlidingWindowBA ba{this->dataset.camera_K, params};
+    this->run(ba, window_size);
+}
+
+}  // namespace wave
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <functional>
 #include <vector>
 
 #include "wave/utils/math.hpp"
@@ -33,23 +34,69 @@ int csvcols(std::string file_path);
 
 /** Load csv file containing a matrix.
  *
- * The parsed matrix will be loaded to `data`.
+ * The parsed matrix will be loaded to `data`. The number of columns is taken
+ * from the first line of the file; missing entries are loaded as zero, and
+ * extra entries are ignored. A first line without commas gives one column,
+ * although `csvcols()` returns 0 for it.
+ *
+ * The file is memory-mapped, split into chunks at line boundaries, and the
+ * chunks are parsed in parallel directly into `data`. Numbers are parsed with
+ * the same results as `atof()`.
  *
  * @param file_path path to the csv file
  * @param header whether a header line exists in the csv file.
  * @param[out] data
+ * @param n_threads maximum number of threads to use. If 0, uses the number of
+ * hardware threads. Small files are parsed on the calling thread only.
  *
  * @return `0` on success, `-1` on error
  *
  */
-int csv2mat(std::string file_path, bool header, MatX &data);
+int csv2mat(const std::string &file_path,
+            bool header,
+            MatX &data,
+            int n_threads = 0);
+
+/** Calls `callback` with each row of the csv file at `file_path` in turn,
+ * parsed as by `csv2mat()`.
+ *
+ * The file is read sequentially on the calling thread and only one row is
+ * held at a time, so files larger than memory can be processed.
+ *
+ * @return `0` on success, `-1` on error
+ */
+int csvForEachRow(const std::string &file_path,
+                  bool header,
+                  const std::function<void(const VecX &row)> &callback);
 
 /** Saves matrix to file.
  *
- * The `data` is saved in csv format to a file at `file_path`.
+ * The `data` is saved in csv format to a file at `file_path`. Blocks of rows
+ * are formatted in parallel, then written in order.
+ *
+ * @param n_threads maximum number of threads to use. If 0, uses the number of
+ * hardware threads.
  * @return `0` on success, `-1` on error
  */
-int mat2csv(std::string file_path, MatX data);
+int mat2csv(const std::string &file_path, const MatX &data, int n_threads = 0);
+
+namespace internal {
+
+/** Converts the csv field [begin, end) to `value` with the same result as
+ * atof(), if it is a plain decimal number. Surrounding whitespace and line
+ * endings are ignored.
+ *
+ * Numbers of up to 19 significant digits and exponents of up to 22 in
+ * magnitude are converted exactly with one multiplication or division of two
+ * exactly-representable doubles, which is correctly rounded (Clinger's fast
+ * path).
+ *
+ * @return false if the field needs a general parser such as strtod(),
+ * including nan and inf
+ */
+bool parseCsvNumberFast(const char *begin, const char *end, double &value);
+
+}  // namespace internal
 
 
 /** Reads a matrix from an input stream.
@@ -0,0 +1,87 @@
+/** @file
+ * @ingroup utils
+ *
+ * Read-only memory-mapped files, for loading large binary and text data
+ * without copying it through stream buffers.
+ */
+
+#ifndef WAVE_UTILS_MAPPED_FILE_HPP
+#define WAVE_UTILS_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace wave {
+/** @addtogroup utils
+ *  @{ */
+
+/** A file mapped read-only into the address space of the process.
+ *
+ * The mapping lives as long as the object. Pointers returned by `data()` must
+ * not be used after the object is destroyed; hold the object in a
+ * `std::shared_ptr` to share views of the mapping safely.
+ *
+ * An empty file is valid: `data()` is then `nullptr` and `size()` is 0.
+ */
+class MappedFile {
+ public:
+    /** Maps the whole file at `file_path` into memory.
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string &file_path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /** @return pointer to the first byte of the file */
+    const char *data() const noexcept {
+        return this->addr;
+    }
+
+    /** @return the size of the file in bytes */
+    std::size_t size() const noexcept {
+        return this->length;
+    }
+
+    /** @return the path the file was opened from */
+    const std::string &path() const noexcept {
+        return this->file_path;
+    }
+
+    /** Hints to the kernel that the file will be read sequentially, so it can
+     * read ahead aggressively. */
+    void adviseSequential() const noexcept;
+
+    /** Asks the kernel to start reading the byte range [offset, offset +
+     * count) into the page cache, without blocking. */
+    void willNeed(std::size_t offset, std::size_t count) const noexcept;
+
+    /** Reads one byte from every page in the file, blocking until the whole
+     * file is resident in memory.
+     *
+     * @return a checksum of the touched bytes, so the reads are not optimized
+     * away
+     */
+    std::size_t touchPages() const noexcept;
+
+    /** Reads one byte from every page overlapping the byte range [offset,
+     * offset + count), blocking until the range is resident in memory.
+     *
+     * @return a checksum of the touched bytes
+     */
+    std::size_t touchPages(std::size_t offset, std::size_t count) const
+      noexcept;
+
+ private:
+    std::string file_path;
+    const char *addr = nullptr;
+    std::size_t length = 0;
+};
+
+/** @} group utils */
+}  // namespace wave
+
+#endif  // WAVE_UTILS_MAPPED_FILE_HPP
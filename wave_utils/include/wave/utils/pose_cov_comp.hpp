@@ -42,6 +42,7 @@
 #ifndef WAVE_UTILS_POSE_COV_COMP_HPP_
 #define WAVE_UTILS_POSE_COV_COMP_HPP_
 
+#include <vector>
 #include <Eigen/Dense>
 
 namespace wave {
@@ -72,8 +73,14 @@ struct PoseWithCovariance {
     Eigen::Quaterniond getQuaternion() const;
     Vector7 getPoseQuaternion() const;
     Eigen::Affine3d getTransformMatrix() const;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+typedef std::vector<PoseWithCovariance,
+                    Eigen::aligned_allocator<PoseWithCovariance>>
+  PoseWithCovarianceVector;
+
 /** Calculates the pose composition of two poses and the estimated covariance.
  *  Based on [1].
  *
@@ -85,6 +92,46 @@ struct PoseWithCovariance {
  */
 PoseWithCovariance composePose(PoseWithCovariance &p1, PoseWithCovariance &p);
 
+/** Composes each pair of poses p1[i] and p2[i] with their covariances, as
+ *  composePose().
+ *
+ *  Each pose is converted to a quaternion and YPR once, and the Jacobians of
+ *  Equations (5.3) and (5.4) are assembled from their non-zero 3x3 blocks
+ *  with fixed-size products, instead of from the full 7x7 and 7x6 Jacobians.
+ *
+ *  @param p1 first poses with covariance
+ *  @param p2 second poses with covariance, the same number as p1
+ *  @param result composed poses with predicted covariance, resized to match
+ *
+ *  @throws std::invalid_argument if p1 and p2 differ in size
+ */
+void composePoses(const PoseWithCovarianceVector &p1,
+                  const PoseWithCovarianceVector &p2,
+                  PoseWithCovarianceVector &result);
+
+/** Composes a chain of poses start + steps[0] + ... + steps[n-1], propagating
+ *  the covariance at each step as composePose() would.
+ *
+ *  The running pose's quaternion and Jacobian terms are reused as the first
+ *  pose of the next step, so each pose is converted once.
+ *
+ *  @param start first pose of the chain
+ *  @param steps relative poses to compose in turn
+ *
+ *  @return the last composed pose, or start if there are no steps
+ */
+PoseWithCovariance composePoseChain(const PoseWithCovariance &start,
+                                    const PoseWithCovarianceVector &steps);
+
+/** As composePoseChain(start, steps), but stores every composed pose.
+ *
+ *  @param chain the pose after each step, with chain[i] the composition of
+ *  start and steps[0] to steps[i]
+ */
+void composePoseChain(const PoseWithCovariance &start,
+                      const PoseWithCovarianceVector &steps,
+                      PoseWithCovarianceVector &chain);
+
 /** The Jacobian of quaternion normalization function. Quaternion in the form of
  *  [qr, qx, qt, qz]
  *  Equation (1.7)
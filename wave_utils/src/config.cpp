@@ -90,7 +90,9 @@ ConfigStatus ConfigParser::load(const std::string &config_file) {
 
     for (const auto &param_ptr : this->params) {
         const auto retval = this->loadParam(*param_ptr);
-        if (retval != ConfigStatus::OK) {
+        // A missing optional key leaves its parameter unchanged
+        if (retval != ConfigStatus::OK &&
+            retval != ConfigStatus::MissingOptionalKey) {
             return retval;
         }
     }
@@ -1,8 +1,233 @@
 #include "wave/utils/data.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "wave/utils/mapped_file.hpp"
 
 namespace wave {
 
+namespace internal {
+
+bool parseCsvNumberFast(const char *begin, const char *end, double &value) {
+    static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                   1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                   1e18, 1e19, 1e20, 1e21, 1e22};
+    // The last field of a line ends with its line ending
+    const auto is_space = [](char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    };
+    const auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+
+    while (begin < end && is_space(*begin)) {
+        ++begin;
+    }
+    while (end > begin && is_space(end[-1])) {
+        --end;
+    }
+
+    auto p = begin;
+    const bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        ++p;
+    }
+
+    std::uint64_t mantissa = 0;
+    int exponent = 0, significant_digits = 0, digits = 0;
+    const auto add_digit = [&](char c) {
+        if (mantissa != 0 || c != '0') {
+            ++significant_digits;
+        }
+        mantissa = 10 * mantissa + (c - '0');
+        ++digits;
+    };
+    for (; p < end && is_digit(*p); ++p) {
+        add_digit(*p);
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && is_digit(*p); ++p) {
+            add_digit(*p);
+            --exponent;
+        }
+    }
+    if (digits > 0 && p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        const bool negative_exponent = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) {
+            ++p;
+        }
+        int e = 0;
+        const auto e_begin = p;
+        for (; p < end && is_digit(*p) && e < 10000; ++p) {
+            e = 10 * e + (*p - '0');
+        }
+        if (p == e_begin) {
+            digits = 0;  // malformed exponent, let strtod() decide
+        }
+        exponent += negative_exponent ? -e : e;
+    }
+
+    if (p != end || digits == 0 || significant_digits > 19 ||
+        mantissa > (std::uint64_t{1} << 53) || exponent < -22 ||
+        exponent > 22) {
+        return false;
+    }
+    value = static_cast<double>(mantissa);
+    value = exponent < 0 ? value / POW10[-exponent] : value * POW10[exponent];
+    value = negative ? -value : value;
+    return true;
+}
+
+}  // namespace internal
+
+namespace {
+
+/** Bytes of csv below which a thread is not worth starting */
+const std::size_t MIN_BYTES_PER_THREAD = 1 << 20;
+
+/** Rows of a matrix formatted per block by mat2csv(), and the fewest rows
+ * worth starting a thread for */
+const Eigen::Index ROWS_PER_WRITE = 1 << 16;
+const Eigen::Index MIN_ROWS_PER_THREAD = 1 << 12;
+
+int threadCount(int n_threads) {
+    if (n_threads <= 0) {
+        n_threads =
+          std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    return n_threads;
+}
+
+/** Runs f(t) for t in [0, num_threads), on the calling thread and
+ * num_threads - 1 others */
+void runThreads(int num_threads, const std::function<void(int)> &f) {
+    std::vector<std::thread> workers;
+    for (int t = 1; t < num_threads; ++t) {
+        workers.emplace_back(f, t);
+    }
+    f(0);
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+/** @return the start of the line after the one containing `p`, or `end` */
+const char *nextLine(const char *p, const char *end) {
+    // memchr is vectorized in common C libraries
+    const auto nl =
+      static_cast<const char *>(std::memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+/** @return the number of lines in [begin, end), counted as std::getline()
+ * would, when `end` is a line boundary */
+std::size_t countLines(const char *begin, const char *end) {
+    std::size_t count = 0;
+    for (auto p = begin; p < end; p = nextLine(p, end)) {
+        ++count;
+    }
+    return count;
+}
+
+/** Parses a number in [begin, end) with the same result as atof(), using
+ * internal::parseCsvNumberFast() where it applies and strtod() otherwise. */
+double parseNumber(const char *begin, const char *end) {
+    double value;
+    if (internal::parseCsvNumberFast(begin, end, value)) {
+        return value;
+    }
+
+    // strtod() needs a null-terminated string, and skips leading whitespace
+    const std::string token{begin, end};
+    return std::strtod(token.c_str(), nullptr);
+}
+
+/** Parses one csv line [begin, end) into `nb_cols` values, written with
+ * `store(col, value)` */
+template <typename Store>
+void parseLine(const char *begin,
+               const char *end,
+               int nb_cols,
+               Store store) {
+    auto p = begin;
+    for (int i = 0; i < nb_cols; ++i) {
+        if (p >= end) {
+            store(i, 0.0);
+            continue;
+        }
+        auto comma = static_cast<const char *>(std::memchr(p, ',', end - p));
+        const auto field_end = comma ? comma : end;
+        store(i, parseNumber(p, field_end));
+        p = field_end + 1;
+    }
+}
+
+/** Maps the csv file at `file_path`, or returns null on failure */
+std::unique_ptr<MappedFile> openCsv(const std::string &file_path) {
+    try {
+        return std::unique_ptr<MappedFile>{new MappedFile{file_path}};
+    } catch (const std::runtime_error &) {
+        printf(E_CSV_DATA_LOAD, file_path.c_str());
+        return nullptr;
+    }
+}
+
+/** The body of a mapped csv file, after the header line if any */
+struct CsvBody {
+    const char *begin;
+    const char *end;
+    int nb_cols;
+};
+
+CsvBody csvBody(const MappedFile &file, bool header) {
+    CsvBody body;
+    body.begin = file.data();
+    body.end = file.data() + file.size();
+
+    // The columns are counted on the first line. Unlike csvcols(), a line
+    // without commas is one column rather than none.
+    const auto first_end = nextLine(body.begin, body.end);
+    const auto nb_commas = std::count(body.begin, first_end, ',');
+    body.nb_cols = (first_end > body.begin && body.begin[0] != '\n')
+                     ? static_cast<int>(nb_commas) + 1
+                     : 0;
+
+    if (header) {
+        body.begin = first_end;
+    }
+    return body;
+}
+
+/** Formats rows [begin, end) of `data` as csv, as `std::ostream` would */
+void formatRows(const MatX &data,
+                Eigen::Index begin,
+                Eigen::Index end,
+                std::string &out) {
+    char buf[32];
+    out.clear();
+    for (auto i = begin; i < end; ++i) {
+        for (Eigen::Index j = 0; j < data.cols(); ++j) {
+            // %g with the default stream precision of 6
+            const int len = std::snprintf(buf, sizeof(buf), "%g", data(i, j));
+            out.append(buf, len);
+            if ((j + 1) != data.cols()) {
+                out.push_back(',');
+            }
+        }
+        out.push_back('\n');
+    }
+}
+
+}  // namespace
+
 int csvrows(std::string file_path) {
     int nb_rows;
     std::string line;
@@ -51,53 +276,79 @@ int csvcols(std::string file_path) {
     return (found_separator) ? nb_elements : 0;
 }
 
-int csv2mat(std::string file_path, bool header, MatX &data) {
-    int line_no;
-    int nb_rows;
-    int nb_cols;
-    std::string line;
-    std::ifstream infile(file_path);
-    std::vector<double> vdata;
-    std::string element;
-    double value;
-
-    // load file
-    if (infile.good() != true) {
-        printf(E_CSV_DATA_LOAD, file_path.c_str());
+int csv2mat(const std::string &file_path,
+            bool header,
+            MatX &data,
+            int n_threads) {
+    const auto file = openCsv(file_path);
+    if (!file) {
         return -1;
     }
+    const auto body = csvBody(*file, header);
 
-    // obtain number of rows and cols
-    nb_rows = csvrows(file_path);
-    nb_cols = csvcols(file_path);
-
-    // header line?
-    if (header) {
-        std::getline(infile, line);
-        nb_rows -= 1;
+    // Split the body into one chunk per thread, at line boundaries
+    const auto size = static_cast<std::size_t>(body.end - body.begin);
+    const auto num_threads = static_cast<int>(std::min<std::size_t>(
+      threadCount(n_threads),
+      std::max<std::size_t>(1, size / MIN_BYTES_PER_THREAD)));
+    std::vector<const char *> bounds(num_threads + 1, body.end);
+    bounds[0] = body.begin;
+    for (int t = 1; t < num_threads; ++t) {
+        const auto mid =
+          std::max(bounds[t - 1], body.begin + size * t / num_threads);
+        bounds[t] = mid > body.begin ? nextLine(mid - 1, body.end) : mid;
     }
 
-    // load data
-    line_no = 0;
-    data.resize(nb_rows, nb_cols);
-    while (std::getline(infile, line)) {
-        std::istringstream ss(line);
+    // Count the lines of each chunk, giving the first row of the next
+    std::vector<std::size_t> first_row(num_threads + 1, 0);
+    runThreads(num_threads, [&](int t) {
+        first_row[t + 1] = countLines(bounds[t], bounds[t + 1]);
+    });
+    for (int t = 0; t < num_threads; ++t) {
+        first_row[t + 1] += first_row[t];
+    }
 
-        // load data row
-        for (int i = 0; i < nb_cols; i++) {
-            std::getline(ss, element, ',');
-            value = atof(element.c_str());
-            data(line_no, i) = value;
+    // Parse each chunk into its rows
+    data.resize(first_row.back(), body.nb_cols);
+    runThreads(num_threads, [&](int t) {
+        auto row = static_cast<Eigen::Index>(first_row[t]);
+        for (auto p = bounds[t]; p < bounds[t + 1]; ++row) {
+            const auto line_end = nextLine(p, bounds[t + 1]);
+            parseLine(p, line_end, body.nb_cols, [&](int col, double value) {
+                data(row, col) = value;
+            });
+            p = line_end;
         }
+    });
 
-        line_no++;
+    return 0;
+}
+
+int csvForEachRow(const std::string &file_path,
+                  bool header,
+                  const std::function<void(const VecX &row)> &callback) {
+    const auto file = openCsv(file_path);
+    if (!file) {
+        return -1;
+    }
+    file->adviseSequential();
+    const auto body = csvBody(*file, header);
+
+    VecX row{body.nb_cols};
+    for (auto p = body.begin; p < body.end;) {
+        const auto line_end = nextLine(p, body.end);
+        parseLine(p, line_end, body.nb_cols, [&row](int col, double value) {
+            row(col) = value;
+        });
+        callback(row);
+        p = line_end;
     }
 
     return 0;
 }
 
-int mat2csv(std::string file_path, MatX data) {
-    std::ofstream outfile(file_path);
+int mat2csv(const std::string &file_path, const MatX &data, int n_threads) {
+    std::ofstream outfile(file_path, std::ios::binary);
 
     // open file
     if (outfile.good() != true) {
@@ -105,21 +356,31 @@ int mat2csv(std::string file_path, MatX data) {
         return -1;
     }
 
-    // save matrix
-    for (int i = 0; i < data.rows(); i++) {
-        for (int j = 0; j < data.cols(); j++) {
-            outfile << data(i, j);
-
-            if ((j + 1) != data.cols()) {
-                outfile << ",";
-            }
+    // Format blocks of rows in parallel, one buffer per thread, and write
+    // the buffers in order
+    const int max_threads = threadCount(n_threads);
+    std::vector<std::string> buffers(max_threads);
+    for (Eigen::Index begin = 0; begin < data.rows();
+         begin += ROWS_PER_WRITE) {
+        const auto end = std::min(begin + ROWS_PER_WRITE, data.rows());
+        const auto num_threads = static_cast<int>(
+          std::min<Eigen::Index>(max_threads,
+                                 std::max<Eigen::Index>(
+                                   1, (end - begin) / MIN_ROWS_PER_THREAD)));
+        runThreads(num_threads, [&](int t) {
+            formatRows(data,
+                       begin + (end - begin) * t / num_threads,
+                       begin + (end - begin) * (t + 1) / num_threads,
+                       buffers[t]);
+        });
+        for (int t = 0; t < num_threads; ++t) {
+            outfile.write(buffers[t].data(), buffers[t].size());
         }
-        outfile << "\n";
     }
 
     // close file
     outfile.close();
-    return 0;
+    return outfile.good() ? 0 : -1;
 }
 
 }  // namespace wave
@@ -0,0 +1,99 @@
+#include "wave/utils/mapped_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wave {
+
+namespace {
+
+std::size_t pageSize() {
+    static const auto page_size =
+      static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string &file_path) : file_path{file_path} {
+    const int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error{"MappedFile: failed to open [" + file_path +
+                                 "]: " + std::strerror(errno)};
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        const auto err = errno;
+        close(fd);
+        throw std::runtime_error{"MappedFile: failed to stat [" + file_path +
+                                 "]: " + std::strerror(err)};
+    }
+    this->length = static_cast<std::size_t>(st.st_size);
+
+    // mmap() rejects zero-length mappings; an empty file maps to nothing
+    if (this->length > 0) {
+        void *ptr = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            const auto err = errno;
+            close(fd);
+            throw std::runtime_error{"MappedFile: failed to map [" +
+                                     file_path + "]: " + std::strerror(err)};
+        }
+        this->addr = static_cast<const char *>(ptr);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (this->addr) {
+        munmap(const_cast<char *>(this->addr), this->length);
+    }
+}
+
+void MappedFile::adviseSequential() const noexcept {
+    if (this->addr) {
+        madvise(
+          const_cast<char *>(this->addr), this->length, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::willNeed(std::size_t offset, std::size_t count) const
+  noexcept {
+    if (!this->addr || offset >= this->length) {
+        return;
+    }
+    // madvise requires a page-aligned start address
+    const auto aligned = offset - offset % pageSize();
+    count = std::min(count + (offset - aligned), this->length - aligned);
+    madvise(const_cast<char *>(this->addr + aligned), count, MADV_WILLNEED);
+}
+
+std::size_t MappedFile::touchPages() const noexcept {
+    return this->touchPages(0, this->length);
+}
+
+std::size_t MappedFile::touchPages(std::size_t offset,
+                                   std::size_t count) const noexcept {
+    if (!this->addr || count == 0 || offset >= this->length) {
+        return 0;
+    }
+    const auto end = offset + std::min(count, this->length - offset);
+    std::size_t sum = 0;
+    for (auto i = offset - offset % pageSize(); i < end; i += pageSize()) {
+        sum += static_cast<unsigned char>(
+          static_cast<const volatile char *>(this->addr)[i]);
+    }
+    return sum;
+}
+
+}  // namespace wave
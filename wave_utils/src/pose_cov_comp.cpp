@@ -35,10 +35,211 @@
  */
 
 #include "wave/utils/pose_cov_comp.hpp"
+#include <stdexcept>
 #include <Eigen/Dense>
 
 namespace wave {
 
+namespace {
+
+typedef Eigen::Matrix<double, 4, 3, Eigen::RowMajor> Matrix4x3;
+
+// Equation (2.8), the quaternion rows of the p6 to p7 Jacobian
+Matrix4x3 jacobian_Ypr_to_Quat(const Vector3 &ypr) {
+    Matrix4x3 m;
+
+    const double cr = cos(ypr(2) / 2), sr = sin(ypr(2) / 2);
+    const double cp = cos(ypr(1) / 2), sp = sin(ypr(1) / 2);
+    const double cy = cos(ypr(0) / 2), sy = sin(ypr(0) / 2);
+
+    const double ccc = cr * cp * cy, ccs = cr * cp * sy, csc = cr * sp * cy,
+                 scs = sr * cp * sy, css = cr * sp * sy, scc = sr * cp * cy,
+                 ssc = sr * sp * cy, sss = sr * sp * sy;
+
+    // clang-format off
+    m << (ssc - ccs) / 2.0, (scs - csc) / 2.0, (css - scc) / 2.0,
+        -(csc + scs) / 2.0, -(ssc + ccs) / 2.0, (ccc + sss) / 2.0,
+        (scc - css) / 2.0, (ccc - sss) / 2.0, (ccs - ssc) / 2.0,
+        (ccc + sss) / 2.0, -(css + scc) / 2.0, -(csc + scs) / 2.0;
+    // clang-format on
+
+    return m;
+}
+
+// Equation (3.9), the quaternion columns of the point composition Jacobian,
+// before normalization
+Matrix3x4 jacobian_Point_Composition_wrt_q(const Vector4 &q,
+                                           const Vector3 &a) {
+    Matrix3x4 m;
+
+    double ax = a(0), ay = a(1), az = a(2);
+    double qr = q(0), qx = q(1), qy = q(2), qz = q(3);
+
+    // clang-format off
+    m << -qz*ay+qy*az, qy*ay+qz*az, -2*qy*ax+qx*ay+qr*az, -2*qz*ax-qr*ay+qx*az,
+        qz*ax-qx*az, qy*ax-2*qx*ay-qr*az, qx*ax+qz*az, qr*ax-2*qz*ay+qy*az,
+        -qy*ax+qx*ay, qz*ax+qr*ay-2*qx*az, -qr*ax+qz*ay-2*qy*az, qx*ax+qy*ay;
+    // clang-format on
+
+    return 2 * m;
+}
+
+// Equation (5.8), the quaternion block of the composition Jacobian wrt p1,
+// before normalization
+Matrix4x4 jacobian_Quat_Composition_wrt_q1(const Vector4 &q2) {
+    double qr2 = q2(0), qx2 = q2(1), qy2 = q2(2), qz2 = q2(3);
+    Matrix4x4 m;
+
+    // clang-format off
+    m << qr2, -qx2, -qy2, -qz2,
+         qx2, qr2, qz2, -qy2,
+         qy2, -qz2, qr2, qx2,
+         qz2, qy2, -qx2, qr2;
+    // clang-format on
+
+    return m;
+}
+
+// Equation (5.9), the quaternion block of the composition Jacobian wrt p2,
+// before normalization
+Matrix4x4 jacobian_Quat_Composition_wrt_q2(const Vector4 &q1) {
+    double qr1 = q1(0), qx1 = q1(1), qy1 = q1(2), qz1 = q1(3);
+    Matrix4x4 m;
+
+    // clang-format off
+    m << qr1, -qx1, -qy1, -qz1,
+         qx1, qr1, -qz1, qy1,
+         qy1, qz1, qr1, -qx1,
+         qz1, -qy1, qx1, qr1;
+    // clang-format on
+
+    return m;
+}
+
+/** The terms of a pose used by the fused composition kernel. Each is
+ * computed once per pose, so that a pose composed in a chain is only
+ * converted to a quaternion and ypr once. */
+struct ComposeTerms {
+    // Pose as p7, with the normalized quaternion as [qr, qx, qy, qz]
+    Vector7 p7;
+
+    // Jacobian of the normalized quaternion wrt ypr, through the
+    // normalization. This is the non-trivial block of Equation (2.8) with
+    // the normalization of Equations (5.8) and (5.9) applied to it.
+    Matrix4x3 dq_dypr;
+
+    // Jacobian of ypr wrt the quaternion, the non-trivial block of Equation
+    // (2.12)
+    Matrix3x4 dypr_dq;
+
+    explicit ComposeTerms(const PoseWithCovariance &p) {
+        const Eigen::Quaterniond quat = p.getQuaternion();
+        this->p7 << p.position, quat.w(), quat.x(), quat.y(), quat.z();
+
+        const Vector4 q = this->quat();
+        const Matrix4x4 jacobian_quat_norm = jacobian_Quat_Norm_wrt_q(q);
+        this->dq_dypr =
+          jacobian_quat_norm * jacobian_Ypr_to_Quat(pose_comp::quatToYPR(quat));
+        this->dypr_dq = jacobian_Quat_Norm_to_Rpy_wrt_q(q) * jacobian_quat_norm;
+    }
+
+    Vector4 quat() const {
+        return this->p7.block<4, 1>(3, 0);
+    }
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/** Computes J * cov * J^T for J = [I, A; 0, B], using only 3x3 products */
+Matrix6x6 propagateUpperTriangular(const Matrix3x3 &A,
+                                   const Matrix3x3 &B,
+                                   const Matrix6x6 &cov) {
+    const Matrix3x3 S11 = cov.block<3, 3>(0, 0), S12 = cov.block<3, 3>(0, 3),
+                    S21 = cov.block<3, 3>(3, 0), S22 = cov.block<3, 3>(3, 3);
+
+    // Blocks of J * cov
+    const Matrix3x3 X11 = S11 + A * S21, X12 = S12 + A * S22;
+    const Matrix3x3 X21 = B * S21, X22 = B * S22;
+
+    Matrix6x6 m;
+    m.block<3, 3>(0, 0) = X11 + X12 * A.transpose();
+    m.block<3, 3>(0, 3) = X12 * B.transpose();
+    m.block<3, 3>(3, 0) = X21 + X22 * A.transpose();
+    m.block<3, 3>(3, 3) = X22 * B.transpose();
+    return m;
+}
+
+/** Computes J * cov * J^T for J = [C, 0; 0, D], using only 3x3 products */
+Matrix6x6 propagateBlockDiagonal(const Matrix3x3 &C,
+                                 const Matrix3x3 &D,
+                                 const Matrix6x6 &cov) {
+    Matrix6x6 m;
+    m.block<3, 3>(0, 0) = C * cov.block<3, 3>(0, 0) * C.transpose();
+    m.block<3, 3>(0, 3) = C * cov.block<3, 3>(0, 3) * D.transpose();
+    m.block<3, 3>(3, 0) = D * cov.block<3, 3>(3, 0) * C.transpose();
+    m.block<3, 3>(3, 3) = D * cov.block<3, 3>(3, 3) * D.transpose();
+    return m;
+}
+
+/** Computes the covariance of r, the composition of p1 and p2, given the
+ * terms of all three. Equivalent to composePose(), but only the non-zero 3x3
+ * blocks of the Jacobians of Equations (5.3) and (5.4) are computed, and
+ * neither those nor the 7x7 and 7x6 Jacobians they are products of are
+ * formed in full. */
+void composeCovariance(const PoseWithCovariance &p1,
+                       const ComposeTerms &t1,
+                       const PoseWithCovariance &p2,
+                       const ComposeTerms &t2,
+                       const ComposeTerms &tr,
+                       PoseWithCovariance &r) {
+    // Equation (5.3): [I, A; 0, B]
+    const Matrix3x3 A =
+      jacobian_Point_Composition_wrt_q(t1.quat(), p2.position) * t1.dq_dypr;
+    const Matrix3x3 B =
+      tr.dypr_dq * jacobian_Quat_Composition_wrt_q1(t2.quat()) * t1.dq_dypr;
+
+    // Equation (5.4): [C, 0; 0, D]
+    const Matrix3x3 C = jacobian_p7_Point_Composition_wrt_a(t1.p7, p2.position);
+    const Matrix3x3 D =
+      tr.dypr_dq * jacobian_Quat_Composition_wrt_q2(t1.quat()) * t2.dq_dypr;
+
+    // Equation (5.2)
+    r.covariance = propagateUpperTriangular(A, B, p1.covariance) +
+                   propagateBlockDiagonal(C, D, p2.covariance);
+}
+
+void composeTransform(const PoseWithCovariance &p1,
+                      const PoseWithCovariance &p2,
+                      PoseWithCovariance &r) {
+    // Equation (5.5)
+    r.position = p1.rotation_matrix * p2.position + p1.position;
+    r.rotation_matrix.noalias() = p1.rotation_matrix * p2.rotation_matrix;
+}
+
+/** Composes start with each of steps in turn, passing each running result to
+ * visit() */
+template <typename Visitor>
+void composeChain(const PoseWithCovariance &start,
+                  const PoseWithCovarianceVector &steps,
+                  Visitor visit) {
+    PoseWithCovariance current = start, next;
+    ComposeTerms t_current{current};
+    for (const auto &step : steps) {
+        composeTransform(current, step, next);
+
+        // The terms of the result are those of the next step's first pose
+        const ComposeTerms t_next{next};
+        composeCovariance(
+          current, t_current, step, ComposeTerms{step}, t_next, next);
+        visit(next);
+
+        current = next;
+        t_current = t_next;
+    }
+}
+
+}  // namespace
+
 PoseWithCovariance::PoseWithCovariance() {
     this->position.setZero();
     this->rotation_matrix.setIdentity();
@@ -158,6 +359,44 @@ PoseWithCovariance composePose(PoseWithCovariance &p1, PoseWithCovariance &p2) {
     return r;
 }
 
+void composePoses(const PoseWithCovarianceVector &p1,
+                  const PoseWithCovarianceVector &p2,
+                  PoseWithCovarianceVector &result) {
+    if (p1.size() != p2.size()) {
+        throw std::invalid_argument{
+          "composePoses: p1 and p2 must have the same size"};
+    }
+
+    result.resize(p1.size());
+    for (std::size_t i = 0; i < p1.size(); ++i) {
+        composeTransform(p1[i], p2[i], result[i]);
+        composeCovariance(p1[i],
+                          ComposeTerms{p1[i]},
+                          p2[i],
+                          ComposeTerms{p2[i]},
+                          ComposeTerms{result[i]},
+                          result[i]);
+    }
+}
+
+PoseWithCovariance composePoseChain(const PoseWithCovariance &start,
+                                    const PoseWithCovarianceVector &steps) {
+    PoseWithCovariance r = start;
+    composeChain(
+      start, steps, [&r](const PoseWithCovariance &next) { r = next; });
+    return r;
+}
+
+void composePoseChain(const PoseWithCovariance &start,
+                      const PoseWithCovarianceVector &steps,
+                      PoseWithCovarianceVector &chain) {
+    chain.clear();
+    chain.reserve(steps.size());
+    composeChain(start, steps, [&chain](const PoseWithCovariance &next) {
+        chain.push_back(next);
+    });
+}
+
 /// the jacobian of quaternion normalization function
 /// quat in the form of [qr, qx, qt, qz]
 /// Equation (1.7)
@@ -275,17 +514,8 @@ Matrix3x7 jacobian_p7_Point_Composition_wrt_p(const Vector7 &p,
     m.block<3, 3>(0, 0) << 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0;
 
     // Equation (3.9)
-    double ax = a(0), ay = a(1), az = a(2);
-    double qr = p(3), qx = p(4), qy = p(5), qz = p(6);
-
-    // clang-format off
-    m.block<3, 4>(0, 3) <<
-        -qz*ay+qy*az, qy*ay+qz*az, -2*qy*ax+qx*ay+qr*az, -2*qz*ax-qr*ay+qx*az,
-        qz*ax-qx*az, qy*ax-2*qx*ay-qr*az, qx*ax+qz*az, qr*ax-2*qz*ay+qy*az,
-        -qy*ax+qx*ay, qz*ax+qr*ay-2*qx*az, -qr*ax+qz*ay-2*qy*az, qx*ax+qy*ay;
-    // clang-format on
-
-    m.block<3, 4>(0, 3) *= 2;
+    m.block<3, 4>(0, 3) =
+      jacobian_Point_Composition_wrt_q(p.block<4, 1>(3, 0), a);
 
     // applying jacobian normalization
     Matrix4x4 jacobian_quat_norm =
@@ -301,15 +531,8 @@ Matrix7x7 jacobian_p7_p7_Composition_wrt_p1(const Vector7 &p1,
                                             const Vector7 &p2) {
     Matrix7x7 m = Matrix7x7::Zero();
 
-    Vector4 q2 = p2.block<4, 1>(3, 0);
-    double qr2 = q2(0), qx2 = q2(1), qy2 = q2(2), qz2 = q2(3);
-
-    // clang-format off
-    m.block<4, 4>(3, 3) << qr2, -qx2, -qy2, -qz2,
-                           qx2, qr2, qz2, -qy2,
-                           qy2, -qz2, qr2, qx2,
-                           qz2, qy2, -qx2, qr2;
-    // clang-format on
+    m.block<4, 4>(3, 3) =
+      jacobian_Quat_Composition_wrt_q1(p2.block<4, 1>(3, 0));
 
     // Note: this quaternion normalization jacobian matrix is not present in
     // the book's formulation, but it should be there if a jacobian
@@ -352,15 +575,8 @@ Matrix7x7 jacobian_p7_p7_Composition_wrt_p2(const Vector7 &p1,
                                             const Vector7 &p2) {
     Matrix7x7 m = Matrix7x7::Zero();
 
-    Vector4 q1 = p1.block<4, 1>(3, 0);
-    double qr1 = q1(0), qx1 = q1(1), qy1 = q1(2), qz1 = q1(3);
-
-    // clang-format off
-    m.block<4, 4>(3, 3) << qr1, -qx1, -qy1, -qz1,
-                           qx1, qr1, -qz1, qy1,
-                           qy1, qz1, qr1, -qx1,
-                           qz1, -qy1, qx1, qr1;
-    // clang-format on
+    m.block<4, 4>(3, 3) =
+      jacobian_Quat_Composition_wrt_q2(p1.block<4, 1>(3, 0));
 
     // Note: this quaternion normalization jacobian matrix is not present in
     // the book's formulation, but it should be there if a jacobian
@@ -384,24 +600,9 @@ Matrix7x6 jacobian_p6_to_p7_wrt_p(const Vector6 &p) {
     // the bottom left 4x3 and top right 3x3 is zero
     m.block<3, 3>(0, 0) << 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0;
 
-    double ccc, ccs, csc, scc, ssc, sss, scs, css;
-    double roll = p(5), pitch = p(4), yaw = p(3);
-    ccc = cos(roll / 2) * cos(pitch / 2) * cos(yaw / 2);
-    ccs = cos(roll / 2) * cos(pitch / 2) * sin(yaw / 2);
-    csc = cos(roll / 2) * sin(pitch / 2) * cos(yaw / 2);
-    scs = sin(roll / 2) * cos(pitch / 2) * sin(yaw / 2);
-    css = cos(roll / 2) * sin(pitch / 2) * sin(yaw / 2);
-    scc = sin(roll / 2) * cos(pitch / 2) * cos(yaw / 2);
-    ssc = sin(roll / 2) * sin(pitch / 2) * cos(yaw / 2);
-    sss = sin(roll / 2) * sin(pitch / 2) * sin(yaw / 2);
-
-    // clang-format off
-    m.block<4, 3>(3, 3) <<
-        (ssc - ccs) / 2.0, (scs - csc) / 2.0, (css - scc) / 2.0,
-        -(csc + scs) / 2.0, -(ssc + ccs) / 2.0, (ccc + sss) / 2.0,
-        (scc - css) / 2.0, (ccc - sss) / 2.0, (ccs - ssc) / 2.0,
-        (ccc + sss) / 2.0, -(css + scc) / 2.0, -(csc + scs) / 2.0;
-    // clang-format on
+    Vector3 ypr;
+    ypr << p(3), p(4), p(5);
+    m.block<4, 3>(3, 3) = jacobian_Ypr_to_Quat(ypr);
 
     return m;
 }
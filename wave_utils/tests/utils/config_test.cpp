@@ -333,3 +333,26 @@ TEST(Utils_config_ConfigParser, load) {
     std::cout << "matrix: \n" << matx << std::endl;
     std::cout << std::endl;
 }
+
+TEST(Utils_config_ConfigParser, loadOptional) {
+    int i = 0;
+    int missing = 7;
+    double d = 0.0;
+
+    wave::ConfigParser parser;
+    parser.addParam("int", &i);
+    parser.addParam("missing_key", &missing, true);
+    parser.addParam("double", &d);
+
+    // A missing optional key is left unchanged, and later keys still load
+    auto res = parser.load(TEST_CONFIG);
+    EXPECT_EQ(wave::ConfigStatus::OK, res);
+    EXPECT_EQ(7, missing);
+    EXPECT_NE(0.0, d);
+
+    // A missing required key is still an error
+    wave::ConfigParser required_parser;
+    required_parser.addParam("missing_key", &missing);
+    EXPECT_EQ(wave::ConfigStatus::KeyError,
+              required_parser.load(TEST_CONFIG));
+}
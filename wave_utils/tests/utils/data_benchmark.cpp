@@ -0,0 +1,171 @@
+/** Throughput of csv2mat() and mat2csv() against the stream-based versions
+ * they replaced.
+ *
+ * The file resembles an IMU log: a timestamp and six readings per row. The
+ * benchmark argument is the number of rows, and items/s is rows per second;
+ * bytes/s is the size of the csv file per second. BM_Csv2matParallel and
+ * BM_Mat2csvParallel use all hardware threads, and *Serial one thread.
+ *
+ * BM_Csv2matStream and BM_Mat2csvStream are the previous implementations,
+ * reproduced below: csv2mat() read the file three times and parsed each line
+ * through std::istringstream and atof(), and mat2csv() wrote each value
+ * through an std::ofstream.
+ */
+
+#include <cstdio>
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "wave/utils/data.hpp"
+
+namespace wave {
+
+const char *const BENCHMARK_FILE = "/tmp/wave_data_benchmark.csv";
+
+int csv2matStream(std::string file_path, bool header, MatX &data) {
+    std::string line, element;
+    std::ifstream infile(file_path);
+    if (infile.good() != true) {
+        return -1;
+    }
+
+    int nb_rows = csvrows(file_path);
+    int nb_cols = csvcols(file_path);
+    if (header) {
+        std::getline(infile, line);
+        nb_rows -= 1;
+    }
+
+    int line_no = 0;
+    data.resize(nb_rows, nb_cols);
+    while (std::getline(infile, line)) {
+        std::istringstream ss(line);
+        for (int i = 0; i < nb_cols; i++) {
+            std::getline(ss, element, ',');
+            data(line_no, i) = atof(element.c_str());
+        }
+        line_no++;
+    }
+    return 0;
+}
+
+int mat2csvStream(std::string file_path, MatX data) {
+    std::ofstream outfile(file_path);
+    if (outfile.good() != true) {
+        return -1;
+    }
+    for (int i = 0; i < data.rows(); i++) {
+        for (int j = 0; j < data.cols(); j++) {
+            outfile << data(i, j);
+            if ((j + 1) != data.cols()) {
+                outfile << ",";
+            }
+        }
+        outfile << "\n";
+    }
+    return 0;
+}
+
+/** An IMU-like log of `rows` rows at 100 Hz */
+MatX makeLog(int rows) {
+    MatX data = MatX::Random(rows, 7);
+    data.col(0).setLinSpaced(1.5e9, 1.5e9 + 0.01 * (rows - 1));
+    data.rightCols<3>() *= 9.81;
+    return data;
+}
+
+/** Writes the log for `state` and returns the size of the file in bytes */
+std::size_t writeLog(const benchmark::State &state) {
+    mat2csv(BENCHMARK_FILE, makeLog(state.range(0)));
+    std::ifstream infile(BENCHMARK_FILE, std::ios::ate | std::ios::binary);
+    return static_cast<std::size_t>(infile.tellg());
+}
+
+void BM_Csv2matStream(benchmark::State &state) {
+    const auto bytes = writeLog(state);
+    MatX data;
+
+    for (auto _ : state) {
+        csv2matStream(BENCHMARK_FILE, false, data);
+        benchmark::DoNotOptimize(data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void BM_Csv2matSerial(benchmark::State &state) {
+    const auto bytes = writeLog(state);
+    MatX data;
+
+    for (auto _ : state) {
+        csv2mat(BENCHMARK_FILE, false, data, 1);
+        benchmark::DoNotOptimize(data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void BM_Csv2matParallel(benchmark::State &state) {
+    const auto bytes = writeLog(state);
+    MatX data;
+
+    for (auto _ : state) {
+        csv2mat(BENCHMARK_FILE, false, data);
+        benchmark::DoNotOptimize(data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void BM_CsvForEachRow(benchmark::State &state) {
+    const auto bytes = writeLog(state);
+
+    for (auto _ : state) {
+        double sum = 0;
+        csvForEachRow(
+          BENCHMARK_FILE, false, [&sum](const VecX &row) { sum += row(1); });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void BM_Mat2csvStream(benchmark::State &state) {
+    const auto data = makeLog(state.range(0));
+
+    for (auto _ : state) {
+        mat2csvStream(BENCHMARK_FILE, data);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_Mat2csvSerial(benchmark::State &state) {
+    const auto data = makeLog(state.range(0));
+
+    for (auto _ : state) {
+        mat2csv(BENCHMARK_FILE, data, 1);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_Mat2csvParallel(benchmark::State &state) {
+    const auto data = makeLog(state.range(0));
+
+    for (auto _ : state) {
+        mat2csv(BENCHMARK_FILE, data);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Csv2matStream)->Arg(100000)->Arg(1000000)->UseRealTime();
+BENCHMARK(BM_Csv2matSerial)->Arg(100000)->Arg(1000000)->UseRealTime();
+BENCHMARK(BM_Csv2matParallel)->Arg(100000)->Arg(1000000)->UseRealTime();
+BENCHMARK(BM_CsvForEachRow)->Arg(100000)->Arg(1000000)->UseRealTime();
+BENCHMARK(BM_Mat2csvStream)->Arg(100000)->Arg(1000000)->UseRealTime();
+BENCHMARK(BM_Mat2csvSerial)->Arg(100000)->Arg(1000000)->UseRealTime();
+BENCHMARK(BM_Mat2csvParallel)->Arg(100000)->Arg(1000000)->UseRealTime();
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
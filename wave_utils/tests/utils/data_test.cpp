@@ -1,3 +1,6 @@
+#include <cstdlib>
+#include <sstream>
+
 #include "wave/wave_test.hpp"
 #include "wave/utils/data.hpp"
 
@@ -31,6 +34,22 @@ TEST(Utils_data, csv2mat) {
     ASSERT_FLOAT_EQ(613.503760567, data(279, 1));
 }
 
+TEST(Utils_data, csv2mat_single_column) {
+    std::ofstream outfile(TEST_OUTPUT);
+    outfile << "1.5\n-2\n3\n";
+    outfile.close();
+
+    // csvcols() finds no separator, but the values still form one column
+    ASSERT_EQ(0, csvcols(TEST_OUTPUT));
+    MatX data;
+    ASSERT_EQ(0, csv2mat(TEST_OUTPUT, false, data));
+    ASSERT_EQ(3, data.rows());
+    ASSERT_EQ(1, data.cols());
+    ASSERT_EQ(1.5, data(0, 0));
+    ASSERT_EQ(-2.0, data(1, 0));
+    ASSERT_EQ(3.0, data(2, 0));
+}
+
 TEST(Utils_data, mat2csv) {
     MatX x;
     MatX y;
@@ -46,4 +65,117 @@ TEST(Utils_data, mat2csv) {
     }
 }
 
+TEST(Utils_data, csv2mat_matches_atof) {
+    // Numbers on and off the fast path, and malformed entries
+    const std::vector<std::string> entries = {
+      "1", "-0.5", " 2.25", "3.0e-5", "1E22", "1e23", "-1e-300",
+      "12345678901234567890", "0.1234567890123456789", ".5", "5.", "+7",
+      "nan", "-inf", "abc", "", "1e", "0x10", "4.9406564584124654e-324"};
+    const int nb_cols = 4;
+
+    std::ofstream outfile(TEST_OUTPUT);
+    outfile << "a,b,c,d\n";
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        outfile << entries[i] << ",1," << entries[entries.size() - 1 - i]
+                << ",2\r\n";
+    }
+    outfile.close();
+
+    MatX data;
+    ASSERT_EQ(0, csv2mat(TEST_OUTPUT, true, data));
+    ASSERT_EQ(static_cast<int>(entries.size()), data.rows());
+    ASSERT_EQ(nb_cols, data.cols());
+
+    const auto expect_atof = [](const std::string &entry, double value) {
+        const double expected = atof(entry.c_str());
+        if (std::isnan(expected)) {
+            EXPECT_TRUE(std::isnan(value)) << entry;
+        } else {
+            EXPECT_EQ(expected, value) << entry;
+        }
+    };
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        expect_atof(entries[i], data(i, 0));
+        expect_atof(entries[entries.size() - 1 - i], data(i, 2));
+        EXPECT_EQ(1.0, data(i, 1));
+        EXPECT_EQ(2.0, data(i, 3));
+    }
+}
+
+TEST(Utils_data, parseCsvNumberFast_lastField) {
+    // csv2mat() passes the last field of each line with its line ending
+    for (const std::string field : {"2.5", "2.5\n", "2.5\r\n", " 2.5 \n"}) {
+        double value = 0.0;
+        EXPECT_TRUE(internal::parseCsvNumberFast(
+          field.data(), field.data() + field.size(), value))
+          << field;
+        EXPECT_EQ(2.5, value) << field;
+    }
+
+    // Anything else is left to strtod()
+    for (const std::string field : {"nan\n", "1e23\n", "", "\n", "1,"}) {
+        double value = 0.0;
+        EXPECT_FALSE(internal::parseCsvNumberFast(
+          field.data(), field.data() + field.size(), value))
+          << field;
+    }
+}
+
+TEST(Utils_data, csv2mat_parallel) {
+    // Enough rows to split the file between threads
+    MatX x = 1e3 * MatX::Random(100000, 7);
+    x.col(0).setLinSpaced(0, 1e9);
+    ASSERT_EQ(0, mat2csv(TEST_OUTPUT, x));
+
+    MatX serial, parallel;
+    ASSERT_EQ(0, csv2mat(TEST_OUTPUT, false, serial, 1));
+    ASSERT_EQ(x.rows(), serial.rows());
+    ASSERT_EQ(x.cols(), serial.cols());
+    EXPECT_TRUE(serial.isApprox(x, 1e-5));
+
+    for (const int n_threads : {2, 3, 8, 0}) {
+        ASSERT_EQ(0, csv2mat(TEST_OUTPUT, false, parallel, n_threads));
+        EXPECT_TRUE(serial == parallel) << n_threads;
+    }
+}
+
+TEST(Utils_data, csvForEachRow) {
+    MatX expected;
+    csv2mat(TEST_DATA, true, expected);
+
+    int nb_rows = 0;
+    ASSERT_EQ(0, csvForEachRow(TEST_DATA, true, [&](const VecX &row) {
+                  ASSERT_EQ(expected.cols(), row.size());
+                  EXPECT_TRUE(expected.row(nb_rows).transpose() == row);
+                  nb_rows++;
+              }));
+    EXPECT_EQ(expected.rows(), nb_rows);
+
+    EXPECT_EQ(-1, csvForEachRow("/nonexistent.csv", false, [](const VecX &) {
+              }));
+}
+
+TEST(Utils_data, mat2csv_matches_stream) {
+    MatX x = MatX::Random(10000, 3);
+    x(0, 0) = 1e-20;
+    x(1, 1) = -123456789.0;
+
+    std::ostringstream expected;
+    for (int i = 0; i < x.rows(); i++) {
+        for (int j = 0; j < x.cols(); j++) {
+            expected << x(i, j);
+            if ((j + 1) != x.cols()) {
+                expected << ",";
+            }
+        }
+        expected << "\n";
+    }
+
+    ASSERT_EQ(0, mat2csv(TEST_OUTPUT, x, 4));
+    std::ifstream infile(TEST_OUTPUT);
+    std::stringstream actual;
+    actual << infile.rdbuf();
+    EXPECT_EQ(expected.str(), actual.str());
+}
+
 }  // namespace wave
@@ -0,0 +1,63 @@
+#include <cstdio>
+#include <fstream>
+
+#include <unistd.h>
+
+#include "wave/wave_test.hpp"
+#include "wave/utils/mapped_file.hpp"
+
+#define TEST_DATA "tests/data/matrix.dat"
+#define TEST_EMPTY_FILE "/tmp/wave_mapped_file_empty.dat"
+#define TEST_PAGES_FILE "/tmp/wave_mapped_file_pages.dat"
+
+
+namespace wave {
+
+TEST(Utils_mapped_file, mapsWholeFile) {
+    MappedFile file{TEST_DATA};
+
+    std::ifstream infile{TEST_DATA, std::ios::binary};
+    std::string expected{std::istreambuf_iterator<char>(infile),
+                         std::istreambuf_iterator<char>()};
+
+    ASSERT_EQ(expected.size(), file.size());
+    EXPECT_EQ(expected, std::string(file.data(), file.size()));
+    EXPECT_EQ(TEST_DATA, file.path());
+}
+
+TEST(Utils_mapped_file, emptyFile) {
+    std::ofstream{TEST_EMPTY_FILE}.close();
+    MappedFile file{TEST_EMPTY_FILE};
+
+    EXPECT_EQ(0u, file.size());
+    EXPECT_EQ(nullptr, file.data());
+    EXPECT_EQ(0u, file.touchPages());
+    std::remove(TEST_EMPTY_FILE);
+}
+
+TEST(Utils_mapped_file, touchPagesRange) {
+    // Three pages, each starting with its page number
+    const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::string contents(3 * page_size, '\0');
+    for (std::size_t i = 0; i < 3; ++i) {
+        contents[i * page_size] = static_cast<char>(i + 1);
+    }
+    std::ofstream{TEST_PAGES_FILE, std::ios::binary} << contents;
+    MappedFile file{TEST_PAGES_FILE};
+
+    // A range touches the first byte of each page it overlaps
+    EXPECT_EQ(6u, file.touchPages());
+    EXPECT_EQ(1u, file.touchPages(1, 1));
+    EXPECT_EQ(3u, file.touchPages(1, page_size));
+    EXPECT_EQ(5u, file.touchPages(page_size + 1, 2 * page_size));
+    EXPECT_EQ(6u, file.touchPages(0, 10 * page_size));
+    EXPECT_EQ(0u, file.touchPages(1, 0));
+    EXPECT_EQ(0u, file.touchPages(file.size(), 1));
+    std::remove(TEST_PAGES_FILE);
+}
+
+TEST(Utils_mapped_file, missingFileThrows) {
+    EXPECT_THROW(MappedFile{"/tmp/wave_no_such_file.dat"}, std::runtime_error);
+}
+
+}  // namespace wave
@@ -0,0 +1,89 @@
+/** Throughput of the batch pose compositions against composePose().
+ *
+ * The poses are odometry-like steps with full 6x6 covariances. The benchmark
+ * argument is the number of compositions per iteration, and items/s is
+ * compositions per second.
+ *
+ * BM_ComposePosePairs and BM_ComposePoseChainSerial call composePose() once
+ * per pair or step. BM_ComposePoses and BM_ComposePoseChain use the batch
+ * functions.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "wave/utils/pose_cov_comp.hpp"
+
+namespace wave {
+
+PoseWithCovarianceVector makeSteps(int n) {
+    PoseWithCovarianceVector steps;
+    steps.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        Vector6 p;
+        p << 1, 0.1, 0, 0.01, 0.02, 0.05;
+        p.tail<3>() *= (i % 3) - 1;
+        Matrix6x6 cov = 1.0e-4 * Matrix6x6::Identity();
+        steps.emplace_back(p, cov);
+    }
+    return steps;
+}
+
+void BM_ComposePosePairs(benchmark::State &state) {
+    auto p1 = makeSteps(state.range(0));
+    auto p2 = makeSteps(state.range(0) + 1);
+    p2.erase(p2.begin());
+    PoseWithCovarianceVector result(p1.size());
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < p1.size(); ++i) {
+            result[i] = composePose(p1[i], p2[i]);
+        }
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ComposePoses(benchmark::State &state) {
+    auto p1 = makeSteps(state.range(0));
+    auto p2 = makeSteps(state.range(0) + 1);
+    p2.erase(p2.begin());
+    PoseWithCovarianceVector result;
+
+    for (auto _ : state) {
+        composePoses(p1, p2, result);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ComposePoseChainSerial(benchmark::State &state) {
+    auto steps = makeSteps(state.range(0));
+
+    for (auto _ : state) {
+        PoseWithCovariance r;
+        for (auto &step : steps) {
+            r = composePose(r, step);
+        }
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ComposePoseChain(benchmark::State &state) {
+    const auto steps = makeSteps(state.range(0));
+
+    for (auto _ : state) {
+        auto r = composePoseChain(PoseWithCovariance{}, steps);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ComposePosePairs)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_ComposePoses)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_ComposePoseChainSerial)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_ComposePoseChain)->Arg(1000)->Arg(100000);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
@@ -526,4 +526,81 @@ TEST(PoseCovComp, covariance_test_D) {
     Matrix6x6 covar(r1.covariance);
     EXPECT_TRUE(covar.isApprox(m_exp, 1e-6));
 }
-}  // namespace wave
\ No newline at end of file
+
+/// Random pose with a random positive definite covariance. Includes poses
+/// near the pitch = +-pi/2 degenerate case.
+PoseWithCovariance randomPose(int i) {
+    Vector6 p = Vector6::Random();
+    p.head<3>() *= 10;
+    p.tail<3>() *= M_PI;
+    if (i % 10 == 0) {
+        p(4) = M_PI / 2 * (i % 20 == 0 ? 1 : -1);
+    }
+
+    Matrix6x6 cov = Matrix6x6::Random();
+    cov = 1.0e-2 * (cov.transpose() * cov);
+
+    return PoseWithCovariance{p, cov};
+}
+
+/// The batch composition matches composePose() for each pair
+TEST(PoseCovComp, compose_poses_test) {
+    PoseWithCovarianceVector p1, p2, result;
+    for (int i = 0; i < 200; ++i) {
+        p1.push_back(randomPose(i));
+        p2.push_back(randomPose(i + 1));
+    }
+
+    composePoses(p1, p2, result);
+    ASSERT_EQ(p1.size(), result.size());
+
+    for (std::size_t i = 0; i < p1.size(); ++i) {
+        PoseWithCovariance expected = composePose(p1[i], p2[i]);
+        EXPECT_TRUE(expected.position.isApprox(result[i].position, 1e-12));
+        EXPECT_TRUE(expected.rotation_matrix.isApprox(
+          result[i].rotation_matrix, 1e-12));
+        EXPECT_TRUE(expected.covariance.isApprox(result[i].covariance, 1e-9))
+          << i;
+    }
+
+    p2.pop_back();
+    EXPECT_THROW(composePoses(p1, p2, result), std::invalid_argument);
+}
+
+/// The chain composition matches repeated calls to composePose()
+TEST(PoseCovComp, compose_pose_chain_test) {
+    Vector6 p = Vector6::Zero();
+    Matrix6x6 cov = 1.0e-4 * Matrix6x6::Identity();
+    PoseWithCovariance start{p, cov};
+
+    PoseWithCovarianceVector steps;
+    for (int i = 0; i < 100; ++i) {
+        // Small steps, like odometry, away from the degenerate case
+        p << 1, 0.1, 0, 0.01, 0.02, 0.05;
+        p.tail<3>() *= (i % 3) - 1;
+        cov = 1.0e-4 * Matrix6x6::Identity();
+        steps.emplace_back(p, cov);
+    }
+
+    PoseWithCovarianceVector chain;
+    composePoseChain(start, steps, chain);
+    ASSERT_EQ(steps.size(), chain.size());
+
+    PoseWithCovariance expected = start;
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        expected = composePose(expected, steps[i]);
+        EXPECT_TRUE(expected.position.isApprox(chain[i].position, 1e-10));
+        EXPECT_TRUE(expected.covariance.isApprox(chain[i].covariance, 1e-9))
+          << i;
+    }
+
+    const PoseWithCovariance last = composePoseChain(start, steps);
+    EXPECT_TRUE(last.position.isApprox(chain.back().position));
+    EXPECT_TRUE(last.covariance.isApprox(chain.back().covariance));
+
+    // An empty chain is the start pose
+    const PoseWithCovariance none =
+      composePoseChain(start, PoseWithCovarianceVector{});
+    EXPECT_TRUE(none.covariance.isApprox(start.covariance));
+}
+}  // namespace wave
@@ -128,6 +128,24 @@ struct VoDataset {
      * @todo: add error checking
      */
     static VoDataset loadFromDirectory(const std::string &input_dir);
+
+    /** Writes the whole dataset to a single binary file.
+     *
+     * Unlike the text files written by outputToDirectory(), the file can be
+     * read without parsing, using MappedVoDataset. Values are stored at full
+     * precision, and camera frames are kept.
+     *
+     * @throws std::runtime_error on failure
+     */
+    void outputBinary(const std::string &output_path) const;
+
+    /** Reads a dataset from a file written by outputBinary().
+     *
+     * To read states without copying them, use MappedVoDataset directly.
+     *
+     * @throws std::runtime_error on failure
+     */
+    static VoDataset loadFromBinary(const std::string &input_path);
 };
 
 /**
@@ -138,6 +156,11 @@ struct VoDataset {
  */
 class VoDatasetGenerator {
  public:
+    /** Loads the camera, landmark and trajectory parameters.
+     *
+     * The `trajectory` keys (`nb_steps`, `dt`, `circle_radius`, `velocity`)
+     * and `nb_threads` are optional, and keep their current values if absent.
+     */
     void configure(const std::string &config_file);
 
     /** Generate random 3D landmarks in the world frame
@@ -147,6 +170,13 @@ class VoDatasetGenerator {
      */
     LandmarkMap generateLandmarks();
 
+    /** Generate random 3D landmarks in the world frame, stored contiguously
+     *
+     * @returns matrix where each column is the position in x, y, z of the
+     * landmark whose id is the column index
+     */
+    LandmarkPoints generateLandmarkPoints();
+
     /** Simulates a two wheel robot traversing in a world with random 3D feature
  * points, and records:
  *
@@ -158,6 +188,9 @@ class VoDatasetGenerator {
  *
  * A measurement including robot pose is stored at every timestep (with an
  * arbitrary dt), but feature observations are only made at some timesteps.
+ *
+ * The trajectory is simulated first, then the landmarks are projected into
+ * each camera frame on nb_threads threads.
  */
     VoDataset generate();
 
@@ -166,6 +199,21 @@ class VoDatasetGenerator {
     Vec2 landmark_x_bounds = Vec2::Zero();
     Vec2 landmark_y_bounds = Vec2::Zero();
     Vec2 landmark_z_bounds = Vec2::Zero();
+
+    /** Number of simulated time steps */
+    int nb_steps = 300;
+
+    /** Time between simulated steps, in seconds */
+    double dt = 0.01;
+
+    /** Radius of the circle driven by the robot, in metres */
+    double circle_radius = 0.5;
+
+    /** Forward velocity of the robot, in metres per second */
+    double velocity = 1.0;
+
+    /** Number of threads projecting landmarks, or 0 to use one per core */
+    int nb_threads = 0;
 };
 
 /** @} end of group */
@@ -0,0 +1,162 @@
+/**
+ * @file
+ * Single-file binary format for VoDataset, with a memory-mapped reader.
+ * @ingroup vision
+ */
+#ifndef WAVE_VISION_VODATASETBINARY_HPP
+#define WAVE_VISION_VODATASETBINARY_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "wave/utils/mapped_file.hpp"
+#include "wave/vision/dataset/VoDataset.hpp"
+
+namespace wave {
+/** @addtogroup vision
+ *  @{ */
+
+/** Read-only, zero-copy view of one state of a MappedVoDataset.
+ *
+ * Values are read directly from the mapped file. The view is valid only while
+ * the MappedVoDataset that created it exists.
+ */
+class VoInstantView {
+ public:
+    /** A time in nominal seconds */
+    double time() const {
+        return this->state[0];
+    }
+
+    /** The corresponding camera frame, or -1 if no camera observations */
+    int cameraFrame() const {
+        return this->camera_frame;
+    }
+
+    /** True robot Body position in the Global frame */
+    Eigen::Map<const Vec3> robot_G_p_GB() const {
+        return Eigen::Map<const Vec3>{this->state + 1};
+    }
+
+    /** True robot Body orientation in the Global frame */
+    Eigen::Map<const Quaternion> robot_q_GB() const {
+        return Eigen::Map<const Quaternion>{this->state + 4};
+    }
+
+    /** Returns the number of feature observations */
+    std::size_t size() const {
+        return this->num_observed;
+    }
+
+    /** Returns the landmark id of the k-th observation */
+    LandmarkId landmarkId(std::size_t k) const {
+        return static_cast<LandmarkId>(this->ids[k]);
+    }
+
+    /** Returns the measurement in the image frame of the k-th observation */
+    Eigen::Map<const Vec2> measurement(std::size_t k) const {
+        return Eigen::Map<const Vec2>{this->measurements + 2 * k};
+    }
+
+    /** Copies the state into a VoInstant */
+    VoInstant toInstant() const;
+
+ private:
+    friend class MappedVoDataset;
+
+    VoInstantView(const double *state,
+                  int camera_frame,
+                  std::size_t num_observed,
+                  const uint64_t *ids,
+                  const double *measurements)
+        : state{state},
+          camera_frame{camera_frame},
+          num_observed{num_observed},
+          ids{ids},
+          measurements{measurements} {}
+
+    /** Time, position (x, y, z) and quaternion (x, y, z, w) */
+    const double *state;
+    int camera_frame;
+    std::size_t num_observed;
+    const uint64_t *ids;
+    const double *measurements;
+};
+
+/** A VoDataset file written by VoDataset::outputBinary(), mapped into memory.
+ *
+ * Opening the file maps it and checks its header, without parsing any of the
+ * data, so the cost of opening does not depend on the size of the dataset.
+ * States are then read in place through VoInstantView.
+ *
+ * The file holds, in order:
+ * 1. A header with a format version, the table sizes and the camera matrix
+ * 2. A landmark table, of the id and position (x, y, z) of each landmark,
+ *    sorted by id
+ * 3. A state table, of the time, position, orientation, camera frame, and
+ *    range of observations of each state
+ * 4. The landmark ids of all observations, in state order
+ * 5. The measurements (u, v) of all observations, in the same order
+ *
+ * Observations are stored in columns, so each state's observations are two
+ * contiguous ranges. All values are 64-bit and in native byte order.
+ */
+class MappedVoDataset {
+ public:
+    /** Maps the file and checks its header.
+     *
+     * @throws std::runtime_error if the file cannot be mapped, or is not a
+     * VoDataset file of a supported version
+     */
+    explicit MappedVoDataset(const std::string &input_path);
+
+    /** Pinhole camera intrinsic calibration matrix */
+    Mat3 cameraK() const;
+
+    /** Returns the number of landmarks */
+    std::size_t numLandmarks() const {
+        return this->num_landmarks;
+    }
+
+    /** Returns the id of the i-th landmark, in order of increasing id */
+    LandmarkId landmarkId(std::size_t i) const;
+
+    /** Returns the ground truth position of the i-th landmark */
+    Eigen::Map<const Vec3> landmarkPosition(std::size_t i) const;
+
+    /** Returns the number of states */
+    std::size_t size() const {
+        return this->num_states;
+    }
+
+    /** Returns a view of the i-th state. No bounds checking. */
+    VoInstantView operator[](std::size_t i) const;
+
+    /** Copies the whole dataset into a VoDataset */
+    VoDataset toVoDataset() const;
+
+ private:
+    std::shared_ptr<const MappedFile> file;
+    std::size_t num_landmarks = 0;
+    std::size_t num_states = 0;
+    std::size_t num_observations = 0;
+
+    /** Starts of the tables within the file */
+    const char *landmarks = nullptr;
+    const char *states = nullptr;
+    const uint64_t *observation_ids = nullptr;
+    const double *measurements = nullptr;
+};
+
+/** Converts a dataset written by VoDataset::outputToDirectory() to the binary
+ * format read by MappedVoDataset.
+ *
+ * @throws std::runtime_error on failure
+ */
+void convertVoDatasetDirectory(const std::string &input_dir,
+                               const std::string &output_path);
+
+/** @} end of group */
+}  // namespace wave
+#endif  // WAVE_VISION_VODATASETBINARY_HPP
@@ -17,6 +17,10 @@ namespace wave {
 /** Container for landmarks sorted by id */
 using LandmarkMap = std::map<LandmarkId, Vec3>;
 
+/** Landmark positions stored contiguously, one landmark per column. The id of
+ * each landmark is its column index. */
+using LandmarkPoints = Eigen::Matrix3Xd;
+
 /** One observation of a landmark, in pixel coordinates */
 using LandmarkObservation = std::pair<LandmarkId, Vec2>;
 
@@ -66,6 +70,43 @@ class VoTestCamera {
                          const Quaternion &q_GC,
                          const Vec3 &G_p_GC,
                          std::vector<LandmarkObservation> &observed);
+
+    /** Gives a list of measurements of visible landmarks, if enough time has
+     * passed since the last frame
+     *
+     * Equivalent to the LandmarkMap overload, with the landmarks projected in
+     * batches.
+     *
+     * @param dt Update time step
+     * @param landmarks 3D landmark positions in world frame, one per column
+     * @param q_GC orientation of camera in global frame
+     * @param G_p_GC translation to camera from origin, in global frame
+     * @param observed Observed 3D features in the image frame
+     * @returns 0 if observations were made, 1 if not enough time passed
+     */
+    int observeLandmarks(double dt,
+                         const LandmarkPoints &landmarks,
+                         const Quaternion &q_GC,
+                         const Vec3 &G_p_GC,
+                         std::vector<LandmarkObservation> &observed);
+
+    /** Gives a list of measurements of the landmarks visible from a pose,
+     * regardless of the camera rate. Does not change the camera state, so
+     * may be called from several threads at once.
+     *
+     * All landmarks are transformed and projected by one matrix product per
+     * batch of columns, and tested against the image bounds as arrays.
+     *
+     * @param landmarks 3D landmark positions in world frame, one per column
+     * @param q_GC orientation of camera in global frame
+     * @param G_p_GC translation to camera from origin, in global frame
+     * @param observed Observed 3D features in the image frame, in order of
+     * landmark id
+     */
+    void projectLandmarks(const LandmarkPoints &landmarks,
+                          const Quaternion &q_GC,
+                          const Vec3 &G_p_GC,
+                          std::vector<LandmarkObservation> &observed) const;
 };
 
 
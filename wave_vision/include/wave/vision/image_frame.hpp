@@ -0,0 +1,85 @@
+/**
+ * @file
+ * Image frame with a lazily built, reusable image pyramid.
+ * @ingroup vision
+ */
+#ifndef WAVE_VISION_IMAGE_FRAME_HPP
+#define WAVE_VISION_IMAGE_FRAME_HPP
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+namespace wave {
+/** @addtogroup vision
+ *  @{ */
+
+/** An image prepared once for all stages of the vision pipeline.
+ *
+ *  The grayscale image is computed once when the image is set, and shared by
+ *  the detector, descriptor and flow stages, each of which would otherwise
+ *  convert the input themselves. The pyramid is built on first use, with
+ *  optional precomputed gradients for Lucas-Kanade flow.
+ *
+ *  All buffers are kept between frames. Setting a new image of the same size
+ *  reuses them, so keeping two frames and alternating between them tracks a
+ *  sequence with no per-frame allocation, while retaining the previous
+ *  frame's pyramid for flow.
+ */
+class ImageFrame {
+ public:
+    ImageFrame() = default;
+
+    /** Sets the image for a new frame, invalidating the pyramid.
+     *
+     *  Colour (BGR) images are converted to grayscale, and grayscale images
+     *  copied, into an internal buffer.
+     *
+     *  @param image the new image
+     */
+    void setImage(const cv::Mat &image);
+
+    /** Returns true if no image has been set. */
+    bool empty() const {
+        return this->gray.empty();
+    }
+
+    /** Returns the grayscale image. */
+    const cv::Mat &image() const {
+        return this->gray;
+    }
+
+    /** Returns the image pyramid, building it if needed.
+     *
+     *  The pyramid is in the format produced by cv::buildOpticalFlowPyramid,
+     *  and can be passed directly to cv::calcOpticalFlowPyrLK. It is cached
+     *  until the image or the requested parameters change.
+     *
+     *  @param win_size the flow window size, which sets the border padding
+     *  @param max_level the number of levels above the original image
+     *  @param with_gradients whether to also store the Scharr gradients of
+     *  each level, which flow would otherwise compute on every call
+     *  @return the pyramid
+     */
+    const std::vector<cv::Mat> &pyramid(const cv::Size &win_size,
+                                        int max_level,
+                                        bool with_gradients = true);
+
+ private:
+    /** The grayscale image */
+    cv::Mat gray;
+
+    /** Pyramid levels, with their storage reused between frames */
+    std::vector<cv::Mat> levels;
+
+    /** Parameters of the current contents of levels */
+    bool pyramid_valid = false;
+    cv::Size pyramid_win_size;
+    int pyramid_max_level = -1;
+    bool pyramid_gradients = false;
+};
+
+/** @} group vision */
+}  // namespace wave
+
+#endif  // WAVE_VISION_IMAGE_FRAME_HPP
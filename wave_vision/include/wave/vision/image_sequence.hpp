@@ -0,0 +1,210 @@
+/**
+ * @file
+ * Streaming image sequence loader with background decoding.
+ * @ingroup vision
+ */
+#ifndef WAVE_VISION_IMAGE_SEQUENCE_HPP
+#define WAVE_VISION_IMAGE_SEQUENCE_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+namespace wave {
+/** @addtogroup vision
+ *  @{ */
+
+/** Configuration parameters for the ImageSequence */
+struct ImageSequenceParams {
+    ImageSequenceParams() = default;
+
+    ImageSequenceParams(const int num_threads,
+                        const int prefetch_depth,
+                        const double scale,
+                        const bool grayscale)
+        : num_threads(num_threads),
+          prefetch_depth(prefetch_depth),
+          scale(scale),
+          grayscale(grayscale) {}
+
+    /** Number of background threads decoding images.
+     *
+     *  Recommended: 2. Must be at least one.
+     */
+    int num_threads = 2;
+
+    /** Maximum number of decoded images held ahead of the consumer. Peak
+     *  memory is proportional to this, rather than to the sequence length.
+     *
+     *  Recommended: 8. Must be at least num_threads.
+     */
+    int prefetch_depth = 8;
+
+    /** Factor by which images are resized when decoded. Factors of 1/2, 1/4
+     *  and 1/8 are applied by the JPEG decoder itself, which is faster than
+     *  decoding at full size and resizing.
+     *
+     *  Recommended: 1.0. Must be greater than 0 and at most 1.
+     */
+    double scale = 1.0;
+
+    /** Whether images are decoded as grayscale rather than BGR */
+    bool grayscale = false;
+};
+
+/** A sequence of image files, decoded lazily in order.
+ *
+ *  Background threads decode up to `prefetch_depth` images past the last one
+ *  returned, so the consumer rarely waits on disk or the decoder, while only
+ *  a bounded number of images is in memory at once. Images are returned in
+ *  sequence order, whichever thread decoded them.
+ *
+ *  The sequence is read once. Errors while reading an image are rethrown
+ *  when that image is requested.
+ */
+class ImageSequence {
+ public:
+    /** Input iterator over the remaining images of a sequence */
+    class iterator {
+     public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = cv::Mat;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const cv::Mat *;
+        using reference = const cv::Mat &;
+
+        /** Constructs the end iterator */
+        iterator() = default;
+
+        reference operator*() const {
+            return this->image;
+        }
+
+        pointer operator->() const {
+            return &this->image;
+        }
+
+        iterator &operator++() {
+            if (!this->sequence->next(this->image)) {
+                this->sequence = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const {
+            return this->sequence == other.sequence;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+     private:
+        friend class ImageSequence;
+
+        explicit iterator(ImageSequence *sequence) : sequence(sequence) {
+            ++(*this);
+        }
+
+        ImageSequence *sequence = nullptr;
+        cv::Mat image;
+    };
+
+    /** Opens a numbered sequence of images, and starts decoding.
+     *
+     *  As for readImageSequence, the path is that of the first image, and
+     *  the sequence continues while files exist with the number in the file
+     *  name incremented, keeping its zero padding. For example,
+     *  `frame0057.jpg` is followed by `frame0058.jpg`.
+     *
+     *  @param images_path location of the first image
+     *  @param config contains the desired parameter values
+     *  @throws std::length_error if the first image does not exist
+     */
+    explicit ImageSequence(
+      const std::string &images_path,
+      const ImageSequenceParams &config = ImageSequenceParams{});
+
+    ~ImageSequence();
+
+    ImageSequence(const ImageSequence &) = delete;
+    ImageSequence &operator=(const ImageSequence &) = delete;
+
+    /** Returns the current configuration parameters */
+    ImageSequenceParams getConfiguration() const {
+        return this->current_config;
+    }
+
+    /** Returns the number of images in the sequence */
+    size_t size() const {
+        return this->files.size();
+    }
+
+    /** Returns the path of each image in the sequence */
+    const std::vector<std::string> &paths() const {
+        return this->files;
+    }
+
+    /** Gets the next image, blocking until it has been decoded.
+     *
+     *  @param image the next image
+     *  @return false if every image has already been returned
+     *  @throws std::runtime_error if the image could not be read
+     */
+    bool next(cv::Mat &image);
+
+    /** Returns an iterator at the next image to be returned */
+    iterator begin() {
+        return iterator{this};
+    }
+
+    iterator end() {
+        return iterator{};
+    }
+
+ private:
+    /** Current configuration parameters */
+    ImageSequenceParams current_config;
+
+    /** Paths of the images, in order */
+    std::vector<std::string> files;
+
+    /** Decoded images, in a ring indexed by sequence position modulo
+     *  prefetch_depth, with a flag set once each is ready */
+    std::vector<cv::Mat> slots;
+    std::vector<bool> slot_ready;
+    std::vector<std::exception_ptr> slot_errors;
+
+    /** Position of the next image to be claimed by a worker */
+    size_t num_claimed = 0;
+
+    /** Position of the next image to be returned */
+    size_t num_returned = 0;
+
+    bool stop = false;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable ready_condition;
+    std::condition_variable space_condition;
+
+    /** Checks the configuration, and throws if it is invalid */
+    void checkConfiguration(const ImageSequenceParams &check_config) const;
+
+    /** Reads one image, applying the grayscale and scale options */
+    cv::Mat decode(const std::string &path) const;
+
+    /** Function run by each worker thread */
+    void spin();
+};
+
+/** @} group vision */
+}  // namespace wave
+
+#endif  // WAVE_VISION_IMAGE_SEQUENCE_HPP
@@ -0,0 +1,122 @@
+#ifndef WAVE_VISION_UTILS_IMPL_HPP
+#define WAVE_VISION_UTILS_IMPL_HPP
+
+#include <cassert>
+
+#include "wave/vision/utils.hpp"
+
+namespace wave {
+
+namespace internal {
+
+/** Jacobian of the pixel measurement with respect to the point in the camera
+ * frame, for a point with homogeneous image coordinates `h = K * C_p_CF`. */
+inline Eigen::Matrix<double, 2, 3> pinholeProjectionJacobian(const Mat3 &K,
+                                                             const Vec3 &h) {
+    const double inv_z = 1.0 / h(2);
+    const Vec2 uv = h.head<2>() * inv_z;
+    return (K.topRows<2>() - uv * K.row(2)) * inv_z;
+}
+
+/** Skew-symmetric matrix `[v]x`, so that `[v]x * w = v.cross(w)` */
+inline Mat3 pinholeSkew(const Vec3 &v) {
+    Mat3 m;
+    m << 0, -v(2), v(1), v(2), 0, -v(0), -v(1), v(0), 0;
+    return m;
+}
+
+}  // namespace internal
+
+inline bool pinholeProject(const Mat3 &K,
+                           const Mat3 &R_GC,
+                           const Vec3 &G_p_GC,
+                           const Vec3 &G_p_GF,
+                           Vec2 &result,
+                           Eigen::Matrix<double, 2, 6> *J_pose,
+                           Eigen::Matrix<double, 2, 3> *J_point) {
+    const Mat3 R_CG = R_GC.transpose();
+    const Vec3 C_p_CF = R_CG * (G_p_GF - G_p_GC);
+    const Vec3 h = K * C_p_CF;
+    result = h.head<2>() / h(2);
+
+    if (J_pose != nullptr || J_point != nullptr) {
+        const Eigen::Matrix<double, 2, 3> J_proj =
+          internal::pinholeProjectionJacobian(K, h);
+        const Eigen::Matrix<double, 2, 3> J_G = J_proj * R_CG;
+        if (J_pose != nullptr) {
+            // d(C_p_CF)/d(d_theta) = [C_p_CF]x, d(C_p_CF)/d(d_p) = -R_CG
+            J_pose->leftCols<3>() = J_proj * internal::pinholeSkew(C_p_CF);
+            J_pose->rightCols<3>() = -J_G;
+        }
+        if (J_point != nullptr) {
+            *J_point = J_G;
+        }
+    }
+
+    return h(2) > 0;
+}
+
+template <typename DerivedPoints>
+void pinholeProjectBatch(const Mat3 &K,
+                         const Mat3 &R_GC,
+                         const Vec3 &G_p_GC,
+                         const Eigen::MatrixBase<DerivedPoints> &G_p_GF,
+                         PinholeProjections &result,
+                         Eigen::Array<bool, 1, Eigen::Dynamic> &in_front,
+                         Eigen::Matrix<double, 12, Eigen::Dynamic> *J_pose,
+                         Eigen::Matrix<double, 6, Eigen::Dynamic> *J_point) {
+    static_assert(DerivedPoints::RowsAtCompileTime == 3 ||
+                    DerivedPoints::RowsAtCompileTime == Eigen::Dynamic,
+                  "G_p_GF must have 3 rows");
+    assert(G_p_GF.rows() == 3);
+
+    const auto n = G_p_GF.cols();
+    result.resize(2, n);
+    in_front.resize(n);
+
+    // Without Jacobians, project every point with one product
+    // h = P * G_p_GF + b, where P = K * R_CG and b = -P * G_p_GC
+    if (J_pose == nullptr && J_point == nullptr) {
+        const Mat3 P = K * R_GC.transpose();
+        const Vec3 b = -P * G_p_GC;
+        const Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::RowMajor> h =
+          (P * G_p_GF).colwise() + b;
+        result.row(0).array() = h.row(0).array() / h.row(2).array();
+        result.row(1).array() = h.row(1).array() / h.row(2).array();
+        in_front = h.row(2).array() > 0;
+        return;
+    }
+
+    if (J_pose != nullptr) {
+        J_pose->resize(12, n);
+    }
+    if (J_point != nullptr) {
+        J_point->resize(6, n);
+    }
+
+    const Mat3 R_CG = R_GC.transpose();
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const Vec3 C_p_CF = R_CG * (G_p_GF.col(i) - G_p_GC);
+        const Vec3 h = K * C_p_CF;
+        result(0, i) = h(0) / h(2);
+        result(1, i) = h(1) / h(2);
+        in_front(i) = h(2) > 0;
+
+        const Eigen::Matrix<double, 2, 3> J_proj =
+          internal::pinholeProjectionJacobian(K, h);
+        const Eigen::Matrix<double, 2, 3> J_G = J_proj * R_CG;
+        if (J_pose != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 2, 6>> J{J_pose->col(i).data()};
+            J.leftCols<3>() = J_proj * internal::pinholeSkew(C_p_CF);
+            J.rightCols<3>() = -J_G;
+        }
+        if (J_point != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 2, 3>>{J_point->col(i).data()} =
+              J_G;
+        }
+    }
+}
+
+}  // namespace wave
+
+#endif  // WAVE_VISION_UTILS_IMPL_HPP
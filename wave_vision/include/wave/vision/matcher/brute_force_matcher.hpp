@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "wave/vision/matcher/descriptor_matcher.hpp"
+#include "wave/vision/matcher/epipolar_ransac.hpp"
 
 namespace wave {
 /** @addtogroup vision
@@ -139,9 +140,32 @@ struct BFMatcherParams {
      *  cv::FM_LMEDS : least-median algorithm
      *  cv::FM_RANSAC: RANSAC algorithm
      *
+     *  cv::FM_RANSAC is performed by wave::EpipolarRansac, which samples the
+     *  matches in order of descriptor distance and stops as soon as
+     *  fm_confidence is reached. The other methods use cv::findFundamentalMat.
+     *
      *  Recommended: cv::FM_RANSAC.
      */
     int fm_method = cv::FM_RANSAC;
+
+    /** Maximum Sampson distance, in pixels, of a match from its epipolar
+     *  constraint for the match to be considered an inlier. Only used for
+     *  cv::FM_RANSAC.
+     *
+     *  The Sampson distance is never larger than the distance from a point
+     *  to its epipolar line used by cv::findFundamentalMat, so the same
+     *  threshold accepts at least as many matches.
+     *
+     *  Recommended: 3.0. Must be greater than zero.
+     */
+    double fm_threshold = 3.0;
+
+    /** Desired confidence that the estimated fundamental matrix is correct.
+     *  Only used for cv::FM_RANSAC and cv::FM_LMEDS.
+     *
+     *  Recommended: 0.99. Must be between 0 and 1.
+     */
+    double fm_confidence = 0.99;
 };
 
 /** Representation of a descriptor matcher using the BruteForce algorithm.
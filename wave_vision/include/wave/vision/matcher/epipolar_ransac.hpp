@@ -0,0 +1,228 @@
+/**
+ * @file
+ * Robust estimation of the epipolar geometry between two images.
+ * @ingroup vision
+ */
+#ifndef WAVE_VISION_EPIPOLAR_RANSAC_HPP
+#define WAVE_VISION_EPIPOLAR_RANSAC_HPP
+
+#include <random>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/features2d/features2d.hpp>
+
+#include "wave/utils/math.hpp"
+
+namespace wave {
+/** @addtogroup vision
+ *  @{ */
+
+/** Configuration parameters for EpipolarRansac */
+struct EpipolarRansacParams {
+    EpipolarRansacParams() = default;
+
+    EpipolarRansacParams(const double threshold,
+                         const double confidence,
+                         const int max_iterations,
+                         const int sample_size)
+        : threshold(threshold),
+          confidence(confidence),
+          max_iterations(max_iterations),
+          sample_size(sample_size) {}
+
+    /** Maximum Sampson distance, in pixels, of an inlier from its epipolar
+     *  constraint.
+     *
+     *  Recommended: 3.0. Must be greater than zero.
+     */
+    double threshold = 3.0;
+
+    /** Desired probability that at least one sample contains only inliers.
+     *  Sampling stops as soon as the best model so far reaches it.
+     *
+     *  Recommended: 0.99. Must be between 0 and 1.
+     */
+    double confidence = 0.99;
+
+    /** Maximum number of hypotheses, reached only at high outlier ratios.
+     *
+     *  Recommended: 2000.
+     */
+    int max_iterations = 2000;
+
+    /** Size of the minimal sample.
+     *
+     *  Options:
+     *  7: 7-point algorithm, which yields up to three hypotheses per sample
+     *  8: 8-point algorithm, which yields one hypothesis per sample
+     *
+     *  The 7-point algorithm needs far fewer samples at a given outlier ratio.
+     *
+     *  Recommended: 7.
+     */
+    int sample_size = 7;
+};
+
+/** Estimates the fundamental matrix between two images with RANSAC, rejecting
+ *  mismatched keypoints.
+ *
+ *  Compared to cv::findFundamentalMat with cv::FM_RANSAC, the estimator
+ *
+ *  - samples correspondences in order of quality, following PROSAC ([Chum and
+ *    Matas (2005)][PROSAC]), so that a good hypothesis is usually found within
+ *    the first few samples when the best matches are mostly inliers;
+ *  - scores each hypothesis against all correspondences at once, with the
+ *    Sampson distance evaluated over contiguous coordinate arrays that Eigen
+ *    vectorizes;
+ *  - stops as soon as the best model reaches the desired confidence;
+ *  - refits the best model to all of its inliers.
+ *
+ *  All buffers are kept between calls, so an estimator reused for every frame
+ *  of a sequence does not allocate once it has seen the largest match set.
+ *  Sampling uses a fixed seed, so results are repeatable.
+ *
+ *  The fundamental matrix F maps points in the first image to epipolar lines
+ *  in the second, such that \f$ x_2^T F x_1 = 0 \f$.
+ *
+ *  [PROSAC]: http://cmp.felk.cvut.cz/~matas/papers/chum-prosac-cvpr05.pdf
+ */
+class EpipolarRansac {
+ public:
+    explicit EpipolarRansac(
+      const EpipolarRansacParams &config = EpipolarRansacParams{});
+
+    /** Returns the current configuration parameters */
+    EpipolarRansacParams getConfiguration() const {
+        return this->current_config;
+    }
+
+    /** Estimates the fundamental matrix from point correspondences.
+     *
+     *  @param points_1 points in the first image, one per column
+     *  @param points_2 corresponding points in the second image
+     *  @param fundamental_matrix the estimated fundamental matrix, or zero if
+     *  there are fewer correspondences than the sample size
+     *  @param inliers set to 1 for each inlier correspondence, 0 otherwise
+     *
+     *  Correspondences should be ordered from most to least likely to be
+     *  correct, for example by descriptor distance. Any order gives a correct
+     *  result, but only a good order lets PROSAC terminate early.
+     *
+     *  @return the number of inliers
+     */
+    int estimateFundamental(const Eigen::Matrix2Xd &points_1,
+                            const Eigen::Matrix2Xd &points_2,
+                            Mat3 &fundamental_matrix,
+                            std::vector<uchar> &inliers);
+
+    /** Overloaded method, which takes matched keypoints. Matches are sampled
+     *  in order of descriptor distance.
+     *
+     *  @param matches matches between the two sets of keypoints
+     *  @param keypoints_1 the keypoints detected in the first image
+     *  @param keypoints_2 the keypoints detected in the second image
+     *  @param fundamental_matrix the estimated fundamental matrix
+     *  @param inliers set to 1 for each inlier match, 0 otherwise, in the
+     *  order of `matches`
+     *
+     *  @return the number of inliers
+     */
+    int estimateFundamental(const std::vector<cv::DMatch> &matches,
+                            const std::vector<cv::KeyPoint> &keypoints_1,
+                            const std::vector<cv::KeyPoint> &keypoints_2,
+                            Mat3 &fundamental_matrix,
+                            std::vector<uchar> &inliers);
+
+ private:
+    /** Current configuration parameters */
+    EpipolarRansacParams current_config;
+
+    /** Random number generator for sampling */
+    std::mt19937 generator;
+
+    /** Number of points stored in the coordinate arrays, which may be
+     *  longer */
+    int num_points = 0;
+
+    /** Point coordinates in pixels, in sampling order */
+    Eigen::ArrayXd x1, y1, x2, y2;
+
+    /** Point coordinates after Hartley normalization, used by the solvers */
+    Eigen::ArrayXd nx1, ny1, nx2, ny2;
+
+    /** Normalizing transforms of each image */
+    Mat3 T1, T2;
+
+    /** Sampson distances of the hypothesis being scored */
+    Eigen::ArrayXd errors;
+
+    /** Sampling order of keypoint matches */
+    std::vector<int> order;
+
+    /** Inlier mask in sampling order */
+    std::vector<uchar> sorted_inliers;
+
+    /** Current sample, or the inliers of the model being refitted */
+    std::vector<int> sample;
+
+    /** Hypotheses computed from the current sample */
+    std::vector<Mat3> hypotheses;
+
+    /** Checks the configuration, and throws if it is invalid */
+    void checkConfiguration(const EpipolarRansacParams &check_config) const;
+
+    /** Sets the number of points, growing the coordinate arrays if needed */
+    void setNumPoints(int n);
+
+    /** Runs RANSAC on the points stored in the coordinate arrays.
+     *
+     *  @param fundamental_matrix the best model, in pixel coordinates
+     *  @param inliers the inlier mask, in sampling order
+     *  @return the number of inliers
+     */
+    int run(Mat3 &fundamental_matrix, std::vector<uchar> &inliers);
+
+    /** Computes the normalized coordinates and normalizing transforms */
+    void normalizePoints();
+
+    /** Draws a PROSAC sample of distinct point indices.
+     *
+     *  @param t the index of this sample, starting at 1
+     *  @param n the size of the top subset sampled from, updated in place
+     *  @param T_n the expected number of samples drawn from the top n
+     *  points, updated in place
+     *  @param T_n_prime the sample at which n next grows, updated in place
+     *  @param sample the drawn indices
+     */
+    void drawSample(int t,
+                    int &n,
+                    double &T_n,
+                    double &T_n_prime,
+                    std::vector<int> &sample);
+
+    /** Computes fundamental matrix hypotheses from the normalized points.
+     *
+     *  Points are fitted in the least squares sense, so this also refits a
+     *  model to all of its inliers.
+     *
+     *  @param indices the points to fit
+     *  @param minimal whether to use the 7-point solver, which requires
+     *  exactly seven points, rather than the 8-point solver
+     *  @param hypotheses the hypotheses, in pixel coordinates
+     */
+    void solve(const std::vector<int> &indices,
+               bool minimal,
+               std::vector<Mat3> &hypotheses) const;
+
+    /** Scores a hypothesis, leaving the Sampson distances in `errors`
+     *
+     *  @return the number of inliers
+     */
+    int score(const Mat3 &fundamental_matrix);
+};
+
+/** @} group vision */
+}  // namespace wave
+
+#endif  // WAVE_VISION_EPIPOLAR_RANSAC_HPP
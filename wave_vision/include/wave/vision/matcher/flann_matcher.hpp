@@ -11,6 +11,8 @@
 #include <vector>
 
 #include <wave/vision/matcher/descriptor_matcher.hpp>
+#include <wave/vision/matcher/epipolar_ransac.hpp>
+#include <wave/vision/matcher/lsh_index.hpp>
 
 namespace wave {
 /** @addtogroup vision
@@ -41,13 +43,18 @@ namespace FLANN {
  *  candidate matches to be generated very quickly. This was proposed by [Lv et.
  *  al (2007)][LSH].
  *
+ *  IncrementalLSH: Multi-probe LSH using wave::LSHIndex rather than OpenCV.
+ *  Only binary descriptors of type CV_8U are supported. The hash tables keep
+ *  their storage between calls, and the index is refilled with the second set
+ *  of descriptors on each match.
+ *
  *  These brief descriptions were adapted from Kaehler and Bradski's book
  *  "Learning OpenCV 3: Computer Vision in C++ with the OpenCV Library". For
  *  further reference on the different methods, please refer to pages 575-580.
  *
  *  [LSH]: http://www.cs.princeton.edu/cass/papers/mplsh_vldb07.pdf
  */
-enum { KDTree = 1, KMeans = 2, Composite = 3, LSH = 4 };
+enum { KDTree = 1, KMeans = 2, Composite = 3, LSH = 4, IncrementalLSH = 5 };
 }  // namespace FLANN
 
 struct FLANNMatcherParams {
@@ -94,6 +101,7 @@ struct FLANNMatcherParams {
      *  FLANN::KMeans: k-means clustering.
      *  FLANN::Composite: Combines the above methods.
      *  FLANN::LSH: Locality-sensitive hash table separation.
+     *  FLANN::IncrementalLSH: LSH using wave::LSHIndex.
      *
      *  Recommended: FLANN::KDTree
      */
@@ -160,9 +168,32 @@ struct FLANNMatcherParams {
      *  cv::FM_LMEDS : least-median algorithm
      *  cv::FM_RANSAC: RANSAC algorithm
      *
+     *  cv::FM_RANSAC is performed by wave::EpipolarRansac, which samples the
+     *  matches in order of descriptor distance and stops as soon as
+     *  fm_confidence is reached. The other methods use cv::findFundamentalMat.
+     *
      *  Recommended: cv::FM_RANSAC.
      */
     int fm_method = cv::FM_RANSAC;
+
+    /** Maximum Sampson distance, in pixels, of a match from its epipolar
+     *  constraint for the match to be considered an inlier. Only used for
+     *  cv::FM_RANSAC.
+     *
+     *  The Sampson distance is never larger than the distance from a point
+     *  to its epipolar line used by cv::findFundamentalMat, so the same
+     *  threshold accepts at least as many matches.
+     *
+     *  Recommended: 3.0. Must be greater than zero.
+     */
+    double fm_threshold = 3.0;
+
+    /** Desired confidence that the estimated fundamental matrix is correct.
+     *  Only used for cv::FM_RANSAC and cv::FM_LMEDS.
+     *
+     *  Recommended: 0.99. Must be between 0 and 1.
+     */
+    double fm_confidence = 0.99;
 };
 
 /** Representation of a descriptor matcher using the FLANN algorithm.
@@ -237,6 +268,9 @@ class FLANNMatcher : public DescriptorMatcher {
     /** The pointer to the wrapped cv::FlannBasedMatcher object */
     cv::Ptr<cv::FlannBasedMatcher> flann_matcher;
 
+    /** The index used instead of flann_matcher for FLANN::IncrementalLSH */
+    LSHIndex lsh_index;
+
     /** Current configuration parameters*/
     FLANNMatcherParams current_config;
 
@@ -260,6 +294,28 @@ class FLANNMatcher : public DescriptorMatcher {
     std::vector<cv::DMatch> filterMatches(
       const std::vector<std::vector<cv::DMatch>> &matches) const override;
 
+    /** Matches descriptors with flann_matcher, and filters the matches.
+     *
+     *  Parameters are as in matchDescriptors().
+     *
+     *  @return the filtered matches.
+     */
+    std::vector<cv::DMatch> matchFLANN(cv::Mat &descriptors_1,
+                                       cv::Mat &descriptors_2,
+                                       cv::InputArray mask);
+
+    /** Matches descriptors with lsh_index, and filters the matches. Queries
+     *  left with fewer neighbours than requested, after applying the mask, are
+     *  dropped.
+     *
+     *  Parameters are as in matchDescriptors().
+     *
+     *  @return the filtered matches.
+     */
+    std::vector<cv::DMatch> matchIncrementalLSH(const cv::Mat &descriptors_1,
+                                                const cv::Mat &descriptors_2,
+                                                cv::InputArray mask);
+
     /** Checks whether the desired configuration is valid
      *
      *  @param check_config containing the desired configuration values.
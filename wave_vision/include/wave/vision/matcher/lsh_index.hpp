@@ -0,0 +1,209 @@
+/**
+ * @file
+ * Persistent locality-sensitive hashing index for binary descriptors.
+ * @ingroup vision
+ */
+#ifndef WAVE_VISION_LSH_INDEX_HPP
+#define WAVE_VISION_LSH_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/features2d/features2d.hpp>
+
+namespace wave {
+/** @addtogroup vision
+ *  @{ */
+
+/** Configuration parameters for the LSHIndex */
+struct LSHIndexParams {
+    LSHIndexParams() = default;
+
+    LSHIndexParams(const int num_tables,
+                   const int key_size,
+                   const int multi_probe_level,
+                   const int max_checks)
+        : num_tables(num_tables),
+          key_size(key_size),
+          multi_probe_level(multi_probe_level),
+          max_checks(max_checks) {}
+
+    /** Constructor using parameters extracted from a configuration file.
+     *
+     *  @param config_path the path to the location of the configuration file
+     */
+    explicit LSHIndexParams(const std::string &config_path);
+
+    /** Number of hash tables. More tables find more true neighbours, at the
+     *  cost of memory and of time spent on updates.
+     *
+     *  Recommended: 20. Typically between 10 and 30.
+     */
+    int num_tables = 20;
+
+    /** Number of descriptor bits sampled to form the key of each table.
+     *  Longer keys give smaller buckets, so fewer candidates per probe.
+     *
+     *  Recommended: 15. Must be between 1 and 32.
+     */
+    int key_size = 15;
+
+    /** Largest number of key bits flipped when probing neighbouring buckets,
+     *  as in multi-probe LSH. Probing lets fewer tables reach the same recall.
+     *
+     *  Recommended: 2. Must be between 0 and 2.
+     */
+    int multi_probe_level = 2;
+
+    /** Maximum number of stored descriptors compared with each query.
+     *  Buckets are probed from the exact key outwards, so the most likely
+     *  candidates are checked first.
+     *
+     *  Recommended: 100. Must be greater than zero.
+     */
+    int max_checks = 100;
+};
+
+/** Approximate nearest neighbour index of binary descriptors, such as ORB or
+ *  BRISK, which is updated incrementally rather than rebuilt.
+ *
+ *  cv::FlannBasedMatcher builds its index from scratch on every match call.
+ *  This index instead keeps its hash tables between calls, and descriptors
+ *  are added and removed individually, identified by a user-supplied id such
+ *  as a landmark or track id. The cost of building the index is then spread
+ *  over the frames in which descriptors enter and leave it, which suits a map
+ *  of landmark descriptors queried each frame for relocalization.
+ *
+ *  Each table hashes a descriptor by a fixed random subset of its bits, as in
+ *  [Lv et al. (2007)][LSH]. Queries also probe the buckets whose keys differ
+ *  in a few bits, and candidates are compared by Hamming distance.
+ *
+ *  [LSH]: http://www.cs.princeton.edu/cass/papers/mplsh_vldb07.pdf
+ */
+class LSHIndex {
+ public:
+    /** Default constructor. The user can also specify their own struct with
+     *  desired values. If no struct is provided, default values are used.
+     *
+     *  @param config contains the desired parameter values.
+     */
+    explicit LSHIndex(const LSHIndexParams &config = LSHIndexParams{});
+
+    /** Returns the current configuration parameters */
+    LSHIndexParams getConfiguration() const {
+        return this->current_config;
+    }
+
+    /** Adds descriptors to the index.
+     *
+     *  The first descriptors added set the descriptor length. All must be of
+     *  type CV_8U with that many columns.
+     *
+     *  @param descriptors one descriptor per row
+     *  @param ids the id of each descriptor, which must not already be in
+     *  the index
+     */
+    void add(const cv::Mat &descriptors, const std::vector<int> &ids);
+
+    /** Removes a descriptor from the index.
+     *
+     *  @return false if no descriptor with this id is in the index
+     */
+    bool remove(int id);
+
+    /** Removes all descriptors. The descriptor length may then change. */
+    void clear();
+
+    /** Returns true if a descriptor with this id is in the index */
+    bool contains(int id) const {
+        return this->slots.count(id) > 0;
+    }
+
+    /** Returns the number of descriptors in the index */
+    size_t size() const {
+        return this->slots.size();
+    }
+
+    /** Finds the approximate k nearest neighbours of each query descriptor.
+     *
+     *  Safe to call concurrently, as long as the index is not modified.
+     *
+     *  @param query_descriptors one descriptor per row
+     *  @param k the number of neighbours
+     *
+     *  @return for each query, up to k matches in order of increasing Hamming
+     *  distance. queryIdx is the query row, and trainIdx the id of the stored
+     *  descriptor.
+     */
+    std::vector<std::vector<cv::DMatch>> knnMatch(
+      const cv::Mat &query_descriptors, int k) const;
+
+ private:
+    /** Current configuration parameters */
+    LSHIndexParams current_config;
+
+    /** Length of each descriptor in bytes, or 0 before the first add */
+    int descriptor_size = 0;
+
+    /** Descriptor storage, one row of descriptor_size bytes per slot */
+    std::vector<uchar> data;
+
+    /** Id stored in each slot, or -1 for free slots */
+    std::vector<int> slot_ids;
+
+    /** Slots freed by remove, reused by add */
+    std::vector<int> free_slots;
+
+    /** Slot of each id */
+    std::unordered_map<int, int> slots;
+
+    /** Descriptor bits sampled by each table, num_tables x key_size */
+    std::vector<int> key_bits;
+
+    /** First slot in each bucket, indexed by (table << key_size) + key, or -1
+     *  if the bucket is empty. Used when keys are short enough to address
+     *  every bucket directly. */
+    std::vector<int> direct_heads;
+
+    /** First slot in each non-empty bucket of each table, for longer keys */
+    std::vector<std::unordered_map<uint32_t, int>> hashed_heads;
+
+    /** Next and previous slots in the same bucket, indexed by
+     *  slot * num_tables + table, or -1 at the ends of the bucket. Buckets are
+     *  linked lists through these, so no bucket needs its own allocation. */
+    std::vector<int> next, prev;
+
+    /** Bitmap of the non-empty buckets of all tables. It is much smaller than
+     *  the heads, so most probes of empty buckets stay in cache. Only kept for
+     *  keys short enough for the bitmap to be small. */
+    std::vector<uint64_t> occupied;
+
+    /** Key masks of the probed buckets, from the exact key outwards */
+    std::vector<uint32_t> probes;
+
+    /** Checks the configuration, and throws if it is invalid */
+    void checkConfiguration(const LSHIndexParams &check_config) const;
+
+    /** Chooses the bits sampled by each table for a descriptor length */
+    void initializeTables(int num_bytes);
+
+    /** Computes the key of a descriptor in one table */
+    uint32_t computeKey(const uchar *descriptor, int table) const;
+
+    /** Returns false if the bucket is known to be empty */
+    bool mayBeOccupied(int table, uint32_t key) const;
+
+    /** Returns the first slot in a bucket, or -1 if it is empty */
+    int head(int table, uint32_t key) const;
+
+    /** Sets the first slot in a bucket, or -1 to mark it empty */
+    void setHead(int table, uint32_t key, int slot);
+};
+
+/** @} group vision */
+}  // namespace wave
+
+#endif  // WAVE_VISION_LSH_INDEX_HPP
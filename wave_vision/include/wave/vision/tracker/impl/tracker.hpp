@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "wave/vision/tracker/tracker.hpp"
 
 namespace wave {
@@ -104,6 +106,157 @@ Tracker<TDetector, TDescriptor, TMatcher>::registerKeypoints(
     return curr_ids;
 }
 
+template <typename TDetector, typename TDescriptor, typename TMatcher>
+void Tracker<TDetector, TDescriptor, TMatcher>::trackFlow(
+  std::vector<cv::KeyPoint> &curr_kp, std::vector<cv::DMatch> &matches) {
+    const auto &params = this->klt_params;
+    const cv::Size win_size{params.patch_size, params.patch_size};
+    const cv::TermCriteria criteria{
+      cv::TermCriteria::COUNT | cv::TermCriteria::EPS,
+      params.max_iterations,
+      params.epsilon};
+
+    const auto &image = this->curr_frame.image();
+
+    std::vector<cv::Point2f> prev_pts;
+    cv::KeyPoint::convert(this->prev_kp, prev_pts);
+
+    if (!prev_pts.empty()) {
+        // The previous pyramid was built when tracking into the previous frame
+        const auto &prev_pyramid =
+          this->prev_frame.pyramid(win_size, params.max_level);
+        const auto &curr_pyramid =
+          this->curr_frame.pyramid(win_size, params.max_level);
+
+        // Forward flow
+        std::vector<cv::Point2f> fwd_pts;
+        std::vector<uchar> fwd_status;
+        std::vector<float> err;
+        cv::calcOpticalFlowPyrLK(prev_pyramid,
+                                 curr_pyramid,
+                                 prev_pts,
+                                 fwd_pts,
+                                 fwd_status,
+                                 err,
+                                 win_size,
+                                 params.max_level,
+                                 criteria);
+
+        // Backward flow, only for the features tracked forward
+        std::vector<int> tracked;
+        std::vector<cv::Point2f> tracked_pts;
+        for (int i = 0; i < static_cast<int>(fwd_pts.size()); ++i) {
+            const auto &pt = fwd_pts[i];
+            if (fwd_status[i] && pt.x >= 0 && pt.y >= 0 &&
+                pt.x < image.cols && pt.y < image.rows) {
+                tracked.push_back(i);
+                tracked_pts.push_back(pt);
+            }
+        }
+
+        std::vector<cv::Point2f> bwd_pts;
+        std::vector<uchar> bwd_status;
+        if (!tracked_pts.empty()) {
+            cv::calcOpticalFlowPyrLK(curr_pyramid,
+                                     prev_pyramid,
+                                     tracked_pts,
+                                     bwd_pts,
+                                     bwd_status,
+                                     err,
+                                     win_size,
+                                     params.max_level,
+                                     criteria);
+        }
+
+        // Keep features which return to where they started
+        for (size_t j = 0; j < tracked.size(); ++j) {
+            const auto i = tracked[j];
+            const auto fb_error = cv::norm(bwd_pts[j] - prev_pts[i]);
+            if (bwd_status[j] && fb_error <= params.fb_threshold) {
+                cv::KeyPoint kp = this->prev_kp[i];
+                kp.pt = tracked_pts[j];
+                matches.emplace_back(i,
+                                     static_cast<int>(curr_kp.size()),
+                                     static_cast<float>(fb_error));
+                curr_kp.push_back(kp);
+            }
+        }
+    }
+}
+
+template <typename TDetector, typename TDescriptor, typename TMatcher>
+void Tracker<TDetector, TDescriptor, TMatcher>::detectInSparseCells(
+  const cv::Mat &image, std::vector<cv::KeyPoint> &keypoints) {
+    const auto &params = this->klt_params;
+    const auto num_cells = params.grid_rows * params.grid_cols;
+    const auto cell_width = std::max(1, image.cols / params.grid_cols);
+    const auto cell_height = std::max(1, image.rows / params.grid_rows);
+
+    // The last row and column of cells take any remainder of the image
+    const auto cellOf = [&](const cv::Point2f &pt) {
+        const auto col = std::min(static_cast<int>(pt.x) / cell_width,
+                                  params.grid_cols - 1);
+        const auto row = std::min(static_cast<int>(pt.y) / cell_height,
+                                  params.grid_rows - 1);
+        return row * params.grid_cols + col;
+    };
+
+    std::vector<std::vector<cv::Point2f>> cell_pts(num_cells);
+    for (const auto &kp : keypoints) {
+        cell_pts[cellOf(kp.pt)].push_back(kp.pt);
+    }
+
+    const auto min_dist_sq = params.min_distance * params.min_distance;
+    for (int cell = 0; cell < num_cells; ++cell) {
+        auto &pts = cell_pts[cell];
+        const auto count = static_cast<int>(pts.size());
+        if (count >= params.min_features_per_cell) {
+            continue;
+        }
+
+        const auto row = cell / params.grid_cols;
+        const auto col = cell % params.grid_cols;
+        const cv::Rect cell_rect{
+          col * cell_width,
+          row * cell_height,
+          col == params.grid_cols - 1 ? image.cols - col * cell_width
+                                      : cell_width,
+          row == params.grid_rows - 1 ? image.rows - row * cell_height
+                                      : cell_height};
+        // Cells can fall outside images smaller than the grid
+        const auto roi = cell_rect & cv::Rect{0, 0, image.cols, image.rows};
+        if (roi.area() <= 0) {
+            continue;
+        }
+
+        // Detect within the cell only, strongest first
+        auto detected = this->detector.detectFeatures(image(roi));
+        std::sort(detected.begin(),
+                  detected.end(),
+                  [](const cv::KeyPoint &a, const cv::KeyPoint &b) {
+                      return a.response > b.response;
+                  });
+
+        for (auto &kp : detected) {
+            if (static_cast<int>(pts.size()) >=
+                params.max_features_per_cell) {
+                break;
+            }
+            kp.pt.x += roi.x;
+            kp.pt.y += roi.y;
+            const auto too_close =
+              std::any_of(pts.begin(), pts.end(), [&](const cv::Point2f &p) {
+                  const auto d = p - kp.pt;
+                  return d.dot(d) < min_dist_sq;
+              });
+            if (!too_close) {
+                pts.push_back(kp.pt);
+                keypoints.push_back(kp);
+            }
+        }
+    }
+}
+
 // Public Functions
 template <typename TDetector, typename TDescriptor, typename TMatcher>
 std::vector<FeatureTrack> Tracker<TDetector, TDescriptor, TMatcher>::getTracks(
@@ -153,10 +306,31 @@ void Tracker<TDetector, TDescriptor, TMatcher>::addImage(
     // Register the time this image
     this->timestampImage(current_time);
 
+    // Prepare the image once for all stages, keeping the previous frame
+    std::swap(this->prev_frame, this->curr_frame);
+    this->curr_frame.setImage(image);
+    const auto &gray = this->curr_frame.image();
+
+    if (this->mode == TrackingMode::OPTICAL_FLOW) {
+        // Propagate the previous keypoints, then fill in sparse cells
+        std::vector<cv::KeyPoint> curr_kp;
+        std::vector<cv::DMatch> matches;
+        this->trackFlow(curr_kp, matches);
+        this->detectInSparseCells(gray, curr_kp);
+
+        // Register keypoints with IDs, and store Landmarks in container
+        if (this->img_times.size() > 1) {
+            auto curr_ids = this->registerKeypoints(curr_kp, matches);
+            this->prev_ids.swap(curr_ids);
+        }
+        this->prev_kp.swap(curr_kp);
+        return;
+    }
+
     // Check if this is the first image being tracked.
     if (this->img_times.size() == 1) {
         // Detect features within first image. No tracks can be generated yet.
-        this->detectAndCompute(image, this->prev_kp, this->prev_desc);
+        this->detectAndCompute(gray, this->prev_kp, this->prev_desc);
     } else {
         // Variables for feature detection, description, and matching
         std::vector<cv::KeyPoint> curr_kp;
@@ -167,7 +341,7 @@ void Tracker<TDetector, TDescriptor, TMatcher>::addImage(
         std::map<int, size_t> curr_ids;
 
         // Detect, describe, and match keypoints
-        this->detectAndCompute(image, curr_kp, curr_desc);
+        this->detectAndCompute(gray, curr_kp, curr_desc);
         matches = this->matcher.matchDescriptors(
           this->prev_desc, curr_desc, this->prev_kp, curr_kp);
 
@@ -187,6 +361,21 @@ template <typename TDetector, typename TDescriptor, typename TMatcher>
 std::vector<std::vector<FeatureTrack>>
 Tracker<TDetector, TDescriptor, TMatcher>::offlineTracker(
   const std::vector<cv::Mat> &image_sequence) {
+    return this->trackImages(image_sequence.begin(), image_sequence.end());
+}
+
+template <typename TDetector, typename TDescriptor, typename TMatcher>
+std::vector<std::vector<FeatureTrack>>
+Tracker<TDetector, TDescriptor, TMatcher>::offlineTracker(
+  ImageSequence &image_sequence) {
+    return this->trackImages(image_sequence.begin(), image_sequence.end());
+}
+
+template <typename TDetector, typename TDescriptor, typename TMatcher>
+template <typename TImageIterator>
+std::vector<std::vector<FeatureTrack>>
+Tracker<TDetector, TDescriptor, TMatcher>::trackImages(TImageIterator first,
+                                                       TImageIterator last) {
     // FeatureTracks from current image, and all FeatureTracks
     std::vector<FeatureTrack> curr_track;
     std::vector<std::vector<FeatureTrack>> feature_tracks;
@@ -195,10 +384,8 @@ Tracker<TDetector, TDescriptor, TMatcher>::offlineTracker(
 
     size_t num_images = 0;
 
-    if (!image_sequence.empty()) {
-        for (auto img_it = image_sequence.begin();
-             img_it != image_sequence.end();
-             ++img_it) {
+    if (first != last) {
+        for (auto img_it = first; img_it != last; ++img_it) {
             // Add image to tracker
             this->addImage(*img_it, clock.now());
 
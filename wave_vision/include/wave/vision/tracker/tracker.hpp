@@ -10,9 +10,13 @@
 #include <string>
 #include <vector>
 
+#include <opencv2/video/tracking.hpp>
+
 #include "wave/containers/landmark_measurement.hpp"
 #include "wave/containers/landmark_measurement_container.hpp"
 #include "wave/utils/utils.hpp"
+#include "wave/vision/image_frame.hpp"
+#include "wave/vision/image_sequence.hpp"
 #include "wave/vision/utils.hpp"
 
 namespace wave {
@@ -21,6 +25,66 @@ namespace wave {
 
 using FeatureTrack = std::vector<LandmarkMeasurement<int>>;
 
+/** How the Tracker associates features between consecutive images */
+enum class TrackingMode {
+    /** Detect and describe features in every image, and match descriptors */
+    DESCRIPTOR_MATCHING,
+    /** Propagate features with pyramidal Lucas-Kanade optical flow, detecting
+     *  new features only where tracks have been lost */
+    OPTICAL_FLOW
+};
+
+/** Configuration parameters for the Tracker's optical flow mode. */
+struct KLTTrackerParams {
+    KLTTrackerParams() = default;
+
+    /** Constructor using parameters extracted from a configuration file.
+     *
+     *  @param config_path the path to the location of the configuration file.
+     */
+    explicit KLTTrackerParams(const std::string &config_path);
+
+    /** Side length, in pixels, of the search window at each pyramid level.
+     *
+     *  Recommended: 21
+     */
+    int patch_size = 21;
+
+    /** Number of pyramid levels above the original image. Larger values
+     *  track larger motions.
+     *
+     *  Recommended: 3
+     */
+    int max_level = 3;
+
+    /** Maximum Lucas-Kanade iterations per pyramid level. */
+    int max_iterations = 30;
+
+    /** Lucas-Kanade iterations stop once the update is smaller than this. */
+    double epsilon = 0.01;
+
+    /** Maximum distance, in pixels, between a feature and the result of
+     *  tracking it forward then backward. Features exceeding it are dropped.
+     *
+     *  Recommended: 1.0
+     */
+    double fb_threshold = 1.0;
+
+    /** The image is divided into grid_rows x grid_cols cells for detection. */
+    int grid_rows = 4;
+    int grid_cols = 4;
+
+    /** The detector is only run in cells with fewer tracked features. */
+    int min_features_per_cell = 10;
+
+    /** Detection tops each cell up to this many features. */
+    int max_features_per_cell = 20;
+
+    /** New features closer than this, in pixels, to a tracked feature are
+     *  discarded. */
+    double min_distance = 10.0;
+};
+
 /** Image tracker class.
  *
  * The Tracker class is templated on a feature detector, descriptor, and matcher
@@ -52,6 +116,35 @@ class Tracker {
         }
     }
 
+    /** Constructor for optical flow mode
+     *
+     * Features are detected with the detector, then tracked between images
+     * with pyramidal Lucas-Kanade flow. The descriptor and matcher are unused.
+     *
+     * @param detector detector object (FAST, ORB, etc...)
+     * @param descriptor descriptor object (BRISK, ORB, etc...)
+     * @param matcher matcher object (BruteForceMatcher, FLANN)
+     * @param klt_params optical flow configuration
+     */
+    Tracker(TDetector detector,
+            TDescriptor descriptor,
+            TMatcher matcher,
+            const KLTTrackerParams &klt_params,
+            int window_size = 0)
+        : Tracker(detector, descriptor, matcher, window_size) {
+        if (klt_params.patch_size < 3 || klt_params.max_level < 0 ||
+            klt_params.grid_rows < 1 || klt_params.grid_cols < 1) {
+            throw std::invalid_argument("Invalid KLTTrackerParams!");
+        }
+        this->mode = TrackingMode::OPTICAL_FLOW;
+        this->klt_params = klt_params;
+    }
+
+    /** Returns how features are associated between images. */
+    TrackingMode getMode() const {
+        return this->mode;
+    }
+
     ~Tracker() = default;
 
     /** Get the tracks of all features in the requested image from the sequence.
@@ -87,6 +180,17 @@ class Tracker {
     std::vector<std::vector<FeatureTrack>> offlineTracker(
       const std::vector<cv::Mat> &image_sequence);
 
+    /** Offline feature tracking, decoding images as they are needed.
+     *
+     * Only the images prefetched by the sequence are held in memory, so
+     * sequences of any length can be tracked.
+     *
+     * @param image_sequence the sequence of images to analyze.
+     * @return the vector of FeatureTracks in each image.
+     */
+    std::vector<std::vector<FeatureTrack>> offlineTracker(
+      ImageSequence &image_sequence);
+
     /** The templated FeatureDetector */
     TDetector detector;
 
@@ -113,10 +217,21 @@ class Tracker {
      */
     size_t cleared_img_threshold = 0;
 
+    /** How features are associated between images */
+    TrackingMode mode = TrackingMode::DESCRIPTOR_MATCHING;
+
+    /** Configuration used in optical flow mode */
+    KLTTrackerParams klt_params;
+
     // Keypoints and descriptors from the previous timestep
     std::vector<cv::KeyPoint> prev_kp;
     cv::Mat prev_desc;
 
+    // Current and previous frames. Alternating between the two reuses their
+    // buffers, and keeps the previous pyramid for optical flow.
+    ImageFrame curr_frame;
+    ImageFrame prev_frame;
+
     // Correspondence maps
     std::map<int, size_t> prev_ids;
     std::map<size_t, std::chrono::steady_clock::time_point> img_times;
@@ -149,6 +264,26 @@ class Tracker {
                           std::vector<cv::KeyPoint> &keypoints,
                           cv::Mat &descriptor);
 
+    /** Track the previous keypoints into the current image.
+     *
+     * Keypoints are tracked forwards then backwards with pyramidal
+     * Lucas-Kanade flow, and are kept only if they return close to where they
+     * started.
+     *
+     * @param curr_kp the tracked keypoints in the current image
+     * @param matches from the previous keypoints to the current keypoints
+     */
+    void trackFlow(std::vector<cv::KeyPoint> &curr_kp,
+                   std::vector<cv::DMatch> &matches);
+
+    /** Detect new features in grid cells which have too few.
+     *
+     * @param image the current image, in grayscale
+     * @param keypoints the tracked keypoints. New keypoints are appended.
+     */
+    void detectInSparseCells(const cv::Mat &image,
+                             std::vector<cv::KeyPoint> &keypoints);
+
     /** Register the current time with the current img_count
      *
      * @param current_time the time at which this image was received
@@ -176,6 +311,11 @@ class Tracker {
     std::map<int, size_t> registerKeypoints(
       const std::vector<cv::KeyPoint> &curr_kp,
       const std::vector<cv::DMatch> &matches);
+
+    /** Tracks each image in [first, last), returning the tracks in each */
+    template <typename TImageIterator>
+    std::vector<std::vector<FeatureTrack>> trackImages(TImageIterator first,
+                                                       TImageIterator last);
 };
 
 /** @} group vision */
@@ -74,6 +74,71 @@ bool pinholeProject(const Eigen::Matrix<T, 3, 3> &K,
     return (homogeneous(2) > T{0});
 }
 
+/** Measure a 3D point using a simple pinhole camera model, with the Jacobians
+ * of the measurement.
+ *
+ * The camera pose is perturbed as `R_GC * Exp(d_theta)` and `G_p_GC + d_p`,
+ * where `d_theta` is a rotation vector in the camera frame. The columns of
+ * `J_pose` are ordered `[d_theta, d_p]`.
+ *
+ * @param K camera intrinsic matrix
+ * @param R_GC orientation of camera in world frame
+ * @param G_p_GC translation from world origin to camera, in world frame
+ * @param G_p_GF translation from world origin to feature, in world frame
+ * @param result measurement in image frame (pixels)
+ * @param J_pose if not null, set to the Jacobian of `result` with respect to
+ * the camera pose perturbation
+ * @param J_point if not null, set to the Jacobian of `result` with respect to
+ * `G_p_GF`
+ * @return true if feature is in front of the camera.
+ */
+inline bool pinholeProject(const Mat3 &K,
+                           const Mat3 &R_GC,
+                           const Vec3 &G_p_GC,
+                           const Vec3 &G_p_GF,
+                           Vec2 &result,
+                           Eigen::Matrix<double, 2, 6> *J_pose,
+                           Eigen::Matrix<double, 2, 3> *J_point);
+
+/** Projections of a batch of points, one per column. Row-major, so the u and
+ * v coordinates of all points are each contiguous. */
+using PinholeProjections =
+  Eigen::Matrix<double, 2, Eigen::Dynamic, Eigen::RowMajor>;
+
+/** Measure a batch of 3D points from one camera pose, using a simple pinhole
+ * camera model.
+ *
+ * Equivalent to calling pinholeProject() on each point, but the camera
+ * transform is formed once, and without Jacobians the points are transformed
+ * by a single matrix product. Points stored row-major (all x, then all y, then
+ * all z) let the products and divisions vectorize across points.
+ *
+ * @param K camera intrinsic matrix
+ * @param R_GC orientation of camera in world frame
+ * @param G_p_GC translation from world origin to camera, in world frame
+ * @param G_p_GF translations from world origin to features, in world frame,
+ * one per column
+ * @param result measurements in image frame (pixels), one per column
+ * @param in_front for each feature, true if it is in front of the camera
+ * @param J_pose if not null, set to the Jacobian of each measurement with
+ * respect to the camera pose perturbation, as for pinholeProject(). Each
+ * column holds one 2x6 Jacobian in column-major order.
+ * @param J_point if not null, set to the Jacobian of each measurement with
+ * respect to its feature position, one 2x3 Jacobian per column in
+ * column-major order.
+ */
+template <typename DerivedPoints>
+void pinholeProjectBatch(const Mat3 &K,
+                         const Mat3 &R_GC,
+                         const Vec3 &G_p_GC,
+                         const Eigen::MatrixBase<DerivedPoints> &G_p_GF,
+                         PinholeProjections &result,
+                         Eigen::Array<bool, 1, Eigen::Dynamic> &in_front,
+                         Eigen::Matrix<double, 12, Eigen::Dynamic> *J_pose =
+                           nullptr,
+                         Eigen::Matrix<double, 6, Eigen::Dynamic> *J_point =
+                           nullptr);
+
 /** Convert a single cv::KeyPoint to Vec2
  *
  * @param keypoint input keypoint
@@ -118,7 +183,10 @@ std::vector<cv::Point2f> convertKeypoints(const std::vector<Vec2> &keypoints);
 
 /** Reads images from file into a vector
  *
- * @param images_path location of images
+ * Every image is held in memory. For long sequences, read images as they are
+ * needed with an ImageSequence instead.
+ *
+ * @param images_path location of the first image in a numbered sequence
  * @return all read images
  */
 std::vector<cv::Mat> readImageSequence(const std::string &images_path);
@@ -153,4 +221,6 @@ struct convert<cv::Mat> {
 };
 }  // namespace YAML
 
+#include "impl/utils.hpp"
+
 #endif  // WAVE_VISION_COMMON_HPP
@@ -4,8 +4,23 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace wave {
 
+namespace {
+
+LandmarkMap toLandmarkMap(const LandmarkPoints &points) {
+    LandmarkMap landmarks;
+    for (int i = 0; i < points.cols(); i++) {
+        landmarks.emplace_hint(landmarks.end(), i, points.col(i));
+    }
+    return landmarks;
+}
+
+}  // namespace
+
 void VoDatasetGenerator::configure(const std::string &config_file) {
     ConfigParser parser;
     double fx, fy, cx, cy;
@@ -25,6 +40,11 @@ void VoDatasetGenerator::configure(const std::string &config_file) {
     parser.addParam("landmarks.y.max", &this->landmark_y_bounds(1));
     parser.addParam("landmarks.z.min", &this->landmark_z_bounds(0));
     parser.addParam("landmarks.z.max", &this->landmark_z_bounds(1));
+    parser.addParam("trajectory.nb_steps", &this->nb_steps, true);
+    parser.addParam("trajectory.dt", &this->dt, true);
+    parser.addParam("trajectory.circle_radius", &this->circle_radius, true);
+    parser.addParam("trajectory.velocity", &this->velocity, true);
+    parser.addParam("nb_threads", &this->nb_threads, true);
     if (parser.load(config_file) != ConfigStatus::OK) {
         throw std::runtime_error("Failed to load " + config_file);
     }
@@ -38,20 +58,23 @@ void VoDatasetGenerator::configure(const std::string &config_file) {
 }
 
 LandmarkMap VoDatasetGenerator::generateLandmarks() {
-    LandmarkMap landmarks;
+    return toLandmarkMap(this->generateLandmarkPoints());
+}
+
+LandmarkPoints VoDatasetGenerator::generateLandmarkPoints() {
+    LandmarkPoints points{3, this->nb_landmarks};
 
     // generate random 3d landmarks
     for (int i = 0; i < this->nb_landmarks; i++) {
-        double x =
+        points(0, i) =
           randf(this->landmark_x_bounds(0), this->landmark_x_bounds(1));
-        double y =
+        points(1, i) =
           randf(this->landmark_y_bounds(0), this->landmark_y_bounds(1));
-        double z =
+        points(2, i) =
           randf(this->landmark_z_bounds(0), this->landmark_z_bounds(1));
-        landmarks.emplace(i, Vec3{x, y, z});
     }
 
-    return landmarks;
+    return points;
 }
 
 void VoDataset::outputLandmarks(const std::string &output_path) {
@@ -213,48 +236,71 @@ VoDataset VoDataset::loadFromDirectory(const std::string &input_dir) {
 VoDataset VoDatasetGenerator::generate() {
     VoDataset dataset;
     // generate random 3D features
-    dataset.landmarks = this->generateLandmarks();
+    const auto points = this->generateLandmarkPoints();
+    dataset.landmarks = toLandmarkMap(points);
 
     dataset.camera_K = this->camera.K;
 
     // calculate circle trajectory inputs
-    double circle_radius = 0.5;
-    double distance = 2 * M_PI * circle_radius;
-    double velocity = 1.0;
-    double t_end = distance / velocity;
+    double distance = 2 * M_PI * this->circle_radius;
+    double t_end = distance / this->velocity;
     double angular_velocity = (2 * M_PI) / t_end;
-    Vec2 u = Vec2{velocity, angular_velocity};
+    Vec2 u = Vec2{this->velocity, angular_velocity};
 
     // simulate synthetic VO dataset
-    double dt = 0.01;
     TwoWheelRobot2DModel robot{Vec3{0.0, 0.0, 0.0}};
 
-    for (int i = 0; i < 300; i++) {
+    // Orientation of robot Body frame in Camera frame
+    Quaternion q_BC = Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
+                      Eigen::AngleAxisd(0, Vec3::UnitY()) *
+                      Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX());
+
+    // Simulate the trajectory first, keeping the steps the camera sees
+    std::vector<Quaternion> frames_q_GC;
+    for (int i = 0; i < this->nb_steps; i++) {
         // update state
-        Vec3 pose2d = robot.update(u, dt);
+        Vec3 pose2d = robot.update(u, this->dt);
 
         // convert 2d pose to 3d pose (pose of Body in Global frame)
         auto G_p_GB = Vec3{pose2d.x(), pose2d.y(), 0};
         auto q_GB = Quaternion{Eigen::AngleAxisd{pose2d.z(), Vec3::UnitZ()}};
 
-        auto instant = VoInstant{};
-
-        // Orientation of robot Body frame in Camera frame
-        Quaternion q_BC = Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
-                          Eigen::AngleAxisd(0, Vec3::UnitY()) *
-                          Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX());
-        Quaternion q_GC = q_GB * q_BC;
-
-        int retval = this->camera.observeLandmarks(
-          dt, dataset.landmarks, q_GC, G_p_GB, instant.features_observed);
-        if (retval == 0) {
-            instant.time = i * dt;
+        if (this->camera.update(this->dt)) {
+            auto instant = VoInstant{};
+            instant.time = i * this->dt;
             instant.robot_G_p_GB = G_p_GB;
             instant.robot_q_GB = q_GB;
             dataset.states.push_back(instant);
+            frames_q_GC.push_back(q_GB * q_BC);
         }
     }
 
+    // Then observe the landmarks from each camera frame, in parallel. Each
+    // thread takes every nb_threads-th frame, as all frames cost the same.
+    auto num_threads = this->nb_threads > 0
+                         ? static_cast<std::size_t>(this->nb_threads)
+                         : std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min(num_threads, dataset.states.size());
+    const auto observe = [&](std::size_t first) {
+        for (auto f = first; f < dataset.states.size(); f += num_threads) {
+            auto &instant = dataset.states[f];
+            this->camera.projectLandmarks(points,
+                                          frames_q_GC[f],
+                                          instant.robot_G_p_GB,
+                                          instant.features_observed);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < num_threads; t++) {
+        workers.emplace_back(observe, t);
+    }
+    if (num_threads > 0) {
+        observe(0);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
     return dataset;
 }
 
@@ -0,0 +1,232 @@
+#include "wave/vision/dataset/VoDatasetBinary.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace wave {
+
+namespace {
+
+const char MAGIC[8] = {'W', 'A', 'V', 'E', 'V', 'O', 'D', '\0'};
+const uint32_t VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t num_landmarks;
+    uint64_t num_states;
+    uint64_t num_observations;
+    /** Camera matrix in row-major order */
+    double camera_K[9];
+};
+
+struct LandmarkRecord {
+    uint64_t id;
+    double position[3];
+};
+
+struct StateRecord {
+    /** Time, position (x, y, z) and quaternion (x, y, z, w) */
+    double state[8];
+    int64_t camera_frame;
+    uint64_t first_observation;
+    uint64_t num_observations;
+};
+
+// Every table is a whole number of 8-byte values, so the records of each are
+// aligned when the file is mapped at a page boundary
+static_assert(sizeof(FileHeader) % 8 == 0, "FileHeader must be 8-aligned");
+static_assert(sizeof(LandmarkRecord) == 32, "LandmarkRecord must be packed");
+static_assert(sizeof(StateRecord) == 88, "StateRecord must be packed");
+
+template <typename T>
+void write(std::ofstream &out, const T &value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+}  // namespace
+
+VoInstant VoInstantView::toInstant() const {
+    VoInstant instant;
+    instant.time = this->time();
+    instant.camera_frame = this->cameraFrame();
+    instant.robot_G_p_GB = this->robot_G_p_GB();
+    instant.robot_q_GB = this->robot_q_GB();
+    instant.features_observed.reserve(this->size());
+    for (std::size_t k = 0; k < this->size(); ++k) {
+        instant.features_observed.emplace_back(this->landmarkId(k),
+                                               this->measurement(k));
+    }
+    return instant;
+}
+
+MappedVoDataset::MappedVoDataset(const std::string &input_path)
+    : file{std::make_shared<const MappedFile>(input_path)} {
+    const auto fail = [&input_path](const std::string &msg) {
+        return std::runtime_error{"MappedVoDataset: [" + input_path +
+                                  "]: " + msg};
+    };
+
+    FileHeader header;
+    if (this->file->size() < sizeof(header)) {
+        throw fail("file is shorter than the header");
+    }
+    std::memcpy(&header, this->file->data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw fail("not a VoDataset file");
+    }
+    if (header.version != VERSION || header.header_size != sizeof(header)) {
+        throw fail("unsupported version " + std::to_string(header.version));
+    }
+
+    // Check the table sizes against the file size, before multiplying them
+    const auto available = this->file->size() - sizeof(header);
+    const auto observation_size = sizeof(uint64_t) + 2 * sizeof(double);
+    if (header.num_landmarks > available / sizeof(LandmarkRecord) ||
+        header.num_states > available / sizeof(StateRecord) ||
+        header.num_observations > available / observation_size ||
+        header.num_landmarks * sizeof(LandmarkRecord) +
+            header.num_states * sizeof(StateRecord) +
+            header.num_observations * observation_size !=
+          available) {
+        throw fail("file size does not match its header");
+    }
+
+    this->num_landmarks = header.num_landmarks;
+    this->num_states = header.num_states;
+    this->num_observations = header.num_observations;
+
+    this->landmarks = this->file->data() + sizeof(header);
+    this->states =
+      this->landmarks + this->num_landmarks * sizeof(LandmarkRecord);
+    this->observation_ids = reinterpret_cast<const uint64_t *>(
+      this->states + this->num_states * sizeof(StateRecord));
+    this->measurements = reinterpret_cast<const double *>(
+      this->observation_ids + this->num_observations);
+}
+
+Mat3 MappedVoDataset::cameraK() const {
+    FileHeader header;
+    std::memcpy(&header, this->file->data(), sizeof(header));
+    return Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>{
+      header.camera_K};
+}
+
+LandmarkId MappedVoDataset::landmarkId(std::size_t i) const {
+    const auto record =
+      reinterpret_cast<const LandmarkRecord *>(this->landmarks) + i;
+    return static_cast<LandmarkId>(record->id);
+}
+
+Eigen::Map<const Vec3> MappedVoDataset::landmarkPosition(std::size_t i) const {
+    const auto record =
+      reinterpret_cast<const LandmarkRecord *>(this->landmarks) + i;
+    return Eigen::Map<const Vec3>{record->position};
+}
+
+VoInstantView MappedVoDataset::operator[](std::size_t i) const {
+    const auto record = reinterpret_cast<const StateRecord *>(this->states) + i;
+    const auto first = record->first_observation;
+    const auto count = record->num_observations;
+    if (first > this->num_observations ||
+        count > this->num_observations - first) {
+        throw std::runtime_error{"MappedVoDataset: [" + this->file->path() +
+                                 "]: observations of state " +
+                                 std::to_string(i) + " are out of range"};
+    }
+    return VoInstantView{record->state,
+                         static_cast<int>(record->camera_frame),
+                         count,
+                         this->observation_ids + first,
+                         this->measurements + 2 * first};
+}
+
+VoDataset MappedVoDataset::toVoDataset() const {
+    VoDataset dataset;
+    dataset.camera_K = this->cameraK();
+    for (std::size_t i = 0; i < this->numLandmarks(); ++i) {
+        dataset.landmarks.emplace_hint(dataset.landmarks.end(),
+                                       this->landmarkId(i),
+                                       this->landmarkPosition(i));
+    }
+    dataset.states.reserve(this->size());
+    for (std::size_t i = 0; i < this->size(); ++i) {
+        dataset.states.push_back((*this)[i].toInstant());
+    }
+    return dataset;
+}
+
+void VoDataset::outputBinary(const std::string &output_path) const {
+    std::ofstream out{output_path, std::ios::binary};
+    if (!out) {
+        throw std::runtime_error("Failed to open " + output_path +
+                                 " to output dataset!");
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.header_size = sizeof(header);
+    header.num_landmarks = this->landmarks.size();
+    header.num_states = this->states.size();
+    header.num_observations = 0;
+    for (const auto &state : this->states) {
+        header.num_observations += state.features_observed.size();
+    }
+    Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>{
+      header.camera_K} = this->camera_K;
+    write(out, header);
+
+    // Landmark table, in id order as the map is sorted
+    for (const auto &landmark : this->landmarks) {
+        LandmarkRecord record;
+        record.id = landmark.first;
+        Eigen::Map<Vec3>{record.position} = landmark.second;
+        write(out, record);
+    }
+
+    // State table, with the range of each state's observations
+    uint64_t first_observation = 0;
+    for (const auto &state : this->states) {
+        StateRecord record;
+        record.state[0] = state.time;
+        Eigen::Map<Vec3>{record.state + 1} = state.robot_G_p_GB;
+        Eigen::Map<Vec4>{record.state + 4} = state.robot_q_GB.coeffs();
+        record.camera_frame = state.camera_frame;
+        record.first_observation = first_observation;
+        record.num_observations = state.features_observed.size();
+        first_observation += record.num_observations;
+        write(out, record);
+    }
+
+    // Observation columns
+    for (const auto &state : this->states) {
+        for (const auto &feature : state.features_observed) {
+            write(out, static_cast<uint64_t>(feature.first));
+        }
+    }
+    for (const auto &state : this->states) {
+        for (const auto &feature : state.features_observed) {
+            write(out, feature.second.x());
+            write(out, feature.second.y());
+        }
+    }
+
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write dataset to " + output_path);
+    }
+}
+
+VoDataset VoDataset::loadFromBinary(const std::string &input_path) {
+    return MappedVoDataset{input_path}.toVoDataset();
+}
+
+void convertVoDatasetDirectory(const std::string &input_dir,
+                               const std::string &output_path) {
+    VoDataset::loadFromDirectory(input_dir).outputBinary(output_path);
+}
+
+}  // namespace wave
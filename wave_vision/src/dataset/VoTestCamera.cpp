@@ -1,7 +1,15 @@
 #include "wave/vision/dataset/VoTestCamera.hpp"
 
+#include <algorithm>
+
 namespace wave {
 
+namespace {
+
+// Number of landmarks projected at once, so the projected batch stays in cache
+const int PROJECTION_BATCH_SIZE = 4096;
+
+}  // namespace
 
 bool VoTestCamera::update(double dt) {
     this->dt += dt;
@@ -47,4 +55,54 @@ int VoTestCamera::observeLandmarks(double dt,
     return 0;
 }
 
+int VoTestCamera::observeLandmarks(double dt,
+                                   const LandmarkPoints &landmarks,
+                                   const Quaternion &q_GC,
+                                   const Vec3 &G_p_GC,
+                                   std::vector<LandmarkObservation> &observed) {
+    // pre-check
+    if (this->update(dt) == false) {
+        return 1;
+    }
+
+    this->projectLandmarks(landmarks, q_GC, G_p_GC, observed);
+    return 0;
+}
+
+void VoTestCamera::projectLandmarks(
+  const LandmarkPoints &landmarks,
+  const Quaternion &q_GC,
+  const Vec3 &G_p_GC,
+  std::vector<LandmarkObservation> &observed) const {
+    const Mat3 R_GC = q_GC.matrix();
+
+    observed.clear();
+    PinholeProjections projections;
+    Eigen::Array<bool, 1, Eigen::Dynamic> in_front;
+    for (Eigen::Index start = 0; start < landmarks.cols();
+         start += PROJECTION_BATCH_SIZE) {
+        const auto count = std::min<Eigen::Index>(PROJECTION_BATCH_SIZE,
+                                                  landmarks.cols() - start);
+        pinholeProjectBatch(this->K,
+                            R_GC,
+                            G_p_GC,
+                            landmarks.middleCols(start, count),
+                            projections,
+                            in_front);
+
+        // check cheirality, and whether the feature is within the image plane
+        const auto u = projections.row(0).array();
+        const auto v = projections.row(1).array();
+        const Eigen::Array<bool, 1, Eigen::Dynamic> visible =
+          in_front && (u > 0) && (u < this->image_width) && (v > 0) &&
+          (v < this->image_height);
+
+        for (Eigen::Index i = 0; i < count; ++i) {
+            if (visible(i)) {
+                observed.emplace_back(start + i, Vec2{u(i), v(i)});
+            }
+        }
+    }
+}
+
 }  // namespace wave
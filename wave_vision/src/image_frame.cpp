@@ -0,0 +1,37 @@
+#include "wave/vision/image_frame.hpp"
+
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+namespace wave {
+
+void ImageFrame::setImage(const cv::Mat &image) {
+    // Both write into the existing buffer if it is the right size. Grayscale
+    // input is still copied, as callers such as cv::VideoCapture overwrite
+    // their image while this frame is kept as the previous one.
+    if (image.channels() > 1) {
+        cv::cvtColor(image, this->gray, cv::COLOR_BGR2GRAY);
+    } else {
+        image.copyTo(this->gray);
+    }
+    this->pyramid_valid = false;
+}
+
+const std::vector<cv::Mat> &ImageFrame::pyramid(const cv::Size &win_size,
+                                                int max_level,
+                                                bool with_gradients) {
+    if (!this->pyramid_valid || win_size != this->pyramid_win_size ||
+        max_level != this->pyramid_max_level ||
+        with_gradients != this->pyramid_gradients) {
+        // buildOpticalFlowPyramid reuses the storage of existing levels
+        cv::buildOpticalFlowPyramid(
+          this->gray, this->levels, win_size, max_level, with_gradients);
+        this->pyramid_valid = true;
+        this->pyramid_win_size = win_size;
+        this->pyramid_max_level = max_level;
+        this->pyramid_gradients = with_gradients;
+    }
+    return this->levels;
+}
+
+}  // namespace wave
@@ -0,0 +1,221 @@
+#include "wave/vision/image_sequence.hpp"
+
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace wave {
+
+namespace {
+
+bool fileExists(const std::string &path) {
+    return std::ifstream{path}.good();
+}
+
+bool isDigit(char c) {
+    return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+/** Lists the numbered sequence of files starting at `first_path`, by
+ * incrementing the last number in the file name until a file is missing */
+std::vector<std::string> listSequence(const std::string &first_path) {
+    std::vector<std::string> files;
+    if (!fileExists(first_path)) {
+        return files;
+    }
+    files.push_back(first_path);
+
+    // Find the last run of digits in the file name, not in the directory
+    const auto name_start = first_path.find_last_of('/') + 1;
+    auto digits_end = first_path.size();
+    while (digits_end > name_start &&
+           !isDigit(first_path[digits_end - 1])) {
+        --digits_end;
+    }
+    auto digits_start = digits_end;
+    while (digits_start > name_start &&
+           isDigit(first_path[digits_start - 1])) {
+        --digits_start;
+    }
+    if (digits_start == digits_end) {
+        return files;
+    }
+
+    const auto prefix = first_path.substr(0, digits_start);
+    const auto suffix = first_path.substr(digits_end);
+    const auto width = static_cast<int>(digits_end - digits_start);
+    auto number = std::stoull(
+      first_path.substr(digits_start, digits_end - digits_start));
+    while (true) {
+        std::ostringstream path;
+        path << prefix << std::setw(width) << std::setfill('0') << ++number
+             << suffix;
+        if (!fileExists(path.str())) {
+            break;
+        }
+        files.push_back(path.str());
+    }
+    return files;
+}
+
+/** Returns the imread flag decoding directly at `scale`, or 0 if the decoder
+ * cannot reduce by that factor */
+int reducedFlag(double scale, bool grayscale) {
+    if (scale == 0.5) {
+        return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2
+                         : cv::IMREAD_REDUCED_COLOR_2;
+    } else if (scale == 0.25) {
+        return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4
+                         : cv::IMREAD_REDUCED_COLOR_4;
+    } else if (scale == 0.125) {
+        return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8
+                         : cv::IMREAD_REDUCED_COLOR_8;
+    }
+    return 0;
+}
+
+}  // namespace
+
+ImageSequence::ImageSequence(const std::string &images_path,
+                             const ImageSequenceParams &config) {
+    // Ensure parameters are valid
+    this->checkConfiguration(config);
+
+    this->current_config = config;
+
+    this->files = listSequence(images_path);
+    if (this->files.empty()) {
+        throw std::length_error("No images in image sequence!");
+    }
+
+    const auto depth = static_cast<size_t>(config.prefetch_depth);
+    this->slots.resize(depth);
+    this->slot_ready.assign(depth, false);
+    this->slot_errors.resize(depth);
+
+    for (int i = 0; i < config.num_threads; ++i) {
+        this->workers.emplace_back(&ImageSequence::spin, this);
+    }
+}
+
+ImageSequence::~ImageSequence() {
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->stop = true;
+    }
+    this->space_condition.notify_all();
+    for (auto &worker : this->workers) {
+        worker.join();
+    }
+}
+
+void ImageSequence::checkConfiguration(
+  const ImageSequenceParams &check_config) const {
+    if (check_config.num_threads < 1) {
+        throw std::invalid_argument("num_threads must be at least one!");
+    }
+
+    if (check_config.prefetch_depth < check_config.num_threads) {
+        throw std::invalid_argument(
+          "prefetch_depth must be at least num_threads!");
+    }
+
+    if (!(check_config.scale > 0.0 && check_config.scale <= 1.0)) {
+        throw std::invalid_argument("scale is not an appropriate value!");
+    }
+}
+
+cv::Mat ImageSequence::decode(const std::string &path) const {
+    const auto scale = this->current_config.scale;
+    const auto grayscale = this->current_config.grayscale;
+
+    // Let the decoder downscale if it can, skipping most of the full size
+    // decode
+    const auto reduced = reducedFlag(scale, grayscale);
+    if (reduced != 0) {
+        return cv::imread(path, reduced);
+    }
+
+    auto image =
+      cv::imread(path, grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+    if (scale != 1.0 && !image.empty()) {
+        cv::Mat resized;
+        cv::resize(image, resized, cv::Size{}, scale, scale, cv::INTER_AREA);
+        image = resized;
+    }
+    return image;
+}
+
+void ImageSequence::spin() {
+    const auto depth = this->slots.size();
+    while (true) {
+        size_t index;
+        {
+            // Claim the next image once it fits in the ring
+            std::unique_lock<std::mutex> lock(this->mutex);
+            while (!this->stop && this->num_claimed < this->files.size() &&
+                   this->num_claimed >= this->num_returned + depth) {
+                this->space_condition.wait(lock);
+            }
+            if (this->stop || this->num_claimed >= this->files.size()) {
+                return;
+            }
+            index = this->num_claimed++;
+        }
+
+        // Decode without holding the lock
+        cv::Mat image;
+        std::exception_ptr error;
+        try {
+            image = this->decode(this->files[index]);
+            if (image.empty()) {
+                throw std::runtime_error("Failed to read image " +
+                                         this->files[index]);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->slots[index % depth] = image;
+            this->slot_errors[index % depth] = error;
+            this->slot_ready[index % depth] = true;
+        }
+        this->ready_condition.notify_all();
+    }
+}
+
+bool ImageSequence::next(cv::Mat &image) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (this->num_returned >= this->files.size()) {
+        return false;
+    }
+
+    const auto slot = this->num_returned % this->slots.size();
+    while (!this->slot_ready[slot]) {
+        this->ready_condition.wait(lock);
+    }
+
+    // Hand over the image, so the ring holds no reference to it
+    image = this->slots[slot];
+    this->slots[slot].release();
+    const auto error = this->slot_errors[slot];
+    this->slot_errors[slot] = nullptr;
+    this->slot_ready[slot] = false;
+    ++(this->num_returned);
+    lock.unlock();
+    this->space_condition.notify_all();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return true;
+}
+
+}  // namespace wave
@@ -13,6 +13,9 @@ BFMatcherParams::BFMatcherParams(const std::string &config_path) {
     int distance_threshold;
     bool auto_remove_outliers;
     int fm_method;
+    // Configs written before these keys existed keep the defaults
+    double fm_threshold = this->fm_threshold;
+    double fm_confidence = this->fm_confidence;
 
     // Add parameters to parser, to be loaded. If path cannot be found, throw
     // an exception.
@@ -22,6 +25,8 @@ BFMatcherParams::BFMatcherParams(const std::string &config_path) {
     parser.addParam("distance_threshold", &distance_threshold);
     parser.addParam("auto_remove_outliers", &auto_remove_outliers);
     parser.addParam("fm_method", &fm_method);
+    parser.addParam("fm_threshold", &fm_threshold, true);
+    parser.addParam("fm_confidence", &fm_confidence, true);
 
     if (parser.load(config_path) != ConfigStatus::OK) {
         throw std::invalid_argument(
@@ -34,6 +39,8 @@ BFMatcherParams::BFMatcherParams(const std::string &config_path) {
     this->distance_threshold = distance_threshold;
     this->auto_remove_outliers = auto_remove_outliers;
     this->fm_method = fm_method;
+    this->fm_threshold = fm_threshold;
+    this->fm_confidence = fm_confidence;
 }
 
 // Default constructor. Struct may be default or user defined.
@@ -81,6 +88,17 @@ void BruteForceMatcher::checkConfiguration(
         check_config.fm_method != cv::FM_RANSAC) {
         throw std::invalid_argument("fm_method is not an acceptable value!");
     }
+
+    // Check the values of the fundamental matrix estimation parameters
+    if (check_config.fm_threshold <= 0.0) {
+        throw std::invalid_argument("fm_threshold must be greater than zero!");
+    }
+
+    if (check_config.fm_confidence <= 0.0 ||
+        check_config.fm_confidence >= 1.0) {
+        throw std::invalid_argument(
+          "fm_confidence is not an appropriate value!");
+    }
 }
 
 std::vector<cv::DMatch> BruteForceMatcher::filterMatches(
@@ -124,28 +142,36 @@ std::vector<cv::DMatch> BruteForceMatcher::removeOutliers(
   const std::vector<cv::KeyPoint> &keypoints_1,
   const std::vector<cv::KeyPoint> &keypoints_2) const {
     std::vector<cv::DMatch> good_matches;
-    std::vector<cv::Point2f> fp1, fp2;
-
-    // Take all good keypoints from matches, convert to cv::Point2f
-    for (auto &match : matches) {
-        fp1.push_back(keypoints_1.at((size_t) match.queryIdx).pt);
-        fp2.push_back(keypoints_2.at((size_t) match.trainIdx).pt);
-    }
-
-    // Find fundamental matrix
     std::vector<uchar> mask;
-    cv::Mat fundamental_matrix;
 
-    // Maximum distance from a point to an epipolar line in pixels. Any points
-    // further are considered outliers. Only used for RANSAC.
-    double fm_param_1 = 3.0;
+    if (this->current_config.fm_method == cv::FM_RANSAC) {
+        // The estimator is local, so concurrent calls do not share buffers
+        EpipolarRansacParams ransac_config;
+        ransac_config.threshold = this->current_config.fm_threshold;
+        ransac_config.confidence = this->current_config.fm_confidence;
+        EpipolarRansac ransac{ransac_config};
+
+        Mat3 fundamental_matrix;
+        ransac.estimateFundamental(
+          matches, keypoints_1, keypoints_2, fundamental_matrix, mask);
+    } else {
+        std::vector<cv::Point2f> fp1, fp2;
 
-    // Desired confidence interval of the estimated fundamental matrix. Only
-    // used for RANSAC or LMedS methods.
-    double fm_param_2 = 0.99;
+        // Take all good keypoints from matches, convert to cv::Point2f
+        for (auto &match : matches) {
+            fp1.push_back(keypoints_1.at((size_t) match.queryIdx).pt);
+            fp2.push_back(keypoints_2.at((size_t) match.trainIdx).pt);
+        }
 
-    fundamental_matrix = cv::findFundamentalMat(
-      fp1, fp2, this->current_config.fm_method, fm_param_1, fm_param_2, mask);
+        // Find fundamental matrix. Of the two parameters, only the confidence
+        // is used by these methods, for LMedS.
+        cv::findFundamentalMat(fp1,
+                               fp2,
+                               this->current_config.fm_method,
+                               this->current_config.fm_threshold,
+                               this->current_config.fm_confidence,
+                               mask);
+    }
 
     // Only retain the inliers matches
     for (size_t i = 0; i < mask.size(); i++) {
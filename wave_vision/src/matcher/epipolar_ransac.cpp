@@ -0,0 +1,414 @@
+#include "wave/vision/matcher/epipolar_ransac.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/SVD>
+
+namespace wave {
+
+namespace {
+
+using Mat9 = Eigen::Matrix<double, 9, 9>;
+using Vec9 = Eigen::Matrix<double, 9, 1>;
+using RowMat3 = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
+
+// Seed used at the start of every estimate, so that results are repeatable
+const unsigned int RANSAC_SEED = 42;
+
+// Number of samples after which PROSAC samples uniformly from all points, as
+// RANSAC does. The value suggested by Chum and Matas.
+const double PROSAC_MAX_SAMPLES = 200000;
+
+// Number of least squares refits of the best model to its inliers
+const int MAX_REFITS = 2;
+
+// Number of samples needed to draw one free of outliers with the desired
+// confidence, given the fraction of inliers
+int requiredIterations(double inlier_ratio,
+                       int sample_size,
+                       double confidence,
+                       int max_iterations) {
+    const double p_good = std::pow(inlier_ratio, sample_size);
+    if (p_good >= 1.0) {
+        return 0;
+    } else if (p_good <= 0.0) {
+        return max_iterations;
+    }
+    // log1p keeps precision when p_good is tiny
+    const double k = std::log(1.0 - confidence) / std::log1p(-p_good);
+    return k < max_iterations ? static_cast<int>(std::ceil(k))
+                              : max_iterations;
+}
+
+// Normalizes one image's points to zero mean and a mean distance of sqrt(2)
+// from the origin, as in Hartley's normalized 8-point algorithm
+template <typename Array>
+Mat3 normalize(const Array &x, const Array &y, Array &nx, Array &ny) {
+    const double cx = x.mean();
+    const double cy = y.mean();
+    const double mean_dist =
+      ((x - cx).square() + (y - cy).square()).sqrt().mean();
+    const double s = mean_dist > 0 ? std::sqrt(2.0) / mean_dist : 1.0;
+
+    nx = (x - cx) * s;
+    ny = (y - cy) * s;
+
+    Mat3 T;
+    T << s, 0, -s * cx, 0, s, -s * cy, 0, 0, 1;
+    return T;
+}
+
+}  // namespace
+
+EpipolarRansac::EpipolarRansac(const EpipolarRansacParams &config) {
+    // Ensure parameters are valid
+    this->checkConfiguration(config);
+
+    this->current_config = config;
+}
+
+void EpipolarRansac::checkConfiguration(
+  const EpipolarRansacParams &check_config) const {
+    if (check_config.threshold <= 0.0) {
+        throw std::invalid_argument("threshold must be greater than zero!");
+    }
+
+    if (check_config.confidence <= 0.0 || check_config.confidence >= 1.0) {
+        throw std::invalid_argument(
+          "confidence is not an appropriate value!");
+    }
+
+    if (check_config.max_iterations < 1) {
+        throw std::invalid_argument("max_iterations must be at least one!");
+    }
+
+    // Only acceptable values are 7 and 8
+    if (check_config.sample_size != 7 && check_config.sample_size != 8) {
+        throw std::invalid_argument("sample_size is not an acceptable value!");
+    }
+}
+
+void EpipolarRansac::setNumPoints(int n) {
+    if (this->x1.size() < n) {
+        for (auto *a : {&this->x1,
+                        &this->y1,
+                        &this->x2,
+                        &this->y2,
+                        &this->nx1,
+                        &this->ny1,
+                        &this->nx2,
+                        &this->ny2,
+                        &this->errors}) {
+            a->resize(n);
+        }
+    }
+    this->num_points = n;
+}
+
+int EpipolarRansac::estimateFundamental(const Eigen::Matrix2Xd &points_1,
+                                        const Eigen::Matrix2Xd &points_2,
+                                        Mat3 &fundamental_matrix,
+                                        std::vector<uchar> &inliers) {
+    if (points_1.cols() != points_2.cols()) {
+        throw std::invalid_argument(
+          "Number of points in each image must be equal!");
+    }
+
+    const auto n = static_cast<int>(points_1.cols());
+    this->setNumPoints(n);
+    this->x1.head(n) = points_1.row(0).transpose();
+    this->y1.head(n) = points_1.row(1).transpose();
+    this->x2.head(n) = points_2.row(0).transpose();
+    this->y2.head(n) = points_2.row(1).transpose();
+
+    return this->run(fundamental_matrix, inliers);
+}
+
+int EpipolarRansac::estimateFundamental(
+  const std::vector<cv::DMatch> &matches,
+  const std::vector<cv::KeyPoint> &keypoints_1,
+  const std::vector<cv::KeyPoint> &keypoints_2,
+  Mat3 &fundamental_matrix,
+  std::vector<uchar> &inliers) {
+    const auto n = static_cast<int>(matches.size());
+
+    // Sample the matches with the smallest descriptor distance first
+    this->order.resize(n);
+    std::iota(this->order.begin(), this->order.end(), 0);
+    std::stable_sort(
+      this->order.begin(), this->order.end(), [&matches](int a, int b) {
+          return matches[a].distance < matches[b].distance;
+      });
+
+    this->setNumPoints(n);
+    for (int i = 0; i < n; ++i) {
+        const auto &match = matches[this->order[i]];
+        const auto &p1 = keypoints_1.at((size_t) match.queryIdx).pt;
+        const auto &p2 = keypoints_2.at((size_t) match.trainIdx).pt;
+        this->x1[i] = p1.x;
+        this->y1[i] = p1.y;
+        this->x2[i] = p2.x;
+        this->y2[i] = p2.y;
+    }
+
+    const auto num_inliers =
+      this->run(fundamental_matrix, this->sorted_inliers);
+
+    // Return the mask in the order of the matches
+    inliers.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        inliers[this->order[i]] = this->sorted_inliers[i];
+    }
+    return num_inliers;
+}
+
+int EpipolarRansac::run(Mat3 &fundamental_matrix,
+                        std::vector<uchar> &inliers) {
+    const auto n = this->num_points;
+    const auto m = this->current_config.sample_size;
+    const auto confidence = this->current_config.confidence;
+    const auto threshold_sq =
+      this->current_config.threshold * this->current_config.threshold;
+
+    fundamental_matrix.setZero();
+    inliers.assign(n, 0);
+    if (n < m) {
+        return 0;
+    }
+
+    this->normalizePoints();
+    this->generator.seed(RANSAC_SEED);
+
+    // PROSAC starts by sampling the top m points, and grows the subset
+    // sampled from as the expected number of samples from it is reached
+    int subset_size = m;
+    double T_n = PROSAC_MAX_SAMPLES;
+    for (int i = 0; i < m; ++i) {
+        T_n *= static_cast<double>(m - i) / (n - i);
+    }
+    double T_n_prime = 1.0;
+
+    Mat3 best_model = Mat3::Zero();
+    int best_count = 0;
+    int max_iterations = this->current_config.max_iterations;
+
+    for (int t = 1; t <= max_iterations; ++t) {
+        this->drawSample(t, subset_size, T_n, T_n_prime, this->sample);
+        this->solve(this->sample, m == 7, this->hypotheses);
+
+        for (const auto &hypothesis : this->hypotheses) {
+            const auto count = this->score(hypothesis);
+            if (count > best_count) {
+                best_count = count;
+                best_model = hypothesis;
+
+                // Terminate as soon as the desired confidence is reached
+                max_iterations = requiredIterations(
+                  static_cast<double>(best_count) / n,
+                  m,
+                  confidence,
+                  this->current_config.max_iterations);
+            }
+        }
+    }
+
+    if (best_count == 0) {
+        return 0;
+    }
+
+    // Refit the best model to all of its inliers, keeping the refit as long as
+    // it does not lose inliers
+    for (int refit = 0; refit < MAX_REFITS && best_count >= 8; ++refit) {
+        this->score(best_model);
+        this->sample.clear();
+        for (int i = 0; i < n; ++i) {
+            if (this->errors[i] < threshold_sq) {
+                this->sample.push_back(i);
+            }
+        }
+
+        this->solve(this->sample, false, this->hypotheses);
+        const auto count = this->score(this->hypotheses.front());
+        if (count < best_count) {
+            break;
+        }
+
+        const bool improved = count > best_count;
+        best_count = count;
+        best_model = this->hypotheses.front();
+        if (!improved) {
+            break;
+        }
+    }
+
+    best_count = this->score(best_model);
+    for (int i = 0; i < n; ++i) {
+        inliers[i] = this->errors[i] < threshold_sq;
+    }
+    fundamental_matrix = best_model.normalized();
+    return best_count;
+}
+
+void EpipolarRansac::normalizePoints() {
+    const auto n = this->num_points;
+    auto nx1 = this->nx1.head(n), ny1 = this->ny1.head(n);
+    auto nx2 = this->nx2.head(n), ny2 = this->ny2.head(n);
+
+    this->T1 = normalize(this->x1.head(n), this->y1.head(n), nx1, ny1);
+    this->T2 = normalize(this->x2.head(n), this->y2.head(n), nx2, ny2);
+}
+
+void EpipolarRansac::drawSample(int t,
+                                int &n,
+                                double &T_n,
+                                double &T_n_prime,
+                                std::vector<int> &sample) {
+    const auto m = this->current_config.sample_size;
+
+    // Grow the subset once the samples expected from it have been drawn
+    if (t >= T_n_prime && n < this->num_points) {
+        const double T_n_next = T_n * (n + 1) / (n + 1 - m);
+        T_n_prime += std::ceil(T_n_next - T_n);
+        T_n = T_n_next;
+        ++n;
+    }
+
+    // Until the next growth, each sample includes the newest point of the
+    // subset, with the rest drawn from the points ranked above it
+    const bool include_newest = T_n_prime >= t;
+    const auto num_random = include_newest ? m - 1 : m;
+    const auto pool_size = include_newest ? n - 1 : n;
+
+    sample.clear();
+    std::uniform_int_distribution<int> distribution(0, pool_size - 1);
+    while (static_cast<int>(sample.size()) < num_random) {
+        const auto index = distribution(this->generator);
+        if (std::find(sample.begin(), sample.end(), index) == sample.end()) {
+            sample.push_back(index);
+        }
+    }
+    if (include_newest) {
+        sample.push_back(n - 1);
+    }
+}
+
+void EpipolarRansac::solve(const std::vector<int> &indices,
+                           bool minimal,
+                           std::vector<Mat3> &hypotheses) const {
+    // Each point gives one row of the linear system A f = 0, where f is F in
+    // row major order. The normal equations are accumulated directly, so the
+    // cost of the eigendecomposition is independent of the number of points.
+    Mat9 AtA = Mat9::Zero();
+    Vec9 a;
+    for (const auto i : indices) {
+        const double u1 = this->nx1[i], v1 = this->ny1[i];
+        const double u2 = this->nx2[i], v2 = this->ny2[i];
+        a << u2 * u1, u2 * v1, u2, v2 * u1, v2 * v1, v2, u1, v1, 1.0;
+        AtA.selfadjointView<Eigen::Lower>().rankUpdate(a);
+    }
+    const Eigen::SelfAdjointEigenSolver<Mat9> eigen_solver{AtA};
+    const Mat9 &V = eigen_solver.eigenvectors();
+
+    // Convert a solution in normalized coordinates back to pixels
+    const auto denormalize = [this](const Mat3 &F) -> Mat3 {
+        return this->T2.transpose() * F * this->T1;
+    };
+
+    hypotheses.clear();
+    if (!minimal) {
+        // The eigenvector of the smallest eigenvalue, with the rank 2
+        // constraint enforced by zeroing the smallest singular value
+        const Mat3 F = Eigen::Map<const RowMat3>(V.col(0).data());
+        const Eigen::JacobiSVD<Mat3> svd{F,
+                                         Eigen::ComputeFullU |
+                                           Eigen::ComputeFullV};
+        Vec3 s = svd.singularValues();
+        s(2) = 0.0;
+        hypotheses.push_back(denormalize(
+          svd.matrixU() * s.asDiagonal() * svd.matrixV().transpose()));
+        return;
+    }
+
+    // Seven points leave a two dimensional null space F = F2 + alpha * D.
+    // The rank 2 constraint det(F) = 0 is a cubic in alpha, whose
+    // coefficients are found from its values at four points.
+    const Mat3 F1 = Eigen::Map<const RowMat3>(V.col(0).data());
+    const Mat3 F2 = Eigen::Map<const RowMat3>(V.col(1).data());
+    const Mat3 D = F1 - F2;
+    const auto det = [&F2, &D](double alpha) {
+        return (F2 + alpha * D).determinant();
+    };
+
+    const double c0 = det(0.0);
+    const double p1 = det(1.0), pm1 = det(-1.0), p2 = det(2.0);
+    const double c2 = (p1 + pm1) / 2.0 - c0;
+    const double c1_plus_c3 = (p1 - pm1) / 2.0;
+    const double c1_plus_4c3 = (p2 - c0 - 4.0 * c2) / 2.0;
+    const double c3 = (c1_plus_4c3 - c1_plus_c3) / 3.0;
+    const double c1 = c1_plus_c3 - c3;
+
+    const double scale =
+      std::max({std::abs(c0), std::abs(c1), std::abs(c2), std::abs(c3)});
+    if (scale == 0.0) {
+        return;
+    }
+
+    const auto add_root = [&](double alpha) {
+        hypotheses.push_back(denormalize(F2 + alpha * D));
+    };
+
+    if (std::abs(c3) > 1e-10 * scale) {
+        // Real eigenvalues of the companion matrix
+        Mat3 companion = Mat3::Zero();
+        companion.row(0) << -c2 / c3, -c1 / c3, -c0 / c3;
+        companion(1, 0) = 1.0;
+        companion(2, 1) = 1.0;
+        const Eigen::EigenSolver<Mat3> roots{companion, false};
+        for (int i = 0; i < 3; ++i) {
+            const auto root = roots.eigenvalues()[i];
+            if (std::abs(root.imag()) <=
+                1e-8 * std::max(1.0, std::abs(root.real()))) {
+                add_root(root.real());
+            }
+        }
+    } else if (std::abs(c2) > 1e-10 * scale) {
+        const double discriminant = c1 * c1 - 4.0 * c2 * c0;
+        if (discriminant >= 0.0) {
+            const double sqrt_disc = std::sqrt(discriminant);
+            add_root((-c1 + sqrt_disc) / (2.0 * c2));
+            add_root((-c1 - sqrt_disc) / (2.0 * c2));
+        }
+    } else if (std::abs(c1) > 0.0) {
+        add_root(-c0 / c1);
+    }
+}
+
+int EpipolarRansac::score(const Mat3 &F) {
+    const auto n = this->num_points;
+    const auto u1 = this->x1.head(n), v1 = this->y1.head(n);
+    const auto u2 = this->x2.head(n), v2 = this->y2.head(n);
+
+    // F x1, F^T x2 and the epipolar residual x2^T F x1, all as array
+    // expressions evaluated in a single vectorized pass
+    const auto a = F(0, 0) * u1 + F(0, 1) * v1 + F(0, 2);
+    const auto b = F(1, 0) * u1 + F(1, 1) * v1 + F(1, 2);
+    const auto c = F(2, 0) * u1 + F(2, 1) * v1 + F(2, 2);
+    const auto d = F(0, 0) * u2 + F(1, 0) * v2 + F(2, 0);
+    const auto e = F(0, 1) * u2 + F(1, 1) * v2 + F(2, 1);
+    const auto r = u2 * a + v2 * b + c;
+
+    // Squared Sampson distance. Degenerate points give NaN, which is never
+    // counted as an inlier.
+    auto errors = this->errors.head(n);
+    errors = r.square() / (a.square() + b.square() + d.square() + e.square());
+
+    const auto threshold_sq =
+      this->current_config.threshold * this->current_config.threshold;
+    return static_cast<int>((errors < threshold_sq).count());
+}
+
+}  // namespace wave
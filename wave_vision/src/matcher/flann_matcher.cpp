@@ -1,5 +1,8 @@
 #include "wave/vision/matcher/flann_matcher.hpp"
 
+#include <algorithm>
+#include <numeric>
+
 namespace wave {
 
 // Filesystem based constructor for FLANNMatcherParams
@@ -13,6 +16,9 @@ FLANNMatcherParams::FLANNMatcherParams(const std::string &config_path) {
     int distance_threshold;
     bool auto_remove_outliers;
     int fm_method;
+    // Configs written before these keys existed keep the defaults
+    double fm_threshold = this->fm_threshold;
+    double fm_confidence = this->fm_confidence;
 
     // Add parameters to parser, to be loaded. If path cannot be found, throw
     // an exception.
@@ -22,6 +28,8 @@ FLANNMatcherParams::FLANNMatcherParams(const std::string &config_path) {
     parser.addParam("distance_threshold", &distance_threshold);
     parser.addParam("auto_remove_outliers", &auto_remove_outliers);
     parser.addParam("fm_method", &fm_method);
+    parser.addParam("fm_threshold", &fm_threshold, true);
+    parser.addParam("fm_confidence", &fm_confidence, true);
 
     if (parser.load(config_path) != ConfigStatus::OK) {
         throw std::invalid_argument(
@@ -34,6 +42,8 @@ FLANNMatcherParams::FLANNMatcherParams(const std::string &config_path) {
     this->distance_threshold = distance_threshold;
     this->auto_remove_outliers = auto_remove_outliers;
     this->fm_method = fm_method;
+    this->fm_threshold = fm_threshold;
+    this->fm_confidence = fm_confidence;
 }
 
 FLANNMatcher::FLANNMatcher(const FLANNMatcherParams &config) {
@@ -81,7 +91,7 @@ FLANNMatcher::FLANNMatcher(const FLANNMatcherParams &config) {
 void FLANNMatcher::checkConfiguration(const FLANNMatcherParams &check_config) {
     // Check that the value of flann_method is one of the valid values.
     if (check_config.flann_method < FLANN::KDTree ||
-        check_config.flann_method > FLANN::LSH) {
+        check_config.flann_method > FLANN::IncrementalLSH) {
         throw std::invalid_argument("Flann method selected does not exist!");
     }
 
@@ -104,6 +114,17 @@ void FLANNMatcher::checkConfiguration(const FLANNMatcherParams &check_config) {
         check_config.fm_method != cv::FM_RANSAC) {
         throw std::invalid_argument("fm_method is not an acceptable value!");
     }
+
+    // Check the values of the fundamental matrix estimation parameters
+    if (check_config.fm_threshold <= 0.0) {
+        throw std::invalid_argument("fm_threshold must be greater than zero!");
+    }
+
+    if (check_config.fm_confidence <= 0.0 ||
+        check_config.fm_confidence >= 1.0) {
+        throw std::invalid_argument(
+          "fm_confidence is not an appropriate value!");
+    }
 }
 
 std::vector<cv::DMatch> FLANNMatcher::filterMatches(
@@ -147,28 +168,36 @@ std::vector<cv::DMatch> FLANNMatcher::removeOutliers(
   const std::vector<cv::KeyPoint> &keypoints_1,
   const std::vector<cv::KeyPoint> &keypoints_2) const {
     std::vector<cv::DMatch> good_matches;
-    std::vector<cv::Point2f> fp1, fp2;
-
-    // Take all good keypoints from matches, convert to cv::Point2f
-    for (auto &match : matches) {
-        fp1.push_back(keypoints_1.at((size_t) match.queryIdx).pt);
-        fp2.push_back(keypoints_2.at((size_t) match.trainIdx).pt);
-    }
-
-    // Find fundamental matrix
     std::vector<uchar> mask;
-    cv::Mat fundamental_matrix;
 
-    // Maximum distance from a point to an epipolar line in pixels. Any points
-    // further are considered outliers. Only used for RANSAC.
-    double fm_param_1 = 3.0;
+    if (this->current_config.fm_method == cv::FM_RANSAC) {
+        // The estimator is local, so concurrent calls do not share buffers
+        EpipolarRansacParams ransac_config;
+        ransac_config.threshold = this->current_config.fm_threshold;
+        ransac_config.confidence = this->current_config.fm_confidence;
+        EpipolarRansac ransac{ransac_config};
 
-    // Desired confidence interval of the estimated fundamental matrix. Only
-    // used for RANSAC or LMedS methods.
-    double fm_param_2 = 0.99;
+        Mat3 fundamental_matrix;
+        ransac.estimateFundamental(
+          matches, keypoints_1, keypoints_2, fundamental_matrix, mask);
+    } else {
+        std::vector<cv::Point2f> fp1, fp2;
 
-    fundamental_matrix = cv::findFundamentalMat(
-      fp1, fp2, this->current_config.fm_method, fm_param_1, fm_param_2, mask);
+        // Take all good keypoints from matches, convert to cv::Point2f
+        for (auto &match : matches) {
+            fp1.push_back(keypoints_1.at((size_t) match.queryIdx).pt);
+            fp2.push_back(keypoints_2.at((size_t) match.trainIdx).pt);
+        }
+
+        // Find fundamental matrix. Of the two parameters, only the confidence
+        // is used by these methods, for LMedS.
+        cv::findFundamentalMat(fp1,
+                               fp2,
+                               this->current_config.fm_method,
+                               this->current_config.fm_threshold,
+                               this->current_config.fm_confidence,
+                               mask);
+    }
 
     // Only retain the inliers matches
     for (size_t i = 0; i < mask.size(); i++) {
@@ -188,6 +217,30 @@ std::vector<cv::DMatch> FLANNMatcher::matchDescriptors(
   cv::InputArray mask) {
     std::vector<cv::DMatch> filtered_matches;
 
+    if (this->current_config.flann_method == FLANN::IncrementalLSH) {
+        filtered_matches = this->matchIncrementalLSH(
+          descriptors_1, descriptors_2, mask);
+    } else {
+        filtered_matches =
+          this->matchFLANN(descriptors_1, descriptors_2, mask);
+    }
+
+    if (this->current_config.auto_remove_outliers) {
+        std::vector<cv::DMatch> good_matches =
+          this->removeOutliers(filtered_matches, keypoints_1, keypoints_2);
+        this->num_good_matches = good_matches.size();
+
+        return good_matches;
+    }
+
+    return filtered_matches;
+}
+
+std::vector<cv::DMatch> FLANNMatcher::matchFLANN(cv::Mat &descriptors_1,
+                                                 cv::Mat &descriptors_2,
+                                                 cv::InputArray mask) {
+    std::vector<cv::DMatch> filtered_matches;
+
     // The FLANN matcher (except for the LSH method) requires the descriptors
     // to be of type CV_32F (float, from 0-1.0). Some descriptors
     // (ex. ORB, BRISK) provide descriptors in the form of CV_8U (unsigned int).
@@ -229,13 +282,54 @@ std::vector<cv::DMatch> FLANNMatcher::matchDescriptors(
         this->num_filtered_matches = filtered_matches.size();
     }
 
-    if (this->current_config.auto_remove_outliers) {
-        std::vector<cv::DMatch> good_matches =
-          this->removeOutliers(filtered_matches, keypoints_1, keypoints_2);
-        this->num_good_matches = good_matches.size();
+    return filtered_matches;
+}
 
-        return good_matches;
+std::vector<cv::DMatch> FLANNMatcher::matchIncrementalLSH(
+  const cv::Mat &descriptors_1,
+  const cv::Mat &descriptors_2,
+  cv::InputArray mask) {
+    // Refill the index with the train descriptors, using their rows as ids
+    std::vector<int> ids(descriptors_2.rows);
+    std::iota(ids.begin(), ids.end(), 0);
+    this->lsh_index.clear();
+    this->lsh_index.add(descriptors_2, ids);
+
+    // Same number of neighbours as the OpenCV matchers request
+    const int k = this->current_config.use_knn ? 2 : 1;
+    auto raw_matches = this->lsh_index.knnMatch(descriptors_1, k);
+
+    // Drop neighbours excluded by the mask, and queries with too few left
+    const cv::Mat mask_mat = mask.getMat();
+    std::vector<std::vector<cv::DMatch>> knn_matches;
+    for (auto &neighbours : raw_matches) {
+        if (!mask_mat.empty()) {
+            neighbours.erase(
+              std::remove_if(neighbours.begin(),
+                             neighbours.end(),
+                             [&mask_mat](const cv::DMatch &m) {
+                                 return mask_mat.at<uchar>(
+                                          m.queryIdx, m.trainIdx) == 0;
+                             }),
+              neighbours.end());
+        }
+        if (static_cast<int>(neighbours.size()) == k) {
+            knn_matches.push_back(std::move(neighbours));
+        }
+    }
+    this->num_raw_matches = knn_matches.size();
+
+    std::vector<cv::DMatch> filtered_matches;
+    if (this->current_config.use_knn) {
+        filtered_matches = this->filterMatches(knn_matches);
+    } else if (!knn_matches.empty()) {
+        std::vector<cv::DMatch> best_matches;
+        for (const auto &neighbours : knn_matches) {
+            best_matches.push_back(neighbours.front());
+        }
+        filtered_matches = this->filterMatches(best_matches);
     }
+    this->num_filtered_matches = filtered_matches.size();
 
     return filtered_matches;
 }
@@ -0,0 +1,362 @@
+#include "wave/vision/matcher/lsh_index.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <opencv2/core/hal/hal.hpp>
+
+#include "wave/utils/config.hpp"
+
+namespace wave {
+
+namespace {
+
+// Seed for choosing the bits sampled by each table, so that results are
+// repeatable
+const unsigned int LSH_SEED = 42;
+
+// Longest key for which every bucket has a head entry, of 2^16 entries or
+// 256 kB per table
+const int MAX_DIRECT_KEY_SIZE = 16;
+
+// Longest key for which bucket occupancy is kept as a bitmap, of 2^20 bits or
+// 128 kB per table
+const int MAX_BITMAP_KEY_SIZE = 20;
+
+}  // namespace
+
+// Filesystem based constructor for LSHIndexParams
+LSHIndexParams::LSHIndexParams(const std::string &config_path) {
+    // Extract parameters from .yaml file.
+    ConfigParser parser;
+
+    int num_tables;
+    int key_size;
+    int multi_probe_level;
+    int max_checks;
+
+    // Add parameters to parser, to be loaded. If path cannot be found, throw
+    // an exception.
+    parser.addParam("num_tables", &num_tables);
+    parser.addParam("key_size", &key_size);
+    parser.addParam("multi_probe_level", &multi_probe_level);
+    parser.addParam("max_checks", &max_checks);
+
+    if (parser.load(config_path) != ConfigStatus::OK) {
+        throw std::invalid_argument(
+          "Failed to Load LSHIndexParams Configuration");
+    }
+
+    this->num_tables = num_tables;
+    this->key_size = key_size;
+    this->multi_probe_level = multi_probe_level;
+    this->max_checks = max_checks;
+}
+
+LSHIndex::LSHIndex(const LSHIndexParams &config) {
+    // Ensure parameters are valid
+    this->checkConfiguration(config);
+
+    this->current_config = config;
+
+    // Probe the exact key first, then keys differing in one bit, then two
+    const auto key_size = config.key_size;
+    this->probes.push_back(0);
+    if (config.multi_probe_level >= 1) {
+        for (int i = 0; i < key_size; ++i) {
+            this->probes.push_back(1u << i);
+        }
+    }
+    if (config.multi_probe_level >= 2) {
+        for (int i = 0; i < key_size; ++i) {
+            for (int j = i + 1; j < key_size; ++j) {
+                this->probes.push_back((1u << i) | (1u << j));
+            }
+        }
+    }
+}
+
+void LSHIndex::checkConfiguration(const LSHIndexParams &check_config) const {
+    if (check_config.num_tables < 1) {
+        throw std::invalid_argument("num_tables must be at least one!");
+    }
+
+    if (check_config.key_size < 1 || check_config.key_size > 32) {
+        throw std::invalid_argument("key_size is not an appropriate value!");
+    }
+
+    if (check_config.multi_probe_level < 0 ||
+        check_config.multi_probe_level > 2) {
+        throw std::invalid_argument(
+          "multi_probe_level is not an appropriate value!");
+    }
+
+    if (check_config.max_checks < 1) {
+        throw std::invalid_argument("max_checks must be at least one!");
+    }
+}
+
+void LSHIndex::initializeTables(int num_bytes) {
+    const auto num_tables = this->current_config.num_tables;
+    const auto key_size = this->current_config.key_size;
+    const auto num_bits = 8 * num_bytes;
+    if (num_bits < key_size) {
+        throw std::invalid_argument(
+          "Descriptors are shorter than the key size!");
+    }
+
+    // Each table samples a different random subset of the descriptor bits
+    std::mt19937 generator{LSH_SEED};
+    std::vector<int> bits(num_bits);
+    this->key_bits.clear();
+    for (int t = 0; t < num_tables; ++t) {
+        std::iota(bits.begin(), bits.end(), 0);
+        std::shuffle(bits.begin(), bits.end(), generator);
+        this->key_bits.insert(
+          this->key_bits.end(), bits.begin(), bits.begin() + key_size);
+    }
+
+    const auto num_buckets = size_t{1} << key_size;
+    if (key_size <= MAX_DIRECT_KEY_SIZE) {
+        this->direct_heads.assign(num_tables * num_buckets, -1);
+    } else {
+        this->hashed_heads.assign(num_tables, {});
+    }
+    if (key_size <= MAX_BITMAP_KEY_SIZE) {
+        this->occupied.assign(num_tables * ((num_buckets + 63) / 64), 0);
+    }
+    this->descriptor_size = num_bytes;
+}
+
+bool LSHIndex::mayBeOccupied(int table, uint32_t key) const {
+    if (this->occupied.empty()) {
+        return true;
+    }
+    const auto bit =
+      (static_cast<size_t>(table) << this->current_config.key_size) + key;
+    return (this->occupied[bit / 64] >> (bit % 64)) & 1u;
+}
+
+int LSHIndex::head(int table, uint32_t key) const {
+    if (!this->direct_heads.empty()) {
+        return this->direct_heads
+          [(static_cast<size_t>(table) << this->current_config.key_size) +
+           key];
+    }
+    const auto &heads = this->hashed_heads[table];
+    const auto it = heads.find(key);
+    return it == heads.end() ? -1 : it->second;
+}
+
+void LSHIndex::setHead(int table, uint32_t key, int slot) {
+    const auto bucket =
+      (static_cast<size_t>(table) << this->current_config.key_size) + key;
+    if (!this->direct_heads.empty()) {
+        this->direct_heads[bucket] = slot;
+    } else if (slot >= 0) {
+        this->hashed_heads[table][key] = slot;
+    } else {
+        this->hashed_heads[table].erase(key);
+    }
+
+    if (!this->occupied.empty()) {
+        const auto mask = uint64_t{1} << (bucket % 64);
+        if (slot >= 0) {
+            this->occupied[bucket / 64] |= mask;
+        } else {
+            this->occupied[bucket / 64] &= ~mask;
+        }
+    }
+}
+
+uint32_t LSHIndex::computeKey(const uchar *descriptor, int table) const {
+    const auto key_size = this->current_config.key_size;
+    const int *bits = &this->key_bits[table * key_size];
+
+    uint32_t key = 0;
+    for (int b = 0; b < key_size; ++b) {
+        const uint32_t bit = (descriptor[bits[b] >> 3] >> (bits[b] & 7)) & 1u;
+        key |= bit << b;
+    }
+    return key;
+}
+
+void LSHIndex::add(const cv::Mat &descriptors, const std::vector<int> &ids) {
+    if (descriptors.rows != static_cast<int>(ids.size())) {
+        throw std::invalid_argument(
+          "Number of descriptors and ids must be equal!");
+    }
+    if (descriptors.empty()) {
+        return;
+    }
+    if (descriptors.type() != CV_8U) {
+        throw std::invalid_argument("Descriptors must be of type CV_8U!");
+    }
+    if (this->descriptor_size == 0) {
+        this->initializeTables(descriptors.cols);
+    } else if (descriptors.cols != this->descriptor_size) {
+        throw std::invalid_argument(
+          "Descriptor length differs from those in the index!");
+    }
+
+    // Check every id before changing anything
+    std::unordered_set<int> new_ids;
+    for (const auto id : ids) {
+        if (this->contains(id) || !new_ids.insert(id).second) {
+            throw std::invalid_argument("Descriptor id is already in use!");
+        }
+    }
+
+    const auto size = this->descriptor_size;
+    const auto num_tables = this->current_config.num_tables;
+    for (int i = 0; i < descriptors.rows; ++i) {
+        // Reuse the slot of a removed descriptor if there is one
+        int slot;
+        if (!this->free_slots.empty()) {
+            slot = this->free_slots.back();
+            this->free_slots.pop_back();
+        } else {
+            slot = static_cast<int>(this->slot_ids.size());
+            this->slot_ids.push_back(-1);
+            this->data.resize(this->data.size() + size);
+            this->next.resize(this->next.size() + num_tables);
+            this->prev.resize(this->prev.size() + num_tables);
+        }
+
+        uchar *descriptor = &this->data[slot * size];
+        std::memcpy(descriptor, descriptors.ptr<uchar>(i), size);
+        this->slot_ids[slot] = ids[i];
+        this->slots[ids[i]] = slot;
+
+        // Insert at the front of the bucket in each table
+        for (int t = 0; t < num_tables; ++t) {
+            const auto key = this->computeKey(descriptor, t);
+            const auto first = this->head(t, key);
+            this->next[slot * num_tables + t] = first;
+            this->prev[slot * num_tables + t] = -1;
+            if (first >= 0) {
+                this->prev[first * num_tables + t] = slot;
+            }
+            this->setHead(t, key, slot);
+        }
+    }
+}
+
+bool LSHIndex::remove(int id) {
+    const auto it = this->slots.find(id);
+    if (it == this->slots.end()) {
+        return false;
+    }
+
+    const auto slot = it->second;
+    const auto num_tables = this->current_config.num_tables;
+    const uchar *descriptor = &this->data[slot * this->descriptor_size];
+    for (int t = 0; t < num_tables; ++t) {
+        // Unlink the slot from its bucket
+        const auto before = this->prev[slot * num_tables + t];
+        const auto after = this->next[slot * num_tables + t];
+        if (before >= 0) {
+            this->next[before * num_tables + t] = after;
+        } else {
+            this->setHead(t, this->computeKey(descriptor, t), after);
+        }
+        if (after >= 0) {
+            this->prev[after * num_tables + t] = before;
+        }
+    }
+
+    this->slot_ids[slot] = -1;
+    this->free_slots.push_back(slot);
+    this->slots.erase(it);
+    return true;
+}
+
+void LSHIndex::clear() {
+    this->descriptor_size = 0;
+    this->data.clear();
+    this->slot_ids.clear();
+    this->free_slots.clear();
+    this->slots.clear();
+    this->key_bits.clear();
+    this->direct_heads.clear();
+    this->hashed_heads.clear();
+    this->next.clear();
+    this->prev.clear();
+    this->occupied.clear();
+}
+
+std::vector<std::vector<cv::DMatch>> LSHIndex::knnMatch(
+  const cv::Mat &query_descriptors, int k) const {
+    std::vector<std::vector<cv::DMatch>> matches(query_descriptors.rows);
+    if (query_descriptors.empty() || this->slots.empty() || k < 1) {
+        return matches;
+    }
+    if (query_descriptors.type() != CV_8U ||
+        query_descriptors.cols != this->descriptor_size) {
+        throw std::invalid_argument(
+          "Query descriptors do not match those in the index!");
+    }
+
+    const auto num_tables = this->current_config.num_tables;
+    const auto max_checks = this->current_config.max_checks;
+    const auto size = this->descriptor_size;
+    std::vector<uint32_t> keys(num_tables);
+
+    // Query in which each slot was last visited, to skip duplicates. It is
+    // local to the call, so concurrent queries do not share state.
+    std::vector<int> visited(this->slot_ids.size(), -1);
+
+    for (int q = 0; q < query_descriptors.rows; ++q) {
+        const uchar *query = query_descriptors.ptr<uchar>(q);
+        for (int t = 0; t < num_tables; ++t) {
+            keys[t] = this->computeKey(query, t);
+        }
+
+        auto &best = matches[q];
+        int checks = 0;
+        for (size_t p = 0; p < this->probes.size() && checks < max_checks;
+             ++p) {
+            for (int t = 0; t < num_tables && checks < max_checks; ++t) {
+                const auto key = keys[t] ^ this->probes[p];
+                if (!this->mayBeOccupied(t, key)) {
+                    continue;
+                }
+                for (auto slot = this->head(t, key);
+                     slot >= 0 && checks < max_checks;
+                     slot = this->next[slot * num_tables + t]) {
+                    if (visited[slot] == q) {
+                        continue;
+                    }
+                    visited[slot] = q;
+
+                    const auto distance =
+                      static_cast<float>(cv::hal::normHamming(
+                        query, &this->data[slot * size], size));
+
+                    // Keep the k best, sorted by distance
+                    if (static_cast<int>(best.size()) < k ||
+                        distance < best.back().distance) {
+                        const cv::DMatch match{
+                          q, this->slot_ids[slot], distance};
+                        best.insert(
+                          std::upper_bound(best.begin(), best.end(), match),
+                          match);
+                        if (static_cast<int>(best.size()) > k) {
+                            best.pop_back();
+                        }
+                    }
+
+                    ++checks;
+                }
+            }
+        }
+    }
+
+    return matches;
+}
+
+}  // namespace wave
@@ -0,0 +1,51 @@
+#include "wave/vision/tracker/tracker.hpp"
+
+namespace wave {
+
+// Filesystem constructor for KLTTrackerParams struct
+KLTTrackerParams::KLTTrackerParams(const std::string &config_path) {
+    // Extract parameters from .yaml file.
+    ConfigParser parser;
+
+    int patch_size;
+    int max_level;
+    int max_iterations;
+    double epsilon;
+    double fb_threshold;
+    int grid_rows;
+    int grid_cols;
+    int min_features_per_cell;
+    int max_features_per_cell;
+    double min_distance;
+
+    // Add parameters to parser, to be loaded. If path cannot be found,
+    // throw an exception.
+    parser.addParam("patch_size", &patch_size);
+    parser.addParam("max_level", &max_level);
+    parser.addParam("max_iterations", &max_iterations);
+    parser.addParam("epsilon", &epsilon);
+    parser.addParam("fb_threshold", &fb_threshold);
+    parser.addParam("grid_rows", &grid_rows);
+    parser.addParam("grid_cols", &grid_cols);
+    parser.addParam("min_features_per_cell", &min_features_per_cell);
+    parser.addParam("max_features_per_cell", &max_features_per_cell);
+    parser.addParam("min_distance", &min_distance);
+
+    if (parser.load(config_path) != ConfigStatus::OK) {
+        throw std::invalid_argument(
+          "Failed to Load KLTTrackerParams Configuration");
+    }
+
+    this->patch_size = patch_size;
+    this->max_level = max_level;
+    this->max_iterations = max_iterations;
+    this->epsilon = epsilon;
+    this->fb_threshold = fb_threshold;
+    this->grid_rows = grid_rows;
+    this->grid_cols = grid_cols;
+    this->min_features_per_cell = min_features_per_cell;
+    this->max_features_per_cell = max_features_per_cell;
+    this->min_distance = min_distance;
+}
+
+}  // namespace wave
@@ -1,4 +1,5 @@
 #include "wave/vision/utils.hpp"
+#include "wave/vision/image_sequence.hpp"
 
 namespace wave {
 
@@ -96,23 +97,12 @@ std::vector<cv::Point2f> convertKeypoints(const std::vector<Vec2> &keypoints) {
 }
 
 std::vector<cv::Mat> readImageSequence(const std::string &path) {
-    cv::String img_path(path);
-    std::vector<cv::String> files;
+    ImageSequence sequence{path};
     std::vector<cv::Mat> image_sequence;
-    int num_images;
+    image_sequence.reserve(sequence.size());
 
-    cv::VideoCapture sequence(img_path, cv::CAP_IMAGES);
-
-    num_images = (int) sequence.get(cv::CAP_PROP_FRAME_COUNT);
-
-    if (sequence.isOpened()) {
-        for (double i = 0; i < num_images; ++i) {
-            cv::Mat image;
-            sequence >> image;
-            image_sequence.push_back(image);
-        }
-    } else {
-        throw std::length_error("No images in image sequence!");
+    for (const auto &image : sequence) {
+        image_sequence.push_back(image);
     }
 
     return image_sequence;
@@ -1,10 +1,12 @@
 #include "wave/wave_test.hpp"
 #include "wave/vision/dataset/VoDataset.hpp"
+#include "wave/vision/dataset/VoDatasetBinary.hpp"
 
 namespace wave {
 
 const std::string TEST_CONFIG = "tests/data/vo_test.yaml";
 const std::string TEST_OUTPUT = "/tmp/dataset_test";
+const std::string TEST_BINARY = "/tmp/dataset_test.vod";
 
 TEST(VoTestCamera, constructor) {
     VoTestCamera camera;
@@ -68,6 +70,39 @@ TEST(VoTestCamera, observeLandmarks) {
     EXPECT_LT(observed[1].second.y(), 320);
 }
 
+TEST(VoTestCamera, projectLandmarksMatchesMap) {
+    // More landmarks than are projected in one batch
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    generator.nb_landmarks = 10000;
+    const auto points = generator.generateLandmarkPoints();
+    LandmarkMap landmarks;
+    for (int i = 0; i < points.cols(); ++i) {
+        landmarks.emplace(i, points.col(i));
+    }
+
+    Quaternion q_GC = Eigen::AngleAxisd(-M_PI_2, Vec3::UnitZ()) *
+                      Eigen::AngleAxisd(-M_PI_2, Vec3::UnitX());
+    Vec3 G_p_GC{0.5, -0.2, 0.1};
+
+    std::vector<LandmarkObservation> expected, observed;
+    // Step by a whole second, so the camera is triggered
+    auto camera = generator.camera;
+    auto res = camera.observeLandmarks(1.0, landmarks, q_GC, G_p_GC, expected);
+    ASSERT_EQ(0, res);
+    generator.camera.projectLandmarks(points, q_GC, G_p_GC, observed);
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected.size(), observed.size());
+    for (auto k = 0u; k < expected.size(); ++k) {
+        EXPECT_EQ(expected[k].first, observed[k].first);
+        EXPECT_PRED3(VectorsNearPrec,
+                     expected[k].second,
+                     observed[k].second,
+                     1e-9);
+    }
+}
+
 TEST(VoDataset, constructor) {
     VoDatasetGenerator dataset;
     EXPECT_EQ(0, dataset.camera.image_width);
@@ -85,6 +120,11 @@ TEST(VoDataset, configure) {
     EXPECT_FLOAT_EQ(554.25, dataset.camera.K(1, 1));
     EXPECT_FLOAT_EQ(0.0, dataset.camera.K(2, 0));
     EXPECT_FLOAT_EQ(0.0, dataset.camera.K(2, 1));
+
+    EXPECT_EQ(300, dataset.nb_steps);
+    EXPECT_DOUBLE_EQ(0.01, dataset.dt);
+    EXPECT_DOUBLE_EQ(0.5, dataset.circle_radius);
+    EXPECT_DOUBLE_EQ(1.0, dataset.velocity);
 }
 
 TEST(VoDataset, generate) {
@@ -93,6 +133,31 @@ TEST(VoDataset, generate) {
     auto dataset = generator.generate();
 }
 
+TEST(VoDataset, generateIsIndependentOfThreads) {
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    generator.nb_steps = 100;
+
+    generator.nb_threads = 1;
+    srand(1);
+    generator.camera.dt = 0;
+    auto serial = generator.generate();
+
+    generator.nb_threads = 4;
+    srand(1);
+    generator.camera.dt = 0;
+    auto parallel = generator.generate();
+
+    EXPECT_EQ(serial.landmarks, parallel.landmarks);
+    ASSERT_EQ(serial.states.size(), parallel.states.size());
+    ASSERT_FALSE(serial.states.empty());
+    for (auto i = 0u; i < serial.states.size(); ++i) {
+        EXPECT_EQ(serial.states[i].time, parallel.states[i].time);
+        EXPECT_EQ(serial.states[i].features_observed,
+                  parallel.states[i].features_observed);
+    }
+}
+
 TEST(VoDataset, writeAndReadToFile) {
     // To test both operations, we write to files, read them, and ensure the
     // resulting dataset is the one we started with
@@ -142,4 +207,104 @@ TEST(VoDataset, writeAndReadToFile) {
     }
 }
 
+TEST(VoDataset, writeAndReadBinary) {
+    // The binary format stores values exactly, so the datasets must be equal
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    auto dataset = generator.generate();
+    dataset.states[1].camera_frame = 7;
+
+    dataset.outputBinary(TEST_BINARY);
+    auto input = VoDataset::loadFromBinary(TEST_BINARY);
+
+    EXPECT_EQ(dataset.camera_K, input.camera_K);
+    EXPECT_EQ(dataset.landmarks, input.landmarks);
+    ASSERT_EQ(dataset.states.size(), input.states.size());
+    for (auto i = 0u; i < dataset.states.size(); ++i) {
+        const auto &lhs = dataset.states[i];
+        const auto &rhs = input.states[i];
+        EXPECT_EQ(lhs.time, rhs.time);
+        EXPECT_EQ(lhs.camera_frame, rhs.camera_frame);
+        EXPECT_EQ(lhs.robot_G_p_GB, rhs.robot_G_p_GB);
+        EXPECT_EQ(lhs.robot_q_GB.coeffs(), rhs.robot_q_GB.coeffs());
+        EXPECT_EQ(lhs.features_observed, rhs.features_observed);
+    }
+}
+
+TEST(VoDataset, mappedViews) {
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    auto dataset = generator.generate();
+    dataset.outputBinary(TEST_BINARY);
+
+    MappedVoDataset mapped{TEST_BINARY};
+    EXPECT_EQ(dataset.camera_K, mapped.cameraK());
+
+    ASSERT_EQ(dataset.landmarks.size(), mapped.numLandmarks());
+    std::size_t i = 0;
+    for (const auto &l : dataset.landmarks) {
+        EXPECT_EQ(l.first, mapped.landmarkId(i));
+        EXPECT_EQ(l.second, mapped.landmarkPosition(i));
+        ++i;
+    }
+
+    ASSERT_EQ(dataset.states.size(), mapped.size());
+    for (i = 0; i < mapped.size(); ++i) {
+        const auto &state = dataset.states[i];
+        const auto view = mapped[i];
+        EXPECT_EQ(state.time, view.time());
+        EXPECT_EQ(state.robot_G_p_GB, view.robot_G_p_GB());
+        EXPECT_EQ(state.robot_q_GB.coeffs(), view.robot_q_GB().coeffs());
+        ASSERT_EQ(state.features_observed.size(), view.size());
+        for (auto k = 0u; k < view.size(); ++k) {
+            EXPECT_EQ(state.features_observed[k].first, view.landmarkId(k));
+            EXPECT_EQ(state.features_observed[k].second, view.measurement(k));
+        }
+    }
+}
+
+TEST(VoDataset, convertDirectory) {
+    VoDatasetGenerator generator;
+    remove_dir(TEST_OUTPUT);
+    generator.configure(TEST_CONFIG);
+    generator.generate().outputToDirectory(TEST_OUTPUT);
+
+    convertVoDatasetDirectory(TEST_OUTPUT, TEST_BINARY);
+
+    // Both formats must give the same dataset once read
+    auto text = VoDataset::loadFromDirectory(TEST_OUTPUT);
+    auto binary = VoDataset::loadFromBinary(TEST_BINARY);
+    EXPECT_EQ(text.camera_K, binary.camera_K);
+    EXPECT_EQ(text.landmarks, binary.landmarks);
+    ASSERT_EQ(text.states.size(), binary.states.size());
+    for (auto i = 0u; i < text.states.size(); ++i) {
+        EXPECT_EQ(text.states[i].time, binary.states[i].time);
+        EXPECT_EQ(text.states[i].features_observed,
+                  binary.states[i].features_observed);
+    }
+}
+
+TEST(VoDataset, badBinaryFile) {
+    // Missing file, and a file in another format
+    EXPECT_THROW(MappedVoDataset{"/tmp/no_such_dataset.vod"},
+                 std::runtime_error);
+    EXPECT_THROW(MappedVoDataset{TEST_CONFIG}, std::runtime_error);
+
+    // A truncated file
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    generator.generate().outputBinary(TEST_BINARY);
+    std::string contents;
+    {
+        std::ifstream in{TEST_BINARY, std::ios::binary};
+        contents.assign(std::istreambuf_iterator<char>{in},
+                        std::istreambuf_iterator<char>{});
+    }
+    {
+        std::ofstream out{TEST_BINARY, std::ios::binary};
+        out.write(contents.data(), contents.size() - 8);
+    }
+    EXPECT_THROW(MappedVoDataset{TEST_BINARY}, std::runtime_error);
+}
+
 }  // namespace wave
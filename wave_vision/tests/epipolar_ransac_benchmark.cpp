@@ -0,0 +1,120 @@
+/** Outlier rejection with EpipolarRansac and cv::findFundamentalMat.
+ *
+ * Each benchmark estimates the fundamental matrix from the matches of a
+ * synthetic scene, with the benchmark argument giving the percentage of
+ * outliers. Descriptor distances are drawn so that inliers tend to have
+ * smaller distances, but the two overlap, as with a real matcher. items/s is
+ * matches per second, and the `recall` counter is the fraction of true
+ * inliers found.
+ */
+
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "wave/vision/matcher/epipolar_ransac.hpp"
+#include "wave/vision/utils.hpp"
+
+namespace wave {
+
+const int NUM_MATCHES = 1000;
+
+struct MatchSet {
+    std::vector<cv::KeyPoint> keypoints_1, keypoints_2;
+    std::vector<cv::DMatch> matches;
+    std::vector<bool> is_inlier;
+
+    explicit MatchSet(double outlier_ratio) {
+        std::mt19937 gen{1};
+        std::uniform_real_distribution<double> lateral(-4.0, 4.0);
+        std::uniform_real_distribution<double> depth(4.0, 12.0);
+        std::uniform_real_distribution<float> image_u(0.0, 640.0);
+        std::uniform_real_distribution<float> image_v(0.0, 480.0);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::normal_distribution<float> noise(0.0, 0.5);
+        std::normal_distribution<float> inlier_distance(30.0, 10.0);
+        std::normal_distribution<float> outlier_distance(50.0, 10.0);
+
+        Mat3 K;
+        K << 500, 0, 320, 0, 500, 240, 0, 0, 1;
+        const Mat3 R =
+          Eigen::AngleAxisd(0.1, Vec3{0.2, 1.0, 0.1}.normalized()).matrix();
+        const Vec3 t{1.0, 0.1, 0.2};
+
+        for (int i = 0; i < NUM_MATCHES; ++i) {
+            const Vec3 X_1{lateral(gen), lateral(gen), depth(gen)};
+            const Vec2 x_1 = (K * X_1).hnormalized();
+            const Vec2 x_2 = (K * (R * X_1 + t)).hnormalized();
+            this->keypoints_1.emplace_back(
+              x_1.x() + noise(gen), x_1.y() + noise(gen), 1.0);
+
+            this->is_inlier.push_back(unit(gen) >= outlier_ratio);
+            if (this->is_inlier.back()) {
+                this->keypoints_2.emplace_back(
+                  x_2.x() + noise(gen), x_2.y() + noise(gen), 1.0);
+                this->matches.emplace_back(i, i, inlier_distance(gen));
+            } else {
+                this->keypoints_2.emplace_back(
+                  image_u(gen), image_v(gen), 1.0);
+                this->matches.emplace_back(i, i, outlier_distance(gen));
+            }
+        }
+    }
+
+    double recall(const std::vector<uchar> &inliers) const {
+        int found = 0, total = 0;
+        for (size_t i = 0; i < inliers.size(); ++i) {
+            found += this->is_inlier[i] && inliers[i];
+            total += this->is_inlier[i];
+        }
+        return static_cast<double>(found) / total;
+    }
+};
+
+void BM_EpipolarRansac(benchmark::State &state) {
+    const MatchSet set{state.range(0) / 100.0};
+    EpipolarRansac ransac;
+    Mat3 F;
+    std::vector<uchar> inliers;
+
+    for (auto _ : state) {
+        ransac.estimateFundamental(
+          set.matches, set.keypoints_1, set.keypoints_2, F, inliers);
+        benchmark::DoNotOptimize(inliers.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_MATCHES);
+    state.counters["recall"] = set.recall(inliers);
+}
+
+void BM_FindFundamentalMat(benchmark::State &state) {
+    const MatchSet set{state.range(0) / 100.0};
+    std::vector<uchar> inliers;
+
+    for (auto _ : state) {
+        // The conversion done by removeOutliers for the OpenCV methods
+        std::vector<cv::Point2f> fp1, fp2;
+        for (const auto &match : set.matches) {
+            fp1.push_back(set.keypoints_1[match.queryIdx].pt);
+            fp2.push_back(set.keypoints_2[match.trainIdx].pt);
+        }
+        const cv::Mat F =
+          cv::findFundamentalMat(fp1, fp2, cv::FM_RANSAC, 3.0, 0.99, inliers);
+        benchmark::DoNotOptimize(F.data);
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_MATCHES);
+    state.counters["recall"] = set.recall(inliers);
+}
+
+BENCHMARK(BM_EpipolarRansac)
+  ->Arg(10)
+  ->Arg(30)
+  ->Arg(50)
+  ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FindFundamentalMat)
+  ->Arg(10)
+  ->Arg(30)
+  ->Arg(50)
+  ->Unit(benchmark::kMicrosecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
@@ -0,0 +1,71 @@
+#include "wave/wave_test.hpp"
+#include "wave/vision/image_frame.hpp"
+#include "wave/vision/utils.hpp"
+
+namespace wave {
+
+const auto TEST_IMAGE_0 = "tests/data/tracker_test_sequence/frame0059.jpg";
+const auto TEST_IMAGE_1 = "tests/data/tracker_test_sequence/frame0060.jpg";
+
+TEST(ImageFrameTests, GrayscaleConversion) {
+    cv::Mat image = cv::imread(TEST_IMAGE_0);
+    ImageFrame frame;
+    ASSERT_TRUE(frame.empty());
+
+    frame.setImage(image);
+    ASSERT_FALSE(frame.empty());
+    ASSERT_EQ(CV_8UC1, frame.image().type());
+    ASSERT_EQ(image.size(), frame.image().size());
+
+    cv::Mat expected;
+    cv::cvtColor(image, expected, cv::COLOR_BGR2GRAY);
+    ASSERT_EQ(0, cv::norm(expected, frame.image(), cv::NORM_INF));
+}
+
+TEST(ImageFrameTests, GrayscaleInputIsCopied) {
+    cv::Mat image = cv::imread(TEST_IMAGE_0, cv::IMREAD_GRAYSCALE);
+    ImageFrame frame;
+    frame.setImage(image);
+
+    ASSERT_NE(image.data, frame.image().data);
+    ASSERT_EQ(0, cv::norm(image, frame.image(), cv::NORM_INF));
+}
+
+TEST(ImageFrameTests, PyramidIsCached) {
+    ImageFrame frame;
+    frame.setImage(cv::imread(TEST_IMAGE_0));
+
+    const cv::Size win{21, 21};
+    const auto &pyramid = frame.pyramid(win, 3);
+    ASSERT_FALSE(pyramid.empty());
+    const auto *level0 = pyramid[0].data;
+
+    // The same parameters return the same pyramid without rebuilding
+    ASSERT_EQ(level0, frame.pyramid(win, 3)[0].data);
+
+    // Without gradients, there is one image per level
+    ASSERT_EQ(4u, frame.pyramid(win, 3, false).size());
+}
+
+TEST(ImageFrameTests, BuffersReused) {
+    ImageFrame frame;
+    const cv::Size win{21, 21};
+
+    frame.setImage(cv::imread(TEST_IMAGE_0));
+    const auto *gray = frame.image().data;
+    std::vector<const uchar *> levels;
+    for (const auto &level : frame.pyramid(win, 3)) {
+        levels.push_back(level.datastart);
+    }
+
+    // A new image of the same size is written into the same storage
+    frame.setImage(cv::imread(TEST_IMAGE_1));
+    ASSERT_EQ(gray, frame.image().data);
+    const auto &pyramid = frame.pyramid(win, 3);
+    ASSERT_EQ(levels.size(), pyramid.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        ASSERT_EQ(levels[i], pyramid[i].datastart);
+    }
+}
+
+}  // namespace wave
@@ -0,0 +1,102 @@
+#include "wave/wave_test.hpp"
+#include "wave/vision/image_sequence.hpp"
+#include "wave/vision/utils.hpp"
+
+namespace wave {
+
+const auto FIRST_IMG_PATH = "tests/data/tracker_test_sequence/frame0057.jpg";
+const auto LAST_IMG_PATH = "tests/data/tracker_test_sequence/frame0066.jpg";
+
+TEST(ImageSequenceTests, BadPath) {
+    ASSERT_THROW(ImageSequence sequence("bad_path"), std::length_error);
+}
+
+TEST(ImageSequenceTests, BadConfig) {
+    ASSERT_THROW(ImageSequence bad_threads(
+                   FIRST_IMG_PATH, ImageSequenceParams(0, 8, 1.0, false)),
+                 std::invalid_argument);
+    ASSERT_THROW(ImageSequence bad_depth(
+                   FIRST_IMG_PATH, ImageSequenceParams(4, 2, 1.0, false)),
+                 std::invalid_argument);
+    ASSERT_THROW(ImageSequence bad_scale1(
+                   FIRST_IMG_PATH, ImageSequenceParams(2, 8, 0.0, false)),
+                 std::invalid_argument);
+    ASSERT_THROW(ImageSequence bad_scale2(
+                   FIRST_IMG_PATH, ImageSequenceParams(2, 8, 2.0, false)),
+                 std::invalid_argument);
+}
+
+TEST(ImageSequenceTests, ListsNumberedFiles) {
+    ImageSequence sequence{FIRST_IMG_PATH};
+    ASSERT_EQ(10u, sequence.size());
+    ASSERT_EQ(FIRST_IMG_PATH, sequence.paths().front());
+    ASSERT_EQ(LAST_IMG_PATH, sequence.paths().back());
+}
+
+// Images are returned in order however many threads decode them
+TEST(ImageSequenceTests, ReadsInOrder) {
+    for (int num_threads = 1; num_threads <= 4; ++num_threads) {
+        ImageSequence sequence{
+          FIRST_IMG_PATH, ImageSequenceParams(num_threads, 4, 1.0, false)};
+
+        cv::Mat image;
+        for (const auto &path : sequence.paths()) {
+            ASSERT_TRUE(sequence.next(image));
+            const cv::Mat expected = cv::imread(path);
+            ASSERT_EQ(expected.size(), image.size());
+            ASSERT_EQ(CV_8UC3, image.type());
+            ASSERT_EQ(0, cv::norm(expected, image, cv::NORM_INF));
+        }
+        ASSERT_FALSE(sequence.next(image));
+    }
+}
+
+TEST(ImageSequenceTests, Iterator) {
+    ImageSequence sequence{FIRST_IMG_PATH};
+    size_t count = 0;
+    for (const auto &image : sequence) {
+        ASSERT_FALSE(image.empty());
+        ++count;
+    }
+    ASSERT_EQ(sequence.size(), count);
+
+    // The sequence is read once
+    ASSERT_TRUE(sequence.begin() == sequence.end());
+}
+
+TEST(ImageSequenceTests, GrayscaleAndScale) {
+    const cv::Mat full = cv::imread(FIRST_IMG_PATH);
+
+    // Reduced by the decoder
+    ImageSequence half{FIRST_IMG_PATH, ImageSequenceParams(2, 4, 0.5, true)};
+    cv::Mat image;
+    ASSERT_TRUE(half.next(image));
+    ASSERT_EQ(CV_8UC1, image.type());
+    ASSERT_NEAR(full.cols / 2, image.cols, 1);
+    ASSERT_NEAR(full.rows / 2, image.rows, 1);
+
+    // Resized after decoding
+    ImageSequence other{FIRST_IMG_PATH, ImageSequenceParams(2, 4, 0.3, false)};
+    ASSERT_TRUE(other.next(image));
+    ASSERT_EQ(CV_8UC3, image.type());
+    ASSERT_NEAR(full.cols * 0.3, image.cols, 1);
+    ASSERT_NEAR(full.rows * 0.3, image.rows, 1);
+}
+
+// Destroying a sequence with images still being prefetched must not block
+TEST(ImageSequenceTests, StopsEarly) {
+    ImageSequence sequence{FIRST_IMG_PATH,
+                           ImageSequenceParams(2, 2, 1.0, false)};
+    cv::Mat image;
+    ASSERT_TRUE(sequence.next(image));
+}
+
+TEST(ImageSequenceTests, MatchesReadImageSequence) {
+    const auto images = readImageSequence(FIRST_IMG_PATH);
+    ASSERT_EQ(10u, images.size());
+
+    // Returned images must not share storage
+    ASSERT_NE(images[0].data, images[1].data);
+}
+
+}  // namespace wave
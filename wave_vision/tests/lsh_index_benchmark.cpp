@@ -0,0 +1,186 @@
+/** Per-frame cost of matching against a changing map of binary descriptors.
+ *
+ * The map holds descriptors of landmarks. Each frame, some landmarks leave
+ * the map and new ones enter, then the frame's descriptors, which are noisy
+ * copies of map descriptors, are matched against the map with k = 2. items/s
+ * is query descriptors per second, and the `recall` counter is the fraction
+ * of queries whose nearest match is the landmark they were copied from.
+ *
+ * BM_LSHIndexFrame updates a persistent LSHIndex. BM_FlannLSHFrame builds an
+ * LSH index of the whole map each frame, as FLANNMatcher does, and
+ * BM_BruteForceFrame matches exhaustively.
+ */
+
+#include <random>
+#include <benchmark/benchmark.h>
+#include <opencv2/features2d/features2d.hpp>
+
+#include "wave/vision/matcher/lsh_index.hpp"
+
+namespace wave {
+
+const int MAP_SIZE = 20000;
+const int DESCRIPTOR_SIZE = 32;  // bytes, as for ORB
+const int NUM_QUERIES = 500;     // per frame
+const int NUM_REPLACED = 100;    // map descriptors replaced per frame
+const int NUM_FLIPS = 30;        // bits differing in a query
+
+class Map {
+ public:
+    Map() : gen{1} {
+        this->descriptors = this->random(MAP_SIZE);
+        for (int id = 0; id < MAP_SIZE; ++id) {
+            this->ids.push_back(id);
+        }
+        this->next_id = MAP_SIZE;
+    }
+
+    /** Replaces the oldest descriptors, returning the removed ids */
+    std::vector<int> replace(cv::Mat &added, std::vector<int> &added_ids) {
+        std::vector<int> removed;
+        added = this->random(NUM_REPLACED);
+        added_ids.clear();
+        for (int i = 0; i < NUM_REPLACED; ++i) {
+            // Rows are reused in a ring, so the oldest row is overwritten
+            const auto row = this->next_id % MAP_SIZE;
+            removed.push_back(this->ids[row]);
+            added.row(i).copyTo(this->descriptors.row(row));
+            this->ids[row] = this->next_id;
+            added_ids.push_back(this->next_id++);
+        }
+        return removed;
+    }
+
+    /** Noisy copies of random map descriptors, and their ids */
+    cv::Mat queries(std::vector<int> &true_ids) {
+        std::uniform_int_distribution<int> row(0, MAP_SIZE - 1);
+        std::uniform_int_distribution<int> bit(0, 8 * DESCRIPTOR_SIZE - 1);
+        cv::Mat queries(NUM_QUERIES, DESCRIPTOR_SIZE, CV_8U);
+        true_ids.clear();
+        for (int q = 0; q < NUM_QUERIES; ++q) {
+            const auto r = row(this->gen);
+            this->descriptors.row(r).copyTo(queries.row(q));
+            for (int f = 0; f < NUM_FLIPS; ++f) {
+                const auto b = bit(this->gen);
+                queries.at<uchar>(q, b / 8) ^= static_cast<uchar>(1 << (b % 8));
+            }
+            true_ids.push_back(this->ids[r]);
+        }
+        return queries;
+    }
+
+    cv::Mat descriptors;
+    std::vector<int> ids;
+
+ private:
+    std::mt19937 gen;
+    int next_id;
+
+    cv::Mat random(int num) {
+        cv::Mat descriptors(num, DESCRIPTOR_SIZE, CV_8U);
+        cv::randu(descriptors, 0, 256);
+        return descriptors;
+    }
+};
+
+// Fraction of queries whose nearest match is their true id. Matches give
+// map ids, or map rows if `ids` is not null.
+double recall(const std::vector<std::vector<cv::DMatch>> &matches,
+              const std::vector<int> &true_ids,
+              const std::vector<int> *ids = nullptr) {
+    int correct = 0;
+    for (size_t q = 0; q < matches.size(); ++q) {
+        if (!matches[q].empty()) {
+            const auto train = matches[q][0].trainIdx;
+            correct += (ids ? (*ids)[train] : train) == true_ids[q];
+        }
+    }
+    return static_cast<double>(correct) / matches.size();
+}
+
+void BM_LSHIndexFrame(benchmark::State &state) {
+    Map map;
+    LSHIndex index;
+    index.add(map.descriptors, map.ids);
+    cv::Mat added;
+    std::vector<int> added_ids, true_ids;
+    double total_recall = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        const auto removed = map.replace(added, added_ids);
+        const auto queries = map.queries(true_ids);
+        state.ResumeTiming();
+
+        for (const auto id : removed) {
+            index.remove(id);
+        }
+        index.add(added, added_ids);
+        const auto matches = index.knnMatch(queries, 2);
+
+        state.PauseTiming();
+        total_recall += recall(matches, true_ids);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_QUERIES);
+    state.counters["recall"] = total_recall / state.iterations();
+}
+
+void BM_FlannLSHFrame(benchmark::State &state) {
+    Map map;
+    cv::Mat added;
+    std::vector<int> added_ids, true_ids;
+    double total_recall = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        map.replace(added, added_ids);
+        const auto queries = map.queries(true_ids);
+        state.ResumeTiming();
+
+        // The same parameters as FLANNMatcher with FLANN::LSH
+        cv::FlannBasedMatcher matcher{
+          cv::makePtr<cv::flann::LshIndexParams>(20, 15, 2),
+          cv::makePtr<cv::flann::SearchParams>()};
+        std::vector<std::vector<cv::DMatch>> matches;
+        matcher.knnMatch(queries, map.descriptors, matches, 2);
+
+        state.PauseTiming();
+        total_recall += recall(matches, true_ids, &map.ids);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_QUERIES);
+    state.counters["recall"] = total_recall / state.iterations();
+}
+
+void BM_BruteForceFrame(benchmark::State &state) {
+    Map map;
+    cv::Mat added;
+    std::vector<int> added_ids, true_ids;
+    cv::BFMatcher matcher{cv::NORM_HAMMING};
+    double total_recall = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        map.replace(added, added_ids);
+        const auto queries = map.queries(true_ids);
+        state.ResumeTiming();
+
+        std::vector<std::vector<cv::DMatch>> matches;
+        matcher.knnMatch(queries, map.descriptors, matches, 2);
+
+        state.PauseTiming();
+        total_recall += recall(matches, true_ids, &map.ids);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_QUERIES);
+    state.counters["recall"] = total_recall / state.iterations();
+}
+
+BENCHMARK(BM_LSHIndexFrame)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FlannLSHFrame)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BruteForceFrame)->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
@@ -1,3 +1,6 @@
+#include <cstdio>
+#include <fstream>
+
 #include "wave/wave_test.hpp"
 #include "wave/vision/utils.hpp"
 #include "wave/vision/matcher/brute_force_matcher.hpp"
@@ -28,6 +31,22 @@ TEST(BFTests, GoodConfig) {
     EXPECT_NO_THROW(BFMatcherParams config4(TEST_CONFIG));
 }
 
+// Checks that configs without the fm_threshold and fm_confidence keys load
+TEST(BFTests, ConfigWithoutFmParams) {
+    const auto path = "/tmp/wave_brute_force_no_fm.yaml";
+    std::ofstream{path} << "norm_type: 6\n"
+                        << "use_knn: true\n"
+                        << "ratio_threshold: 0.8\n"
+                        << "distance_threshold: 5\n"
+                        << "auto_remove_outliers: true\n"
+                        << "fm_method: 8\n";
+
+    BFMatcherParams config(path);
+    EXPECT_EQ(3.0, config.fm_threshold);
+    EXPECT_EQ(0.99, config.fm_confidence);
+    std::remove(path);
+}
+
 // Checks that incorrect configuration path throws an exception
 TEST(BFTests, BadConfigPath) {
     const std::string bad_path = "bad_path";
@@ -86,6 +105,19 @@ TEST(BFTests, BadFmMethod) {
     ASSERT_THROW(BruteForceMatcher bad_fm4(config), std::invalid_argument);
 }
 
+TEST(BFTests, BadFmParams) {
+    BFMatcherParams config;
+    config.fm_threshold = 0.0;
+    ASSERT_THROW(BruteForceMatcher bad_fm_th(config), std::invalid_argument);
+
+    config.fm_threshold = 3.0;
+    config.fm_confidence = 1.5;
+    ASSERT_THROW(BruteForceMatcher bad_fm_c1(config), std::invalid_argument);
+
+    config.fm_confidence = 0.0;
+    ASSERT_THROW(BruteForceMatcher bad_fm_c2(config), std::invalid_argument);
+}
+
 TEST(BFTests, ConfigurationTests) {
     BFMatcherParams ref_config;
     BFMatcherParams yaml_config(TEST_CONFIG);
@@ -106,6 +138,8 @@ TEST(BFTests, ConfigurationTests) {
     ASSERT_EQ(curr_config_1.auto_remove_outliers,
               ref_config.auto_remove_outliers);
     ASSERT_EQ(curr_config_1.fm_method, ref_config.fm_method);
+    ASSERT_EQ(curr_config_1.fm_threshold, ref_config.fm_threshold);
+    ASSERT_EQ(curr_config_1.fm_confidence, ref_config.fm_confidence);
 
     // Confirm default construction
     ASSERT_EQ(curr_config_2.norm_type, ref_config.norm_type);
@@ -115,6 +149,8 @@ TEST(BFTests, ConfigurationTests) {
     ASSERT_EQ(curr_config_2.auto_remove_outliers,
               ref_config.auto_remove_outliers);
     ASSERT_EQ(curr_config_2.fm_method, ref_config.fm_method);
+    ASSERT_EQ(curr_config_2.fm_threshold, ref_config.fm_threshold);
+    ASSERT_EQ(curr_config_2.fm_confidence, ref_config.fm_confidence);
 
     // Confirm construction with .yaml file
     ASSERT_EQ(curr_config_3.norm_type, ref_config.norm_type);
@@ -124,5 +160,7 @@ TEST(BFTests, ConfigurationTests) {
     ASSERT_EQ(curr_config_3.auto_remove_outliers,
               ref_config.auto_remove_outliers);
     ASSERT_EQ(curr_config_3.fm_method, ref_config.fm_method);
+    ASSERT_EQ(curr_config_3.fm_threshold, ref_config.fm_threshold);
+    ASSERT_EQ(curr_config_3.fm_confidence, ref_config.fm_confidence);
 }
 }  // namespace wave
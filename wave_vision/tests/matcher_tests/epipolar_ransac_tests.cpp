@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <random>
+
+#include "wave/wave_test.hpp"
+#include "wave/vision/matcher/epipolar_ransac.hpp"
+
+namespace wave {
+
+// Correspondences between two views of random points, some replaced by
+// outliers
+struct EpipolarScene {
+    Eigen::Matrix2Xd points_1, points_2;
+    std::vector<bool> is_inlier;
+    Mat3 K;
+    Mat3 fundamental_matrix;
+};
+
+EpipolarScene makeScene(int num_points, double outlier_ratio) {
+    std::mt19937 gen{1};
+    std::uniform_real_distribution<double> lateral(-4.0, 4.0);
+    std::uniform_real_distribution<double> depth(4.0, 12.0);
+    std::uniform_real_distribution<double> image_u(0.0, 640.0);
+    std::uniform_real_distribution<double> image_v(0.0, 480.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> noise(0.0, 0.5);
+
+    EpipolarScene scene;
+    scene.K << 500, 0, 320, 0, 500, 240, 0, 0, 1;
+
+    // Second camera, such that X_2 = R X_1 + t
+    const Mat3 R =
+      Eigen::AngleAxisd(0.1, Vec3{0.2, 1.0, 0.1}.normalized()).matrix();
+    const Vec3 t{1.0, 0.1, 0.2};
+    Mat3 t_skew;
+    t_skew << 0, -t.z(), t.y(), t.z(), 0, -t.x(), -t.y(), t.x(), 0;
+    const Mat3 K_inv = scene.K.inverse();
+    scene.fundamental_matrix = K_inv.transpose() * t_skew * R * K_inv;
+
+    scene.points_1.resize(2, num_points);
+    scene.points_2.resize(2, num_points);
+    for (int i = 0; i < num_points; ++i) {
+        const Vec3 X_1{lateral(gen), lateral(gen), depth(gen)};
+        const Vec3 x_1 = scene.K * X_1;
+        const Vec3 x_2 = scene.K * (R * X_1 + t);
+        const Vec2 noise_1{noise(gen), noise(gen)};
+        const Vec2 noise_2{noise(gen), noise(gen)};
+        scene.points_1.col(i) = x_1.hnormalized() + noise_1;
+        scene.points_2.col(i) = x_2.hnormalized() + noise_2;
+
+        scene.is_inlier.push_back(unit(gen) >= outlier_ratio);
+        if (!scene.is_inlier.back()) {
+            scene.points_2.col(i) = Vec2{image_u(gen), image_v(gen)};
+        }
+    }
+    return scene;
+}
+
+// Checks the inlier mask against the truth. True inliers are only lost to
+// noise, but some outliers fall near their epipolar line by chance.
+void checkInliers(const EpipolarScene &scene,
+                  const std::vector<uchar> &inliers,
+                  int num_inliers) {
+    ASSERT_EQ(inliers.size(), scene.is_inlier.size());
+
+    int true_inliers = 0, found = 0, false_inliers = 0;
+    for (size_t i = 0; i < inliers.size(); ++i) {
+        if (scene.is_inlier[i]) {
+            ++true_inliers;
+            found += inliers[i] != 0;
+        } else {
+            false_inliers += inliers[i] != 0;
+        }
+    }
+    const auto num_outliers = inliers.size() - true_inliers;
+
+    ASSERT_EQ(std::count(inliers.begin(), inliers.end(), 1), num_inliers);
+    ASSERT_GE(found, 0.95 * true_inliers);
+    ASSERT_LE(false_inliers, 0.1 * num_outliers);
+}
+
+TEST(EpipolarRansacTests, GoodConfig) {
+    EXPECT_NO_THROW(EpipolarRansac ransac1);
+
+    EpipolarRansacParams config{1.0, 0.999, 500, 8};
+    EpipolarRansac ransac2{config};
+    ASSERT_EQ(ransac2.getConfiguration().threshold, config.threshold);
+    ASSERT_EQ(ransac2.getConfiguration().confidence, config.confidence);
+    ASSERT_EQ(ransac2.getConfiguration().max_iterations,
+              config.max_iterations);
+    ASSERT_EQ(ransac2.getConfiguration().sample_size, config.sample_size);
+}
+
+// Check that incorrect parameter values throw exceptions.
+TEST(EpipolarRansacTests, BadConfig) {
+    EpipolarRansacParams config;
+    config.threshold = 0.0;
+    ASSERT_THROW(EpipolarRansac bad_threshold(config), std::invalid_argument);
+
+    config = EpipolarRansacParams{};
+    config.confidence = 1.0;
+    ASSERT_THROW(EpipolarRansac bad_conf1(config), std::invalid_argument);
+
+    config.confidence = 0.0;
+    ASSERT_THROW(EpipolarRansac bad_conf2(config), std::invalid_argument);
+
+    config = EpipolarRansacParams{};
+    config.max_iterations = 0;
+    ASSERT_THROW(EpipolarRansac bad_iterations(config), std::invalid_argument);
+
+    config = EpipolarRansacParams{};
+    config.sample_size = 5;
+    ASSERT_THROW(EpipolarRansac bad_sample(config), std::invalid_argument);
+}
+
+TEST(EpipolarRansacTests, TooFewPoints) {
+    const auto scene = makeScene(6, 0.0);
+    EpipolarRansac ransac;
+    Mat3 F;
+    std::vector<uchar> inliers;
+
+    ASSERT_EQ(ransac.estimateFundamental(
+                scene.points_1, scene.points_2, F, inliers),
+              0);
+    ASSERT_TRUE(F.isZero());
+    ASSERT_EQ(inliers, std::vector<uchar>(6, 0));
+}
+
+TEST(EpipolarRansacTests, SevenPoint) {
+    const auto scene = makeScene(300, 0.4);
+    EpipolarRansac ransac;
+    Mat3 F;
+    std::vector<uchar> inliers;
+
+    const auto num_inliers =
+      ransac.estimateFundamental(scene.points_1, scene.points_2, F, inliers);
+    checkInliers(scene, inliers, num_inliers);
+
+    // Compare with the true matrix, up to scale and sign
+    const Mat3 F_true = scene.fundamental_matrix.normalized();
+    const Mat3 F_est = F * (F.cwiseProduct(F_true).sum() > 0 ? 1 : -1);
+    ASSERT_LT((F_est - F_true).norm(), 0.05);
+}
+
+TEST(EpipolarRansacTests, EightPoint) {
+    const auto scene = makeScene(300, 0.4);
+    EpipolarRansac ransac{EpipolarRansacParams{3.0, 0.99, 2000, 8}};
+    Mat3 F;
+    std::vector<uchar> inliers;
+
+    const auto num_inliers =
+      ransac.estimateFundamental(scene.points_1, scene.points_2, F, inliers);
+    checkInliers(scene, inliers, num_inliers);
+
+    // The result satisfies the rank 2 constraint
+    ASSERT_NEAR(F.determinant(), 0.0, 1e-12);
+}
+
+// Matches are sampled by descriptor distance, but the mask is in match order
+TEST(EpipolarRansacTests, KeypointMatches) {
+    const auto scene = makeScene(200, 0.3);
+    std::vector<cv::KeyPoint> keypoints_1, keypoints_2;
+    std::vector<cv::DMatch> matches;
+
+    // Keypoints of the second image in reverse order, with inliers having the
+    // smallest descriptor distances
+    const int n = static_cast<int>(scene.is_inlier.size());
+    for (int i = 0; i < n; ++i) {
+        const auto &p1 = scene.points_1.col(i);
+        const auto &p2 = scene.points_2.col(n - 1 - i);
+        keypoints_1.emplace_back(p1.x(), p1.y(), 1.0);
+        keypoints_2.emplace_back(p2.x(), p2.y(), 1.0);
+    }
+    for (int i = 0; i < n; ++i) {
+        const float distance = scene.is_inlier[i] ? i % 20 : 20 + i % 20;
+        matches.emplace_back(i, n - 1 - i, distance);
+    }
+
+    EpipolarRansac ransac;
+    Mat3 F;
+    std::vector<uchar> inliers;
+    const auto num_inliers =
+      ransac.estimateFundamental(matches, keypoints_1, keypoints_2, F, inliers);
+    checkInliers(scene, inliers, num_inliers);
+}
+
+TEST(EpipolarRansacTests, RepeatableResults) {
+    const auto scene = makeScene(300, 0.5);
+    EpipolarRansac ransac;
+    Mat3 F1, F2;
+    std::vector<uchar> inliers1, inliers2;
+
+    ransac.estimateFundamental(scene.points_1, scene.points_2, F1, inliers1);
+    ransac.estimateFundamental(scene.points_1, scene.points_2, F2, inliers2);
+    ASSERT_EQ(inliers1, inliers2);
+    ASSERT_TRUE(F1.isApprox(F2));
+}
+
+}  // namespace wave
@@ -1,3 +1,5 @@
+#include <random>
+
 #include "wave/wave_test.hpp"
 #include "wave/vision/utils.hpp"
 #include "wave/vision/matcher/flann_matcher.hpp"
@@ -50,6 +52,9 @@ TEST(FLANNTests, ConstructorTest) {
 
     config.flann_method = FLANN::LSH;
     EXPECT_NO_THROW(FLANNMatcher matcher4(config));
+
+    config.flann_method = FLANN::IncrementalLSH;
+    EXPECT_NO_THROW(FLANNMatcher matcher5(config));
 }
 
 // Check that incorrect parameter values throw exceptions.
@@ -58,7 +63,7 @@ TEST(FLANNTests, BadFLANNMethod) {
     config.flann_method = 0;
     ASSERT_THROW(FLANNMatcher bad_norm1(config), std::invalid_argument);
 
-    config.flann_method = 5;
+    config.flann_method = 6;
     ASSERT_THROW(FLANNMatcher bad_norm2(config), std::invalid_argument);
 }
 
@@ -93,6 +98,19 @@ TEST(FLANNTests, BadFmMethod) {
     ASSERT_THROW(FLANNMatcher bad_fm4(config), std::invalid_argument);
 }
 
+TEST(FLANNTests, BadFmParams) {
+    FLANNMatcherParams config;
+    config.fm_threshold = 0.0;
+    ASSERT_THROW(FLANNMatcher bad_fm_th(config), std::invalid_argument);
+
+    config.fm_threshold = 3.0;
+    config.fm_confidence = 1.5;
+    ASSERT_THROW(FLANNMatcher bad_fm_c1(config), std::invalid_argument);
+
+    config.fm_confidence = 0.0;
+    ASSERT_THROW(FLANNMatcher bad_fm_c2(config), std::invalid_argument);
+}
+
 TEST(FLANNTests, ConfigurationTests) {
     FLANNMatcherParams ref_config;
     FLANNMatcherParams yaml_config(TEST_CONFIG);
@@ -113,6 +131,8 @@ TEST(FLANNTests, ConfigurationTests) {
     ASSERT_EQ(curr_config_1.auto_remove_outliers,
               ref_config.auto_remove_outliers);
     ASSERT_EQ(curr_config_1.fm_method, ref_config.fm_method);
+    ASSERT_EQ(curr_config_1.fm_threshold, ref_config.fm_threshold);
+    ASSERT_EQ(curr_config_1.fm_confidence, ref_config.fm_confidence);
 
     // Confirm default construction
     ASSERT_EQ(curr_config_2.flann_method, ref_config.flann_method);
@@ -122,6 +142,8 @@ TEST(FLANNTests, ConfigurationTests) {
     ASSERT_EQ(curr_config_2.auto_remove_outliers,
               ref_config.auto_remove_outliers);
     ASSERT_EQ(curr_config_2.fm_method, ref_config.fm_method);
+    ASSERT_EQ(curr_config_2.fm_threshold, ref_config.fm_threshold);
+    ASSERT_EQ(curr_config_2.fm_confidence, ref_config.fm_confidence);
 
     // Confirm construction with .yaml file
     ASSERT_EQ(curr_config_3.flann_method, ref_config.flann_method);
@@ -131,5 +153,66 @@ TEST(FLANNTests, ConfigurationTests) {
     ASSERT_EQ(curr_config_3.auto_remove_outliers,
               ref_config.auto_remove_outliers);
     ASSERT_EQ(curr_config_3.fm_method, ref_config.fm_method);
+    ASSERT_EQ(curr_config_3.fm_threshold, ref_config.fm_threshold);
+    ASSERT_EQ(curr_config_3.fm_confidence, ref_config.fm_confidence);
+}
+
+// Matches binary descriptors against noisy copies of themselves
+TEST(FLANNTests, IncrementalLSHMatch) {
+    std::mt19937 gen{1};
+    std::uniform_int_distribution<int> byte(0, 255), bit(0, 255);
+    const int num = 300;
+    cv::Mat train(num, 32, CV_8U), query(num, 32, CV_8U);
+    for (int i = 0; i < num; ++i) {
+        for (int j = 0; j < 32; ++j) {
+            train.at<uchar>(i, j) = static_cast<uchar>(byte(gen));
+            query.at<uchar>(i, j) = train.at<uchar>(i, j);
+        }
+        for (int f = 0; f < 5; ++f) {
+            const auto b = bit(gen);
+            query.at<uchar>(i, b / 8) ^= static_cast<uchar>(1 << (b % 8));
+        }
+    }
+    const std::vector<cv::KeyPoint> keypoints;
+
+    FLANNMatcherParams config;
+    config.flann_method = FLANN::IncrementalLSH;
+    config.auto_remove_outliers = false;
+    FLANNMatcher matcher(config);
+
+    auto matches =
+      matcher.matchDescriptors(query, train, keypoints, keypoints);
+    ASSERT_GE(matches.size(), 0.9 * num);
+    for (const auto &match : matches) {
+        ASSERT_EQ(match.queryIdx, match.trainIdx);
+    }
+
+    // The index is refilled on each call, so a new train set is used
+    cv::Mat half_train = train.rowRange(0, num / 2);
+    matches = matcher.matchDescriptors(query, half_train, keypoints, keypoints);
+    for (const auto &match : matches) {
+        ASSERT_LT(match.trainIdx, num / 2);
+    }
+
+    // Masked pairs are never matched
+    cv::Mat mask(num, num, CV_8U, cv::Scalar(1));
+    for (int i = 0; i < num; ++i) {
+        mask.at<uchar>(i, i) = 0;
+    }
+    matches =
+      matcher.matchDescriptors(query, train, keypoints, keypoints, mask);
+    for (const auto &match : matches) {
+        ASSERT_NE(match.queryIdx, match.trainIdx);
+    }
+
+    // Without the ratio test, each query keeps its nearest neighbour
+    config.use_knn = false;
+    FLANNMatcher distance_matcher(config);
+    matches =
+      distance_matcher.matchDescriptors(query, train, keypoints, keypoints);
+    ASSERT_GE(matches.size(), 0.9 * num);
+    for (const auto &match : matches) {
+        ASSERT_EQ(match.queryIdx, match.trainIdx);
+    }
 }
 }  // namespace wave
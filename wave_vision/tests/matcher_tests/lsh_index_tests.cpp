@@ -0,0 +1,219 @@
+#include <random>
+#include <thread>
+
+#include "wave/wave_test.hpp"
+#include "wave/vision/matcher/lsh_index.hpp"
+
+namespace wave {
+
+const auto TEST_CONFIG = "tests/config/matcher/lsh_index.yaml";
+
+// Descriptor length in bytes, as for ORB
+const int DESCRIPTOR_SIZE = 32;
+
+cv::Mat randomDescriptors(int num, std::mt19937 &gen) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    cv::Mat descriptors(num, DESCRIPTOR_SIZE, CV_8U);
+    for (int i = 0; i < num; ++i) {
+        for (int j = 0; j < DESCRIPTOR_SIZE; ++j) {
+            descriptors.ptr<uchar>(i)[j] = static_cast<uchar>(byte(gen));
+        }
+    }
+    return descriptors;
+}
+
+// Copies descriptors with a number of random bits flipped in each
+cv::Mat perturb(const cv::Mat &descriptors, int num_flips, std::mt19937 &gen) {
+    std::uniform_int_distribution<int> bit(0, 8 * DESCRIPTOR_SIZE - 1);
+    cv::Mat perturbed(descriptors.rows, DESCRIPTOR_SIZE, CV_8U);
+    for (int i = 0; i < descriptors.rows; ++i) {
+        std::copy(descriptors.ptr<uchar>(i),
+                  descriptors.ptr<uchar>(i) + DESCRIPTOR_SIZE,
+                  perturbed.ptr<uchar>(i));
+        for (int f = 0; f < num_flips; ++f) {
+            const auto b = bit(gen);
+            perturbed.ptr<uchar>(i)[b / 8] ^= static_cast<uchar>(1 << (b % 8));
+        }
+    }
+    return perturbed;
+}
+
+std::vector<int> range(int first, int last) {
+    std::vector<int> ids;
+    for (int id = first; id < last; ++id) {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+// Checks that default configuration has no issues
+TEST(LSHIndexTests, GoodConfig) {
+    EXPECT_NO_THROW(LSHIndexParams config1);
+    EXPECT_NO_THROW(LSHIndexParams config2(10, 20, 1, 100));
+    EXPECT_NO_THROW(LSHIndexParams config3(TEST_CONFIG));
+
+    LSHIndexParams ref_config;
+    LSHIndex index{LSHIndexParams{TEST_CONFIG}};
+    const auto curr_config = index.getConfiguration();
+    ASSERT_EQ(curr_config.num_tables, ref_config.num_tables);
+    ASSERT_EQ(curr_config.key_size, ref_config.key_size);
+    ASSERT_EQ(curr_config.multi_probe_level, ref_config.multi_probe_level);
+    ASSERT_EQ(curr_config.max_checks, ref_config.max_checks);
+}
+
+// Checks that incorrect configuration path throws an exception
+TEST(LSHIndexTests, BadConfigPath) {
+    const std::string bad_path = "bad_path";
+
+    ASSERT_THROW(LSHIndexParams config(bad_path), std::invalid_argument);
+}
+
+// Check that incorrect parameter values throw exceptions.
+TEST(LSHIndexTests, BadConfig) {
+    ASSERT_THROW(LSHIndex bad_tables(LSHIndexParams(0, 15, 2, 100)),
+                 std::invalid_argument);
+    ASSERT_THROW(LSHIndex bad_key1(LSHIndexParams(20, 0, 2, 100)),
+                 std::invalid_argument);
+    ASSERT_THROW(LSHIndex bad_key2(LSHIndexParams(20, 33, 2, 100)),
+                 std::invalid_argument);
+    ASSERT_THROW(LSHIndex bad_probe(LSHIndexParams(20, 15, 3, 100)),
+                 std::invalid_argument);
+    ASSERT_THROW(LSHIndex bad_checks(LSHIndexParams(20, 15, 2, 0)),
+                 std::invalid_argument);
+}
+
+TEST(LSHIndexTests, AddRemove) {
+    std::mt19937 gen{1};
+    LSHIndex index;
+    index.add(randomDescriptors(10, gen), range(0, 10));
+    ASSERT_EQ(index.size(), 10u);
+    ASSERT_TRUE(index.contains(3));
+
+    ASSERT_TRUE(index.remove(3));
+    ASSERT_FALSE(index.remove(3));
+    ASSERT_FALSE(index.contains(3));
+    ASSERT_EQ(index.size(), 9u);
+
+    // Ids may be reused once removed, but not while in the index
+    EXPECT_NO_THROW(index.add(randomDescriptors(1, gen), {3}));
+    ASSERT_THROW(index.add(randomDescriptors(1, gen), {3}),
+                 std::invalid_argument);
+    ASSERT_THROW(index.add(randomDescriptors(2, gen), {20, 20}),
+                 std::invalid_argument);
+    ASSERT_EQ(index.size(), 10u);
+
+    // Descriptors must match those already in the index
+    ASSERT_THROW(index.add(cv::Mat(1, 64, CV_8U), {30}),
+                 std::invalid_argument);
+    ASSERT_THROW(index.add(cv::Mat(1, DESCRIPTOR_SIZE, CV_32F), {30}),
+                 std::invalid_argument);
+    ASSERT_THROW(index.add(randomDescriptors(2, gen), {30}),
+                 std::invalid_argument);
+
+    index.clear();
+    ASSERT_EQ(index.size(), 0u);
+    EXPECT_NO_THROW(index.add(cv::Mat(1, 64, CV_8U), {30}));
+}
+
+TEST(LSHIndexTests, NearestNeighbours) {
+    std::mt19937 gen{1};
+    const int num = 2000;
+    const auto stored = randomDescriptors(num, gen);
+    const auto queries = perturb(stored, 10, gen);
+
+    LSHIndex index;
+    // Offset ids, to check that matches refer to ids rather than rows
+    index.add(stored, range(1000, 1000 + num));
+    const auto matches = index.knnMatch(queries, 2);
+    ASSERT_EQ(matches.size(), static_cast<size_t>(num));
+
+    int correct = 0;
+    for (int q = 0; q < num; ++q) {
+        ASSERT_LE(matches[q].size(), 2u);
+        if (matches[q].empty()) {
+            continue;
+        }
+        ASSERT_EQ(matches[q][0].queryIdx, q);
+        if (matches[q].size() == 2) {
+            ASSERT_LE(matches[q][0].distance, matches[q][1].distance);
+        }
+        if (matches[q][0].trainIdx == 1000 + q) {
+            ++correct;
+            ASSERT_LE(matches[q][0].distance, 10.0f);
+        }
+    }
+    ASSERT_GE(correct, 0.95 * num);
+}
+
+TEST(LSHIndexTests, IncrementalUpdates) {
+    std::mt19937 gen{1};
+    const int num = 500;
+    const auto stored = randomDescriptors(num, gen);
+    LSHIndex index;
+    index.add(stored, range(0, num));
+
+    // Replace the first half, as if those tracks died and new ones started
+    for (int id = 0; id < num / 2; ++id) {
+        index.remove(id);
+    }
+    const auto added = randomDescriptors(num / 2, gen);
+    index.add(added, range(num, num + num / 2));
+
+    // Removed descriptors are never matched, even by an exact query
+    for (const auto &query_matches : index.knnMatch(stored, 1)) {
+        for (const auto &match : query_matches) {
+            ASSERT_GE(match.trainIdx, num / 2);
+        }
+    }
+
+    // Added descriptors are found exactly
+    const auto matches = index.knnMatch(added, 1);
+    for (int q = 0; q < num / 2; ++q) {
+        ASSERT_EQ(matches[q].size(), 1u);
+        ASSERT_EQ(matches[q][0].trainIdx, num + q);
+        ASSERT_EQ(matches[q][0].distance, 0.0f);
+    }
+}
+
+TEST(LSHIndexTests, ConcurrentQueries) {
+    std::mt19937 gen{1};
+    const int num = 500;
+    const auto stored = randomDescriptors(num, gen);
+    const auto queries = perturb(stored, 10, gen);
+    LSHIndex index;
+    index.add(stored, range(0, num));
+    const auto expected = index.knnMatch(queries, 2);
+
+    // Queries do not modify the index, so threads may share it
+    std::vector<std::vector<std::vector<cv::DMatch>>> results(4);
+    std::vector<std::thread> threads;
+    for (auto &result : results) {
+        threads.emplace_back(
+          [&index, &queries, &result] { result = index.knnMatch(queries, 2); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (const auto &result : results) {
+        ASSERT_EQ(result.size(), expected.size());
+        for (size_t q = 0; q < expected.size(); ++q) {
+            ASSERT_EQ(result[q].size(), expected[q].size());
+            for (size_t i = 0; i < expected[q].size(); ++i) {
+                ASSERT_EQ(result[q][i].trainIdx, expected[q][i].trainIdx);
+            }
+        }
+    }
+}
+
+TEST(LSHIndexTests, EmptyIndex) {
+    std::mt19937 gen{1};
+    LSHIndex index;
+    const auto matches = index.knnMatch(randomDescriptors(5, gen), 2);
+    ASSERT_EQ(matches.size(), 5u);
+    for (const auto &query_matches : matches) {
+        ASSERT_TRUE(query_matches.empty());
+    }
+}
+
+}  // namespace wave
@@ -0,0 +1,93 @@
+/** Projecting a batch of points from one camera pose.
+ *
+ * The number of points is given by the benchmark argument, and items/s is
+ * points projected per second. BM_PinholeProjectScalar calls the templated
+ * pinholeProject() on each point, as the synthetic camera used to.
+ * BM_PinholeProjectBatch calls pinholeProjectBatch() on all points, and
+ * BM_PinholeProjectBatchJacobians also computes the pose and point Jacobians.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "wave/vision/utils.hpp"
+
+namespace wave {
+
+struct PinholeScene {
+    Mat3 K;
+    Mat3 R_GC;
+    Vec3 G_p_GC{0.5, -0.2, 0.1};
+    Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::RowMajor> points;
+
+    explicit PinholeScene(int num_points) {
+        this->K << 554.38, 0.0, 320.0,  //
+          0.0, 554.38, 320.0,           //
+          0.0, 0.0, 1.0;
+        this->R_GC =
+          Quaternion{Eigen::AngleAxisd(0.3, Vec3{1, 2, 3}.normalized())}
+            .matrix();
+        this->points = 10 * Eigen::Matrix3Xd::Random(3, num_points);
+        this->points.row(2).array() += 20;
+    }
+};
+
+void BM_PinholeProjectScalar(benchmark::State &state) {
+    PinholeScene scene(state.range(0));
+    PinholeProjections result(2, scene.points.cols());
+
+    for (auto _ : state) {
+        for (int i = 0; i < scene.points.cols(); ++i) {
+            Vec2 meas;
+            pinholeProject(scene.K,
+                           scene.R_GC,
+                           scene.G_p_GC,
+                           Vec3{scene.points.col(i)},
+                           meas);
+            result.col(i) = meas;
+        }
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scene.points.cols());
+}
+
+void BM_PinholeProjectBatch(benchmark::State &state) {
+    PinholeScene scene(state.range(0));
+    PinholeProjections result;
+    Eigen::Array<bool, 1, Eigen::Dynamic> in_front;
+
+    for (auto _ : state) {
+        pinholeProjectBatch(
+          scene.K, scene.R_GC, scene.G_p_GC, scene.points, result, in_front);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scene.points.cols());
+}
+
+void BM_PinholeProjectBatchJacobians(benchmark::State &state) {
+    PinholeScene scene(state.range(0));
+    PinholeProjections result;
+    Eigen::Array<bool, 1, Eigen::Dynamic> in_front;
+    Eigen::Matrix<double, 12, Eigen::Dynamic> J_pose;
+    Eigen::Matrix<double, 6, Eigen::Dynamic> J_point;
+
+    for (auto _ : state) {
+        pinholeProjectBatch(scene.K,
+                            scene.R_GC,
+                            scene.G_p_GC,
+                            scene.points,
+                            result,
+                            in_front,
+                            &J_pose,
+                            &J_point);
+        benchmark::DoNotOptimize(J_pose.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scene.points.cols());
+}
+
+BENCHMARK(BM_PinholeProjectScalar)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_PinholeProjectBatch)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_PinholeProjectBatchJacobians)->Arg(1000)->Arg(100000);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
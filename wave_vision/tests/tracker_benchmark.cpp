@@ -0,0 +1,112 @@
+/** Compares the Tracker's descriptor matching and optical flow modes on the
+ * test image sequence, and image preparation with and without reused buffers.
+ *
+ * The items/s counter reported for each benchmark is images per second, and
+ * `tracks` is the mean number of feature tracks in each image.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "wave/vision/detector/fast_detector.hpp"
+#include "wave/vision/detector/orb_detector.hpp"
+#include "wave/vision/descriptor/brisk_descriptor.hpp"
+#include "wave/vision/matcher/brute_force_matcher.hpp"
+#include "wave/vision/tracker/tracker.hpp"
+
+namespace wave {
+
+const auto FIRST_IMG_PATH = "tests/data/tracker_test_sequence/frame0057.jpg";
+
+const std::vector<cv::Mat> &imageSequence() {
+    static const auto images = readImageSequence(FIRST_IMG_PATH);
+    return images;
+}
+
+/** Tracks the whole sequence with `tracker`, recording the mean track count */
+template <typename TTracker>
+void trackSequence(benchmark::State &state, TTracker make_tracker) {
+    const auto &images = imageSequence();
+    std::size_t num_tracks = 0;
+
+    for (auto _ : state) {
+        auto tracker = make_tracker();
+        const auto tracks = tracker.offlineTracker(images);
+        for (const auto &t : tracks) {
+            num_tracks += t.size();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * images.size());
+    state.counters["tracks"] =
+      static_cast<double>(num_tracks) / (state.iterations() * images.size());
+}
+
+/** Baseline: ORB detection, BRISK description and brute force matching in
+ * every image */
+void BM_DescriptorTracker(benchmark::State &state) {
+    trackSequence(state, [] {
+        return Tracker<ORBDetector, BRISKDescriptor, BruteForceMatcher>{
+          ORBDetector{}, BRISKDescriptor{}, BruteForceMatcher{}};
+    });
+}
+
+/** Optical flow tracking, with ORB detection only in sparse cells */
+void BM_KLTTrackerORB(benchmark::State &state) {
+    trackSequence(state, [] {
+        return Tracker<ORBDetector, BRISKDescriptor, BruteForceMatcher>{
+          ORBDetector{},
+          BRISKDescriptor{},
+          BruteForceMatcher{},
+          KLTTrackerParams{}};
+    });
+}
+
+/** Optical flow tracking, with FAST detection only in sparse cells */
+void BM_KLTTrackerFAST(benchmark::State &state) {
+    trackSequence(state, [] {
+        return Tracker<FASTDetector, BRISKDescriptor, BruteForceMatcher>{
+          FASTDetector{},
+          BRISKDescriptor{},
+          BruteForceMatcher{},
+          KLTTrackerParams{}};
+    });
+}
+
+/** Preparing each image in a new ImageFrame, allocating every buffer */
+void BM_FramePyramidFresh(benchmark::State &state) {
+    const auto &images = imageSequence();
+    const cv::Size win{21, 21};
+    std::size_t i = 0;
+
+    for (auto _ : state) {
+        ImageFrame frame;
+        frame.setImage(images[i++ % images.size()]);
+        benchmark::DoNotOptimize(frame.pyramid(win, 3).data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** Preparing each image in one of two alternating frames, as the Tracker
+ * does, reusing their buffers */
+void BM_FramePyramidPooled(benchmark::State &state) {
+    const auto &images = imageSequence();
+    const cv::Size win{21, 21};
+    ImageFrame frames[2];
+    std::size_t i = 0;
+
+    for (auto _ : state) {
+        auto &frame = frames[i % 2];
+        frame.setImage(images[i++ % images.size()]);
+        benchmark::DoNotOptimize(frame.pyramid(win, 3).data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DescriptorTracker)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_KLTTrackerORB)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_KLTTrackerFAST)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FramePyramidFresh)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FramePyramidPooled)->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();
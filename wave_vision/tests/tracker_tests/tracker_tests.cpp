@@ -14,6 +14,7 @@ namespace wave {
 const auto TEST_IMAGE_0 = "tests/data/tracker_test_sequence/frame0059.jpg";
 const auto TEST_IMAGE_1 = "tests/data/tracker_test_sequence/frame0060.jpg";
 const auto TEST_IMAGE_2 = "tests/data/tracker_test_sequence/frame0061.jpg";
+const auto TEST_KLT_CONFIG = "tests/config/tracker/klt.yaml";
 
 TEST(TrackerTests, ConstructorTest) {
     FASTDetector detector1;
@@ -109,4 +110,94 @@ TEST(TrackerTests, OfflineTrackerNoImages) {
 
     ASSERT_THROW(tracker.offlineTracker(image_sequence), std::invalid_argument);
 }
+
+// Tracking a streamed sequence gives the same tracks as a loaded one
+TEST(TrackerTests, OfflineTrackerImageSequence) {
+    const auto first_image = "tests/data/tracker_test_sequence/frame0057.jpg";
+    FASTDetector detector;
+    BRISKDescriptor descriptor;
+    BruteForceMatcher matcher;
+
+    Tracker<FASTDetector, BRISKDescriptor, BruteForceMatcher> tracker1(
+      detector, descriptor, matcher);
+    Tracker<FASTDetector, BRISKDescriptor, BruteForceMatcher> tracker2(
+      detector, descriptor, matcher);
+
+    const auto loaded = tracker1.offlineTracker(readImageSequence(first_image));
+    ImageSequence sequence{first_image};
+    const auto streamed = tracker2.offlineTracker(sequence);
+
+    ASSERT_EQ(loaded.size(), streamed.size());
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        ASSERT_EQ(loaded[i].size(), streamed[i].size());
+    }
+
+    // The sequence has now been read, so there are no images left to track
+    ASSERT_THROW(tracker2.offlineTracker(sequence), std::invalid_argument);
+}
+
+TEST(TrackerTests, KLTParamsConfigTest) {
+    KLTTrackerParams params{TEST_KLT_CONFIG};
+    ASSERT_EQ(params.patch_size, 21);
+    ASSERT_EQ(params.max_level, 3);
+    ASSERT_EQ(params.grid_rows, 4);
+    ASSERT_EQ(params.grid_cols, 4);
+
+    ASSERT_THROW(KLTTrackerParams{"bad_path"}, std::invalid_argument);
+}
+
+TEST(TrackerTests, KLTBadParams) {
+    FASTDetector detector;
+    BRISKDescriptor descriptor;
+    BruteForceMatcher matcher;
+    KLTTrackerParams params;
+    params.grid_rows = 0;
+
+    using KLTTracker =
+      Tracker<FASTDetector, BRISKDescriptor, BruteForceMatcher>;
+    ASSERT_THROW(KLTTracker(detector, descriptor, matcher, params),
+                 std::invalid_argument);
+}
+
+TEST(TrackerTests, KLTAddImageGetTracks) {
+    FASTDetector detector;
+    BRISKDescriptor descriptor;
+    BruteForceMatcher matcher;
+    KLTTrackerParams params;
+
+    std::chrono::steady_clock clock;
+
+    Tracker<FASTDetector, BRISKDescriptor, BruteForceMatcher> tracker(
+      detector, descriptor, matcher, params);
+    ASSERT_EQ(TrackingMode::OPTICAL_FLOW, tracker.getMode());
+
+    int window_size = 2;
+    Tracker<FASTDetector, BRISKDescriptor, BruteForceMatcher> tracker2(
+      detector, descriptor, matcher, params, window_size);
+
+    for (const auto &path : {TEST_IMAGE_0, TEST_IMAGE_1, TEST_IMAGE_2}) {
+        cv::Mat image = cv::imread(path);
+        auto time = clock.now();
+        tracker.addImage(image, time);
+        tracker2.addImage(image, time);
+    }
+
+    ASSERT_TRUE(tracker.getTracks(0).empty());
+    ASSERT_THROW(tracker2.getTracks(0), std::out_of_range);
+
+    // Features persist over the sequence, with small inter-frame motion
+    std::vector<FeatureTrack> ft2 = tracker.getTracks(2);
+    ASSERT_FALSE(ft2.empty());
+    bool long_track = false;
+    for (const auto &ft : ft2) {
+        long_track = long_track || ft.size() == 3;
+        for (size_t i = 1; i < ft.size(); ++i) {
+            ASSERT_LT((ft[i].value - ft[i - 1].value).norm(), 50.0);
+        }
+    }
+    ASSERT_TRUE(long_track);
+    ASSERT_FALSE(tracker2.getTracks(2).empty());
+
+    ASSERT_TRUE(tracker.lmc_size > tracker2.lmc_size);
+}
 }  // namespace wave
@@ -198,6 +198,102 @@ TEST_F(PinholeProjectTest, projectKnownPoint) {
     EXPECT_PRED2(VectorsNear, expected, meas);
 }
 
+TEST_F(PinholeProjectTest, projectBatchMatchesSingle) {
+    auto G_p_GC = Vec3{1.0, -0.5, 0.2};
+    auto q_GB = Quaternion{Eigen::AngleAxisd(0.3, Vec3::UnitZ())};
+    auto R_GC = Mat3{q_GB * this->q_BC};
+
+    // Points spread around the camera, some of them behind it
+    srand(2);
+    const Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::RowMajor> points =
+      10 * Eigen::Matrix3Xd::Random(3, 100);
+
+    PinholeProjections result;
+    Eigen::Array<bool, 1, Eigen::Dynamic> in_front;
+    pinholeProjectBatch(this->K, R_GC, G_p_GC, points, result, in_front);
+    ASSERT_EQ(100, result.cols());
+    ASSERT_EQ(100, in_front.cols());
+
+    Eigen::Matrix<double, 12, Eigen::Dynamic> J_pose;
+    Eigen::Matrix<double, 6, Eigen::Dynamic> J_point;
+    PinholeProjections result_jac;
+    Eigen::Array<bool, 1, Eigen::Dynamic> in_front_jac;
+    pinholeProjectBatch(this->K,
+                        R_GC,
+                        G_p_GC,
+                        points,
+                        result_jac,
+                        in_front_jac,
+                        &J_pose,
+                        &J_point);
+
+    for (int i = 0; i < points.cols(); ++i) {
+        Vec2 expected;
+        Eigen::Matrix<double, 2, 6> expected_J_pose;
+        Eigen::Matrix<double, 2, 3> expected_J_point;
+        const bool res = pinholeProject(this->K,
+                                        R_GC,
+                                        G_p_GC,
+                                        Vec3{points.col(i)},
+                                        expected,
+                                        &expected_J_pose,
+                                        &expected_J_point);
+        EXPECT_EQ(res, in_front(i));
+        EXPECT_EQ(res, in_front_jac(i));
+        EXPECT_PRED2(VectorsNear, expected, Vec2{result.col(i)});
+        EXPECT_PRED2(VectorsNear, expected, Vec2{result_jac.col(i)});
+        EXPECT_PRED2(MatricesNear,
+                     expected_J_pose,
+                     (Eigen::Map<Eigen::Matrix<double, 2, 6>>{
+                       J_pose.col(i).data()}));
+        EXPECT_PRED2(MatricesNear,
+                     expected_J_point,
+                     (Eigen::Map<Eigen::Matrix<double, 2, 3>>{
+                       J_point.col(i).data()}));
+    }
+}
+
+TEST_F(PinholeProjectTest, projectJacobians) {
+    auto G_p_GF = Vec3{12.0, -3.4, 2.1};
+    auto G_p_GC = Vec3{5.0, 0.5, -0.3};
+    auto q_GB = Quaternion{Eigen::AngleAxisd(0.2, Vec3{1, 2, 3}.normalized())};
+    auto R_GC = Mat3{q_GB * this->q_BC};
+
+    Vec2 meas;
+    Eigen::Matrix<double, 2, 6> J_pose;
+    Eigen::Matrix<double, 2, 3> J_point;
+    ASSERT_TRUE(pinholeProject(
+      this->K, R_GC, G_p_GC, G_p_GF, meas, &J_pose, &J_point));
+
+    // Compare to central differences, perturbing the rotation on the right
+    const double h = 1e-6;
+    Eigen::Matrix<double, 2, 6> numerical_J_pose;
+    Eigen::Matrix<double, 2, 3> numerical_J_point;
+    for (int j = 0; j < 3; ++j) {
+        const Vec3 d = h * Vec3::Unit(j);
+        const Mat3 R_plus =
+          R_GC * Eigen::AngleAxisd(h, Vec3::Unit(j)).toRotationMatrix();
+        const Mat3 R_minus =
+          R_GC * Eigen::AngleAxisd(-h, Vec3::Unit(j)).toRotationMatrix();
+        Vec2 plus, minus;
+
+        pinholeProject(this->K, R_plus, G_p_GC, G_p_GF, plus);
+        pinholeProject(this->K, R_minus, G_p_GC, G_p_GF, minus);
+        numerical_J_pose.col(j) = (plus - minus) / (2 * h);
+
+        pinholeProject(this->K, R_GC, Vec3{G_p_GC + d}, G_p_GF, plus);
+        pinholeProject(this->K, R_GC, Vec3{G_p_GC - d}, G_p_GF, minus);
+        numerical_J_pose.col(3 + j) = (plus - minus) / (2 * h);
+
+        pinholeProject(this->K, R_GC, G_p_GC, Vec3{G_p_GF + d}, plus);
+        pinholeProject(this->K, R_GC, G_p_GC, Vec3{G_p_GF - d}, minus);
+        numerical_J_point.col(j) = (plus - minus) / (2 * h);
+    }
+
+    EXPECT_TRUE(J_pose.isApprox(numerical_J_pose, 1e-6));
+    EXPECT_TRUE(J_point.isApprox(numerical_J_point, 1e-6));
+}
+
 TEST(VisionYamlConfig, loadCvMatParam) {
     wave::ConfigParser parser;
     cv::Mat cvmat;
@@ -0,0 +1,112 @@
+/** Generating a VoDataset, and loading one from the text directory format and
+ * the binary format.
+ *
+ * For loading, the dataset from tests/data/vo_test.yaml is repeated the number
+ * of times given by the benchmark argument, to give longer sequences. items/s
+ * is feature observations loaded per second. BM_MapBinary only maps the file
+ * and reads every observation in place, without building a VoDataset.
+ *
+ * BM_GenerateDataset generates the test dataset with the number of landmarks
+ * given by the benchmark argument, and items/s is landmarks projected into
+ * camera frames per second.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "wave/vision/dataset/VoDataset.hpp"
+#include "wave/vision/dataset/VoDatasetBinary.hpp"
+
+namespace wave {
+
+const auto TEST_CONFIG = "tests/data/vo_test.yaml";
+const auto TEXT_OUTPUT = "/tmp/vo_dataset_benchmark";
+const auto BINARY_OUTPUT = "/tmp/vo_dataset_benchmark.vod";
+
+/** Generates a dataset with the generated trajectory repeated `repeats`
+ * times, and returns its number of observations */
+std::size_t writeDataset(int repeats) {
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    const auto generated = generator.generate();
+
+    VoDataset dataset = generated;
+    dataset.states.clear();
+    std::size_t num_observations = 0;
+    for (int r = 0; r < repeats; ++r) {
+        const auto time_offset = r * (generated.states.back().time + 0.01);
+        for (auto state : generated.states) {
+            state.time += time_offset;
+            num_observations += state.features_observed.size();
+            dataset.states.push_back(state);
+        }
+    }
+
+    remove_dir(TEXT_OUTPUT);
+    dataset.outputToDirectory(TEXT_OUTPUT);
+    dataset.outputBinary(BINARY_OUTPUT);
+    return num_observations;
+}
+
+void BM_LoadFromDirectory(benchmark::State &state) {
+    const auto num_observations = writeDataset(state.range(0));
+
+    for (auto _ : state) {
+        const auto dataset = VoDataset::loadFromDirectory(TEXT_OUTPUT);
+        benchmark::DoNotOptimize(dataset.states.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_observations);
+}
+
+void BM_LoadFromBinary(benchmark::State &state) {
+    const auto num_observations = writeDataset(state.range(0));
+
+    for (auto _ : state) {
+        const auto dataset = VoDataset::loadFromBinary(BINARY_OUTPUT);
+        benchmark::DoNotOptimize(dataset.states.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_observations);
+}
+
+void BM_MapBinary(benchmark::State &state) {
+    const auto num_observations = writeDataset(state.range(0));
+
+    for (auto _ : state) {
+        MappedVoDataset dataset{BINARY_OUTPUT};
+        Vec2 sum = Vec2::Zero();
+        for (std::size_t i = 0; i < dataset.size(); ++i) {
+            const auto instant = dataset[i];
+            for (std::size_t k = 0; k < instant.size(); ++k) {
+                sum += instant.measurement(k);
+            }
+        }
+        benchmark::DoNotOptimize(sum.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_observations);
+}
+
+void BM_GenerateDataset(benchmark::State &state) {
+    VoDatasetGenerator generator;
+    generator.configure(TEST_CONFIG);
+    generator.nb_landmarks = state.range(0);
+    std::size_t num_frames = 0;
+
+    for (auto _ : state) {
+        generator.camera.dt = 0;
+        const auto dataset = generator.generate();
+        num_frames = dataset.states.size();
+    }
+    state.SetItemsProcessed(state.iterations() * num_frames *
+                            generator.nb_landmarks);
+}
+
+BENCHMARK(BM_GenerateDataset)
+  ->Arg(10000)
+  ->Arg(1000000)
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadFromDirectory)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadFromBinary)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MapBinary)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+
+}  // namespace wave
+
+BENCHMARK_MAIN();